@@ -0,0 +1,288 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "DataDefinition.h"
+
+/**
+* The numbers that change, one double each: what the pipeline works with, and the state definition's layout
+* before it was packed into PackedAircraftState. Recordings made then still carry it.
+*/
+struct AircraftState
+{
+    double  isUser;
+    double  onGround;
+    double  trueHeading;    // radians
+    double  magHeading;     // radians
+    double  altitude;       // feet
+    double  latitude;
+    double  longitude;
+    double  groundSpeed;    // knots
+    double  verticalSpeed;  // feet per minute
+    double  groundTrack;    // radians true: the direction groundSpeed is along, which the wind turns away from the heading
+};
+
+/**
+* The fields of AircraftState in order. Each one is also its DatumID in the state definition, so a tagged
+* (changed-only) record names the fields it carries.
+*/
+enum AircraftStateField : uint32_t
+{
+    STATE_IS_USER,
+    STATE_ON_GROUND,
+    STATE_TRUE_HEADING,
+    STATE_MAG_HEADING,
+    STATE_ALTITUDE,
+    STATE_LATITUDE,
+    STATE_LONGITUDE,
+    STATE_GROUND_SPEED,
+    STATE_VERTICAL_SPEED,
+    STATE_GROUND_TRACK,
+    STATE_FIELD_COUNT,
+};
+
+constexpr uint32_t STATE_ALL_FIELDS = (1u << STATE_FIELD_COUNT) - 1;
+
+static_assert(sizeof(AircraftState) == STATE_FIELD_COUNT * sizeof(double), "every field is one double, in AircraftStateField order");
+
+template <>
+struct WireRecord<AircraftState>
+{
+    static constexpr WireField fields[] =
+    {
+        WIRE_FIELD(AircraftState, isUser, "Is User Sim", "bool", WIRE_FLOAT64, STATE_IS_USER),
+        WIRE_FIELD(AircraftState, onGround, "Sim On Ground", "bool", WIRE_FLOAT64, STATE_ON_GROUND),
+        WIRE_FIELD(AircraftState, trueHeading, "Plane Heading Degrees True", "radians", WIRE_FLOAT64, STATE_TRUE_HEADING),
+        WIRE_FIELD(AircraftState, magHeading, "Plane Heading Degrees Magnetic", "radians", WIRE_FLOAT64, STATE_MAG_HEADING),
+        WIRE_FIELD(AircraftState, altitude, "Plane Altitude", "feet", WIRE_FLOAT64, STATE_ALTITUDE),
+        WIRE_FIELD(AircraftState, latitude, "Plane Latitude", "degrees", WIRE_FLOAT64, STATE_LATITUDE),
+        WIRE_FIELD(AircraftState, longitude, "Plane Longitude", "degrees", WIRE_FLOAT64, STATE_LONGITUDE),
+        WIRE_FIELD(AircraftState, groundSpeed, "Ground Velocity", "knots", WIRE_FLOAT64, STATE_GROUND_SPEED),
+        WIRE_FIELD(AircraftState, verticalSpeed, "Vertical Speed", "feet per minute", WIRE_FLOAT64, STATE_VERTICAL_SPEED),
+        WIRE_FIELD(AircraftState, groundTrack, "GPS Ground True Track", "radians", WIRE_FLOAT64, STATE_GROUND_TRACK),
+    };
+};
+
+static_assert(isWireLayout<AircraftState>() && hasPositionalDatumIds<AircraftState>(), "AircraftState does not match its description");
+
+/**
+* Layout of DEFINITION_AIRCRAFT_STATE, requested every sweep and by every tracked aircraft. The same fields as
+* AircraftState, packed for the wire: the flags as INT32 and everything but the position as FLOAT32, which
+* still resolves a heading to a millionth of a radian and an altitude to a hundredth of a foot. 48 bytes
+* instead of 80 per aircraft.
+*/
+#pragma pack(push, 1)
+struct PackedAircraftState
+{
+    int32_t isUser;
+    int32_t onGround;
+    float   trueHeading;    // radians
+    float   magHeading;     // radians
+    float   altitude;       // feet
+    double  latitude;
+    double  longitude;
+    float   groundSpeed;    // knots
+    float   verticalSpeed;  // feet per minute
+    float   groundTrack;    // radians true
+};
+#pragma pack(pop)
+
+template <>
+struct WireRecord<PackedAircraftState>
+{
+    static constexpr WireField fields[] =
+    {
+        WIRE_FIELD(PackedAircraftState, isUser, "Is User Sim", "bool", WIRE_INT32, STATE_IS_USER),
+        WIRE_FIELD(PackedAircraftState, onGround, "Sim On Ground", "bool", WIRE_INT32, STATE_ON_GROUND),
+        WIRE_FIELD(PackedAircraftState, trueHeading, "Plane Heading Degrees True", "radians", WIRE_FLOAT32, STATE_TRUE_HEADING),
+        WIRE_FIELD(PackedAircraftState, magHeading, "Plane Heading Degrees Magnetic", "radians", WIRE_FLOAT32, STATE_MAG_HEADING),
+        WIRE_FIELD(PackedAircraftState, altitude, "Plane Altitude", "feet", WIRE_FLOAT32, STATE_ALTITUDE),
+        WIRE_FIELD(PackedAircraftState, latitude, "Plane Latitude", "degrees", WIRE_FLOAT64, STATE_LATITUDE),
+        WIRE_FIELD(PackedAircraftState, longitude, "Plane Longitude", "degrees", WIRE_FLOAT64, STATE_LONGITUDE),
+        WIRE_FIELD(PackedAircraftState, groundSpeed, "Ground Velocity", "knots", WIRE_FLOAT32, STATE_GROUND_SPEED),
+        WIRE_FIELD(PackedAircraftState, verticalSpeed, "Vertical Speed", "feet per minute", WIRE_FLOAT32, STATE_VERTICAL_SPEED),
+        WIRE_FIELD(PackedAircraftState, groundTrack, "GPS Ground True Track", "radians", WIRE_FLOAT32, STATE_GROUND_TRACK),
+    };
+};
+
+static_assert(isWireLayout<PackedAircraftState>() && hasPositionalDatumIds<PackedAircraftState>(), "PackedAircraftState does not match its description");
+static_assert(wireFieldCount<PackedAircraftState>() == STATE_FIELD_COUNT && wireFieldCount<AircraftState>() == STATE_FIELD_COUNT, "one datum per state field");
+
+inline AircraftState stateOf(const PackedAircraftState& packed)
+{
+    AircraftState state;
+    state.isUser = packed.isUser;
+    state.onGround = packed.onGround;
+    state.trueHeading = packed.trueHeading;
+    state.magHeading = packed.magHeading;
+    state.altitude = packed.altitude;
+    state.latitude = packed.latitude;
+    state.longitude = packed.longitude;
+    state.groundSpeed = packed.groundSpeed;
+    state.verticalSpeed = packed.verticalSpeed;
+    state.groundTrack = packed.groundTrack;
+    return state;
+}
+
+inline PackedAircraftState packState(const AircraftState& state)
+{
+    PackedAircraftState packed;
+    packed.isUser = state.isUser != 0;
+    packed.onGround = state.onGround != 0;
+    packed.trueHeading = (float)state.trueHeading;
+    packed.magHeading = (float)state.magHeading;
+    packed.altitude = (float)state.altitude;
+    packed.latitude = state.latitude;
+    packed.longitude = state.longitude;
+    packed.groundSpeed = (float)state.groundSpeed;
+    packed.verticalSpeed = (float)state.verticalSpeed;
+    packed.groundTrack = (float)state.groundTrack;
+    return packed;
+}
+
+/**
+* How far a field must move before a changed-only request sends it again, in the units of the state
+* definition. Smaller moves are not sent at all; dead reckoning covers them until the next update.
+*/
+struct StateEpsilons
+{
+    float heading;              // radians, also the ground track
+    float altitude;             // feet
+    float position;             // degrees of latitude or longitude
+    float groundSpeed;          // knots
+    float verticalSpeed;        // feet per minute
+};
+
+// About 0.1 degree, 1 ft, 1 m, half a knot and 20 fpm: below what the report or the conflict probe can use
+constexpr StateEpsilons DEFAULT_STATE_EPSILONS = { 0.002f, 1, 0.00001f, 0.5f, 20 };
+
+// The epsilon of one AircraftStateField; the flags are sent whenever they change
+inline float stateEpsilon(const StateEpsilons& epsilons, uint32_t field)
+{
+    switch (field)
+    {
+    case STATE_TRUE_HEADING:
+    case STATE_MAG_HEADING:
+    case STATE_GROUND_TRACK: return epsilons.heading;
+    case STATE_ALTITUDE: return epsilons.altitude;
+    case STATE_LATITUDE:
+    case STATE_LONGITUDE: return epsilons.position;
+    case STATE_GROUND_SPEED: return epsilons.groundSpeed;
+    case STATE_VERTICAL_SPEED: return epsilons.verticalSpeed;
+    default: return 0;
+    }
+}
+
+/**
+* Copy the fields set in fields (bits of AircraftStateField) from from into into.
+*/
+inline void mergeStateFields(AircraftState& into, const AircraftState& from, uint32_t fields)
+{
+    for (uint32_t field = 0; field < STATE_FIELD_COUNT; field++)
+    {
+        if (fields & (1u << field))
+            memcpy((char*)&into + field * sizeof(double), (const char*)&from + field * sizeof(double), sizeof(double));
+    }
+}
+
+/**
+* Layout of DEFINITION_OWNSHIP, requested every sim frame on SIMCONNECT_OBJECT_ID_USER.
+*/
+struct OwnshipState
+{
+    double  latitude;
+    double  longitude;
+    double  altitude;       // feet
+    double  trueHeading;    // radians
+    double  groundSpeed;    // knots
+    double  verticalSpeed;  // feet per minute
+};
+
+template <>
+struct WireRecord<OwnshipState>
+{
+    static constexpr WireField fields[] =
+    {
+        WIRE_FIELD(OwnshipState, latitude, "Plane Latitude", "degrees", WIRE_FLOAT64, WIRE_UNUSED_DATUM),
+        WIRE_FIELD(OwnshipState, longitude, "Plane Longitude", "degrees", WIRE_FLOAT64, WIRE_UNUSED_DATUM),
+        WIRE_FIELD(OwnshipState, altitude, "Plane Altitude", "feet", WIRE_FLOAT64, WIRE_UNUSED_DATUM),
+        WIRE_FIELD(OwnshipState, trueHeading, "Plane Heading Degrees True", "radians", WIRE_FLOAT64, WIRE_UNUSED_DATUM),
+        WIRE_FIELD(OwnshipState, groundSpeed, "Ground Velocity", "knots", WIRE_FLOAT64, WIRE_UNUSED_DATUM),
+        WIRE_FIELD(OwnshipState, verticalSpeed, "Vertical Speed", "feet per minute", WIRE_FLOAT64, WIRE_UNUSED_DATUM),
+    };
+};
+
+static_assert(isWireLayout<OwnshipState>(), "OwnshipState does not match its description");
+
+/**
+* Layout of DEFINITION_AIRCRAFT_TITLE, requested once per new ObjectID.
+*/
+struct AircraftTitle
+{
+    char    title[256];
+};
+
+template <>
+struct WireRecord<AircraftTitle>
+{
+    static constexpr WireField fields[] = { WIRE_FIELD(AircraftTitle, title, "Title", NULL, WIRE_STRING256, WIRE_UNUSED_DATUM) };
+};
+
+static_assert(isWireLayout<AircraftTitle>(), "AircraftTitle does not match its description");
+
+/**
+* Layout of DEFINITION_AIRCRAFT_IDENTITY: what names one aircraft alike on every simulator of a shared session,
+* where ObjectIDs differ. TrafficAggregator requests it once per new ObjectID of each source.
+*/
+struct AircraftIdentity
+{
+    char    title[256];
+    char    atcId[32];
+};
+
+template <>
+struct WireRecord<AircraftIdentity>
+{
+    static constexpr WireField fields[] =
+    {
+        WIRE_FIELD(AircraftIdentity, title, "Title", NULL, WIRE_STRING256, WIRE_UNUSED_DATUM),
+        WIRE_FIELD(AircraftIdentity, atcId, "ATC ID", NULL, WIRE_STRING32, WIRE_UNUSED_DATUM),
+    };
+};
+
+static_assert(isWireLayout<AircraftIdentity>(), "AircraftIdentity does not match its description");
+
+/**
+* Layout of TRAFFIC_DEFINITION_COMBINED, the original single definition: the title followed by the state.
+* Live sessions no longer request it, but recordings made with it still replay.
+*/
+struct AircraftInfo
+{
+    char    title[256];
+    double  isUser;
+    double  onGround;
+    double  trueHeading;
+    double  magHeading;
+    double  altitude;
+    double  latitude;
+    double  longitude;
+};
+
+/**
+* The state part of a combined record; it never carried speeds, so the heading stands in for the track.
+*/
+inline AircraftState stateOf(const AircraftInfo& info)
+{
+    AircraftState state = {};
+    state.isUser = info.isUser;
+    state.onGround = info.onGround;
+    state.trueHeading = info.trueHeading;
+    state.magHeading = info.magHeading;
+    state.altitude = info.altitude;
+    state.latitude = info.latitude;
+    state.longitude = info.longitude;
+    state.groundTrack = info.trueHeading;
+    return state;
+}
@@ -0,0 +1,265 @@
+#include <charconv>
+#include <chrono>
+#include <string.h>
+#include <vector>
+
+#include "AsyncOutput.h"
+
+static const size_t WRITE_BUFFER_SIZE = 64 * 1024;
+static const int IDLE_WAIT_MS = 2;
+
+/**
+* Append-only view of a fixed buffer; anything past the end is cut off.
+*/
+class TextWriter
+{
+public:
+    TextWriter(char* buffer, size_t size) : m_next(buffer), m_end(buffer + size), m_begin(buffer) {}
+
+    size_t length() const { return m_next - m_begin; }
+
+    void text(const char* value)
+    {
+        while (*value && m_next < m_end)
+            *m_next++ = *value++;
+    }
+
+    void number(uint64_t value)
+    {
+        m_next = std::to_chars(m_next, m_end, value).ptr;
+    }
+
+    void fixed(double value, int precision)
+    {
+        std::to_chars_result result = std::to_chars(m_next, m_end, value, std::chars_format::fixed, precision);
+        m_next = result.ec == std::errc() ? result.ptr : m_end;
+    }
+
+private:
+    char* m_next;
+    char* m_end;
+    char* m_begin;
+};
+
+size_t formatOutputRecord(const OutputRecord& record, char* buffer, size_t size)
+{
+    TextWriter out(buffer, size);
+    char title[OUTPUT_TITLE_LENGTH + 1];
+    memcpy(title, record.title, OUTPUT_TITLE_LENGTH);
+    title[OUTPUT_TITLE_LENGTH] = '\0';
+
+    switch (record.kind)
+    {
+    case OUTPUT_SWEEP:
+        out.text("\nSweep indexed: ");
+        out.number(record.aircraftCount);
+        out.text(" aircraft, nearest:");
+        for (uint32_t i = 0; i < record.nearestCount && i < OUTPUT_NEAREST_MAX; i++)
+        {
+            out.text("  ");
+            out.number(record.nearestIds[i]);
+            out.text(" (");
+            out.fixed(record.nearestRangeNm[i], 2);
+            out.text("nm)");
+        }
+        out.text("\n");
+        break;
+
+    case OUTPUT_USER_AIRCRAFT:
+    case OUTPUT_TRAFFIC:
+        out.text(record.kind == OUTPUT_USER_AIRCRAFT ? "\nUSER AIRCRAFT!!!\nObjectID=" : "\nObjectID=");
+        out.number(record.objectId);
+        out.text("  Title=\"");
+        out.text(title);
+        out.text("\"\nLat=");
+        out.fixed(record.latitude, 6);
+        out.text("  Lon=");
+        out.fixed(record.longitude, 6);
+        out.text("  Alt=");
+        out.fixed(record.altitude, 6);
+        out.text("ft  HdgT=");
+        out.fixed(record.trueHeading, 2);
+        out.text("  HdgM=");
+        out.fixed(record.magHeading, 2);
+        out.text("  OnGround=");
+        out.fixed(record.onGround, 6);
+        if (record.kind == OUTPUT_TRAFFIC)
+        {
+            out.text("  Range=");
+            out.fixed(record.rangeNm, 2);
+            out.text("nm  Brng=");
+            out.fixed(record.bearingDeg, 2);
+            out.text("  Elev=");
+            out.fixed(record.elevationDeg, 2);
+        }
+        out.text("\n");
+        break;
+
+    case OUTPUT_CONFLICT:
+        out.text("\nCONFLICT: ");
+        out.number(record.objectId);
+        out.text(" and ");
+        out.number(record.otherId);
+        out.text(" lose separation in ");
+        out.fixed(record.lossSeconds, 0);
+        out.text("s, closest ");
+        out.fixed(record.cpaRangeNm, 2);
+        out.text("nm ");
+        out.fixed(record.cpaVerticalFt, 0);
+        out.text("ft in ");
+        out.fixed(record.cpaSeconds, 0);
+        out.text("s\n");
+        break;
+
+    case OUTPUT_CONFLICT_CLEARED:
+        out.text("\nConflict cleared: ");
+        out.number(record.objectId);
+        out.text(" and ");
+        out.number(record.otherId);
+        out.text("\n");
+        break;
+    }
+
+    return out.length();
+}
+
+AsyncOutput::AsyncOutput(FILE* sink, size_t capacity, OverflowPolicy policy)
+    : m_sink(sink)
+    , m_policy(policy)
+    , m_ring(capacity)
+    , m_stopping(false)
+    , m_queued(0)
+    , m_written(0)
+    , m_dropped(0)
+    , m_blocked(0)
+    , m_batches(0)
+    , m_highWater(0)
+    , m_blockedNs(0)
+    , m_busyNs(0)
+    , m_latency(NULL)
+{
+}
+
+AsyncOutput::~AsyncOutput()
+{
+    stop();
+}
+
+void AsyncOutput::start()
+{
+    if (m_writer.joinable())
+        return;
+
+    m_stopping.store(false);
+    m_writer = std::thread(&AsyncOutput::writerLoop, this);
+}
+
+void AsyncOutput::stop()
+{
+    if (!m_writer.joinable())
+        return;
+
+    m_stopping.store(true, std::memory_order_release);
+    m_writer.join();
+}
+
+bool AsyncOutput::push(const OutputRecord& record)
+{
+    if (!m_ring.tryPush(record))
+    {
+        if (m_policy != OVERFLOW_BLOCK || !m_writer.joinable())
+        {
+            m_dropped.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+
+        m_blocked.fetch_add(1, std::memory_order_relaxed);
+        auto start = std::chrono::steady_clock::now();
+        while (!m_ring.tryPush(record))
+            std::this_thread::yield();
+        auto waited = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+        m_blockedNs.store(m_blockedNs.load(std::memory_order_relaxed) + waited, std::memory_order_relaxed);
+    }
+
+    // Only this thread writes these, so a load/store pair is enough
+    m_queued.store(m_queued.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    uint64_t depth = m_ring.size();
+    if (depth > m_highWater.load(std::memory_order_relaxed))
+        m_highWater.store(depth, std::memory_order_relaxed);
+    return true;
+}
+
+OutputStats AsyncOutput::stats() const
+{
+    OutputStats stats;
+    stats.queued = m_queued.load(std::memory_order_relaxed);
+    stats.written = m_written.load(std::memory_order_relaxed);
+    stats.dropped = m_dropped.load(std::memory_order_relaxed);
+    stats.blocked = m_blocked.load(std::memory_order_relaxed);
+    stats.batches = m_batches.load(std::memory_order_relaxed);
+    stats.highWater = m_highWater.load(std::memory_order_relaxed);
+    stats.blockedNs = m_blockedNs.load(std::memory_order_relaxed);
+    stats.busyNs = m_busyNs.load(std::memory_order_relaxed);
+    return stats;
+}
+
+void AsyncOutput::writerLoop()
+{
+    std::vector<char> buffer(WRITE_BUFFER_SIZE);
+    std::vector<uint64_t> received;
+    uint64_t reportedDrops = 0;
+    OutputRecord record;
+
+    for (;;)
+    {
+        // Read the flag before draining so the final pass sees every record pushed before stop()
+        bool stopping = m_stopping.load(std::memory_order_acquire);
+
+        auto start = std::chrono::steady_clock::now();
+        size_t used = 0;
+        uint64_t count = 0;
+        received.clear();
+        while (used + OUTPUT_MAX_RECORD_TEXT <= buffer.size() && m_ring.tryPop(record))
+        {
+            used += formatOutputRecord(record, &buffer[used], buffer.size() - used);
+            count++;
+            if (m_latency && record.receivedNs != 0)
+                received.push_back(record.receivedNs);
+        }
+
+        uint64_t dropped = m_dropped.load(std::memory_order_relaxed);
+        if (m_policy == OVERFLOW_COUNT && dropped != reportedDrops && used + OUTPUT_MAX_RECORD_TEXT <= buffer.size())
+        {
+            TextWriter out(&buffer[used], buffer.size() - used);
+            out.text("\n[output ring full, ");
+            out.number(dropped - reportedDrops);
+            out.text(" records dropped]\n");
+            used += out.length();
+            reportedDrops = dropped;
+        }
+
+        if (used > 0)
+        {
+            fwrite(buffer.data(), 1, used, m_sink);
+            fflush(m_sink);
+            if (!received.empty())
+            {
+                uint64_t written = monotonicNs();
+                for (uint64_t receivedNs : received)
+                    m_latency->record(written - receivedNs);
+            }
+            m_written.fetch_add(count, std::memory_order_relaxed);
+            m_batches.fetch_add(1, std::memory_order_relaxed);
+            auto busy = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+            m_busyNs.fetch_add(busy, std::memory_order_relaxed);
+        }
+        else if (stopping)
+        {
+            break;
+        }
+        else
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(IDLE_WAIT_MS));
+        }
+    }
+}
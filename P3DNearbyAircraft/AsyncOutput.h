@@ -0,0 +1,132 @@
+#pragma once
+
+#include <atomic>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <thread>
+
+#include "LatencyHistogram.h"
+#include "OutputRing.h"
+
+constexpr size_t OUTPUT_TITLE_LENGTH = 128;     // longer titles are truncated in the report
+constexpr size_t OUTPUT_NEAREST_MAX = 4;
+constexpr size_t OUTPUT_MAX_RECORD_TEXT = 512;  // upper bound of one formatted record
+
+enum OutputKind : uint8_t
+{
+    OUTPUT_USER_AIRCRAFT,
+    OUTPUT_TRAFFIC,
+    OUTPUT_SWEEP,
+    OUTPUT_CONFLICT,
+    OUTPUT_CONFLICT_CLEARED,
+};
+
+/**
+* One line group of the traffic report, in binary form. Headings are already in degrees.
+*/
+struct OutputRecord
+{
+    OutputKind kind;
+    uint32_t objectId;
+    uint64_t receivedNs;    // monotonicNs() when the message behind the record arrived; 0 if unknown
+    double latitude;
+    double longitude;
+    double altitude;
+    double trueHeading;
+    double magHeading;
+    double onGround;
+    double rangeNm;         // OUTPUT_TRAFFIC only
+    double bearingDeg;
+    double elevationDeg;
+
+    // OUTPUT_SWEEP only
+    uint32_t aircraftCount;
+    uint32_t nearestCount;
+    uint32_t nearestIds[OUTPUT_NEAREST_MAX];
+    double nearestRangeNm[OUTPUT_NEAREST_MAX];
+
+    // OUTPUT_CONFLICT and OUTPUT_CONFLICT_CLEARED only; objectId is the first aircraft of the pair
+    uint32_t otherId;
+    double lossSeconds;
+    double cpaSeconds;
+    double cpaRangeNm;
+    double cpaVerticalFt;
+
+    char title[OUTPUT_TITLE_LENGTH];
+};
+
+/**
+* What push() does when the ring is full.
+*/
+enum OverflowPolicy
+{
+    OVERFLOW_DROP,      // discard the record; only the dropped counter shows it
+    OVERFLOW_BLOCK,     // wait for the writer to make room
+    OVERFLOW_COUNT,     // discard the record and have the writer print how many were lost at that point
+};
+
+struct OutputStats
+{
+    uint64_t queued;
+    uint64_t written;
+    uint64_t dropped;
+    uint64_t blocked;       // pushes that had to wait under OVERFLOW_BLOCK
+    uint64_t batches;       // fwrite calls
+    uint64_t highWater;     // deepest the ring has been
+    uint64_t blockedNs;     // time push() spent waiting under OVERFLOW_BLOCK
+    uint64_t busyNs;        // time the writer spent formatting and writing
+};
+
+/**
+* Formats record into buffer exactly as the old printf calls did. Returns the number of characters written
+* (at most size, no terminator).
+*/
+size_t formatOutputRecord(const OutputRecord& record, char* buffer, size_t size);
+
+/**
+* Moves report formatting and console I/O off the dispatch thread.
+*
+* The dispatch thread push()es binary records into an SpscRing; a writer thread formats them with
+* std::to_chars and writes them to the sink in batches. push() must only be called from one thread.
+*/
+class AsyncOutput
+{
+public:
+    AsyncOutput(FILE* sink = stdout, size_t capacity = 4096, OverflowPolicy policy = OVERFLOW_COUNT);
+    ~AsyncOutput();
+
+    void start();
+
+    // Write everything still queued, then stop the writer thread
+    void stop();
+
+    bool push(const OutputRecord& record);
+
+    OverflowPolicy policy() const { return m_policy; }
+    void setPolicy(OverflowPolicy policy) { m_policy = policy; }
+
+    OutputStats stats() const;
+
+    // Record how long each record took from receivedNs until it was written. Set before start().
+    void setLatencyHistogram(LatencyHistogram* histogram) { m_latency = histogram; }
+
+private:
+    void writerLoop();
+
+    FILE* m_sink;
+    OverflowPolicy m_policy;
+    SpscRing<OutputRecord> m_ring;
+    std::thread m_writer;
+    std::atomic<bool> m_stopping;
+
+    std::atomic<uint64_t> m_queued;
+    std::atomic<uint64_t> m_written;
+    std::atomic<uint64_t> m_dropped;
+    std::atomic<uint64_t> m_blocked;
+    std::atomic<uint64_t> m_batches;
+    std::atomic<uint64_t> m_highWater;
+    std::atomic<uint64_t> m_blockedNs;
+    std::atomic<uint64_t> m_busyNs;
+    LatencyHistogram* m_latency;
+};
@@ -0,0 +1,419 @@
+#include <algorithm>
+#include <math.h>
+
+#include "ConflictDetector.h"
+#include "SimdOps.h"
+#include "Utilities.h"
+
+static constexpr double MIN_CLOSURE_SQ = 1e-12;     // (nm/s)^2, about 0.004 kt: slower than this the horizontal geometry is frozen
+static constexpr double MIN_VERTICAL_RATE = 1e-3;   // ft/s
+static constexpr int32_t MAX_CELL_SPAN = 16;        // boxes covering more columns, rows or layers than this are not hashed
+static constexpr int32_t MAX_CELL = 32767;          // columns and rows are packed into 16 bits each
+static constexpr int32_t MAX_LAYER = 127;           // layers into 8 bits
+static constexpr uint32_t MAX_AIRCRAFT = 1 << 24;   // and the aircraft into the remaining 24
+static constexpr int32_t OVERSIZED = INT32_MIN;
+
+/**
+* Closest approach and loss of separation for a single pair, written the same way as the vector kernel below.
+*
+* Horizontally the squared distance a t^2 + 2 b t + c is under the minimum between the roots of the quadratic;
+* vertically the distance is under it between the two crossings of the linear track. Separation is lost where
+* both intervals and [0, lookahead] overlap.
+*/
+static void cpaOne(double dx, double dy, double dz, double dvx, double dvy, double dvz, const ConflictSettings& settings,
+    double* lossSeconds, double* cpaSeconds, double* cpaRangeNm, double* cpaVerticalFt)
+{
+    double lookahead = settings.lookaheadSeconds;
+    double sepH2 = settings.separationNm * settings.separationNm;
+    double sepV = settings.separationFt;
+
+    double a = dvx * dvx + dvy * dvy;
+    double b = dx * dvx + dy * dvy;
+    double c = dx * dx + dy * dy;
+    bool moving = a > MIN_CLOSURE_SQ;
+    double safeA = moving ? a : 1.0;
+
+    double tcpa = moving ? (0.0 - b) / safeA : 0.0;
+    tcpa = std::min(std::max(tcpa, 0.0), lookahead);
+    double cx = dx + dvx * tcpa;
+    double cy = dy + dvy * tcpa;
+    *cpaSeconds = tcpa;
+    *cpaRangeNm = sqrt(cx * cx + cy * cy);
+    *cpaVerticalFt = fabs(dz + dvz * tcpa);
+
+    double disc = b * b - a * (c - sepH2);
+    double root = sqrt(std::max(disc, 0.0));
+    bool horizontal = moving ? disc >= 0.0 : c < sepH2;
+    double hIn = moving ? (0.0 - b - root) / safeA : -CPA_NO_LOSS;
+    double hOut = moving ? (0.0 - b + root) / safeA : CPA_NO_LOSS;
+
+    bool climbing = fabs(dvz) > MIN_VERTICAL_RATE;
+    double safeVz = climbing ? dvz : 1.0;
+    double t1 = (0.0 - sepV - dz) / safeVz;
+    double t2 = (sepV - dz) / safeVz;
+    bool vertical = climbing || fabs(dz) < sepV;
+    double vIn = climbing ? std::min(t1, t2) : -CPA_NO_LOSS;
+    double vOut = climbing ? std::max(t1, t2) : CPA_NO_LOSS;
+
+    double enter = std::max(std::max(hIn, vIn), 0.0);
+    double exit = std::min(std::min(hOut, vOut), lookahead);
+    *lossSeconds = horizontal && vertical && enter < exit ? enter : CPA_NO_LOSS;
+}
+
+void cpaBatchScalar(const CpaPairs& pairs, const ConflictSettings& settings, const CpaResults& out)
+{
+    for (size_t i = 0; i < pairs.count; i++)
+    {
+        cpaOne(pairs.dx[i], pairs.dy[i], pairs.dz[i], pairs.dvx[i], pairs.dvy[i], pairs.dvz[i], settings,
+            &out.lossSeconds[i], &out.cpaSeconds[i], &out.cpaRangeNm[i], &out.cpaVerticalFt[i]);
+    }
+}
+
+#if defined(SIMDOPS_AVX2) || defined(SIMDOPS_SSE2)
+
+typedef SimdOps S;
+typedef SimdOps::V V;
+
+static void cpaSimd(const CpaPairs& pairs, const ConflictSettings& settings, const CpaResults& out)
+{
+    const V vZero = S::set1(0.0);
+    const V vOne = S::set1(1.0);
+    const V vLookahead = S::set1(settings.lookaheadSeconds);
+    const V vSepH2 = S::set1(settings.separationNm * settings.separationNm);
+    const V vSepV = S::set1(settings.separationFt);
+    const V vNever = S::set1(CPA_NO_LOSS);
+    const V vNegNever = S::set1(-CPA_NO_LOSS);
+    const V vMinClosure = S::set1(MIN_CLOSURE_SQ);
+    const V vMinVertical = S::set1(MIN_VERTICAL_RATE);
+    const V signMask = S::set1(-0.0);
+
+    size_t i = 0;
+    for (; i + S::width <= pairs.count; i += S::width)
+    {
+        V dx = S::load(&pairs.dx[i]);
+        V dy = S::load(&pairs.dy[i]);
+        V dz = S::load(&pairs.dz[i]);
+        V dvx = S::load(&pairs.dvx[i]);
+        V dvy = S::load(&pairs.dvy[i]);
+        V dvz = S::load(&pairs.dvz[i]);
+
+        V a = S::add(S::mul(dvx, dvx), S::mul(dvy, dvy));
+        V b = S::add(S::mul(dx, dvx), S::mul(dy, dvy));
+        V c = S::add(S::mul(dx, dx), S::mul(dy, dy));
+        V moving = S::gt(a, vMinClosure);
+        V safeA = simdSelect(moving, a, vOne);
+        V negB = S::sub(vZero, b);
+
+        V tcpa = S::and_(moving, S::div(negB, safeA));
+        tcpa = S::min(S::max(tcpa, vZero), vLookahead);
+        V cx = S::add(dx, S::mul(dvx, tcpa));
+        V cy = S::add(dy, S::mul(dvy, tcpa));
+        S::store(&out.cpaSeconds[i], tcpa);
+        S::store(&out.cpaRangeNm[i], S::sqrt(S::add(S::mul(cx, cx), S::mul(cy, cy))));
+        S::store(&out.cpaVerticalFt[i], S::andNot(signMask, S::add(dz, S::mul(dvz, tcpa))));
+
+        V disc = S::sub(S::mul(b, b), S::mul(a, S::sub(c, vSepH2)));
+        V root = S::sqrt(S::max(disc, vZero));
+        V horizontal = simdSelect(moving, S::ge(disc, vZero), S::lt(c, vSepH2));
+        V hIn = simdSelect(moving, S::div(S::sub(negB, root), safeA), vNegNever);
+        V hOut = simdSelect(moving, S::div(S::add(negB, root), safeA), vNever);
+
+        V climbing = S::gt(S::andNot(signMask, dvz), vMinVertical);
+        V safeVz = simdSelect(climbing, dvz, vOne);
+        V t1 = S::div(S::sub(S::sub(vZero, vSepV), dz), safeVz);
+        V t2 = S::div(S::sub(vSepV, dz), safeVz);
+        V vertical = S::or_(climbing, S::lt(S::andNot(signMask, dz), vSepV));
+        V vIn = simdSelect(climbing, S::min(t1, t2), vNegNever);
+        V vOut = simdSelect(climbing, S::max(t1, t2), vNever);
+
+        V enter = S::max(S::max(hIn, vIn), vZero);
+        V exit = S::min(S::min(hOut, vOut), vLookahead);
+        V lost = S::and_(S::and_(horizontal, vertical), S::lt(enter, exit));
+        S::store(&out.lossSeconds[i], simdSelect(lost, enter, vNever));
+    }
+
+    for (; i < pairs.count; i++)
+    {
+        cpaOne(pairs.dx[i], pairs.dy[i], pairs.dz[i], pairs.dvx[i], pairs.dvy[i], pairs.dvz[i], settings,
+            &out.lossSeconds[i], &out.cpaSeconds[i], &out.cpaRangeNm[i], &out.cpaVerticalFt[i]);
+    }
+}
+
+#endif
+
+void cpaBatch(const CpaPairs& pairs, const ConflictSettings& settings, const CpaResults& out)
+{
+#if defined(SIMDOPS_AVX2) || defined(SIMDOPS_SSE2)
+    cpaSimd(pairs, settings, out);
+#else
+    cpaBatchScalar(pairs, settings, out);
+#endif
+}
+
+const char* cpaBatchIsa()
+{
+#if defined(SIMDOPS_AVX2)
+    return "AVX2";
+#elif defined(SIMDOPS_SSE2)
+    return "SSE2";
+#else
+    return "scalar";
+#endif
+}
+
+ConflictDetector::ConflictDetector(const ConflictSettings& settings)
+    : m_settings(settings)
+{
+}
+
+static int32_t cellOf(double value, double cellSize, int32_t limit)
+{
+    double cell = floor(value / cellSize);
+    return (int32_t)std::min(std::max(cell, (double)-limit), (double)limit);
+}
+
+static uint64_t entryOf(int32_t column, int32_t row, int32_t layer, uint32_t aircraft)
+{
+    return ((uint64_t)(column + MAX_CELL) << 48) | ((uint64_t)(row + MAX_CELL) << 32) | ((uint64_t)(layer + MAX_LAYER) << 24) | aircraft;
+}
+
+void ConflictDetector::project(const TrafficTable& table, const double* latitudes, const double* longitudes, const double* altitudes,
+    double refLat, double refLon)
+{
+    double lookahead = m_settings.lookaheadSeconds;
+    double halfSepNm = m_settings.separationNm * 0.5;
+    double halfSepFt = m_settings.separationFt * 0.5;
+    double nmPerDegLat = 60.0;
+    double nmPerDegLon = 60.0 * cos(refLat * (M_PI / 180));
+
+    m_objectIds.clear();
+    m_x.clear();
+    m_y.clear();
+    m_z.clear();
+    m_vx.clear();
+    m_vy.clear();
+    m_vz.clear();
+    m_boxes.clear();
+    for (size_t slot = 0; slot < table.size(); slot++)
+    {
+        if (table.onGround()[slot])
+            continue;
+
+        double x = wrapLongitude(longitudes[slot] - refLon) * nmPerDegLon;
+        double y = (latitudes[slot] - refLat) * nmPerDegLat;
+        double z = altitudes[slot];
+        double speed = table.groundSpeeds()[slot] / 3600;
+        double vx = speed * sin(table.groundTracks()[slot]);
+        double vy = speed * cos(table.groundTracks()[slot]);
+        double vz = table.verticalSpeeds()[slot] / 60;
+
+        m_objectIds.push_back(table.objectIds()[slot]);
+        m_x.push_back(x);
+        m_y.push_back(y);
+        m_z.push_back(z);
+        m_vx.push_back(vx);
+        m_vy.push_back(vy);
+        m_vz.push_back(vz);
+
+        // Everywhere the aircraft can be within the look-ahead, plus half the minima on each side
+        double endX = x + vx * lookahead;
+        double endY = y + vy * lookahead;
+        double endZ = z + vz * lookahead;
+        m_boxes.push_back(std::min(x, endX) - halfSepNm);
+        m_boxes.push_back(std::max(x, endX) + halfSepNm);
+        m_boxes.push_back(std::min(y, endY) - halfSepNm);
+        m_boxes.push_back(std::max(y, endY) + halfSepNm);
+        m_boxes.push_back(std::min(z, endZ) - halfSepFt);
+        m_boxes.push_back(std::max(z, endZ) + halfSepFt);
+    }
+}
+
+void ConflictDetector::addIfOverlapping(uint32_t a, uint32_t b)
+{
+    const double* boxA = &m_boxes[a * 6];
+    const double* boxB = &m_boxes[b * 6];
+    if (boxA[0] <= boxB[1] && boxB[0] <= boxA[1] && boxA[2] <= boxB[3] && boxB[2] <= boxA[3] && boxA[4] <= boxB[5] && boxB[4] <= boxA[5])
+        addPair(a, b);
+}
+
+void ConflictDetector::addPair(uint32_t a, uint32_t b)
+{
+    m_pairFirst.push_back(a);
+    m_pairSecond.push_back(b);
+    m_dx.push_back(m_x[b] - m_x[a]);
+    m_dy.push_back(m_y[b] - m_y[a]);
+    m_dz.push_back(m_z[b] - m_z[a]);
+    m_dvx.push_back(m_vx[b] - m_vx[a]);
+    m_dvy.push_back(m_vy[b] - m_vy[a]);
+    m_dvz.push_back(m_vz[b] - m_vz[a]);
+}
+
+void ConflictDetector::gridPairs()
+{
+    double cellNm = m_settings.cellNm;
+    double layerFt = m_settings.layerFt;
+    uint32_t count = (uint32_t)m_objectIds.size();
+
+    m_entries.clear();
+    m_oversized.clear();
+    m_firstCells.resize(count * 3);
+    for (uint32_t i = 0; i < count; i++)
+    {
+        const double* box = &m_boxes[i * 6];
+        int32_t firstColumn = cellOf(box[0], cellNm, MAX_CELL);
+        int32_t lastColumn = cellOf(box[1], cellNm, MAX_CELL);
+        int32_t firstRow = cellOf(box[2], cellNm, MAX_CELL);
+        int32_t lastRow = cellOf(box[3], cellNm, MAX_CELL);
+        int32_t firstLayer = cellOf(box[4], layerFt, MAX_LAYER);
+        int32_t lastLayer = cellOf(box[5], layerFt, MAX_LAYER);
+        if (lastColumn - firstColumn >= MAX_CELL_SPAN || lastRow - firstRow >= MAX_CELL_SPAN || lastLayer - firstLayer >= MAX_CELL_SPAN ||
+            i >= MAX_AIRCRAFT)
+        {
+            m_firstCells[i * 3] = OVERSIZED;
+            m_oversized.push_back(i);
+            continue;
+        }
+
+        m_firstCells[i * 3] = firstColumn;
+        m_firstCells[i * 3 + 1] = firstRow;
+        m_firstCells[i * 3 + 2] = firstLayer;
+        for (int32_t column = firstColumn; column <= lastColumn; column++)
+        {
+            for (int32_t row = firstRow; row <= lastRow; row++)
+            {
+                for (int32_t layer = firstLayer; layer <= lastLayer; layer++)
+                    m_entries.push_back(entryOf(column, row, layer, i));
+            }
+        }
+    }
+    // LSD radix sort on the 40 bits of the cell; stable, so aircraft stay in order within a cell
+    m_sortScratch.resize(m_entries.size());
+    for (int shift = 24; shift < 64; shift += 8)
+    {
+        size_t offsets[257] = {};
+        for (uint64_t entry : m_entries)
+            offsets[((entry >> shift) & 0xFF) + 1]++;
+        for (int digit = 0; digit < 256; digit++)
+            offsets[digit + 1] += offsets[digit];
+        for (uint64_t entry : m_entries)
+            m_sortScratch[offsets[(entry >> shift) & 0xFF]++] = entry;
+        m_entries.swap(m_sortScratch);
+    }
+
+    // Aircraft sharing a cell, each pair only in the first cell both boxes cover
+    for (size_t begin = 0; begin < m_entries.size(); )
+    {
+        uint64_t cell = m_entries[begin] >> 24;
+        size_t end = begin + 1;
+        while (end < m_entries.size() && m_entries[end] >> 24 == cell)
+            end++;
+
+        int32_t column = (int32_t)(cell >> 24) - MAX_CELL;
+        int32_t row = (int32_t)((cell >> 8) & 0xFFFF) - MAX_CELL;
+        int32_t layer = (int32_t)(cell & 0xFF) - MAX_LAYER;
+        for (size_t i = begin; i < end; i++)
+        {
+            uint32_t a = (uint32_t)(m_entries[i] & (MAX_AIRCRAFT - 1));
+            const int32_t* cellsA = &m_firstCells[a * 3];
+            const double* boxA = &m_boxes[a * 6];
+            for (size_t j = i + 1; j < end; j++)
+            {
+                // Few pairs pass, so both tests are evaluated without branches and only the survivors branch
+                uint32_t b = (uint32_t)(m_entries[j] & (MAX_AIRCRAFT - 1));
+                const int32_t* cellsB = &m_firstCells[b * 3];
+                const double* boxB = &m_boxes[b * 6];
+                bool firstShared = (std::max(cellsA[0], cellsB[0]) == column) & (std::max(cellsA[1], cellsB[1]) == row) &
+                    (std::max(cellsA[2], cellsB[2]) == layer);
+                bool overlapping = (boxA[0] <= boxB[1]) & (boxB[0] <= boxA[1]) & (boxA[2] <= boxB[3]) & (boxB[2] <= boxA[3]) &
+                    (boxA[4] <= boxB[5]) & (boxB[4] <= boxA[5]);
+                if (firstShared & overlapping)
+                    addPair(a, b);
+            }
+        }
+        begin = end;
+    }
+
+    // The few aircraft with implausible speeds are checked the slow way
+    for (uint32_t a : m_oversized)
+    {
+        for (uint32_t b = 0; b < count; b++)
+        {
+            if (b != a && (m_firstCells[b * 3] != OVERSIZED || b > a))
+                addIfOverlapping(a, b);
+        }
+    }
+}
+
+void ConflictDetector::allPairs()
+{
+    uint32_t count = (uint32_t)m_objectIds.size();
+    for (uint32_t a = 0; a < count; a++)
+    {
+        for (uint32_t b = a + 1; b < count; b++)
+            addIfOverlapping(a, b);
+    }
+}
+
+size_t ConflictDetector::detect(const TrafficTable& table, const double* latitudes, const double* longitudes, const double* altitudes,
+    double refLat, double refLon, std::vector<ConflictAlert>& alerts)
+{
+    project(table, latitudes, longitudes, altitudes, refLat, refLon);
+
+    m_pairFirst.clear();
+    m_pairSecond.clear();
+    m_dx.clear();
+    m_dy.clear();
+    m_dz.clear();
+    m_dvx.clear();
+    m_dvy.clear();
+    m_dvz.clear();
+    if (m_settings.cellNm > 0)
+        gridPairs();
+    else
+        allPairs();
+
+    size_t pairCount = m_pairFirst.size();
+    m_lossSeconds.resize(pairCount);
+    m_cpaSeconds.resize(pairCount);
+    m_cpaRangeNm.resize(pairCount);
+    m_cpaVerticalFt.resize(pairCount);
+    CpaPairs pairs = { m_dx.data(), m_dy.data(), m_dz.data(), m_dvx.data(), m_dvy.data(), m_dvz.data(), pairCount };
+    CpaResults results = { m_lossSeconds.data(), m_cpaSeconds.data(), m_cpaRangeNm.data(), m_cpaVerticalFt.data() };
+    cpaBatch(pairs, m_settings, results);
+
+    m_previous.swap(m_conflicts);
+    m_conflicts.clear();
+    for (size_t i = 0; i < pairCount; i++)
+    {
+        if (m_lossSeconds[i] >= CPA_NO_LOSS)
+            continue;
+
+        uint32_t first = m_objectIds[m_pairFirst[i]];
+        uint32_t second = m_objectIds[m_pairSecond[i]];
+        m_conflicts.push_back({ std::min(first, second), std::max(first, second), m_lossSeconds[i], m_cpaSeconds[i],
+            m_cpaRangeNm[i], m_cpaVerticalFt[i] });
+    }
+    auto byPair = [](const Conflict& a, const Conflict& b)
+    {
+        return a.firstId != b.firstId ? a.firstId < b.firstId : a.secondId < b.secondId;
+    };
+    std::sort(m_conflicts.begin(), m_conflicts.end(), byPair);
+
+    // Both lists are ordered by pair, so one merge finds what started and what ended
+    alerts.clear();
+    size_t now = 0;
+    size_t before = 0;
+    while (now < m_conflicts.size() || before < m_previous.size())
+    {
+        if (before == m_previous.size() || (now < m_conflicts.size() && byPair(m_conflicts[now], m_previous[before])))
+            alerts.push_back({ CONFLICT_NEW, m_conflicts[now++] });
+        else if (now == m_conflicts.size() || byPair(m_previous[before], m_conflicts[now]))
+            alerts.push_back({ CONFLICT_CLEARED, m_previous[before++] });
+        else
+        {
+            now++;
+            before++;
+        }
+    }
+    return m_conflicts.size();
+}
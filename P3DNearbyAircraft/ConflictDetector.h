@@ -0,0 +1,176 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+#include "TrafficTable.h"
+
+/**
+* Maximum difference between cpaBatch() and cpaBatchScalar(). Both evaluate the same closed-form solution,
+* only the vector path may round differently, so the bound is set just above double rounding noise for the
+* ranges and times a look-ahead produces.
+*/
+constexpr double CPA_TOLERANCE_SECONDS = 1e-6;
+constexpr double CPA_TOLERANCE_NM = 1e-9;
+constexpr double CPA_TOLERANCE_FT = 1e-6;
+
+// lossSeconds of a pair that keeps its separation throughout the look-ahead
+constexpr double CPA_NO_LOSS = 1e30;
+
+struct ConflictSettings
+{
+    double lookaheadSeconds;    // how far ahead each track is projected
+    double separationNm;        // horizontal minimum
+    double separationFt;        // vertical minimum; separation is lost when both minima are broken at once
+    double cellNm;              // cell width of the pair search; 0 tests every pair against every other (the O(n^2) reference)
+    double layerFt;             // cell height of the pair search
+};
+
+constexpr ConflictSettings DEFAULT_CONFLICT_SETTINGS = { 120, 3, 1000, 12, 4000 };
+
+/**
+* Relative motion of the second aircraft of each pair as seen from the first, on a local flat earth:
+* x east and y north in nm, z up in feet, velocities per second.
+*/
+struct CpaPairs
+{
+    const double* dx;
+    const double* dy;
+    const double* dz;
+    const double* dvx;
+    const double* dvy;
+    const double* dvz;
+    size_t count;
+};
+
+struct CpaResults
+{
+    double* lossSeconds;        // first moment in [0, lookahead] with both minima broken, or CPA_NO_LOSS
+    double* cpaSeconds;         // closest horizontal approach, clamped to [0, lookahead]
+    double* cpaRangeNm;         // horizontal distance then
+    double* cpaVerticalFt;      // vertical distance then
+};
+
+/**
+* Closest point of approach and loss of separation for every pair, assuming both aircraft hold their velocity.
+* Uses AVX2 or SSE2 when the compiler targets them and falls back to cpaBatchScalar() otherwise.
+*/
+void cpaBatch(const CpaPairs& pairs, const ConflictSettings& settings, const CpaResults& out);
+
+/**
+* Reference implementation of cpaBatch(), one pair at a time.
+*/
+void cpaBatchScalar(const CpaPairs& pairs, const ConflictSettings& settings, const CpaResults& out);
+
+/**
+* Name of the instruction set cpaBatch() was compiled for ("AVX2", "SSE2" or "scalar").
+*/
+const char* cpaBatchIsa();
+
+/**
+* Two aircraft predicted to lose separation within the look-ahead.
+*/
+struct Conflict
+{
+    uint32_t firstId;           // the lower ObjectID
+    uint32_t secondId;
+    double lossSeconds;         // until separation is lost; 0 if it already is
+    double cpaSeconds;
+    double cpaRangeNm;
+    double cpaVerticalFt;
+};
+
+enum ConflictEvent : uint8_t
+{
+    CONFLICT_NEW,               // the pair was not in conflict at the previous detect()
+    CONFLICT_CLEARED,           // the pair no longer is, or one of them has left; the conflict is as last seen
+};
+
+struct ConflictAlert
+{
+    ConflictEvent event;
+    Conflict conflict;
+};
+
+/**
+* Traffic-to-traffic conflict probe over everything in a TrafficTable.
+*
+* Each airborne aircraft is projected onto a flat earth around a reference point and flown straight along
+* its ground track at its ground speed and vertical speed for lookaheadSeconds. The track, not the heading:
+* in a crosswind the nose points several degrees off the way the aircraft actually goes. Two tracks can only come within
+* the minima if the boxes they sweep in that time, grown by half the minima, overlap. detect() hashes every
+* box into a grid of cellNm by cellNm by layerFt cells, sorts the entries by cell and only pairs up aircraft
+* that share a cell, so the work grows with the traffic density rather than with the square of the traffic
+* count. Each pair is examined in the first cell both boxes cover, which keeps it from being tested twice.
+* The pairs whose boxes overlap go through cpaBatch() in one pass.
+*
+* The flat earth uses the cosine of the reference latitude throughout; over the couple of hundred nm a sweep
+* covers, pairs a few nm apart come out within a few percent of their great-circle distance.
+*
+* Alerts are incremental: detect() reports pairs that went into or out of conflict since the previous call,
+* while conflicts() lists everything in conflict now.
+*/
+class ConflictDetector
+{
+public:
+    explicit ConflictDetector(const ConflictSettings& settings = DEFAULT_CONFLICT_SETTINGS);
+
+    /**
+    * Probe every pair of airborne aircraft in table, with their positions at the moment of the probe given
+    * per slot in latitudes, longitudes and altitudes (as DeadReckoning::predictAll() fills them). Alerts since
+    * the previous call replace the contents of alerts. Returns the number of pairs in conflict.
+    */
+    size_t detect(const TrafficTable& table, const double* latitudes, const double* longitudes, const double* altitudes,
+        double refLat, double refLon, std::vector<ConflictAlert>& alerts);
+
+    // Everything in conflict as of the last detect(), ordered by ObjectID pair
+    const std::vector<Conflict>& conflicts() const { return m_conflicts; }
+
+    // Pairs whose swept boxes overlapped in the last detect(), i.e. the ones that reached cpaBatch()
+    size_t candidates() const { return m_pairFirst.size(); }
+
+    const ConflictSettings& settings() const { return m_settings; }
+    void setSettings(const ConflictSettings& settings) { m_settings = settings; }
+
+private:
+    void project(const TrafficTable& table, const double* latitudes, const double* longitudes, const double* altitudes,
+        double refLat, double refLon);
+    void gridPairs();
+    void allPairs();
+    void addIfOverlapping(uint32_t a, uint32_t b);
+    void addPair(uint32_t a, uint32_t b);
+
+    ConflictSettings m_settings;
+
+    // Airborne aircraft of the current probe, projected
+    std::vector<uint32_t> m_objectIds;
+    std::vector<double> m_x;
+    std::vector<double> m_y;
+    std::vector<double> m_z;
+    std::vector<double> m_vx;
+    std::vector<double> m_vy;
+    std::vector<double> m_vz;
+    std::vector<double> m_boxes;            // minX, maxX, minY, maxY, minZ, maxZ per aircraft
+    std::vector<int32_t> m_firstCells;      // column, row and layer of the first cell each box covers
+    std::vector<uint64_t> m_entries;        // cell and aircraft, one per cell a box covers
+    std::vector<uint64_t> m_sortScratch;
+    std::vector<uint32_t> m_oversized;      // boxes too large to hash; tested against everything
+
+    // Candidate pairs, in the layout cpaBatch() takes
+    std::vector<uint32_t> m_pairFirst;
+    std::vector<uint32_t> m_pairSecond;
+    std::vector<double> m_dx;
+    std::vector<double> m_dy;
+    std::vector<double> m_dz;
+    std::vector<double> m_dvx;
+    std::vector<double> m_dvy;
+    std::vector<double> m_dvz;
+    std::vector<double> m_lossSeconds;
+    std::vector<double> m_cpaSeconds;
+    std::vector<double> m_cpaRangeNm;
+    std::vector<double> m_cpaVerticalFt;
+
+    std::vector<Conflict> m_conflicts;
+    std::vector<Conflict> m_previous;
+};
@@ -0,0 +1,129 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+/**
+* Datum types, numbered as SIMCONNECT_DATATYPE numbers them, so a record can be described without SimConnect.h.
+*/
+enum WireType : uint32_t
+{
+    WIRE_INT32 = 1,
+    WIRE_INT64 = 2,
+    WIRE_FLOAT32 = 3,
+    WIRE_FLOAT64 = 4,
+    WIRE_STRING32 = 6,
+    WIRE_STRING256 = 9,
+};
+
+constexpr uint32_t WIRE_UNUSED_DATUM = 0xFFFFFFFF;     // SIMCONNECT_UNUSED: the datum has no DatumID
+
+constexpr uint32_t wireTypeSize(WireType type)
+{
+    return type == WIRE_INT32 || type == WIRE_FLOAT32 ? 4 : type == WIRE_INT64 || type == WIRE_FLOAT64 ? 8 :
+        type == WIRE_STRING32 ? 32 : type == WIRE_STRING256 ? 256 : 0;
+}
+
+/**
+* One datum of a data definition and the member of the record it lands in.
+*/
+struct WireField
+{
+    const char* name;           // simulation variable
+    const char* units;          // NULL for strings
+    WireType type;
+    uint32_t offset;            // of the member in the record
+    uint32_t size;              // of the member
+    uint32_t datumId;           // what a tagged record names it by, or WIRE_UNUSED_DATUM
+};
+
+#define WIRE_FIELD(Record, member, name, units, type, datumId) \
+    WireField{ name, units, type, (uint32_t)offsetof(Record, member), (uint32_t)sizeof(Record::member), datumId }
+
+/**
+* The description of a record: specialized next to each layout with its datums in definition order,
+*
+*     template <> struct WireRecord<AircraftTitle>
+*     {
+*         static constexpr WireField fields[] = { WIRE_FIELD(AircraftTitle, title, "Title", NULL, WIRE_STRING256, WIRE_UNUSED_DATUM) };
+*     };
+*
+* and nothing else. The definition calls come from it (addDataDefinition() in SimConnectDefinition.h), and
+* isWireLayout() checks at compile time that the struct is what SimConnect will send for those calls.
+*/
+template <typename Record>
+struct WireRecord;
+
+template <typename Record>
+constexpr size_t wireFieldCount()
+{
+    return sizeof(WireRecord<Record>::fields) / sizeof(WireField);
+}
+
+/**
+* SimConnect writes the datums back to back in the order they were added, each at its type's size. True when
+* the members of Record sit exactly there, with nothing before, between or after them.
+*/
+template <typename Record>
+constexpr bool isWireLayout()
+{
+    uint32_t offset = 0;
+    for (const WireField& field : WireRecord<Record>::fields)
+    {
+        if (field.offset != offset || field.size != wireTypeSize(field.type))
+            return false;
+        offset += field.size;
+    }
+    return offset == sizeof(Record);
+}
+
+// True when each datum's DatumID is its position, so a tagged record's DatumID indexes fields directly
+template <typename Record>
+constexpr bool hasPositionalDatumIds()
+{
+    uint32_t position = 0;
+    for (const WireField& field : WireRecord<Record>::fields)
+    {
+        if (field.datumId != position++)
+            return false;
+    }
+    return true;
+}
+
+/**
+* A typed view of a record where it arrived (dwData): no copy, just the size checked. Only for 1-byte packed
+* records, which can sit at any address.
+*/
+template <typename Record>
+inline const Record* wireView(const void* payload, size_t payloadSize)
+{
+    static_assert(alignof(Record) == 1, "a view over dwData needs a 1-byte packed record");
+    static_assert(isWireLayout<Record>(), "the record must match its description");
+    return payloadSize >= sizeof(Record) ? (const Record*)payload : NULL;  // security check
+}
+
+// One numeric datum as a double; the source may be unaligned
+inline double readWireValue(WireType type, const void* source)
+{
+    switch (type)
+    {
+    case WIRE_INT32: { int32_t v; memcpy(&v, source, sizeof(v)); return (double)v; }
+    case WIRE_INT64: { int64_t v; memcpy(&v, source, sizeof(v)); return (double)v; }
+    case WIRE_FLOAT32: { float v; memcpy(&v, source, sizeof(v)); return (double)v; }
+    case WIRE_FLOAT64: { double v; memcpy(&v, source, sizeof(v)); return v; }
+    default: return 0;
+    }
+}
+
+inline void writeWireValue(WireType type, double value, void* target)
+{
+    switch (type)
+    {
+    case WIRE_INT32: { int32_t v = (int32_t)value; memcpy(target, &v, sizeof(v)); break; }
+    case WIRE_INT64: { int64_t v = (int64_t)value; memcpy(target, &v, sizeof(v)); break; }
+    case WIRE_FLOAT32: { float v = (float)value; memcpy(target, &v, sizeof(v)); break; }
+    case WIRE_FLOAT64: memcpy(target, &value, sizeof(value)); break;
+    default: break;
+    }
+}
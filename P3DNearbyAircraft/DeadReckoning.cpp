@@ -0,0 +1,76 @@
+#include <chrono>
+#include <math.h>
+
+#include "DeadReckoning.h"
+#include "Utilities.h"
+
+static constexpr double NM_PER_DEGREE_LAT = 60;
+
+DeadReckoning::DeadReckoning()
+    : blendSeconds(1)
+    , maxExtrapolationSeconds(5)
+    , maxBlendNm(1)
+{
+}
+
+/**
+* The whole prediction for one slot, shared by predict() and predictAll() so both give identical answers.
+*/
+static inline void predictSlot(const TrafficTable& table, size_t slot, double time, double blendSeconds, double maxExtrapolationSeconds,
+    double& lat, double& lon, double& alt)
+{
+    double elapsed = time - table.sampleTimes()[slot];
+    double dt = elapsed < 0 ? 0 : (elapsed > maxExtrapolationSeconds ? maxExtrapolationSeconds : elapsed);
+
+    // Smoothstep fade: 1 at the sample, 0 with zero slope after blendSeconds
+    double weight = 0;
+    if (elapsed < blendSeconds)
+    {
+        double s = elapsed <= 0 ? 0 : elapsed / blendSeconds;
+        weight = 1 - s * s * (3 - 2 * s);
+    }
+
+    double track = table.groundTracks()[slot];
+    double distanceNm = table.groundSpeeds()[slot] * dt / 3600;
+    double northNm = distanceNm * cos(track) + table.blendNorth()[slot] * weight;
+    double eastNm = distanceNm * sin(track) + table.blendEast()[slot] * weight;
+
+    double sampleLat = table.latitudes()[slot];
+    lat = sampleLat + northNm / NM_PER_DEGREE_LAT;
+    lon = wrapLongitude(table.longitudes()[slot] + eastNm / (NM_PER_DEGREE_LAT * cos(sampleLat * (M_PI / 180))));
+    alt = table.altitudes()[slot] + table.verticalSpeeds()[slot] * dt / 60 + table.blendUp()[slot] * weight;
+}
+
+PredictedPosition DeadReckoning::predict(const TrafficTable& table, size_t slot, double time) const
+{
+    PredictedPosition position;
+    predictSlot(table, slot, time, blendSeconds, maxExtrapolationSeconds, position.latitude, position.longitude, position.altitude);
+    return position;
+}
+
+void DeadReckoning::predictAll(const TrafficTable& table, double time, double* latitudes, double* longitudes, double* altitudes) const
+{
+    for (size_t slot = 0; slot < table.size(); slot++)
+        predictSlot(table, slot, time, blendSeconds, maxExtrapolationSeconds, latitudes[slot], longitudes[slot], altitudes[slot]);
+}
+
+void DeadReckoning::startTrack(TrafficTable& table, size_t slot, double time, const PredictedPosition* shown) const
+{
+    double northNm = 0, eastNm = 0, upFt = 0;
+    if (shown)
+    {
+        double lat = table.latitudes()[slot];
+        northNm = (shown->latitude - lat) * NM_PER_DEGREE_LAT;
+        eastNm = wrapLongitude(shown->longitude - table.longitudes()[slot]) * NM_PER_DEGREE_LAT * cos(lat * (M_PI / 180));
+        upFt = shown->altitude - table.altitudes()[slot];
+
+        if (northNm * northNm + eastNm * eastNm > maxBlendNm * maxBlendNm)
+            northNm = eastNm = upFt = 0;
+    }
+    table.setTrack(slot, time, northNm, eastNm, upFt);
+}
+
+double trafficClockSeconds()
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
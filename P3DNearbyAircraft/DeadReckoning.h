@@ -0,0 +1,56 @@
+#pragma once
+
+#include <stddef.h>
+
+#include "TrafficTable.h"
+
+/**
+* Position of an aircraft at some moment between samples.
+*/
+struct PredictedPosition
+{
+    double latitude;
+    double longitude;
+    double altitude;        // feet
+};
+
+/**
+* Extrapolates traffic between sweeps from each aircraft's last sample in a TrafficTable.
+*
+* An aircraft is assumed to hold the ground track, ground speed and vertical speed of its last sample. The
+* track, not the heading: a crosswind points the nose off the way the aircraft goes, and a prediction along
+* the nose drifts sideways by the crab angle. Positions are stepped on a local flat earth, which is good
+* to a few meters over the seconds between sweeps. Extrapolation stops after maxExtrapolationSeconds so an
+* aircraft that drops out of the sweeps does not fly on indefinitely.
+*
+* A new sample rarely lands exactly where the old track predicted. Instead of jumping, the difference at
+* that moment becomes a blend offset that fades out over blendSeconds with a smoothstep, so the position
+* stays continuous and joins the new track without a kink. Offsets beyond maxBlendNm (slews, teleports)
+* snap immediately.
+*
+* Usage: after TrafficTable::update(), call startTrack() with what predict() returned for the aircraft just
+* before the update; then query predict() or predictAll() at any rate.
+*/
+class DeadReckoning
+{
+public:
+    DeadReckoning();
+
+    // Where the aircraft in slot is at time (seconds, on the clock its samples were stamped with)
+    PredictedPosition predict(const TrafficTable& table, size_t slot, double time) const;
+
+    // Every slot at once, into arrays of table.size() entries
+    void predictAll(const TrafficTable& table, double time, double* latitudes, double* longitudes, double* altitudes) const;
+
+    // Begin a new track from the sample just written to slot; shown is NULL for an aircraft seen for the first time
+    void startTrack(TrafficTable& table, size_t slot, double time, const PredictedPosition* shown) const;
+
+    double blendSeconds;
+    double maxExtrapolationSeconds;
+    double maxBlendNm;
+};
+
+/**
+* Seconds on the monotonic clock, the default time base for samples and predictions.
+*/
+double trafficClockSeconds();
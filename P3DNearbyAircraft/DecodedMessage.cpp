@@ -0,0 +1,126 @@
+#include <string.h>
+
+#include "DecodedMessage.h"
+#include "TrafficMessage.h"
+
+/**
+* The (DatumID, value) pairs of a tagged state record: only the fields that changed by more than their epsilon.
+* Each value is as wide as its datum in the definition.
+*/
+static bool decodeTaggedState(const WireField* definition, const uint8_t* payload, uint32_t payloadSize, uint32_t count, DecodedMessage& out)
+{
+    // security check: the count comes from the message, so it must fit in what arrived
+    if (count == 0 || count > STATE_FIELD_COUNT)
+        return false;
+
+    out.state = AircraftState();
+    out.fields = 0;
+    uint32_t offset = 0;
+    for (uint32_t i = 0; i < count; i++)
+    {
+        uint32_t field;
+        if (payloadSize - offset < TAGGED_DATUM_ID_SIZE)      // security check
+            return false;
+        memcpy(&field, payload + offset, sizeof(field));
+        offset += TAGGED_DATUM_ID_SIZE;
+        if (field >= STATE_FIELD_COUNT || payloadSize - offset < definition[field].size)     // security check
+            return false;
+        double value = readWireValue(definition[field].type, payload + offset);
+        memcpy((char*)&out.state + field * sizeof(double), &value, sizeof(value));
+        offset += definition[field].size;
+        out.fields |= 1u << field;
+    }
+    return true;
+}
+
+bool decodeTrafficMessage(const void* data, uint32_t size, DecodedMessage& out)
+{
+    out.kind = DECODED_NONE;
+    out.hasGeometry = false;
+    out.title = NULL;
+    out.atcId = NULL;
+    out.fields = STATE_ALL_FIELDS;
+    if (size < sizeof(TrafficMessageHeader))
+        return false;
+
+    TrafficMessageHeader header;
+    memcpy(&header, data, sizeof(header));
+    const uint8_t* payload = (const uint8_t*)data + sizeof(header);
+    uint32_t payloadSize = size - (uint32_t)sizeof(header);
+    out.requestId = header.requestId;
+    out.objectId = header.objectId;
+    out.entryNumber = header.entryNumber;
+    out.outOf = header.outOf;
+
+    if (header.id == TRAFFIC_RECV_ID_SIMOBJECT_DATA_BYTYPE)
+    {
+        if (header.defineId == TRAFFIC_DEFINITION_PACKED_STATE)
+        {
+            if (const PackedAircraftState* packed = wireView<PackedAircraftState>(payload, payloadSize))
+            {
+                out.state = stateOf(*packed);
+                out.kind = DECODED_SWEEP;
+            }
+        }
+        else if (header.defineId == TRAFFIC_DEFINITION_STATE && payloadSize >= sizeof(AircraftState))
+        {
+            memcpy(&out.state, payload, sizeof(out.state));
+            out.kind = DECODED_SWEEP;
+        }
+        else if (header.defineId == TRAFFIC_DEFINITION_COMBINED && payloadSize >= sizeof(AircraftInfo))
+        {
+            const AircraftInfo* aircraft = (const AircraftInfo*)payload;
+            out.state = stateOf(*aircraft);
+            out.title = aircraft->title;
+            out.kind = DECODED_SWEEP;
+        }
+    }
+    else if (header.id == TRAFFIC_RECV_ID_SIMOBJECT_DATA)
+    {
+        if (header.defineId == TRAFFIC_DEFINITION_TITLE && payloadSize >= sizeof(AircraftTitle))
+        {
+            out.title = ((const AircraftTitle*)payload)->title;
+            out.kind = DECODED_TITLE;
+        }
+        else if (header.defineId == TRAFFIC_DEFINITION_IDENTITY && payloadSize >= sizeof(AircraftIdentity))
+        {
+            const AircraftIdentity* identity = (const AircraftIdentity*)payload;
+            out.title = identity->title;
+            out.atcId = identity->atcId;
+            out.kind = DECODED_IDENTITY;
+        }
+        else if (header.defineId == TRAFFIC_DEFINITION_OWNSHIP && payloadSize >= sizeof(OwnshipState))
+        {
+            OwnshipState ownship;
+            memcpy(&ownship, payload, sizeof(ownship));
+            out.state = AircraftState();
+            out.state.isUser = 1;
+            out.state.latitude = ownship.latitude;
+            out.state.longitude = ownship.longitude;
+            out.state.altitude = ownship.altitude;
+            out.state.trueHeading = ownship.trueHeading;
+            out.state.groundSpeed = ownship.groundSpeed;
+            out.state.verticalSpeed = ownship.verticalSpeed;
+            out.kind = DECODED_OWNSHIP;
+        }
+        else if (stateDefinitionFields(header.defineId) && (header.flags & TRAFFIC_DATA_REQUEST_FLAG_TAGGED))
+        {
+            if (decodeTaggedState(stateDefinitionFields(header.defineId), payload, payloadSize, header.defineCount, out))
+                out.kind = DECODED_TRACKED;
+        }
+        else if (header.defineId == TRAFFIC_DEFINITION_PACKED_STATE)
+        {
+            if (const PackedAircraftState* packed = wireView<PackedAircraftState>(payload, payloadSize))
+            {
+                out.state = stateOf(*packed);
+                out.kind = DECODED_TRACKED;
+            }
+        }
+        else if (header.defineId == TRAFFIC_DEFINITION_STATE && payloadSize >= sizeof(AircraftState))
+        {
+            memcpy(&out.state, payload, sizeof(out.state));
+            out.kind = DECODED_TRACKED;
+        }
+    }
+    return out.kind != DECODED_NONE;
+}
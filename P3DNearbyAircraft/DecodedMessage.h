@@ -0,0 +1,49 @@
+#pragma once
+
+#include <stdint.h>
+#include <string.h>
+
+#include "AircraftInfo.h"
+#include "ReferenceFrame.h"
+
+enum DecodedKind : uint8_t
+{
+    DECODED_NONE,           // not a traffic message, or truncated
+    DECODED_SWEEP,          // one record of a SIMOBJECT_DATA_BYTYPE sweep
+    DECODED_TRACKED,        // a per-object update between sweeps; tagged updates carry only some fields
+    DECODED_TITLE,
+    DECODED_OWNSHIP,        // the user aircraft's own per-frame request; position and velocity in state
+    DECODED_IDENTITY,       // title and ATC ID of one aircraft, for matching it across simulators
+};
+
+/**
+* One traffic message, decoded. decodeTrafficMessage() has no state, so any thread can produce these;
+* TrafficPipeline::apply() consumes them in message order.
+*/
+struct DecodedMessage
+{
+    DecodedKind kind;
+    bool hasGeometry;           // geometry was solved ahead of apply(), against the ownship in ownLat/ownLon/ownAlt
+    uint32_t requestId;
+    uint32_t objectId;
+    uint32_t entryNumber;
+    uint32_t outOf;
+    uint32_t fields;            // DECODED_TRACKED: the AircraftStateField bits present in state; STATE_ALL_FIELDS unless tagged
+    AircraftState state;
+    const char* title;          // DECODED_TITLE, DECODED_IDENTITY and sweeps of the combined definition; points into the message
+    const char* atcId;          // DECODED_IDENTITY; points into the message
+    TargetGeometry geometry;
+    double ownLat;
+    double ownLon;
+    double ownAlt;
+};
+
+// Decode a raw SIMOBJECT_DATA(_BYTYPE) message. Returns false (kind DECODED_NONE) for anything TrafficPipeline ignores.
+bool decodeTrafficMessage(const void* data, uint32_t size, DecodedMessage& out);
+
+// Whether a record goes into the report: airborne, with its title (if it carries one) terminated. Only reported
+// user aircraft records move the ownship.
+inline bool isReported(const AircraftState& state, const char* title)
+{
+    return !state.onGround && (title == NULL || memchr(title, '\0', sizeof(AircraftTitle::title)) != NULL); // security check
+}
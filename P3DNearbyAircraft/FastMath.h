@@ -0,0 +1,104 @@
+#pragma once
+
+#include <math.h>
+
+/**
+* Polynomial replacements for the CRT trig used by the MATH_FAST paths in Utilities.
+*
+* The coefficients are least-squares fits on Chebyshev nodes (close to minimax) over the reduced ranges.
+* Maximum absolute errors, measured over the full reduced range:
+*
+*     fastSin, fastCos   2e-9      for |x| < 1000 rad (single-constant reduction by pi/2)
+*     fastAsin           4e-9 rad  on [-1, 1]
+*     fastAtan2          1.8e-6 rad (1.1e-4 deg) for any quadrant
+*
+* Near zero the fits are exact to first order (sin x = x + O(x^3), asin x = x + O(x^3)), so the error
+* shrinks with the argument; that is what keeps short-range haversines accurate.
+*/
+
+constexpr double FAST_PI = 3.14159265358979323846;
+
+inline double fastSinReduced(double r)
+{
+    double z = r * r;
+    return r + r * z * (-0.16666650859079207 + z * (0.008331987566647162 + z * -0.00019496605446977245));
+}
+
+inline double fastCosReduced(double r)
+{
+    double z = r * r;
+    return 1 + z * (-0.4999999974374467 + z * (0.04166662500980289 + z * (-0.0013886808533649562 + z * 2.4394093907712312e-05)));
+}
+
+/**
+* sin and cos of x together, sharing the quadrant reduction.
+*/
+inline void fastSinCos(double x, double& sinOut, double& cosOut)
+{
+    double q = nearbyint(x * (2 / FAST_PI));
+    double r = x - q * (FAST_PI / 2);
+    double s = fastSinReduced(r);
+    double c = fastCosReduced(r);
+
+    switch ((long long)q & 3)
+    {
+    case 0: sinOut = s;  cosOut = c;  break;
+    case 1: sinOut = c;  cosOut = -s; break;
+    case 2: sinOut = -s; cosOut = -c; break;
+    default: sinOut = -c; cosOut = s; break;
+    }
+}
+
+inline double fastSin(double x)
+{
+    double s, c;
+    fastSinCos(x, s, c);
+    return s;
+}
+
+inline double fastCos(double x)
+{
+    double s, c;
+    fastSinCos(x, s, c);
+    return c;
+}
+
+inline double fastAsin(double x)
+{
+    double ax = fabs(x);
+    double result;
+    if (ax <= 0.5)
+    {
+        double z = ax * ax;
+        result = ax + ax * z * (0.1666680989578044 + z * (0.074934482455666 + z * (0.045668361749655516 + z * (0.023313693517505542 + z * 0.043500192661973476))));
+    }
+    else
+    {
+        // asin(x) = pi/2 - 2 asin(sqrt((1 - x) / 2)), which brings the argument back under 0.5
+        double t = sqrt((1 - (ax > 1 ? 1 : ax)) * 0.5);
+        double z = t * t;
+        double inner = t + t * z * (0.1666680989578044 + z * (0.074934482455666 + z * (0.045668361749655516 + z * (0.023313693517505542 + z * 0.043500192661973476))));
+        result = FAST_PI / 2 - 2 * inner;
+    }
+    return x < 0 ? -result : result;
+}
+
+inline double fastAtan2(double y, double x)
+{
+    double ax = fabs(x);
+    double ay = fabs(y);
+    double big = ax > ay ? ax : ay;
+    if (big == 0)
+        return 0;
+
+    // atan on [0, 1], then unfold the octant and quadrant
+    double t = (ax > ay ? ay : ax) / big;
+    double z = t * t;
+    double r = t * (0.9999798340379767 + z * (-0.3326554831980844 + z * (0.1936703187696784 + z * (-0.11665112232997552 + z * (0.05282349383876246 + z * -0.011770502066020351)))));
+
+    if (ay > ax)
+        r = FAST_PI / 2 - r;
+    if (x < 0)
+        r = FAST_PI - r;
+    return y < 0 ? -r : r;
+}
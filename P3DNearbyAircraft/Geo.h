@@ -0,0 +1,235 @@
+#pragma once
+
+#include <cmath>
+#include <limits>
+
+/**
+* Header-only geodesy templated on scalar precision and earth model:
+*
+*     Geo<float, Spherical>   fast haversine for hot per-target loops
+*     Geo<double, Spherical>  same model as distance()/getBearing() in Utilities
+*     Geo<double, WGS84>      Vincenty on the ellipsoid for offline analysis
+*
+* Everything is inline so each combination the caller picks is specialized and inlined at the call site.
+* Latitudes and longitudes are in degrees, altitudes in feet, distances in nautical miles, bearings in
+* degrees true in [0, 360).
+*/
+namespace geo
+{
+    namespace units
+    {
+        template <typename T> constexpr T pi = T(3.14159265358979323846L);
+
+        constexpr double METERS_PER_NM = 1852;
+        constexpr double FEET_PER_NM = 6076.11548556;
+        constexpr double METERS_PER_FOOT = 0.3048;
+
+        template <typename T> constexpr T nmToMeters(T nm) { return nm * T(METERS_PER_NM); }
+        template <typename T> constexpr T metersToNm(T meters) { return meters / T(METERS_PER_NM); }
+        template <typename T> constexpr T feetToMeters(T feet) { return feet * T(METERS_PER_FOOT); }
+        template <typename T> constexpr T metersToFeet(T meters) { return meters / T(METERS_PER_FOOT); }
+        template <typename T> constexpr T feetToNm(T feet) { return feet / T(FEET_PER_NM); }
+        template <typename T> constexpr T nmToFeet(T nm) { return nm * T(FEET_PER_NM); }
+        template <typename T> constexpr T degToRad(T degrees) { return degrees * (pi<T> / T(180)); }
+        template <typename T> constexpr T radToDeg(T radians) { return radians * (T(180) / pi<T>); }
+
+        static_assert(nmToMeters(1.0) == 1852.0, "1 nm is exactly 1852 m");
+        static_assert(metersToFeet(feetToMeters(1000.0)) == 1000.0, "ft/m round trip");
+    }
+
+    /**
+    * Sphere with the same radius as distance() in Utilities.
+    */
+    struct Spherical
+    {
+        static constexpr double radiusNm = 3443.9308855292;
+    };
+
+    /**
+    * WGS84 ellipsoid
+    * https://en.wikipedia.org/wiki/World_Geodetic_System
+    */
+    struct WGS84
+    {
+        static constexpr double a = 6378137.0;
+        static constexpr double f = 1 / 298.257223563;
+        static constexpr double b = a * (1 - f);
+        static constexpr double e2 = f * (2 - f);       // first eccentricity squared
+    };
+
+    /**
+    * Result of an inverse geodesic problem.
+    */
+    template <typename T>
+    struct Inverse
+    {
+        T distanceNm;
+        T initialBearingDeg;
+        bool converged;     // false only when Vincenty gave up near the antipode and the sphere was used instead
+    };
+
+    template <typename T>
+    inline T normalizeBearing(T degrees)
+    {
+        degrees = std::fmod(degrees, T(360));
+        if (degrees < T(0))
+            degrees += T(360);
+        return degrees < T(360) ? degrees : T(0);   // -tiny + 360 rounds up to 360
+    }
+
+    template <typename T, typename Model>
+    struct Geo;
+
+    template <typename T>
+    struct Geo<T, Spherical>
+    {
+        /**
+        * Haversine distance and forward azimuth
+        * https://www.movable-type.co.uk/scripts/latlong.html
+        */
+        static Inverse<T> inverse(T lat1, T lon1, T lat2, T lon2)
+        {
+            T phi1 = units::degToRad(lat1);
+            T phi2 = units::degToRad(lat2);
+            T halfDLat = (phi2 - phi1) * T(0.5);
+            T halfDLon = units::degToRad(lon2 - lon1) * T(0.5);
+
+            T sinHalfDLat = std::sin(halfDLat);
+            T sinHalfDLon = std::sin(halfDLon);
+            T cosPhi1 = std::cos(phi1);
+            T cosPhi2 = std::cos(phi2);
+
+            T a = sinHalfDLat * sinHalfDLat + cosPhi1 * cosPhi2 * sinHalfDLon * sinHalfDLon;
+            a = a < T(0) ? T(0) : (a > T(1) ? T(1) : a);
+
+            Inverse<T> result;
+            result.distanceNm = T(2) * std::atan2(std::sqrt(a), std::sqrt(T(1) - a)) * T(Spherical::radiusNm);
+
+            // cos(phi1)sin(phi2) - sin(phi1)cos(phi2)cos(dLon) in half-angle form, exact for short baselines
+            T y = T(2) * sinHalfDLon * std::cos(halfDLon) * cosPhi2;
+            T x = T(2) * sinHalfDLat * std::cos(halfDLat) + T(2) * std::sin(phi1) * cosPhi2 * sinHalfDLon * sinHalfDLon;
+            result.initialBearingDeg = a > T(0) ? normalizeBearing(units::radToDeg(std::atan2(y, x))) : T(0);
+            result.converged = true;
+            return result;
+        }
+
+        static T distanceNm(T lat1, T lon1, T lat2, T lon2)
+        {
+            return inverse(lat1, lon1, lat2, lon2).distanceNm;
+        }
+
+        static T bearingDeg(T lat1, T lon1, T lat2, T lon2)
+        {
+            return inverse(lat1, lon1, lat2, lon2).initialBearingDeg;
+        }
+
+        static T slantRangeNm(T lat1, T lon1, T alt1Ft, T lat2, T lon2, T alt2Ft)
+        {
+            T range = distanceNm(lat1, lon1, lat2, lon2);
+            T deltaHeight = units::feetToNm(alt2Ft - alt1Ft);
+            return std::sqrt(range * range + deltaHeight * deltaHeight);
+        }
+    };
+
+    template <typename T>
+    struct Geo<T, WGS84>
+    {
+        static constexpr int MAX_ITERATIONS = 200;
+
+        /**
+        * Vincenty's inverse formula on the WGS84 ellipsoid
+        * https://en.wikipedia.org/wiki/Vincenty%27s_formulae
+        * Accurate to well under a millimetre in double. It does not converge for nearly antipodal points;
+        * those fall back to the spherical solution with converged = false.
+        */
+        static Inverse<T> inverse(T lat1, T lon1, T lat2, T lon2)
+        {
+            const T f = T(WGS84::f);
+            const T a = T(WGS84::a);
+            const T b = T(WGS84::b);
+            const T tolerance = std::numeric_limits<T>::epsilon() * T(16);
+
+            T L = units::degToRad(lon2 - lon1);
+            // Reduced latitudes; atan2 keeps the poles on the right side where tan() overflows its sign
+            T phi1 = units::degToRad(lat1);
+            T phi2 = units::degToRad(lat2);
+            T U1 = std::atan2((T(1) - f) * std::sin(phi1), std::cos(phi1));
+            T U2 = std::atan2((T(1) - f) * std::sin(phi2), std::cos(phi2));
+            T sinU1 = std::sin(U1), cosU1 = std::cos(U1);
+            T sinU2 = std::sin(U2), cosU2 = std::cos(U2);
+
+            T lambda = L;
+            T sinLambda = 0, cosLambda = 0;
+            T sinSigma = 0, cosSigma = 0, sigma = 0;
+            T cosSqAlpha = 0, cos2SigmaM = 0;
+
+            int iteration = 0;
+            for (; iteration < MAX_ITERATIONS; iteration++)
+            {
+                sinLambda = std::sin(lambda);
+                cosLambda = std::cos(lambda);
+                T p = cosU2 * sinLambda;
+                T q = cosU1 * sinU2 - sinU1 * cosU2 * cosLambda;
+                sinSigma = std::sqrt(p * p + q * q);
+                if (sinSigma < std::numeric_limits<T>::epsilon())   // coincident, including both on the same pole
+                {
+                    Inverse<T> coincident = { T(0), T(0), true };
+                    return coincident;
+                }
+
+                cosSigma = sinU1 * sinU2 + cosU1 * cosU2 * cosLambda;
+                sigma = std::atan2(sinSigma, cosSigma);
+                T sinAlpha = cosU1 * cosU2 * sinLambda / sinSigma;
+                cosSqAlpha = T(1) - sinAlpha * sinAlpha;
+                cos2SigmaM = cosSqAlpha != T(0) ? cosSigma - T(2) * sinU1 * sinU2 / cosSqAlpha : T(0);   // equatorial line
+
+                T C = f / T(16) * cosSqAlpha * (T(4) + f * (T(4) - T(3) * cosSqAlpha));
+                T previous = lambda;
+                lambda = L + (T(1) - C) * f * sinAlpha *
+                    (sigma + C * sinSigma * (cos2SigmaM + C * cosSigma * (T(-1) + T(2) * cos2SigmaM * cos2SigmaM)));
+
+                if (std::fabs(lambda - previous) <= tolerance)
+                    break;
+            }
+
+            if (iteration == MAX_ITERATIONS || std::fabs(lambda) > units::pi<T>)
+            {
+                Inverse<T> fallback = Geo<T, Spherical>::inverse(lat1, lon1, lat2, lon2);
+                fallback.converged = false;
+                return fallback;
+            }
+
+            T uSq = cosSqAlpha * (a * a - b * b) / (b * b);
+            T A = T(1) + uSq / T(16384) * (T(4096) + uSq * (T(-768) + uSq * (T(320) - T(175) * uSq)));
+            T B = uSq / T(1024) * (T(256) + uSq * (T(-128) + uSq * (T(74) - T(47) * uSq)));
+            T deltaSigma = B * sinSigma * (cos2SigmaM + B / T(4) * (cosSigma * (T(-1) + T(2) * cos2SigmaM * cos2SigmaM) -
+                B / T(6) * cos2SigmaM * (T(-3) + T(4) * sinSigma * sinSigma) * (T(-3) + T(4) * cos2SigmaM * cos2SigmaM)));
+
+            Inverse<T> result;
+            result.distanceNm = units::metersToNm(b * A * (sigma - deltaSigma));
+            result.initialBearingDeg = normalizeBearing(units::radToDeg(std::atan2(cosU2 * sinLambda, cosU1 * sinU2 - sinU1 * cosU2 * cosLambda)));
+            result.converged = true;
+            return result;
+        }
+
+        static T distanceNm(T lat1, T lon1, T lat2, T lon2)
+        {
+            return inverse(lat1, lon1, lat2, lon2).distanceNm;
+        }
+
+        static T bearingDeg(T lat1, T lon1, T lat2, T lon2)
+        {
+            return inverse(lat1, lon1, lat2, lon2).initialBearingDeg;
+        }
+
+        static T slantRangeNm(T lat1, T lon1, T alt1Ft, T lat2, T lon2, T alt2Ft)
+        {
+            T range = distanceNm(lat1, lon1, lat2, lon2);
+            T deltaHeight = units::feetToNm(alt2Ft - alt1Ft);
+            return std::sqrt(range * range + deltaHeight * deltaHeight);
+        }
+    };
+
+    typedef Geo<float, Spherical> FastGeo;
+    typedef Geo<double, WGS84> PreciseGeo;
+}
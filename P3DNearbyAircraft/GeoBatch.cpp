@@ -0,0 +1,233 @@
+#include "GeoBatch.h"
+#include "SimdOps.h"
+#include "Utilities.h"
+
+static constexpr double DEG_TO_RAD = M_PI / 180.0;
+static constexpr double RAD_TO_DEG = 180.0 / M_PI;
+
+/**
+* Haversine range and initial bearing for a single target, written the same way as the vector kernel below
+* so that both paths share the formula and only differ in the trig implementation.
+*/
+static void rangeBearingOne(double sinOwnLat, double cosOwnLat, double ownLatRad, double ownLonRad, double ownAlt,
+    double lat, double lon, double alt, double* rangeNm, double* bearingDeg)
+{
+    double latRad = lat * DEG_TO_RAD;
+    double halfDLat = (latRad - ownLatRad) * 0.5;
+    double halfDLon = (lon * DEG_TO_RAD - ownLonRad) * 0.5;
+
+    double sinHalfDLat = sin(halfDLat);
+    double cosHalfDLat = cos(halfDLat);
+    double sinHalfDLon = sin(halfDLon);
+    double cosHalfDLon = cos(halfDLon);
+    double cosLat = cos(latRad);
+
+    double a = sinHalfDLat * sinHalfDLat + cosOwnLat * cosLat * sinHalfDLon * sinHalfDLon;
+    a = a < 0.0 ? 0.0 : (a > 1.0 ? 1.0 : a);
+    double range = 2.0 * atan2(sqrt(a), sqrt(1.0 - a)) * EARTH_RADIUS_NM;
+    double deltaHeight = (alt - ownAlt) / FEET_PER_NM;
+    *rangeNm = sqrt(range * range + deltaHeight * deltaHeight);
+
+    // cos(lat1)sin(lat2) - sin(lat1)cos(lat2)cos(dLon) rewritten without the cancellation for short baselines
+    double y = 2.0 * sinHalfDLon * cosHalfDLon * cosLat;
+    double x = 2.0 * sinHalfDLat * cosHalfDLat + 2.0 * sinOwnLat * cosLat * sinHalfDLon * sinHalfDLon;
+    double degrees = a > 0.0 ? atan2(y, x) * RAD_TO_DEG : 0.0;
+    if (degrees < 0.0)
+        degrees += 360.0;
+    if (degrees >= 360.0)
+        degrees -= 360.0;
+    *bearingDeg = degrees;
+}
+
+void rangeBearingBatchScalar(const TrafficPositions& targets, double ownLat, double ownLon, double ownAlt, double* rangeNm, double* bearingDeg)
+{
+    double ownLatRad = ownLat * DEG_TO_RAD;
+    double ownLonRad = ownLon * DEG_TO_RAD;
+    double sinOwnLat = sin(ownLatRad);
+    double cosOwnLat = cos(ownLatRad);
+
+    for (size_t i = 0; i < targets.count; i++)
+    {
+        rangeBearingOne(sinOwnLat, cosOwnLat, ownLatRad, ownLonRad, ownAlt,
+            targets.latitude[i], targets.longitude[i], targets.altitude[i], &rangeNm[i], &bearingDeg[i]);
+    }
+}
+
+#if defined(SIMDOPS_AVX2) || defined(SIMDOPS_SSE2)
+
+typedef SimdOps S;
+typedef SimdOps::V V;
+typedef SimdOps::I I;
+
+static inline V select(V mask, V a, V b)
+{
+    return simdSelect(mask, a, b);
+}
+
+/**
+* sin and cos of x (radians, |x| well below 1e5) in one pass.
+* Cody-Waite reduction by pi/2, then the fdlibm kernel polynomials on [-pi/4, pi/4].
+* The quadrant is read straight out of the mantissa of x * 2/pi + 1.5 * 2^52.
+*/
+static inline void sinCos(V x, V& sinOut, V& cosOut)
+{
+    const V roundMagic = S::set1(6755399441055744.0);
+    V k = S::add(S::mul(x, S::set1(0.63661977236758134308)), roundMagic);
+    V q = S::sub(k, roundMagic);
+    V r = S::sub(S::sub(x, S::mul(q, S::set1(1.57079632673412561417e+00))), S::mul(q, S::set1(6.07710050650619224932e-11)));
+    V z = S::mul(r, r);
+
+    V ps = S::set1(1.58969099521155010221e-10);
+    ps = S::add(S::mul(ps, z), S::set1(-2.50507602534068634195e-08));
+    ps = S::add(S::mul(ps, z), S::set1(2.75573137070700676789e-06));
+    ps = S::add(S::mul(ps, z), S::set1(-1.98412698298579493134e-04));
+    ps = S::add(S::mul(ps, z), S::set1(8.33333333332248946124e-03));
+    ps = S::add(S::mul(ps, z), S::set1(-1.66666666666666324348e-01));
+    ps = S::add(r, S::mul(S::mul(r, z), ps));
+
+    V pc = S::set1(-1.13596475577881948265e-11);
+    pc = S::add(S::mul(pc, z), S::set1(2.08757232129817482790e-09));
+    pc = S::add(S::mul(pc, z), S::set1(-2.75573143513906633035e-07));
+    pc = S::add(S::mul(pc, z), S::set1(2.48015872894767294178e-05));
+    pc = S::add(S::mul(pc, z), S::set1(-1.38888888888741095749e-03));
+    pc = S::add(S::mul(pc, z), S::set1(4.16666666666666019037e-02));
+    pc = S::add(S::sub(S::set1(1.0), S::mul(z, S::set1(0.5))), S::mul(S::mul(z, z), pc));
+
+    // Quadrant n: sin uses cos(r) on odd n and is negated for n = 2, 3; cos is negated for n = 1, 2
+    I n = S::bits(k);
+    I one = S::set1i(1);
+    I two = S::set1i(2);
+    V swap = S::fromBits(S::subi(S::set1i(0), S::andi(n, one)));
+    V sinSign = S::fromBits(S::shl<62>(S::andi(n, two)));
+    V cosSign = S::fromBits(S::shl<62>(S::andi(S::addi(n, one), two)));
+
+    sinOut = S::xor_(select(swap, pc, ps), sinSign);
+    cosOut = S::xor_(select(swap, ps, pc), cosSign);
+}
+
+/**
+* Cephes atan: reduce to |x| <= 0.66 with the tan(3pi/8) and tan(pi/8) splits, then a 4/5 rational approximation.
+*/
+static inline V atanV(V x)
+{
+    const V signMask = S::set1(-0.0);
+    const V one = S::set1(1.0);
+    V sign = S::and_(x, signMask);
+    V ax = S::andNot(signMask, x);
+
+    V big = S::gt(ax, S::set1(2.41421356237309504880));
+    V mid = S::andNot(big, S::gt(ax, S::set1(0.66)));
+
+    V xr = select(big, S::div(S::set1(-1.0), ax), select(mid, S::div(S::sub(ax, one), S::add(ax, one)), ax));
+    V y0 = select(big, S::set1(M_PI / 2), S::and_(mid, S::set1(M_PI / 4)));
+    V extra = select(big, S::set1(6.123233995736765886130e-17), S::and_(mid, S::set1(3.061616997868382943065e-17)));
+
+    V z = S::mul(xr, xr);
+    V p = S::set1(-8.750608600031904122785e-01);
+    p = S::add(S::mul(p, z), S::set1(-1.615753718733365076637e+01));
+    p = S::add(S::mul(p, z), S::set1(-7.500855792314704667340e+01));
+    p = S::add(S::mul(p, z), S::set1(-1.228866684490136173410e+02));
+    p = S::add(S::mul(p, z), S::set1(-6.485021904942025371773e+01));
+    V qd = S::add(z, S::set1(2.485846490142306297962e+01));
+    qd = S::add(S::mul(qd, z), S::set1(1.650270098316988542046e+02));
+    qd = S::add(S::mul(qd, z), S::set1(4.328810604912902668951e+02));
+    qd = S::add(S::mul(qd, z), S::set1(4.853903996359136964868e+02));
+    qd = S::add(S::mul(qd, z), S::set1(1.945506571482613964425e+02));
+
+    V t = S::div(S::mul(z, p), qd);
+    t = S::add(S::mul(xr, t), xr);
+    V y = S::add(y0, S::add(t, extra));
+    return S::xor_(y, sign);
+}
+
+static inline V atan2V(V y, V x)
+{
+    const V zero = S::set1(0.0);
+    V result = atanV(S::div(y, x));
+
+    // Left half plane: shift by pi towards the sign of y
+    V piSigned = S::or_(S::set1(M_PI), S::and_(y, S::set1(-0.0)));
+    result = S::add(result, S::and_(S::lt(x, zero), piSigned));
+
+    // atan2(0, 0) is 0 rather than the NaN from 0/0
+    V origin = S::and_(S::eq(x, zero), S::eq(y, zero));
+    return S::andNot(origin, result);
+}
+
+static void rangeBearingSimd(const TrafficPositions& targets, double ownLat, double ownLon, double ownAlt, double* rangeNm, double* bearingDeg)
+{
+    double ownLatRad = ownLat * DEG_TO_RAD;
+    double ownLonRad = ownLon * DEG_TO_RAD;
+    double sinOwnLat = sin(ownLatRad);
+    double cosOwnLat = cos(ownLatRad);
+
+    const V vDegToRad = S::set1(DEG_TO_RAD);
+    const V vRadToDeg = S::set1(RAD_TO_DEG);
+    const V vHalf = S::set1(0.5);
+    const V vOne = S::set1(1.0);
+    const V vTwo = S::set1(2.0);
+    const V vZero = S::set1(0.0);
+    const V v360 = S::set1(360.0);
+    const V vOwnLat = S::set1(ownLatRad);
+    const V vOwnLon = S::set1(ownLonRad);
+    const V vOwnAlt = S::set1(ownAlt);
+    const V vSinOwnLat = S::set1(sinOwnLat);
+    const V vCosOwnLat = S::set1(cosOwnLat);
+    const V vRadius = S::set1(EARTH_RADIUS_NM);
+    const V vFeetPerNm = S::set1(FEET_PER_NM);
+
+    size_t i = 0;
+    for (; i + S::width <= targets.count; i += S::width)
+    {
+        V latRad = S::mul(S::load(&targets.latitude[i]), vDegToRad);
+        V lonRad = S::mul(S::load(&targets.longitude[i]), vDegToRad);
+        V alt = S::load(&targets.altitude[i]);
+
+        V sinLat, cosLat, sinHalfDLat, cosHalfDLat, sinHalfDLon, cosHalfDLon;
+        sinCos(latRad, sinLat, cosLat);
+        sinCos(S::mul(S::sub(latRad, vOwnLat), vHalf), sinHalfDLat, cosHalfDLat);
+        sinCos(S::mul(S::sub(lonRad, vOwnLon), vHalf), sinHalfDLon, cosHalfDLon);
+
+        V sinHalfDLon2 = S::mul(sinHalfDLon, sinHalfDLon);
+        V a = S::add(S::mul(sinHalfDLat, sinHalfDLat), S::mul(S::mul(vCosOwnLat, cosLat), sinHalfDLon2));
+        a = S::min(S::max(a, vZero), vOne);
+        V range = S::mul(S::mul(vTwo, atan2V(S::sqrt(a), S::sqrt(S::sub(vOne, a)))), vRadius);
+        V deltaHeight = S::div(S::sub(alt, vOwnAlt), vFeetPerNm);
+        S::store(&rangeNm[i], S::sqrt(S::add(S::mul(range, range), S::mul(deltaHeight, deltaHeight))));
+
+        V y = S::mul(S::mul(vTwo, S::mul(sinHalfDLon, cosHalfDLon)), cosLat);
+        V x = S::mul(vTwo, S::add(S::mul(sinHalfDLat, cosHalfDLat), S::mul(S::mul(vSinOwnLat, cosLat), sinHalfDLon2)));
+        V degrees = S::andNot(S::eq(a, vZero), S::mul(atan2V(y, x), vRadToDeg));
+        degrees = S::add(degrees, S::and_(S::lt(degrees, vZero), v360));
+        degrees = S::sub(degrees, S::and_(S::ge(degrees, v360), v360));
+        S::store(&bearingDeg[i], degrees);
+    }
+
+    for (; i < targets.count; i++)
+    {
+        rangeBearingOne(sinOwnLat, cosOwnLat, ownLatRad, ownLonRad, ownAlt,
+            targets.latitude[i], targets.longitude[i], targets.altitude[i], &rangeNm[i], &bearingDeg[i]);
+    }
+}
+
+#endif
+
+void rangeBearingBatch(const TrafficPositions& targets, double ownLat, double ownLon, double ownAlt, double* rangeNm, double* bearingDeg)
+{
+#if defined(SIMDOPS_AVX2) || defined(SIMDOPS_SSE2)
+    rangeBearingSimd(targets, ownLat, ownLon, ownAlt, rangeNm, bearingDeg);
+#else
+    rangeBearingBatchScalar(targets, ownLat, ownLon, ownAlt, rangeNm, bearingDeg);
+#endif
+}
+
+const char* rangeBearingBatchIsa()
+{
+#if defined(SIMDOPS_AVX2)
+    return "AVX2";
+#elif defined(SIMDOPS_SSE2)
+    return "SSE2";
+#else
+    return "scalar";
+#endif
+}
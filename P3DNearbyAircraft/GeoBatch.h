@@ -0,0 +1,41 @@
+#pragma once
+
+#include <stddef.h>
+
+/**
+* Maximum difference between the vectorized batch kernel and rangeBearingBatchScalar().
+* The SIMD path uses its own sin/cos/atan2 polynomials, the scalar path uses the CRT,
+* so results are not bit-identical but agree to well below anything we display. The bound holds for
+* targets closer than 5000 nm; towards the antipode the haversine itself loses precision in both paths.
+*/
+constexpr double BATCH_RANGE_TOLERANCE_NM = 1e-9;
+constexpr double BATCH_BEARING_TOLERANCE_DEG = 1e-9;
+
+/**
+* Structure-of-arrays view over the aircraft of one traffic sweep.
+* Latitude and longitude are in degrees, altitude in feet.
+*/
+struct TrafficPositions
+{
+    const double* latitude;
+    const double* longitude;
+    const double* altitude;
+    size_t count;
+};
+
+/**
+* Fill rangeNm[i] with the slant range (haversine plus altitude difference, same model as rangeWithAlt())
+* and bearingDeg[i] with the true bearing in [0, 360) from the ownship to every target in the sweep.
+* Uses AVX2 or SSE2 when the compiler targets them and falls back to rangeBearingBatchScalar() otherwise.
+*/
+void rangeBearingBatch(const TrafficPositions& targets, double ownLat, double ownLon, double ownAlt, double* rangeNm, double* bearingDeg);
+
+/**
+* Reference implementation of rangeBearingBatch() using the CRT math functions one target at a time.
+*/
+void rangeBearingBatchScalar(const TrafficPositions& targets, double ownLat, double ownLon, double ownAlt, double* rangeNm, double* bearingDeg);
+
+/**
+* Name of the instruction set rangeBearingBatch() was compiled for ("AVX2", "SSE2" or "scalar").
+*/
+const char* rangeBearingBatchIsa();
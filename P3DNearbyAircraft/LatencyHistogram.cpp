@@ -0,0 +1,84 @@
+#include <chrono>
+
+#include "LatencyHistogram.h"
+
+uint64_t monotonicNs()
+{
+    return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+LatencyHistogram::LatencyHistogram()
+    : m_sum(0)
+    , m_max(0)
+{
+    for (std::atomic<uint64_t>& count : m_counts)
+        count.store(0, std::memory_order_relaxed);
+}
+
+uint64_t LatencyHistogram::bucketTop(size_t bucket)
+{
+    if (bucket < SUB_BUCKETS)
+        return bucket;
+    int shift = (int)(bucket >> SUB_BUCKET_BITS) - 1;
+    uint64_t lower = (SUB_BUCKETS + (bucket & (SUB_BUCKETS - 1))) << shift;
+    return lower + (1ull << shift) - 1;
+}
+
+uint64_t LatencyHistogram::percentile(double quantile) const
+{
+    uint64_t total = 0;
+    for (const std::atomic<uint64_t>& count : m_counts)
+        total += count.load(std::memory_order_relaxed);
+    if (total == 0)
+        return 0;
+
+    // The smallest bucket that has at least quantile of the values at or below it
+    uint64_t rank = (uint64_t)(quantile * total + 0.5);
+    rank = rank < 1 ? 1 : (rank > total ? total : rank);
+    uint64_t seen = 0;
+    uint64_t max = m_max.load(std::memory_order_relaxed);
+    for (size_t bucket = 0; bucket < BUCKETS; bucket++)
+    {
+        seen += m_counts[bucket].load(std::memory_order_relaxed);
+        if (seen >= rank)
+        {
+            uint64_t top = bucketTop(bucket);
+            return top < max ? top : max;
+        }
+    }
+    return max;
+}
+
+HistogramSummary LatencyHistogram::summary() const
+{
+    // One pass over a copy, so every figure comes from the same counts
+    uint64_t counts[BUCKETS];
+    uint64_t total = 0;
+    for (size_t bucket = 0; bucket < BUCKETS; bucket++)
+    {
+        counts[bucket] = m_counts[bucket].load(std::memory_order_relaxed);
+        total += counts[bucket];
+    }
+
+    HistogramSummary summary = {};
+    summary.count = total;
+    summary.max = m_max.load(std::memory_order_relaxed);
+    if (total == 0)
+        return summary;
+    summary.mean = (double)m_sum.load(std::memory_order_relaxed) / total;
+
+    const double quantiles[] = { 0.5, 0.9, 0.99, 0.999 };
+    uint64_t* results[] = { &summary.p50, &summary.p90, &summary.p99, &summary.p999 };
+    size_t next = 0;
+    uint64_t seen = 0;
+    for (size_t bucket = 0; bucket < BUCKETS && next < 4; bucket++)
+    {
+        seen += counts[bucket];
+        while (next < 4 && seen >= (uint64_t)(quantiles[next] * total + 0.5) && seen > 0)
+        {
+            uint64_t top = bucketTop(bucket);
+            *results[next++] = top < summary.max ? top : summary.max;
+        }
+    }
+    return summary;
+}
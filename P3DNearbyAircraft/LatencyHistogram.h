@@ -0,0 +1,101 @@
+#pragma once
+
+#include <atomic>
+#include <stddef.h>
+#include <stdint.h>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+/**
+* Nanoseconds on the monotonic clock, the time base of every latency histogram.
+*/
+uint64_t monotonicNs();
+
+/**
+* Count, mean, percentiles and maximum of a LatencyHistogram. Percentiles are the upper edge of the bucket
+* they fall in, so they overstate the exact value by at most 1 / LatencyHistogram::SUB_BUCKETS.
+*/
+struct HistogramSummary
+{
+    uint64_t count;
+    double mean;
+    uint64_t p50;
+    uint64_t p90;
+    uint64_t p99;
+    uint64_t p999;
+    uint64_t max;
+};
+
+/**
+* HDR-style histogram of non-negative values, normally nanoseconds.
+*
+* Values below SUB_BUCKETS are counted exactly; above that each power of two is split into SUB_BUCKETS
+* linear buckets, so every bucket is within about 3% of the values it holds from 1 ns up to MAX_VALUE (about
+* 18 minutes). record() is a bit scan and a few relaxed stores into a fixed array: no locks, no allocation.
+*
+* Each histogram has a single writer thread. Any thread may call summary() at any time; it sees a
+* consistent-enough picture for monitoring, at worst missing the last few values in flight. Counts are
+* cumulative from construction.
+*/
+class LatencyHistogram
+{
+public:
+    static const int SUB_BUCKET_BITS = 5;
+    static const uint64_t SUB_BUCKETS = 1ull << SUB_BUCKET_BITS;
+    static const int MAX_VALUE_BITS = 40;
+    static const uint64_t MAX_VALUE = (1ull << MAX_VALUE_BITS) - 1;     // larger values are counted as this
+    static const size_t BUCKETS = (size_t)(MAX_VALUE_BITS - SUB_BUCKET_BITS + 1) << SUB_BUCKET_BITS;
+
+    LatencyHistogram();
+
+    void record(uint64_t value)
+    {
+        if (value > MAX_VALUE)
+            value = MAX_VALUE;
+        bump(m_counts[bucketOf(value)], 1);
+        bump(m_sum, value);
+        if (value > m_max.load(std::memory_order_relaxed))
+            m_max.store(value, std::memory_order_relaxed);
+    }
+
+    HistogramSummary summary() const;
+
+    // Value at quantile (0..1), as the upper edge of its bucket; 0 when nothing has been recorded
+    uint64_t percentile(double quantile) const;
+
+    static size_t bucketOf(uint64_t value)
+    {
+        if (value < SUB_BUCKETS)
+            return (size_t)value;
+        int magnitude = highestBit(value);
+        int shift = magnitude - SUB_BUCKET_BITS;
+        return ((size_t)(shift + 1) << SUB_BUCKET_BITS) + (size_t)((value >> shift) - SUB_BUCKETS);
+    }
+
+    // Largest value that lands in bucket
+    static uint64_t bucketTop(size_t bucket);
+
+private:
+    // Single writer, so a load/store pair is enough
+    static void bump(std::atomic<uint64_t>& counter, uint64_t amount)
+    {
+        counter.store(counter.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+    }
+
+    static int highestBit(uint64_t value)
+    {
+#if defined(_MSC_VER)
+        unsigned long index;
+        _BitScanReverse64(&index, value);
+        return (int)index;
+#else
+        return 63 - __builtin_clzll(value);
+#endif
+    }
+
+    std::atomic<uint64_t> m_counts[BUCKETS];
+    std::atomic<uint64_t> m_sum;
+    std::atomic<uint64_t> m_max;
+};
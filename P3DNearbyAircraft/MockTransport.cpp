@@ -0,0 +1,38 @@
+#include <chrono>
+
+#include "MockTransport.h"
+
+void MockTransport::push(const void* data, uint32_t size)
+{
+    const uint8_t* bytes = (const uint8_t*)data;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_queue.emplace_back(bytes, bytes + size);
+    }
+    m_arrived.notify_one();
+}
+
+size_t MockTransport::pending() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_queue.size();
+}
+
+bool MockTransport::waitForMessages(uint32_t timeoutMs)
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    return m_arrived.wait_for(lock, std::chrono::milliseconds(timeoutMs), [this]() { return !m_queue.empty(); });
+}
+
+bool MockTransport::nextMessage(const void** data, uint32_t* size)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_queue.empty())
+        return false;
+
+    m_current.swap(m_queue.front());
+    m_queue.pop_front();
+    *data = m_current.data();
+    *size = (uint32_t)m_current.size();
+    return true;
+}
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <stdint.h>
+#include <vector>
+
+#include "TrafficTransport.h"
+
+/**
+* In-memory TrafficTransport. Any thread may push() messages; the receive thread consumes them
+* through waitForMessages()/nextMessage() exactly as it would a SimConnect connection.
+*/
+class MockTransport : public TrafficTransport
+{
+public:
+    void push(const void* data, uint32_t size);
+    size_t pending() const;
+
+    bool waitForMessages(uint32_t timeoutMs) override;
+    bool nextMessage(const void** data, uint32_t* size) override;
+
+private:
+    mutable std::mutex m_mutex;
+    std::condition_variable m_arrived;
+    std::deque<std::vector<uint8_t>> m_queue;
+    std::vector<uint8_t> m_current;
+};
@@ -1,49 +1,109 @@
 #include <windows.h>
 #include <tchar.h>
 #include <stdio.h>
+#include <stdlib.h>
+#include <ctype.h>
 #include <strsafe.h>
 #include <conio.h>
 
 #include "SimConnect.h"
+#include "SimConnectDefinition.h"
 #include "Utilities.h"
+#include "AsyncOutput.h"
+#include "TrafficPipeline.h"
+#include "TrafficStages.h"
+#include "TrafficMessage.h"
+#include "TrafficMetrics.h"
+#include "TrafficSnapshot.h"
+#include "TrafficRecorder.h"
+#include "ReceiveEngine.h"
+#include "SimConnectTransport.h"
 
 bool shouldQuit = false;
 HANDLE  hSimConnect = NULL;
 double nmRadius = 10;
-double lat = 32.951917;
-double lon = -97.264323;
-double alt = 3799;
-
-struct AircraftInfo
-{
-    char    title[256];
-    double  isUser;
-    double  onGround;
-    double  trueHeading;
-    double  magHeading;
-    double  altitude;
-    double  latitude;
-    double  longitude;
-};
+AsyncOutput trafficOutput(stdout, 4096, OVERFLOW_COUNT);
+TrafficPipeline trafficPipeline(trafficOutput, 32.951917, -97.264323, 3799);     // until the first ownship sample
+TrafficStages trafficStages(trafficPipeline);
+TrafficRecorder trafficRecorder;
+TrafficMetrics trafficMetrics;
+FILE* metricsFile = NULL;
+ULONGLONG metricsIntervalMs = 10000;
+SnapshotPublisher trafficSnapshots;
+const char* snapshotName = DEFAULT_SNAPSHOT_NAME;
+ReceiveSettings receiveSettings = DEFAULT_RECEIVE_SETTINGS;
+TierSettings tierSettings = DEFAULT_TIER_SETTINGS;
+StateEpsilons stateEpsilons = DEFAULT_STATE_EPSILONS;
+SIMCONNECT_DATA_REQUEST_FLAG trackedFlags = SIMCONNECT_DATA_REQUEST_FLAG_CHANGED | SIMCONNECT_DATA_REQUEST_FLAG_TAGGED;
+ULONGLONG lastSweepRequest = 0;
+std::vector<uint32_t> titleRequests;
+std::vector<TierChange> tierChanges;
 
 enum EVENT_ID {
     EVENT_SIM_START,
 };
 
+// Snapshot the metrics into the --metrics file (or the console when there is none)
+void dumpMetrics()
+{
+    MetricsSnapshot snapshot;
+    snapshotMetrics(trafficMetrics, trafficOutput, snapshot);
+    writeMetrics(metricsFile ? metricsFile : stdout, snapshot);
+}
+
+// Numbered as in TrafficMessage.h, so recordings and replays agree on what each definition holds
 enum DATA_DEFINE_ID {
-    DEFINITION_LOCAL_AIRCRAFT,
+    DEFINITION_AIRCRAFT_STATE = TRAFFIC_DEFINITION_PACKED_STATE,
+    DEFINITION_AIRCRAFT_TITLE = TRAFFIC_DEFINITION_TITLE,
+    DEFINITION_OWNSHIP = TRAFFIC_DEFINITION_OWNSHIP,
 };
 
 enum DATA_REQUEST_ID {
     REQUEST_LOCAL_AIRCRAFT,
+    REQUEST_AIRCRAFT_TITLE,
+    REQUEST_OWNSHIP,
+    REQUEST_TRACKED_AIRCRAFT = 0x10000,     // + ObjectID: the per-object request of a TIER_NEAR or TIER_MID aircraft
 };
 
-void CALLBACK TestDispatchProc(SIMCONNECT_RECV* pData, DWORD cbData, void* pContext)
+void requestNearbyAircraft()
 {
+    SimConnect_RequestDataOnSimObjectType(hSimConnect, REQUEST_LOCAL_AIRCRAFT, DEFINITION_AIRCRAFT_STATE, nmToMeters(nmRadius), SIMCONNECT_SIMOBJECT_TYPE_AIRCRAFT);
+    lastSweepRequest = GetTickCount64();
+}
 
+// Titles never change for an ObjectID, so each one is asked for once, when the aircraft first shows up
+void requestTitles()
+{
+    trafficStages.takeTitleRequests(titleRequests);
+    for (uint32_t objectId : titleRequests)
+        SimConnect_RequestDataOnSimObject(hSimConnect, REQUEST_AIRCRAFT_TITLE, DEFINITION_AIRCRAFT_TITLE, objectId, SIMCONNECT_PERIOD_ONCE);
+}
 
-    HRESULT hr;
+// Close traffic gets its own high-rate request, mid-range traffic a 1 Hz one; the rest waits for the wide sweeps.
+// By default these send only the fields that changed (trackedFlags), so parked and steady traffic costs next to nothing.
+void applyTierChanges()
+{
+    trafficStages.takeTierChanges(tierChanges);
+    for (const TierChange& change : tierChanges)
+    {
+        DWORD requestId = REQUEST_TRACKED_AIRCRAFT + change.objectId;
+        switch (change.to)
+        {
+        case TIER_NEAR:
+            SimConnect_RequestDataOnSimObject(hSimConnect, requestId, DEFINITION_AIRCRAFT_STATE, change.objectId, SIMCONNECT_PERIOD_SIM_FRAME, trackedFlags, 0, tierSettings.nearFrameInterval);
+            break;
+        case TIER_MID:
+            SimConnect_RequestDataOnSimObject(hSimConnect, requestId, DEFINITION_AIRCRAFT_STATE, change.objectId, SIMCONNECT_PERIOD_SECOND, trackedFlags);
+            break;
+        default:
+            SimConnect_RequestDataOnSimObject(hSimConnect, requestId, DEFINITION_AIRCRAFT_STATE, change.objectId, SIMCONNECT_PERIOD_NEVER);
+            break;
+        }
+    }
+}
 
+void CALLBACK TestDispatchProc(SIMCONNECT_RECV* pData, DWORD cbData, void* pContext)
+{
     switch (pData->dwID)
     {
     case SIMCONNECT_RECV_ID_SIMOBJECT_DATA_BYTYPE:
@@ -57,25 +117,10 @@ void CALLBACK TestDispatchProc(SIMCONNECT_RECV* pData, DWORD cbData, void* pCont
         {
             //printf("\nDEBUG: Aircraft Found...\n");
 
-            DWORD ObjectID = simObjData->dwObjectID;
-            AircraftInfo* aircraft = (AircraftInfo*)&simObjData->dwData;
-            if (SUCCEEDED(StringCbLengthA(&aircraft->title[0], sizeof(aircraft->title), NULL))) // security check
-            {   
-                if (!aircraft->onGround)
-                {
-                    if (aircraft->isUser)
-                    {
-                        printf("\nUSER AIRCRAFT!!!\nObjectID=%d  Title=\"%s\"\nLat=%f  Lon=%f  Alt=%fft  HdgT=%.2f  HdgM=%.2f  OnGround=%f\n", ObjectID, aircraft->title, aircraft->latitude, aircraft->longitude, aircraft->altitude, aircraft->trueHeading * (180 / M_PI), aircraft->magHeading * (180 / M_PI), aircraft->onGround);
-                        lat = aircraft->latitude;
-                        lon = aircraft->longitude;
-                    }
-                    else
-                    {
-                        //printf("\nObjectID=%d  Title=\"%s\"\nLat=%f  Lon=%f  Alt=%fft  HdgT=%.2f  HdgM=%.2f  OnGround=%f  Range=%.2fnm  Brng=%.2f\n", ObjectID, aircraft->title, aircraft->latitude, aircraft->longitude, aircraft->altitude, aircraft->trueHeading * (180 / M_PI), aircraft->magHeading * (180 / M_PI), aircraft->onGround, rangeWithAlt(lat, lon, alt, aircraft->latitude, aircraft->longitude, aircraft->altitude), getBearing(lat, lon, aircraft->latitude, aircraft->longitude));
-                        printf("\nObjectID=%d  Title=\"%s\"\nLat=%f  Lon=%f  Alt=%fft  HdgT=%.2f  HdgM=%.2f  OnGround=%f  Range=%.2fnm  Brng=%.2f\n", ObjectID, aircraft->title, aircraft->latitude, aircraft->longitude, aircraft->altitude, aircraft->trueHeading * (180 / M_PI), aircraft->magHeading * (180 / M_PI), aircraft->onGround, rangeWithAlt(lat, lon, alt, aircraft->latitude, aircraft->longitude, aircraft->altitude), getBearing(lat, lon, aircraft->latitude, aircraft->longitude));
-                    }
-                }
-            }
+            // Raw messages go to the recording untouched, so a replay runs exactly what the stages are given
+            if (trafficRecorder.isOpen())
+                trafficRecorder.append(pData, cbData);
+            trafficStages.submit(pData, cbData);
             break;
         }
 
@@ -86,6 +131,19 @@ void CALLBACK TestDispatchProc(SIMCONNECT_RECV* pData, DWORD cbData, void* pCont
         break;
     }
 
+    case SIMCONNECT_RECV_ID_SIMOBJECT_DATA:
+    {
+        SIMCONNECT_RECV_SIMOBJECT_DATA* simObjData = (SIMCONNECT_RECV_SIMOBJECT_DATA*)pData;
+        if (simObjData->dwRequestID == REQUEST_AIRCRAFT_TITLE || simObjData->dwRequestID == REQUEST_OWNSHIP ||
+            simObjData->dwRequestID >= REQUEST_TRACKED_AIRCRAFT)
+        {
+            if (trafficRecorder.isOpen())
+                trafficRecorder.append(pData, cbData);
+            trafficStages.submit(pData, cbData);
+        }
+        break;
+    }
+
     case SIMCONNECT_RECV_ID_QUIT:
     {
         printf("/nDEBUGGING: SIMCONNECT_RECV_ID_QUIT recieved...");
@@ -95,52 +153,159 @@ void CALLBACK TestDispatchProc(SIMCONNECT_RECV* pData, DWORD cbData, void* pCont
 
     default:
         printf("\nRequesting aircraft nearby...\n");
-        hr = SimConnect_RequestDataOnSimObjectType(hSimConnect, REQUEST_LOCAL_AIRCRAFT, DEFINITION_LOCAL_AIRCRAFT, nmToMeters(nmRadius), SIMCONNECT_SIMOBJECT_TYPE_AIRCRAFT);
+        requestNearbyAircraft();
         break;
     }
 }
 
+void dispatchMessage(const void* data, uint32_t size, void* context)
+{
+    TestDispatchProc((SIMCONNECT_RECV*)data, size, context);
+}
+
 void testDataRequest()
 {
     HRESULT hr;
 
-    if (SUCCEEDED(SimConnect_Open(&hSimConnect, "Request Data", NULL, 0, 0, 0)))
+    // SimConnect signals this event whenever a message is queued, so the loop below sleeps until there is work
+    HANDLE hEvent = CreateEvent(NULL, FALSE, FALSE, NULL);
+
+    if (SUCCEEDED(SimConnect_Open(&hSimConnect, "Request Data", NULL, 0, hEvent, 0)))
     {
         printf("\nConnected to Prepar3D!");
         printf("\nSearching a %.2f nm (%.2f m) radius\n", nmRadius, nmToMeters(nmRadius));
 
-        // Set up the data definition, but do not yet do anything with it
-        hr = SimConnect_AddToDataDefinition(hSimConnect, DEFINITION_LOCAL_AIRCRAFT, "Title", NULL, SIMCONNECT_DATATYPE_STRING256);
-        hr = SimConnect_AddToDataDefinition(hSimConnect, DEFINITION_LOCAL_AIRCRAFT, "Is User Sim", "bool");
-        hr = SimConnect_AddToDataDefinition(hSimConnect, DEFINITION_LOCAL_AIRCRAFT, "Sim On Ground", "bool");
-        hr = SimConnect_AddToDataDefinition(hSimConnect, DEFINITION_LOCAL_AIRCRAFT, "Plane Heading Degrees True", "radians");
-        hr = SimConnect_AddToDataDefinition(hSimConnect, DEFINITION_LOCAL_AIRCRAFT, "Plane Heading Degrees Magnetic", "radians");
-        hr = SimConnect_AddToDataDefinition(hSimConnect, DEFINITION_LOCAL_AIRCRAFT, "Plane Altitude", "feet");
-        hr = SimConnect_AddToDataDefinition(hSimConnect, DEFINITION_LOCAL_AIRCRAFT, "Plane Latitude", "degrees");
-        hr = SimConnect_AddToDataDefinition(hSimConnect, DEFINITION_LOCAL_AIRCRAFT, "Plane Longitude", "degrees");
+        // Set up the data definitions, but do not yet do anything with them.
+        // Sweeps carry only the numbers (PackedAircraftState); the 256-byte title is fetched once per ObjectID (AircraftTitle).
+        // Each definition is generated from its record's description in AircraftInfo.h.
+        hr = addDataDefinition<PackedAircraftState>(hSimConnect, DEFINITION_AIRCRAFT_STATE, &stateEpsilons);
+        hr = addDataDefinition<AircraftTitle>(hSimConnect, DEFINITION_AIRCRAFT_TITLE);
+
+        // The user aircraft has its own per-frame request, so every range and bearing is measured from where it is now
+        hr = addDataDefinition<OwnshipState>(hSimConnect, DEFINITION_OWNSHIP);
+        hr = SimConnect_RequestDataOnSimObject(hSimConnect, REQUEST_OWNSHIP, DEFINITION_OWNSHIP, SIMCONNECT_OBJECT_ID_USER, SIMCONNECT_PERIOD_SIM_FRAME);
 
         // Request an event when the simulation starts
         //hr = SimConnect_SubscribeToSystemEvent(hSimConnect, EVENT_SIM_START, "SimStart");
 
         //SimConnect_RequestDataOnSimObject(hSimConnect, REQUEST_2, DEFINITION_1, SIMCONNECT_OBJECT_ID_, SIMCONNECT_PERIOD_SECOND);
 
+        // Far traffic is only swept every few seconds, so keep extrapolating it until the next sweep
+        trafficPipeline.scheduler().setSettings(tierSettings);
+        trafficPipeline.predictor().maxExtrapolationSeconds = tierSettings.farSweepMs / 1000.0 + 1;
+
+        // This thread only receives; decoding, geometry, the table and the report run on the stage threads
+        // Local tools read the traffic from shared memory instead of opening their own SimConnect connection
+        if (trafficSnapshots.open(snapshotName))
+        {
+            trafficPipeline.snapshots = &trafficSnapshots;
+            printf("Publishing traffic snapshots as %s\n", snapshotName);
+        }
+        else
+        {
+            printf("Could not create the traffic snapshot region %s\n", snapshotName);
+        }
+
+        trafficPipeline.metrics = &trafficMetrics;
+        trafficStages.setMetrics(&trafficMetrics);
+        trafficOutput.setLatencyHistogram(&trafficMetrics.outputNs);
+        trafficOutput.start();
+        trafficStages.start();
+        ULONGLONG started = GetTickCount64();
+        ULONGLONG lastMetrics = started;
+        SimConnectTransport transport(hSimConnect, hEvent);
+        ReceiveEngine receiver(transport, receiveSettings);
+
         while (!shouldQuit)
         {
             //printf("Searching...");
-            SimConnect_CallDispatch(hSimConnect, TestDispatchProc, NULL);
+            uint64_t dispatchStart = monotonicNs();
+            receiver.pump(dispatchMessage, NULL);
+            trafficMetrics.dispatchNs.record(monotonicNs() - dispatchStart);
+            trafficStages.flush();
+            requestTitles();
+            applyTierChanges();
 
-            Sleep(1000);
+            // Each request returns one wide sweep; tracked traffic updates itself in between
+            if (lastSweepRequest != 0 && GetTickCount64() - lastSweepRequest >= tierSettings.farSweepMs)
+                requestNearbyAircraft();
+
+            // 'm' dumps the metrics now; with --metrics they are also written every metricsIntervalMs
+            if (_kbhit() && tolower(_getch()) == 'm')
+                dumpMetrics();
+            if (metricsFile && GetTickCount64() - lastMetrics >= metricsIntervalMs)
+            {
+                dumpMetrics();
+                lastMetrics = GetTickCount64();
+            }
         }
 
+        trafficStages.stop();
+        trafficOutput.stop();
+        dumpMetrics();
+
+        std::vector<StageStats> stageStats;
+        trafficStages.stats(stageStats);
+        printf("\nPipeline stages (%u compute workers):\n", trafficStages.workers());
+        printStageStats(stdout, stageStats, (GetTickCount64() - started) / 1000.0);
         hr = SimConnect_Close(hSimConnect);
     }
+
+    CloseHandle(hEvent);
 }
 
 int __cdecl _tmain(int argc, _TCHAR* argv[])
 {
+    // --record <file>: save every traffic message for TrafficReplay
+    // --publish <name>: name of the shared memory traffic snapshot (default P3DNearbyAircraftTraffic)
+    // --metrics <file>: write latency and throughput metrics to file every --metrics-interval <seconds> (default 10)
+    // --updates <changed|full>: tracked aircraft send only the fields that changed (default), or every field every time
+    // --epsilon <scale>: multiply the change thresholds of DEFAULT_STATE_EPSILONS (default 1)
+    for (int i = 1; i + 1 < argc; i++)
+    {
+        if (_tcscmp(argv[i], _T("--record")) == 0)
+        {
+            if (trafficRecorder.open(argv[++i]))
+                printf("\nRecording traffic to %s\n", argv[i]);
+            else
+                printf("\nCould not create recording %s\n", argv[i]);
+        }
+        else if (_tcscmp(argv[i], _T("--metrics")) == 0)
+        {
+            metricsFile = fopen(argv[++i], "w");
+            if (metricsFile)
+                printf("\nWriting metrics to %s\n", argv[i]);
+            else
+                printf("\nCould not create metrics file %s\n", argv[i]);
+        }
+        else if (_tcscmp(argv[i], _T("--publish")) == 0)
+        {
+            snapshotName = argv[++i];
+        }
+        else if (_tcscmp(argv[i], _T("--metrics-interval")) == 0)
+        {
+            metricsIntervalMs = (ULONGLONG)(atof(argv[++i]) * 1000);
+        }
+        else if (_tcscmp(argv[i], _T("--updates")) == 0)
+        {
+            trackedFlags = _tcscmp(argv[++i], _T("full")) == 0 ? 0 : SIMCONNECT_DATA_REQUEST_FLAG_CHANGED | SIMCONNECT_DATA_REQUEST_FLAG_TAGGED;
+        }
+        else if (_tcscmp(argv[i], _T("--epsilon")) == 0)
+        {
+            float scale = (float)atof(argv[++i]);
+            stateEpsilons.heading *= scale;
+            stateEpsilons.altitude *= scale;
+            stateEpsilons.position *= scale;
+            stateEpsilons.groundSpeed *= scale;
+            stateEpsilons.verticalSpeed *= scale;
+        }
+    }
 
     testDataRequest();
 
+    trafficRecorder.close();
+    if (metricsFile)
+        fclose(metricsFile);
     return 0;
 }
 
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <atomic>
+#include <stddef.h>
+#include <vector>
+
+/**
+* Bounded single-producer/single-consumer queue.
+*
+* One thread may call tryPush() and one other thread tryPop(); neither ever takes a lock. Each side caches the
+* other side's index and only reloads it when the ring looks full/empty, so the shared cache lines are touched
+* once per wrap rather than once per item.
+*/
+template <typename T>
+class SpscRing
+{
+public:
+    explicit SpscRing(size_t capacity)
+        : m_head(0)
+        , m_cachedTail(0)
+        , m_tail(0)
+        , m_cachedHead(0)
+    {
+        size_t rounded = 2;
+        while (rounded < capacity)
+            rounded *= 2;
+        m_items.resize(rounded);
+        m_mask = rounded - 1;
+    }
+
+    size_t capacity() const { return m_items.size(); }
+
+    // Approximate when called from a third thread
+    size_t size() const { return m_head.load(std::memory_order_acquire) - m_tail.load(std::memory_order_acquire); }
+
+    bool tryPush(const T& item)
+    {
+        size_t head = m_head.load(std::memory_order_relaxed);
+        if (head - m_cachedTail == m_items.size())
+        {
+            m_cachedTail = m_tail.load(std::memory_order_acquire);
+            if (head - m_cachedTail == m_items.size())
+                return false;
+        }
+
+        m_items[head & m_mask] = item;
+        m_head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool tryPop(T& item)
+    {
+        size_t tail = m_tail.load(std::memory_order_relaxed);
+        if (tail == m_cachedHead)
+        {
+            m_cachedHead = m_head.load(std::memory_order_acquire);
+            if (tail == m_cachedHead)
+                return false;
+        }
+
+        item = m_items[tail & m_mask];
+        m_tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+private:
+    std::vector<T> m_items;
+    size_t m_mask;
+
+    // Producer side: next slot to write and its last view of the consumer
+    alignas(64) std::atomic<size_t> m_head;
+    size_t m_cachedTail;
+
+    // Consumer side: next slot to read and its last view of the producer
+    alignas(64) std::atomic<size_t> m_tail;
+    size_t m_cachedHead;
+};
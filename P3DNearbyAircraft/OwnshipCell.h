@@ -0,0 +1,83 @@
+#pragma once
+
+#include <atomic>
+#include <stdint.h>
+#include <string.h>
+
+/**
+* The user aircraft as its own per-frame request last reported it.
+*/
+struct OwnshipSample
+{
+    double latitude;
+    double longitude;
+    double altitude;            // feet
+    double trueHeading;         // radians
+    double groundSpeed;         // knots
+    double verticalSpeed;       // feet per minute
+    double time;                // clock() when it arrived
+};
+
+/**
+* Latest-value cell for the ownship: one thread stores each sample as it arrives, any number of threads load
+* the newest one. Nothing queues, so a reader never works through stale samples to reach the current one.
+*
+* A sequence counter guards the words of the sample: odd while a store is under way. load() copies the words
+* and retries if the counter moved, so the writer never waits and a reader only repeats a copy that raced a
+* store. The words are atomics so the racing copy is well defined.
+*/
+class OwnshipCell
+{
+public:
+    OwnshipCell()
+        : m_sequence(0)
+    {
+        for (std::atomic<uint64_t>& word : m_words)
+            word.store(0, std::memory_order_relaxed);
+    }
+
+    // Single writer
+    void store(const OwnshipSample& sample)
+    {
+        uint64_t words[WORDS];
+        memcpy(words, &sample, sizeof(sample));
+
+        uint64_t sequence = m_sequence.load(std::memory_order_relaxed);
+        m_sequence.store(sequence + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        for (size_t i = 0; i < WORDS; i++)
+            m_words[i].store(words[i], std::memory_order_relaxed);
+        m_sequence.store(sequence + 2, std::memory_order_release);
+    }
+
+    // The newest sample. False before the first store.
+    bool load(OwnshipSample& out) const
+    {
+        uint64_t words[WORDS];
+        for (;;)
+        {
+            uint64_t before = m_sequence.load(std::memory_order_acquire);
+            if (before == 0)
+                return false;
+            if (before & 1)
+                continue;
+            for (size_t i = 0; i < WORDS; i++)
+                words[i] = m_words[i].load(std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (m_sequence.load(std::memory_order_relaxed) == before)
+                break;
+        }
+        memcpy(&out, words, sizeof(out));
+        return true;
+    }
+
+    // Samples stored so far
+    uint64_t updates() const { return m_sequence.load(std::memory_order_acquire) / 2; }
+
+private:
+    static constexpr size_t WORDS = sizeof(OwnshipSample) / sizeof(uint64_t);
+    static_assert(sizeof(OwnshipSample) == WORDS * sizeof(uint64_t), "the sample is copied as whole words");
+
+    alignas(64) std::atomic<uint64_t> m_sequence;
+    std::atomic<uint64_t> m_words[WORDS];
+};
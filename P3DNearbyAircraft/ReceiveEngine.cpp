@@ -0,0 +1,39 @@
+#include "ReceiveEngine.h"
+
+ReceiveEngine::ReceiveEngine(TrafficTransport& transport, const ReceiveSettings& settings)
+    : m_transport(transport)
+    , m_settings(settings)
+    , m_stats()
+    , m_backlog(false)
+{
+}
+
+size_t ReceiveEngine::pump(MessageHandler handler, void* context)
+{
+    if (!m_backlog)
+    {
+        if (!m_transport.waitForMessages(m_settings.maxLatencyMs))
+        {
+            m_stats.timeouts++;
+            return 0;
+        }
+        m_stats.wakeups++;
+    }
+
+    size_t delivered = 0;
+    const void* data;
+    uint32_t size;
+    while (delivered < m_settings.maxBatch && m_transport.nextMessage(&data, &size))
+    {
+        handler(data, size, context);
+        delivered++;
+    }
+
+    // Messages may remain when the batch limit was hit; come straight back for them next call
+    m_backlog = delivered == m_settings.maxBatch && delivered > 0;
+    if (m_backlog)
+        m_stats.fullBatches++;
+
+    m_stats.messages += delivered;
+    return delivered;
+}
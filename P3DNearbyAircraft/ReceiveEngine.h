@@ -0,0 +1,51 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "TrafficTransport.h"
+
+typedef void (*MessageHandler)(const void* data, uint32_t size, void* context);
+
+/**
+* Knobs for ReceiveEngine::pump().
+*/
+struct ReceiveSettings
+{
+    uint32_t maxLatencyMs;  // longest pump() blocks waiting for traffic before handing control back
+    uint32_t maxBatch;      // most messages delivered per wakeup, so a burst cannot starve the caller
+};
+
+constexpr ReceiveSettings DEFAULT_RECEIVE_SETTINGS = { 100, 256 };
+
+struct ReceiveStats
+{
+    uint64_t wakeups;       // waits that returned with messages queued
+    uint64_t timeouts;      // waits that ran out after maxLatencyMs
+    uint64_t messages;
+    uint64_t fullBatches;   // wakeups that stopped at maxBatch with messages still queued
+};
+
+/**
+* Replaces the CallDispatch + Sleep(1000) poll: block until the transport signals a message,
+* then drain everything queued (up to maxBatch) in one go.
+*/
+class ReceiveEngine
+{
+public:
+    ReceiveEngine(TrafficTransport& transport, const ReceiveSettings& settings = DEFAULT_RECEIVE_SETTINGS);
+
+    // Wait for traffic and deliver it to handler. Returns the number of messages delivered (0 on timeout).
+    size_t pump(MessageHandler handler, void* context);
+
+    const ReceiveSettings& settings() const { return m_settings; }
+    void setSettings(const ReceiveSettings& settings) { m_settings = settings; }
+
+    const ReceiveStats& stats() const { return m_stats; }
+
+private:
+    TrafficTransport& m_transport;
+    ReceiveSettings m_settings;
+    ReceiveStats m_stats;
+    bool m_backlog;         // the last pump() hit maxBatch, so skip the wait next time
+};
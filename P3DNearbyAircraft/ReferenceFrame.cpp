@@ -0,0 +1,83 @@
+#include "ReferenceFrame.h"
+#include "Geo.h"
+#include "Utilities.h"
+
+using geo::WGS84;
+
+void geodeticToEcef(double lat, double lon, double altFt, double ecef[3])
+{
+    double latRad = lat * (M_PI / 180);
+    double lonRad = lon * (M_PI / 180);
+    double sinLat = sin(latRad);
+    double cosLat = cos(latRad);
+    double h = geo::units::feetToMeters(altFt);
+
+    // Prime vertical radius of curvature
+    double n = WGS84::a / sqrt(1 - WGS84::e2 * sinLat * sinLat);
+
+    ecef[0] = (n + h) * cosLat * cos(lonRad);
+    ecef[1] = (n + h) * cosLat * sin(lonRad);
+    ecef[2] = (n * (1 - WGS84::e2) + h) * sinLat;
+}
+
+OwnshipFrame::OwnshipFrame()
+{
+    update(0, 0, 0);
+}
+
+OwnshipFrame::OwnshipFrame(double lat, double lon, double altFt)
+{
+    update(lat, lon, altFt);
+}
+
+void OwnshipFrame::update(double lat, double lon, double altFt)
+{
+    m_lat = lat;
+    m_lon = lon;
+    m_alt = altFt;
+
+    geodeticToEcef(lat, lon, altFt, m_origin);
+
+    double latRad = lat * (M_PI / 180);
+    double lonRad = lon * (M_PI / 180);
+    double sinLat = sin(latRad);
+    double cosLat = cos(latRad);
+    double sinLon = sin(lonRad);
+    double cosLon = cos(lonRad);
+
+    m_east[0] = -sinLon;
+    m_east[1] = cosLon;
+    m_east[2] = 0;
+
+    m_north[0] = -sinLat * cosLon;
+    m_north[1] = -sinLat * sinLon;
+    m_north[2] = cosLat;
+
+    m_up[0] = cosLat * cosLon;
+    m_up[1] = cosLat * sinLon;
+    m_up[2] = sinLat;
+}
+
+TargetGeometry OwnshipFrame::solve(double lat, double lon, double altFt) const
+{
+    double target[3];
+    geodeticToEcef(lat, lon, altFt, target);
+
+    double dx = target[0] - m_origin[0];
+    double dy = target[1] - m_origin[1];
+    double dz = target[2] - m_origin[2];
+
+    double e = m_east[0] * dx + m_east[1] * dy;
+    double n = m_north[0] * dx + m_north[1] * dy + m_north[2] * dz;
+    double u = m_up[0] * dx + m_up[1] * dy + m_up[2] * dz;
+
+    double horizontal = sqrt(e * e + n * n);
+
+    TargetGeometry geometry;
+    geometry.rangeNm = geo::units::metersToNm(sqrt(horizontal * horizontal + u * u));
+
+    double degrees = atan2(e, n) * (180 / M_PI);
+    geometry.bearingDeg = degrees < 0 ? degrees + 360 : degrees;
+    geometry.elevationDeg = atan2(u, horizontal) * (180 / M_PI);
+    return geometry;
+}
@@ -0,0 +1,62 @@
+#include <algorithm>
+#include <thread>
+
+#include "ReplayTransport.h"
+
+ReplayTransport::ReplayTransport(TrafficLogReader& reader, double speed)
+    : m_reader(reader)
+    , m_speed(speed)
+    , m_next()
+    , m_currentTimestampNs(0)
+    , m_firstTimestampNs(0)
+    , m_start(std::chrono::steady_clock::now())
+{
+    m_pending = m_reader.next(m_next);
+    if (m_pending)
+        m_firstTimestampNs = m_next.timestampNs;
+}
+
+/**
+* When the next record should be delivered, relative to when the replay started.
+*/
+std::chrono::steady_clock::time_point ReplayTransport::dueAt() const
+{
+    double offsetNs = (m_next.timestampNs - m_firstTimestampNs) / m_speed;
+    return m_start + std::chrono::nanoseconds((int64_t)offsetNs);
+}
+
+bool ReplayTransport::due() const
+{
+    return m_speed <= 0 || std::chrono::steady_clock::now() >= dueAt();
+}
+
+bool ReplayTransport::waitForMessages(uint32_t timeoutMs)
+{
+    if (!m_pending)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(timeoutMs));
+        return false;
+    }
+    if (m_speed <= 0)
+        return true;
+
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMs);
+    std::this_thread::sleep_until(std::min(dueAt(), deadline));
+    return due();
+}
+
+bool ReplayTransport::nextMessage(const void** data, uint32_t* size)
+{
+    if (!m_pending || !due())
+        return false;
+
+    // Reading ahead can replace the reader's chunk buffer, so the record handed out is a copy
+    const uint8_t* bytes = (const uint8_t*)m_next.data;
+    m_current.assign(bytes, bytes + m_next.size);
+    *data = m_current.data();
+    *size = (uint32_t)m_current.size();
+    m_currentTimestampNs = m_next.timestampNs - m_firstTimestampNs;
+
+    m_pending = m_reader.next(m_next);
+    return true;
+}
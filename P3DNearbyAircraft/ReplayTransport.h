@@ -0,0 +1,43 @@
+#pragma once
+
+#include <chrono>
+#include <stdint.h>
+#include <vector>
+
+#include "TrafficLog.h"
+#include "TrafficTransport.h"
+
+/**
+* TrafficTransport that plays a recording back with its original timing scaled by speed
+* (1 = real time, N = N times faster, 0 = as fast as the receiver takes them).
+*
+* recordedSeconds() is the recording's own clock, whatever the speed: point the pipeline's clock at it and
+* a replay stamps sweeps, times them out and dead-reckons exactly the same at --max as in real time.
+*/
+class ReplayTransport : public TrafficTransport
+{
+public:
+    ReplayTransport(TrafficLogReader& reader, double speed = 1);
+
+    // True once every record has been handed out
+    bool finished() const { return !m_pending; }
+
+    // When the message last handed out was recorded, in seconds from the first record; 0 before any
+    double recordedSeconds() const { return m_currentTimestampNs / 1e9; }
+
+    bool waitForMessages(uint32_t timeoutMs) override;
+    bool nextMessage(const void** data, uint32_t* size) override;
+
+private:
+    std::chrono::steady_clock::time_point dueAt() const;
+    bool due() const;
+
+    TrafficLogReader& m_reader;
+    double m_speed;
+    TrafficLogRecord m_next;
+    std::vector<uint8_t> m_current;
+    uint64_t m_currentTimestampNs;      // from m_firstTimestampNs
+    bool m_pending;
+    uint64_t m_firstTimestampNs;
+    std::chrono::steady_clock::time_point m_start;
+};
@@ -0,0 +1,22 @@
+#pragma once
+
+#include "SimConnect.h"
+#include "AircraftInfo.h"
+
+/**
+* Add the datums of Record's description (WireRecord<Record>) to defineId, in layout order. Records whose
+* DatumIDs are AircraftStateFields take their change thresholds from epsilons; without it every datum has 0.
+*/
+template <typename Record>
+HRESULT addDataDefinition(HANDLE hSimConnect, SIMCONNECT_DATA_DEFINITION_ID defineId, const StateEpsilons* epsilons = NULL)
+{
+    static_assert(isWireLayout<Record>(), "the record must match its description");
+    for (const WireField& field : WireRecord<Record>::fields)
+    {
+        float epsilon = epsilons && field.datumId != WIRE_UNUSED_DATUM ? stateEpsilon(*epsilons, field.datumId) : 0;
+        HRESULT hr = SimConnect_AddToDataDefinition(hSimConnect, defineId, field.name, field.units, (SIMCONNECT_DATATYPE)field.type, epsilon, field.datumId);
+        if (FAILED(hr))
+            return hr;
+    }
+    return S_OK;
+}
@@ -0,0 +1,29 @@
+#pragma once
+
+#include "SimConnect.h"
+#include "TrafficClient.h"
+
+/**
+* RequestSink over an open SimConnect connection.
+*/
+class SimConnectRequests : public RequestSink
+{
+public:
+    SimConnectRequests(HANDLE hSimConnect)
+        : m_hSimConnect(hSimConnect)
+    {
+    }
+
+    bool requestByType(uint32_t requestId, uint32_t defineId, uint32_t radiusMeters, uint32_t objectType) override
+    {
+        return SUCCEEDED(SimConnect_RequestDataOnSimObjectType(m_hSimConnect, requestId, defineId, radiusMeters, (SIMCONNECT_SIMOBJECT_TYPE)objectType));
+    }
+
+    bool requestOnObject(uint32_t requestId, uint32_t defineId, uint32_t objectId, uint32_t period, uint32_t flags, uint32_t interval) override
+    {
+        return SUCCEEDED(SimConnect_RequestDataOnSimObject(m_hSimConnect, requestId, defineId, objectId, (SIMCONNECT_PERIOD)period, flags, 0, interval));
+    }
+
+private:
+    HANDLE m_hSimConnect;
+};
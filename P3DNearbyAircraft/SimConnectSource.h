@@ -0,0 +1,91 @@
+#pragma once
+
+#include <chrono>
+#include <thread>
+
+#include "SimConnect.h"
+#include "SimConnectDefinition.h"
+#include "TrafficAggregator.h"
+#include "TrafficMessage.h"
+
+/**
+* TrafficSource over one SimConnect connection: a sweep of the aircraft within radiusMeters every sweepSeconds,
+* and the identity of each new ObjectID. The constructor adds the data definitions, so it runs before
+* TrafficAggregator::start(); from then on only the source's receive thread touches the connection.
+*
+* hEvent is the event handle the connection was opened with. Without one, as with the stand-in on Linux,
+* poll() looks for messages every millisecond instead of waiting on it.
+*/
+class SimConnectSource : public TrafficSource
+{
+public:
+    enum
+    {
+        REQUEST_SWEEP = 0x20000,
+        REQUEST_IDENTITY,
+    };
+
+    SimConnectSource(HANDLE hSimConnect, HANDLE hEvent, uint32_t radiusMeters, double sweepSeconds = 1)
+        : m_hSimConnect(hSimConnect)
+        , m_hEvent(hEvent)
+        , m_radiusMeters(radiusMeters)
+        , m_sweepPeriod(std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(sweepSeconds)))
+        , m_nextSweep(std::chrono::steady_clock::now())
+    {
+        addDataDefinition<PackedAircraftState>(hSimConnect, TRAFFIC_DEFINITION_PACKED_STATE);
+        addDataDefinition<AircraftIdentity>(hSimConnect, TRAFFIC_DEFINITION_IDENTITY);
+    }
+
+    bool poll(uint32_t timeoutMs, MessageHandler handler, void* context) override
+    {
+        auto now = std::chrono::steady_clock::now();
+        if (now >= m_nextSweep)
+        {
+            SimConnect_RequestDataOnSimObjectType(m_hSimConnect, REQUEST_SWEEP, TRAFFIC_DEFINITION_PACKED_STATE, m_radiusMeters, SIMCONNECT_SIMOBJECT_TYPE_AIRCRAFT);
+            m_nextSweep = now + m_sweepPeriod;
+        }
+
+        // Back in time for the next sweep, however long the caller would wait
+        auto deadline = now + std::chrono::milliseconds(timeoutMs);
+        if (deadline > m_nextSweep)
+            deadline = m_nextSweep;
+
+        for (;;)
+        {
+            size_t delivered = 0;
+            SIMCONNECT_RECV* pData = NULL;
+            DWORD cbData = 0;
+            while (SUCCEEDED(SimConnect_GetNextDispatch(m_hSimConnect, &pData, &cbData)) && pData != NULL)
+            {
+                if (pData->dwID == SIMCONNECT_RECV_ID_QUIT)
+                    return false;
+                handler(pData, (uint32_t)cbData, context);
+                delivered++;
+            }
+
+            now = std::chrono::steady_clock::now();
+            if (delivered > 0 || now >= deadline)
+                return true;
+#ifdef _WIN32
+            if (m_hEvent != NULL)
+            {
+                WaitForSingleObject(m_hEvent, (DWORD)std::chrono::duration_cast<std::chrono::milliseconds>(deadline - now).count() + 1);
+                continue;
+            }
+#endif
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }
+
+    void requestIdentity(uint32_t objectId) override
+    {
+        SimConnect_RequestDataOnSimObject(m_hSimConnect, REQUEST_IDENTITY, TRAFFIC_DEFINITION_IDENTITY, objectId, SIMCONNECT_PERIOD_ONCE);
+    }
+
+private:
+    HANDLE m_hSimConnect;
+    HANDLE m_hEvent;
+    uint32_t m_radiusMeters;
+    std::chrono::steady_clock::duration m_sweepPeriod;
+    std::chrono::steady_clock::time_point m_nextSweep;
+};
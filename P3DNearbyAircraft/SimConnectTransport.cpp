@@ -0,0 +1,24 @@
+#include "SimConnectTransport.h"
+
+SimConnectTransport::SimConnectTransport(HANDLE hSimConnect, HANDLE hEvent)
+    : m_hSimConnect(hSimConnect)
+    , m_hEvent(hEvent)
+{
+}
+
+bool SimConnectTransport::waitForMessages(uint32_t timeoutMs)
+{
+    return WaitForSingleObject(m_hEvent, timeoutMs) == WAIT_OBJECT_0;
+}
+
+bool SimConnectTransport::nextMessage(const void** data, uint32_t* size)
+{
+    SIMCONNECT_RECV* pData = NULL;
+    DWORD cbData = 0;
+    if (FAILED(SimConnect_GetNextDispatch(m_hSimConnect, &pData, &cbData)) || pData == NULL)
+        return false;
+
+    *data = pData;
+    *size = (uint32_t)cbData;
+    return true;
+}
@@ -0,0 +1,24 @@
+#pragma once
+
+#include <windows.h>
+
+#include "SimConnect.h"
+#include "TrafficTransport.h"
+
+/**
+* TrafficTransport over a live SimConnect connection.
+* The connection must have been opened with hEvent as its event handle (SimConnect_Open's hEventHandle),
+* which SimConnect signals whenever a message is queued.
+*/
+class SimConnectTransport : public TrafficTransport
+{
+public:
+    SimConnectTransport(HANDLE hSimConnect, HANDLE hEvent);
+
+    bool waitForMessages(uint32_t timeoutMs) override;
+    bool nextMessage(const void** data, uint32_t* size) override;
+
+private:
+    HANDLE m_hSimConnect;
+    HANDLE m_hEvent;
+};
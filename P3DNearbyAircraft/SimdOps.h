@@ -0,0 +1,93 @@
+#pragma once
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define SIMDOPS_AVX2
+#elif defined(_M_X64) || defined(__SSE2__)
+#include <emmintrin.h>
+#define SIMDOPS_SSE2
+#endif
+
+#include <stddef.h>
+
+#if defined(SIMDOPS_AVX2) || defined(SIMDOPS_SSE2)
+
+/**
+* Thin wrappers over the SSE2 and AVX2 intrinsics so each vector kernel is written once.
+* Only operations available in plain SSE2 are used (no blendv, floor or FMA).
+*/
+#if defined(SIMDOPS_AVX2)
+struct SimdOps
+{
+    typedef __m256d V;
+    typedef __m256i I;
+    static const size_t width = 4;
+
+    static V load(const double* p) { return _mm256_loadu_pd(p); }
+    static void store(double* p, V v) { _mm256_storeu_pd(p, v); }
+    static V set1(double d) { return _mm256_set1_pd(d); }
+    static V add(V a, V b) { return _mm256_add_pd(a, b); }
+    static V sub(V a, V b) { return _mm256_sub_pd(a, b); }
+    static V mul(V a, V b) { return _mm256_mul_pd(a, b); }
+    static V div(V a, V b) { return _mm256_div_pd(a, b); }
+    static V sqrt(V a) { return _mm256_sqrt_pd(a); }
+    static V min(V a, V b) { return _mm256_min_pd(a, b); }
+    static V max(V a, V b) { return _mm256_max_pd(a, b); }
+    static V and_(V a, V b) { return _mm256_and_pd(a, b); }
+    static V andNot(V a, V b) { return _mm256_andnot_pd(a, b); }
+    static V or_(V a, V b) { return _mm256_or_pd(a, b); }
+    static V xor_(V a, V b) { return _mm256_xor_pd(a, b); }
+    static V lt(V a, V b) { return _mm256_cmp_pd(a, b, _CMP_LT_OQ); }
+    static V gt(V a, V b) { return _mm256_cmp_pd(a, b, _CMP_GT_OQ); }
+    static V ge(V a, V b) { return _mm256_cmp_pd(a, b, _CMP_GE_OQ); }
+    static V eq(V a, V b) { return _mm256_cmp_pd(a, b, _CMP_EQ_OQ); }
+    static I bits(V a) { return _mm256_castpd_si256(a); }
+    static V fromBits(I a) { return _mm256_castsi256_pd(a); }
+    static I set1i(long long i) { return _mm256_set1_epi64x(i); }
+    static I andi(I a, I b) { return _mm256_and_si256(a, b); }
+    static I addi(I a, I b) { return _mm256_add_epi64(a, b); }
+    static I subi(I a, I b) { return _mm256_sub_epi64(a, b); }
+    template <int N> static I shl(I a) { return _mm256_slli_epi64(a, N); }
+};
+#else
+struct SimdOps
+{
+    typedef __m128d V;
+    typedef __m128i I;
+    static const size_t width = 2;
+
+    static V load(const double* p) { return _mm_loadu_pd(p); }
+    static void store(double* p, V v) { _mm_storeu_pd(p, v); }
+    static V set1(double d) { return _mm_set1_pd(d); }
+    static V add(V a, V b) { return _mm_add_pd(a, b); }
+    static V sub(V a, V b) { return _mm_sub_pd(a, b); }
+    static V mul(V a, V b) { return _mm_mul_pd(a, b); }
+    static V div(V a, V b) { return _mm_div_pd(a, b); }
+    static V sqrt(V a) { return _mm_sqrt_pd(a); }
+    static V min(V a, V b) { return _mm_min_pd(a, b); }
+    static V max(V a, V b) { return _mm_max_pd(a, b); }
+    static V and_(V a, V b) { return _mm_and_pd(a, b); }
+    static V andNot(V a, V b) { return _mm_andnot_pd(a, b); }
+    static V or_(V a, V b) { return _mm_or_pd(a, b); }
+    static V xor_(V a, V b) { return _mm_xor_pd(a, b); }
+    static V lt(V a, V b) { return _mm_cmplt_pd(a, b); }
+    static V gt(V a, V b) { return _mm_cmpgt_pd(a, b); }
+    static V ge(V a, V b) { return _mm_cmpge_pd(a, b); }
+    static V eq(V a, V b) { return _mm_cmpeq_pd(a, b); }
+    static I bits(V a) { return _mm_castpd_si128(a); }
+    static V fromBits(I a) { return _mm_castsi128_pd(a); }
+    static I set1i(long long i) { return _mm_set1_epi64x(i); }
+    static I andi(I a, I b) { return _mm_and_si128(a, b); }
+    static I addi(I a, I b) { return _mm_add_epi64(a, b); }
+    static I subi(I a, I b) { return _mm_sub_epi64(a, b); }
+    template <int N> static I shl(I a) { return _mm_slli_epi64(a, N); }
+};
+#endif
+
+// Lanes of a where mask is set, of b elsewhere
+inline SimdOps::V simdSelect(SimdOps::V mask, SimdOps::V a, SimdOps::V b)
+{
+    return SimdOps::or_(SimdOps::and_(mask, a), SimdOps::andNot(mask, b));
+}
+
+#endif
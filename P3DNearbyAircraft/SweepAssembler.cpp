@@ -0,0 +1,132 @@
+#include <string.h>
+
+#include "SweepAssembler.h"
+
+SweepAssembler::SweepAssembler()
+    : timeoutSeconds(1)
+    , m_incomplete(0)
+    , m_dropped(0)
+{
+}
+
+bool SweepAssembler::add(const DecodedMessage& message, double (*clock)())
+{
+    // A record with no sweep numbering is a sweep of its own
+    uint32_t outOf = message.outOf;
+    uint32_t entry = message.entryNumber;
+    if (outOf == 0 || entry == 0)
+        outOf = entry = 1;
+    if (entry > outOf || outOf > MAX_ENTRIES)  // security check: outOf sizes the buffers
+    {
+        m_dropped++;
+        return !m_ready.empty();
+    }
+
+    size_t index = 0;
+    while (index < m_open.size() && m_open[index]->requestId != message.requestId)
+        index++;
+    if (index < m_open.size())
+    {
+        AssembledSweep& sweep = *m_open[index];
+        if (sweep.outOf != outOf || (entry == 1 && sweep.seen[0]))
+        {
+            // The request has moved on to its next sweep without finishing this one
+            close(index, false);
+            index = m_open.size();
+        }
+        else if (sweep.seen[entry - 1])
+        {
+            m_dropped++;
+            return !m_ready.empty();
+        }
+    }
+    if (index == m_open.size())
+        open(message.requestId, outOf, clock());
+
+    AssembledSweep& sweep = *m_open[index];
+    sweep.seen[entry - 1] = 1;
+    sweep.entries.push_back(message);
+    if (message.title != NULL)
+    {
+        // The message buffer is reused once this returns, so keep a copy. There are at most outOf titles and
+        // the first reserves room for all of them, so the pointers into titles stay valid.
+        if (sweep.titles.empty())
+            sweep.titles.reserve(outOf);
+        sweep.titles.emplace_back();
+        memcpy(sweep.titles.back().title, message.title, sizeof(AircraftTitle::title));
+        sweep.entries.back().title = sweep.titles.back().title;
+    }
+
+    if (++m_received[index] == outOf)
+        close(index, true);
+    return !m_ready.empty();
+}
+
+bool SweepAssembler::expire(double now)
+{
+    for (size_t index = m_open.size(); index-- > 0; )
+    {
+        if (now - m_open[index]->openedAt >= timeoutSeconds)
+            close(index, false);
+    }
+    return !m_ready.empty();
+}
+
+bool SweepAssembler::closeAll()
+{
+    while (!m_open.empty())
+        close(0, false);
+    return !m_ready.empty();
+}
+
+AssembledSweep* SweepAssembler::nextReady()
+{
+    return m_ready.empty() ? NULL : m_ready.front();
+}
+
+void SweepAssembler::release(AssembledSweep* sweep)
+{
+    for (size_t i = 0; i < m_ready.size(); i++)
+    {
+        if (m_ready[i] == sweep)
+        {
+            m_ready.erase(m_ready.begin() + i);
+            m_free.push_back(sweep);
+            return;
+        }
+    }
+}
+
+AssembledSweep* SweepAssembler::open(uint32_t requestId, uint32_t outOf, double openedAt)
+{
+    if (m_free.empty())
+    {
+        m_pool.emplace_back(new AssembledSweep());
+        m_free.push_back(m_pool.back().get());
+    }
+    AssembledSweep* sweep = m_free.back();
+    m_free.pop_back();
+
+    sweep->requestId = requestId;
+    sweep->outOf = outOf;
+    sweep->openedAt = openedAt;
+    sweep->complete = false;
+    sweep->entries.clear();
+    sweep->entries.reserve(outOf);
+    sweep->titles.clear();
+    sweep->seen.assign(outOf, 0);
+    m_open.push_back(sweep);
+    m_received.push_back(0);
+    return sweep;
+}
+
+void SweepAssembler::close(size_t openIndex, bool complete)
+{
+    AssembledSweep* sweep = m_open[openIndex];
+    sweep->complete = complete;
+    if (!complete)
+        m_incomplete++;
+    m_open.erase(m_open.begin() + openIndex);
+    m_received.erase(m_received.begin() + openIndex);
+    m_ready.push_back(sweep);
+}
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <memory>
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+#include "AircraftInfo.h"
+#include "DecodedMessage.h"
+
+/**
+* One wide sweep, collected from the SIMOBJECT_DATA_BYTYPE messages of a request. Entries are in the order
+* they arrived, each entry number at most once.
+*/
+struct AssembledSweep
+{
+    uint32_t requestId;
+    uint32_t outOf;
+    double openedAt;                        // clock() when its first entry arrived
+    bool complete;                          // false when it was closed by the timeout or a newer sweep
+    std::vector<DecodedMessage> entries;
+    std::vector<AircraftTitle> titles;      // copies of the combined definition's titles, which entries point into
+    std::vector<uint8_t> seen;              // by entry number - 1
+};
+
+/**
+* Collects the entries of each sweep until all outOf of them are in, so the pipeline can process a sweep
+* in one pass and report it as one consistent picture rather than a trickle of partial updates.
+*
+* A sweep closes when its last missing entry arrives. One that is still short after timeoutSeconds, or
+* whose request starts a new sweep (entry 1 again, or a different outOf), closes incomplete with what it
+* has. Sweeps of different request IDs are collected side by side. Duplicate entries, entry numbers
+* beyond outOf and sweeps claiming more than MAX_ENTRIES are dropped and counted.
+*
+* The buffers are pooled: a sweep's storage goes back to the pool at release(), and after the first few
+* sweeps collecting another allocates nothing.
+*/
+class SweepAssembler
+{
+public:
+    static const uint32_t MAX_ENTRIES = 1 << 20;
+
+    SweepAssembler();
+
+    // Add one DECODED_SWEEP message; clock is read when it opens a sweep. Returns true when a sweep is ready.
+    bool add(const DecodedMessage& message, double (*clock)());
+
+    // Close the sweeps open longer than timeoutSeconds at now. Returns true when a sweep is ready.
+    bool expire(double now);
+
+    // Close every open sweep, complete or not (end of a recording). Returns true when a sweep is ready.
+    bool closeAll();
+
+    // The oldest closed sweep, or NULL. It stays valid, and may be modified, until release().
+    AssembledSweep* nextReady();
+    void release(AssembledSweep* sweep);
+
+    size_t openSweeps() const { return m_open.size(); }
+    uint64_t incomplete() const { return m_incomplete; }
+    uint64_t dropped() const { return m_dropped; }
+
+    double timeoutSeconds;
+
+private:
+    AssembledSweep* open(uint32_t requestId, uint32_t outOf, double openedAt);
+    void close(size_t openIndex, bool complete);
+
+    std::vector<std::unique_ptr<AssembledSweep>> m_pool;
+    std::vector<AssembledSweep*> m_free;
+    std::vector<AssembledSweep*> m_open;
+    std::vector<AssembledSweep*> m_ready;   // oldest first
+    std::vector<uint32_t> m_received;       // distinct entries of each m_open sweep
+    uint64_t m_incomplete;
+    uint64_t m_dropped;
+};
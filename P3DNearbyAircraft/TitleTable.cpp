@@ -0,0 +1,20 @@
+#include "TitleTable.h"
+
+TitleTable::TitleTable()
+{
+    m_titles.emplace_back();
+    m_ids.emplace(std::string(), TITLE_UNKNOWN);
+}
+
+uint32_t TitleTable::intern(const char* title, size_t length)
+{
+    std::string key(title, length);
+    auto found = m_ids.find(key);
+    if (found != m_ids.end())
+        return found->second;
+
+    uint32_t id = (uint32_t)m_titles.size();
+    m_titles.push_back(key);
+    m_ids.emplace(std::move(key), id);
+    return id;
+}
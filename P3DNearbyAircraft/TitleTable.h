@@ -0,0 +1,32 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/**
+* Interned aircraft titles.
+*
+* Each distinct title is stored once and named by a small integer, so the traffic table keeps a 4-byte ID
+* per aircraft instead of a string, and a sweep never carries or copies a title. IDs are never reused;
+* TITLE_UNKNOWN is the empty title of an aircraft whose title has not arrived yet.
+*/
+class TitleTable
+{
+public:
+    static constexpr uint32_t TITLE_UNKNOWN = 0;
+
+    TitleTable();
+
+    // The ID of title, adding it on first sight
+    uint32_t intern(const char* title, size_t length);
+
+    const std::string& title(uint32_t id) const { return id < m_titles.size() ? m_titles[id] : m_titles[TITLE_UNKNOWN]; }
+    size_t size() const { return m_titles.size(); }
+
+private:
+    std::vector<std::string> m_titles;
+    std::unordered_map<std::string, uint32_t> m_ids;
+};
@@ -0,0 +1,298 @@
+#include <math.h>
+#include <string.h>
+
+#include "TrafficAggregator.h"
+#include "DecodedMessage.h"
+#include "LatencyHistogram.h"
+#include "Utilities.h"
+
+static double aggregatorClock()
+{
+    return monotonicNs() / 1e9;
+}
+
+// Entries match on title and ATC ID together; a missing ATC ID leaves just the title and the position
+static std::string identityKey(const AircraftIdentity& identity)
+{
+    std::string key(identity.title, strnlen(identity.title, sizeof(identity.title)));
+    key += '\n';
+    key.append(identity.atcId, strnlen(identity.atcId, sizeof(identity.atcId)));
+    return key;
+}
+
+static void take(std::vector<uint32_t>& ids, uint32_t id)
+{
+    for (size_t i = 0; i < ids.size(); i++)
+    {
+        if (ids[i] == id)
+        {
+            ids[i] = ids.back();
+            ids.pop_back();
+            return;
+        }
+    }
+}
+
+TrafficAggregator::TrafficAggregator(const AggregatorSettings& settings)
+    : clock(aggregatorClock)
+    , m_settings(settings)
+    , m_stopping(false)
+    , m_nextId(1)
+    , m_matched(0)
+{
+}
+
+TrafficAggregator::~TrafficAggregator()
+{
+    stop();
+}
+
+int TrafficAggregator::addSource(TrafficSource& source)
+{
+    if (m_sources.size() >= AGGREGATOR_MAX_SOURCES)
+        return -1;
+
+    std::unique_ptr<Source> added(new Source());
+    added->source = &source;
+    added->pollTime = 0;
+    added->messages = 0;
+    added->stats = SourceStats();
+    m_sources.push_back(std::move(added));
+    return (int)m_sources.size() - 1;
+}
+
+void TrafficAggregator::start()
+{
+    m_stopping.store(false);
+    for (std::unique_ptr<Source>& source : m_sources)
+    {
+        if (!source->thread.joinable())
+            source->thread = std::thread(&TrafficAggregator::receiveLoop, this, std::ref(*source));
+    }
+}
+
+void TrafficAggregator::stop()
+{
+    m_stopping.store(true, std::memory_order_release);
+    for (std::unique_ptr<Source>& source : m_sources)
+    {
+        if (source->thread.joinable())
+            source->thread.join();
+    }
+}
+
+void TrafficAggregator::onSourceMessage(const void* data, uint32_t size, void* context)
+{
+    Source& source = *(Source*)context;
+    source.messages++;
+
+    DecodedMessage message;
+    if (!decodeTrafficMessage(data, size, message))
+        return;
+
+    if (message.kind == DECODED_SWEEP || (message.kind == DECODED_TRACKED && message.fields == STATE_ALL_FIELDS))
+    {
+        StateRecord record = { message.objectId, message.state, source.pollTime };
+        source.states.push_back(record);
+        if (source.requested.insert(message.objectId).second)
+            source.unidentified.push_back(message.objectId);
+    }
+    else if (message.kind == DECODED_IDENTITY)
+    {
+        source.identities.emplace_back();
+        IdentityRecord& record = source.identities.back();
+        record.objectId = message.objectId;
+        memcpy(record.identity.title, message.title, sizeof(record.identity.title));
+        memcpy(record.identity.atcId, message.atcId, sizeof(record.identity.atcId));
+        record.identity.title[sizeof(record.identity.title) - 1] = '\0';    // security check: the simulator's strings go into keys
+        record.identity.atcId[sizeof(record.identity.atcId) - 1] = '\0';
+    }
+}
+
+void TrafficAggregator::receiveLoop(Source& source)
+{
+    while (!m_stopping.load(std::memory_order_acquire))
+    {
+        source.pollTime = clock();
+        bool open = source.source->poll(m_settings.pollMs, onSourceMessage, &source);
+
+        // Asked for here rather than inside poll(), where the source is still handing out messages
+        for (uint32_t objectId : source.unidentified)
+            source.source->requestIdentity(objectId);
+        source.unidentified.clear();
+
+        {
+            std::lock_guard<std::mutex> lock(source.mutex);
+            source.stats.polls++;
+            source.stats.messages += source.messages;
+            size_t room = m_settings.maxPending > source.pendingStates.size() ? m_settings.maxPending - source.pendingStates.size() : 0;
+            if (source.states.size() > room)
+            {
+                source.stats.dropped += source.states.size() - room;
+                source.states.resize(room);
+            }
+            source.stats.records += source.states.size();
+            source.stats.identities += source.identities.size();
+            if (source.pendingStates.empty())
+                source.pendingStates.swap(source.states);
+            else
+                source.pendingStates.insert(source.pendingStates.end(), source.states.begin(), source.states.end());
+            source.pendingIdentities.insert(source.pendingIdentities.end(), source.identities.begin(), source.identities.end());
+            source.stats.closed = !open;
+        }
+        source.states.clear();
+        source.identities.clear();
+        source.messages = 0;
+        if (!open)
+            return;
+    }
+}
+
+size_t TrafficAggregator::entryIndex(uint32_t id) const
+{
+    return m_entryIndex.find(id)->second;
+}
+
+void TrafficAggregator::join(size_t source, uint32_t objectId, SourceAircraft& aircraft)
+{
+    uint64_t bit = 1ull << source;
+    std::vector<uint32_t>& candidates = m_byIdentity[identityKey(aircraft.identity)];
+    for (uint32_t id : candidates)
+    {
+        AggregatedAircraft& entry = m_aircraft[entryIndex(id)];
+        if ((entry.sources & bit) != 0)
+            continue;
+        if (distance(entry.state.latitude, entry.state.longitude, aircraft.state.latitude, aircraft.state.longitude, MATH_FAST) > m_settings.matchNm ||
+            fabs(entry.state.altitude - aircraft.state.altitude) > m_settings.matchFt)
+            continue;
+
+        entry.sources |= bit;
+        aircraft.entryId = id;
+        m_matched++;
+        if (aircraft.time >= entry.time)
+        {
+            entry.state = aircraft.state;
+            entry.time = aircraft.time;
+            entry.reportedBy = (uint32_t)source;
+            entry.objectId = objectId;
+        }
+        return;
+    }
+
+    AggregatedAircraft entry = {};
+    entry.id = m_nextId++;
+    entry.sources = bit;
+    entry.reportedBy = (uint32_t)source;
+    entry.objectId = objectId;
+    entry.state = aircraft.state;
+    entry.time = aircraft.time;
+    entry.identity = aircraft.identity;
+    m_entryIndex[entry.id] = m_aircraft.size();
+    m_aircraft.push_back(entry);
+    candidates.push_back(entry.id);
+    aircraft.entryId = entry.id;
+}
+
+void TrafficAggregator::leave(size_t source, SourceAircraft& aircraft)
+{
+    size_t index = entryIndex(aircraft.entryId);
+    aircraft.entryId = 0;
+    AggregatedAircraft& entry = m_aircraft[index];
+    entry.sources &= ~(1ull << source);
+    if (entry.sources != 0)
+        return;
+
+    // Nobody reports it any more
+    auto candidates = m_byIdentity.find(identityKey(entry.identity));
+    take(candidates->second, entry.id);
+    if (candidates->second.empty())
+        m_byIdentity.erase(candidates);
+    m_entryIndex.erase(entry.id);
+    if (index != m_aircraft.size() - 1)
+    {
+        m_aircraft[index] = m_aircraft.back();
+        m_entryIndex[m_aircraft[index].id] = index;
+    }
+    m_aircraft.pop_back();
+}
+
+size_t TrafficAggregator::merge(double now)
+{
+    size_t merged = 0;
+    for (size_t i = 0; i < m_sources.size(); i++)
+    {
+        Source& source = *m_sources[i];
+        bool closed;
+        {
+            std::lock_guard<std::mutex> lock(source.mutex);
+            source.takenStates.clear();
+            source.takenIdentities.clear();
+            source.takenStates.swap(source.pendingStates);
+            source.takenIdentities.swap(source.pendingIdentities);
+            closed = source.stats.closed;
+        }
+
+        for (const IdentityRecord& record : source.takenIdentities)
+        {
+            SourceAircraft& aircraft = source.aircraft[record.objectId];
+            aircraft.identity = record.identity;
+            aircraft.hasIdentity = true;
+            if (aircraft.hasState && aircraft.entryId == 0)
+                join(i, record.objectId, aircraft);
+        }
+
+        for (const StateRecord& record : source.takenStates)
+        {
+            SourceAircraft& aircraft = source.aircraft[record.objectId];
+            aircraft.state = record.state;
+            aircraft.time = record.time;
+            aircraft.hasState = true;
+            if (aircraft.entryId == 0)
+            {
+                if (aircraft.hasIdentity)
+                    join(i, record.objectId, aircraft);
+                continue;
+            }
+
+            AggregatedAircraft& entry = m_aircraft[entryIndex(aircraft.entryId)];
+            if (record.time >= entry.time)
+            {
+                entry.state = record.state;
+                entry.time = record.time;
+                entry.reportedBy = (uint32_t)i;
+                entry.objectId = record.objectId;
+            }
+        }
+        merged += source.takenStates.size() + source.takenIdentities.size();
+
+        // A stale aircraft keeps its identity, which is only asked for once, in case it comes back into range
+        size_t joined = 0;
+        for (auto it = source.aircraft.begin(); it != source.aircraft.end(); )
+        {
+            SourceAircraft& aircraft = it->second;
+            if (aircraft.entryId != 0 && (closed || now - aircraft.time > m_settings.staleSeconds))
+            {
+                leave(i, aircraft);
+                aircraft.hasState = false;
+            }
+            if (closed)
+            {
+                it = source.aircraft.erase(it);
+                continue;
+            }
+            if (aircraft.entryId != 0)
+                joined++;
+            ++it;
+        }
+
+        std::lock_guard<std::mutex> lock(source.mutex);
+        source.stats.aircraft = joined;
+    }
+    return merged;
+}
+
+SourceStats TrafficAggregator::sourceStats(size_t source) const
+{
+    std::lock_guard<std::mutex> lock(m_sources[source]->mutex);
+    return m_sources[source]->stats;
+}
@@ -0,0 +1,175 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "AircraftInfo.h"
+#include "ReceiveEngine.h"
+
+/**
+* One simulator feeding a TrafficAggregator. Both calls are made only from the source's own receive thread,
+* so a source may keep a SimConnect connection that nothing else touches.
+*/
+class TrafficSource
+{
+public:
+    virtual ~TrafficSource() {}
+
+    // Make whatever requests are due, wait up to timeoutMs for traffic and hand every message to handler.
+    // Returns false once the simulator has gone; the source is not polled again.
+    virtual bool poll(uint32_t timeoutMs, MessageHandler handler, void* context) = 0;
+
+    // Ask once for the AircraftIdentity of objectId; the answer arrives through poll()
+    virtual void requestIdentity(uint32_t objectId) = 0;
+};
+
+constexpr size_t AGGREGATOR_MAX_SOURCES = 64;   // one bit each in AggregatedAircraft::sources
+
+/**
+* Knobs for TrafficAggregator.
+*/
+struct AggregatorSettings
+{
+    uint32_t pollMs;            // longest a receive thread waits in poll() before checking for stop()
+    double matchNm;             // an aircraft of one simulator is another's only within this range...
+    double matchFt;             // ...and this height of it
+    double staleSeconds;        // a source's aircraft leaves the table once not reported for this long
+    size_t maxPending;          // records a source may queue between merges; more are dropped
+};
+
+constexpr AggregatorSettings DEFAULT_AGGREGATOR_SETTINGS = { 50, 1.0, 500, 10, 1 << 16 };
+
+/**
+* One aircraft of the merged table, however many simulators report it.
+*/
+struct AggregatedAircraft
+{
+    uint32_t id;                // the aggregator's own number; ObjectIDs only mean something to one simulator
+    uint64_t sources;           // bit n: source n reports it
+    uint32_t reportedBy;        // the source whose report state is
+    uint32_t objectId;          // ...and its ObjectID there
+    AircraftState state;        // the newest report from any source
+    double time;                // when that report arrived
+    AircraftIdentity identity;
+};
+
+struct SourceStats
+{
+    uint64_t messages;          // everything poll() delivered
+    uint64_t records;           // aircraft states queued for the merge
+    uint64_t identities;        // identity answers queued
+    uint64_t dropped;           // records over maxPending
+    uint64_t polls;
+    size_t aircraft;            // the source's aircraft in the table, at the last merge
+    bool closed;
+};
+
+/**
+* Traffic from several simulators at once, merged into one table.
+*
+* Each source has its own receive thread, which decodes what poll() delivers and queues the records under
+* that source's own lock. merge() takes each queue whole (the lock is held only to swap vectors) and folds
+* the records into the table, so a source that is slow or stuck only holds back its own aircraft: the merge
+* never waits for it, and the other receive threads never see it.
+*
+* The same aircraft has a different ObjectID on every simulator. A source's aircraft joins the table once its
+* identity (title and ATC ID) and a position are known: an entry with the same identity that the source does
+* not report yet, within matchNm and matchFt, is the same aircraft; otherwise it starts a new entry.
+*
+* addSource() and start() before the threads run, then merge() and the readers from one thread.
+*/
+class TrafficAggregator
+{
+public:
+    TrafficAggregator(const AggregatorSettings& settings = DEFAULT_AGGREGATOR_SETTINGS);
+    ~TrafficAggregator();
+
+    // The source must outlive the aggregator. Returns its index (the bit in AggregatedAircraft::sources), or -1 when full.
+    int addSource(TrafficSource& source);
+
+    void start();
+    void stop();
+
+    // Fold in everything the sources queued since the last merge and retire aircraft stale at now. Returns the records merged.
+    size_t merge(double now);
+
+    const std::vector<AggregatedAircraft>& aircraft() const { return m_aircraft; }
+    size_t sourceCount() const { return m_sources.size(); }
+    SourceStats sourceStats(size_t source) const;
+    uint64_t matched() const { return m_matched; }      // source aircraft that joined an entry another source already had
+
+    double (*clock)();          // stamps records on the receive threads; the scale of merge()'s now
+
+private:
+    struct StateRecord
+    {
+        uint32_t objectId;
+        AircraftState state;
+        double time;
+    };
+
+    struct IdentityRecord
+    {
+        uint32_t objectId;
+        AircraftIdentity identity;
+    };
+
+    // What one source reports about one of its aircraft; merge thread only
+    struct SourceAircraft
+    {
+        AircraftState state;
+        double time;
+        bool hasState;
+        bool hasIdentity;
+        AircraftIdentity identity;
+        uint32_t entryId;       // AggregatedAircraft::id once joined, 0 before
+    };
+
+    struct Source
+    {
+        TrafficSource* source;
+        std::thread thread;
+
+        // Receive thread only
+        double pollTime;                            // stamps this poll's records
+        uint64_t messages;
+        std::unordered_set<uint32_t> requested;     // ObjectIDs whose identity was asked for
+        std::vector<uint32_t> unidentified;         // ...of which first seen in this poll
+        std::vector<StateRecord> states;            // this poll's records, queued when it returns
+        std::vector<IdentityRecord> identities;
+
+        // Under mutex
+        mutable std::mutex mutex;
+        std::vector<StateRecord> pendingStates;
+        std::vector<IdentityRecord> pendingIdentities;
+        SourceStats stats;
+
+        // Merge thread only
+        std::vector<StateRecord> takenStates;
+        std::vector<IdentityRecord> takenIdentities;
+        std::unordered_map<uint32_t, SourceAircraft> aircraft;
+    };
+
+    static void onSourceMessage(const void* data, uint32_t size, void* context);
+    void receiveLoop(Source& source);
+    void join(size_t source, uint32_t objectId, SourceAircraft& aircraft);
+    void leave(size_t source, SourceAircraft& aircraft);
+    size_t entryIndex(uint32_t id) const;
+
+    AggregatorSettings m_settings;
+    std::vector<std::unique_ptr<Source>> m_sources;
+    std::atomic<bool> m_stopping;
+    std::vector<AggregatedAircraft> m_aircraft;
+    std::unordered_map<uint32_t, size_t> m_entryIndex;                  // AggregatedAircraft::id to its place in m_aircraft
+    std::unordered_map<std::string, std::vector<uint32_t>> m_byIdentity; // title and ATC ID to the entries that have them
+    uint32_t m_nextId;
+    uint64_t m_matched;
+};
@@ -0,0 +1,222 @@
+#include <string.h>
+#include <utility>
+
+#include "DeadReckoning.h"
+#include "TrafficClient.h"
+#include "TrafficMessage.h"
+
+TrafficClient::TrafficClient(RequestSink& sink)
+    : clock(trafficClockSeconds)
+    , maxInFlight(4096)
+    , m_sink(sink)
+    , m_nextRequestId(FIRST_REQUEST_ID)
+    , m_stats()
+{
+}
+
+RequestHandle TrafficClient::add(const Request& request)
+{
+    if (m_requests.size() >= maxInFlight || m_nextRequestId == 0)
+    {
+        m_stats.refused++;
+        return 0;
+    }
+    RequestHandle handle = m_nextRequestId++;
+    m_requests[handle] = request;
+    m_stats.requests++;
+    return handle;
+}
+
+RequestHandle TrafficClient::sendSweep(const Request& request, uint32_t radiusMeters, uint32_t objectType)
+{
+    RequestHandle handle = add(request);
+    if (handle != 0 && !m_sink.requestByType(handle, request.defineId, radiusMeters, objectType))
+    {
+        m_requests.erase(handle);
+        m_stats.refused++;
+        return 0;
+    }
+    return handle;
+}
+
+RequestHandle TrafficClient::sendSubscription(const Request& request, uint32_t flags, uint32_t interval)
+{
+    RequestHandle handle = add(request);
+    if (handle != 0 && !m_sink.requestOnObject(handle, request.defineId, request.objectId, request.period, flags, interval))
+    {
+        m_requests.erase(handle);
+        m_stats.refused++;
+        return 0;
+    }
+    return handle;
+}
+
+RequestHandle TrafficClient::requestByType(uint32_t defineId, uint32_t radiusMeters, uint32_t objectType, SweepHandler handler, void* context)
+{
+    Request request = {};
+    request.defineId = defineId;
+    request.onSweep = handler;
+    request.context = context;
+    return sendSweep(request, radiusMeters, objectType);
+}
+
+RequestHandle TrafficClient::subscribe(uint32_t defineId, uint32_t objectId, uint32_t period, uint32_t flags, uint32_t interval,
+    UpdateHandler handler, void* context)
+{
+    Request request = {};
+    request.defineId = defineId;
+    request.objectId = objectId;
+    request.period = period;
+    request.onUpdate = handler;
+    request.context = context;
+    return sendSubscription(request, flags, interval);
+}
+
+RequestHandle TrafficClient::await(SweepAwaitable& waiter)
+{
+    Request request = {};
+    request.defineId = waiter.m_defineId;
+    request.sweepWaiter = &waiter;
+    return sendSweep(request, waiter.m_target, waiter.m_objectType);
+}
+
+RequestHandle TrafficClient::await(UpdateAwaitable& waiter)
+{
+    Request request = {};
+    request.defineId = waiter.m_defineId;
+    request.objectId = waiter.m_target;
+    request.period = TRAFFIC_PERIOD_ONCE;
+    request.updateWaiter = &waiter;
+    return sendSubscription(request, 0, 0);
+}
+
+bool TrafficClient::cancel(RequestHandle handle)
+{
+    auto found = m_requests.find(handle);
+    if (found == m_requests.end())
+        return false;
+
+    // A sweep cannot be called back; whatever still arrives for it is late
+    const Request& request = found->second;
+    if (request.onUpdate && request.period != TRAFFIC_PERIOD_ONCE)
+        m_sink.requestOnObject(handle, request.defineId, request.objectId, TRAFFIC_PERIOD_NEVER, 0, 0);
+    m_requests.erase(found);
+    return true;
+}
+
+bool TrafficClient::onMessage(const void* data, uint32_t size)
+{
+    TrafficMessageHeader header;
+    if (size < sizeof(header))
+        return false;
+    memcpy(&header, data, sizeof(header));
+    if (header.id != TRAFFIC_RECV_ID_SIMOBJECT_DATA && header.id != TRAFFIC_RECV_ID_SIMOBJECT_DATA_BYTYPE)
+        return false;
+    if (header.requestId < FIRST_REQUEST_ID)
+        return false;
+
+    auto found = m_requests.find(header.requestId);
+    if (found == m_requests.end())
+    {
+        m_stats.late++;
+        return true;
+    }
+    DecodedMessage message;
+    if (!decodeTrafficMessage(data, size, message))
+    {
+        m_stats.malformed++;
+        return true;
+    }
+
+    if (found->second.onSweep || found->second.sweepWaiter)
+    {
+        if (message.kind == DECODED_SWEEP)
+            m_sweeps.add(message, clock);
+        return true;
+    }
+
+    // The message buffer is reused once this returns, so the queue keeps its own copy of a title or ATC ID
+    m_updates.emplace_back();
+    ObjectUpdate& update = m_updates.back();
+    update.message = message;
+    if (message.title != NULL)
+    {
+        memcpy(update.names.title, message.title, sizeof(update.names.title));
+        update.message.title = NULL;
+    }
+    if (message.atcId != NULL)
+    {
+        memcpy(update.names.atcId, message.atcId, sizeof(update.names.atcId));
+        update.message.atcId = NULL;
+    }
+    return true;
+}
+
+size_t TrafficClient::runReady(double now)
+{
+    size_t ran = 0;
+    m_sweeps.expire(now);
+    while (AssembledSweep* sweep = m_sweeps.nextReady())
+    {
+        // One sweep per request: the request ends with its handler or coroutine
+        auto found = m_requests.find(sweep->requestId);
+        if (found != m_requests.end())
+        {
+            Request request = found->second;
+            m_requests.erase(found);
+            m_stats.sweeps++;
+            if (!sweep->complete)
+                m_stats.incomplete++;
+            ran++;
+            if (request.sweepWaiter)
+            {
+                // The coroutine keeps the sweep, so it takes the pooled one's buffers (the titles keep their
+                // addresses) and leaves its own empty ones in the pool
+                SweepAwaitable& waiter = *request.sweepWaiter;
+                std::swap(waiter.m_result, *sweep);
+                m_sweeps.release(sweep);
+                waiter.m_done = true;
+                waiter.m_waiter.resume();
+                continue;
+            }
+            request.onSweep(sweep->requestId, *sweep, request.context);
+        }
+        else
+        {
+            m_stats.late++;
+        }
+        m_sweeps.release(sweep);
+    }
+
+    // Handlers and coroutines may subscribe and cancel, but cannot queue updates: only onMessage() does
+    m_running.clear();
+    m_running.swap(m_updates);
+    for (ObjectUpdate& update : m_running)
+    {
+        auto found = m_requests.find(update.message.requestId);
+        if (found == m_requests.end())
+        {
+            m_stats.late++;
+            continue;
+        }
+        Request request = found->second;
+        if (request.period == TRAFFIC_PERIOD_ONCE)
+            m_requests.erase(found);
+        m_stats.updates++;
+        ran++;
+        if (request.updateWaiter)
+        {
+            UpdateAwaitable& waiter = *request.updateWaiter;
+            waiter.m_result = update;
+            waiter.m_done = true;
+            waiter.m_waiter.resume();
+            continue;
+        }
+        if (update.message.kind == DECODED_TITLE || update.message.kind == DECODED_IDENTITY)
+            update.message.title = update.names.title;
+        if (update.message.kind == DECODED_IDENTITY)
+            update.message.atcId = update.names.atcId;
+        request.onUpdate(update.message.requestId, update.message, request.context);
+    }
+    return ran;
+}
@@ -0,0 +1,223 @@
+#pragma once
+
+#include <coroutine>
+#include <stddef.h>
+#include <stdint.h>
+#include <unordered_map>
+#include <vector>
+
+#include "AircraftInfo.h"
+#include "DecodedMessage.h"
+#include "SweepAssembler.h"
+#include "TrafficMessage.h"
+
+/**
+* Where TrafficClient sends its requests. SimConnectRequests (SimConnectRequests.h) forwards them to a
+* connection; the benchmarks answer them from a fake simulator.
+*/
+class RequestSink
+{
+public:
+    virtual ~RequestSink() {}
+
+    // SimConnect_RequestDataOnSimObjectType; objectType is a TRAFFIC_OBJECT_TYPE_
+    virtual bool requestByType(uint32_t requestId, uint32_t defineId, uint32_t radiusMeters, uint32_t objectType) = 0;
+
+    // SimConnect_RequestDataOnSimObject; period is a TRAFFIC_PERIOD_, and TRAFFIC_PERIOD_NEVER ends the request
+    virtual bool requestOnObject(uint32_t requestId, uint32_t defineId, uint32_t objectId, uint32_t period, uint32_t flags, uint32_t interval) = 0;
+};
+
+typedef uint32_t RequestHandle;         // the request ID the client picked; 0 when a request could not be made
+
+// Runs once with the whole sweep. It stays valid only until the handler returns.
+typedef void (*SweepHandler)(RequestHandle handle, const AssembledSweep& sweep, void* context);
+
+// Runs for each update of a per-object request. A title or ATC ID in the message stays valid only until the handler returns.
+typedef void (*UpdateHandler)(RequestHandle handle, const DecodedMessage& message, void* context);
+
+/**
+* The definition each record type is requested under, for the awaitable requests. Only state records come in sweeps.
+*/
+template <typename Record> struct RecordDefinition;
+template <> struct RecordDefinition<AircraftInfo> { static constexpr uint32_t id = TRAFFIC_DEFINITION_COMBINED; static constexpr bool byType = true; };
+template <> struct RecordDefinition<AircraftState> { static constexpr uint32_t id = TRAFFIC_DEFINITION_STATE; static constexpr bool byType = true; };
+template <> struct RecordDefinition<PackedAircraftState> { static constexpr uint32_t id = TRAFFIC_DEFINITION_PACKED_STATE; static constexpr bool byType = true; };
+template <> struct RecordDefinition<AircraftTitle> { static constexpr uint32_t id = TRAFFIC_DEFINITION_TITLE; static constexpr bool byType = false; };
+template <> struct RecordDefinition<AircraftIdentity> { static constexpr uint32_t id = TRAFFIC_DEFINITION_IDENTITY; static constexpr bool byType = false; };
+
+/**
+* One per-object update with its own copy of the title and ATC ID, which outlives the message buffer.
+*/
+struct ObjectUpdate
+{
+    DecodedMessage message;     // title and atcId are NULL: they are in names
+    AircraftIdentity names;     // the message's title and ATC ID, when it has them
+};
+
+class TrafficClient;
+
+/**
+* The answer to one request, for a coroutine to co_await: TrafficClient::requestByType<Record>() resumes it with
+* the AssembledSweep, requestOnObject<Record>() with the ObjectUpdate. The request goes out at the co_await and
+* runReady() resumes the coroutine, on the dispatch thread, once the answer is in; a request the client could
+* not make does not suspend at all and gives a requestId of 0.
+*
+* The client holds the awaitable's address while it waits, so it can be neither copied nor moved. Destroying
+* it before the answer (with the coroutine suspended on it) cancels the request.
+*/
+template <typename Result>
+class RequestAwaitable
+{
+public:
+    RequestAwaitable(TrafficClient& client, uint32_t defineId, uint32_t target, uint32_t objectType)
+        : m_client(client)
+        , m_defineId(defineId)
+        , m_target(target)
+        , m_objectType(objectType)
+        , m_handle(0)
+        , m_done(false)
+        , m_result()
+    {
+    }
+    RequestAwaitable(const RequestAwaitable&) = delete;
+    RequestAwaitable& operator=(const RequestAwaitable&) = delete;
+    ~RequestAwaitable();
+
+    // The request ID, once awaited; 0 before, or when the request could not be made
+    RequestHandle handle() const { return m_handle; }
+
+    bool await_ready();
+    void await_suspend(std::coroutine_handle<> waiter) { m_waiter = waiter; }
+    Result await_resume() { return std::move(m_result); }
+
+private:
+    friend class TrafficClient;
+
+    TrafficClient& m_client;
+    uint32_t m_defineId;
+    uint32_t m_target;          // a sweep's radius in meters, an update's ObjectID
+    uint32_t m_objectType;      // sweeps
+    RequestHandle m_handle;
+    bool m_done;
+    std::coroutine_handle<> m_waiter;
+    Result m_result;
+};
+
+typedef RequestAwaitable<AssembledSweep> SweepAwaitable;
+typedef RequestAwaitable<ObjectUpdate> UpdateAwaitable;
+
+struct ClientStats
+{
+    uint64_t requests;          // made, both kinds
+    uint64_t sweeps;            // sweeps handed to a handler or an awaiting coroutine
+    uint64_t incomplete;        // ...of which with entries missing at the timeout
+    uint64_t updates;           // updates handed over
+    uint64_t late;              // messages for requests already completed or cancelled
+    uint64_t malformed;         // messages with one of the client's IDs that did not decode
+    uint64_t refused;           // requests the sink refused, or over maxInFlight
+};
+
+/**
+* Many requests in flight on one connection, each answered through its own handler instead of a switch on
+* the request ID. requestByType() and subscribe() pick an unused request ID and remember the handler;
+* onMessage(), called from the dispatch loop, claims every message carrying one of those IDs. A coroutine
+* can instead co_await requestByType<Record>() or requestOnObject<Record>() (RequestAwaitable) and carry on
+* with the answer where it left off.
+*
+* Nothing runs inside onMessage(): sweeps are assembled (SweepAssembler) and updates queued, and runReady()
+* runs the handlers and resumes the waiting coroutines afterwards on the same thread. That is the client's
+* whole executor, so handlers and coroutines never race each other or the dispatch loop, and they may make
+* or cancel requests themselves. Every call belongs on the dispatch thread.
+*
+* Request IDs count up from FIRST_REQUEST_ID and are never reused, so a message still in flight after its
+* request ended can only be counted as late, never handed to a newer request. One connection has 2^31 of them.
+*/
+class TrafficClient
+{
+public:
+    static const uint32_t FIRST_REQUEST_ID = 0x80000000;   // above every ID the client programs number themselves
+
+    TrafficClient(RequestSink& sink);
+
+    // One sweep of objectType within radiusMeters; handler runs once, with every entry or what came before the timeout
+    RequestHandle requestByType(uint32_t defineId, uint32_t radiusMeters, uint32_t objectType, SweepHandler handler, void* context);
+
+    // Data on one object, once or every period; handler runs for each update until the request ends (TRAFFIC_PERIOD_ONCE) or cancel()
+    RequestHandle subscribe(uint32_t defineId, uint32_t objectId, uint32_t period, uint32_t flags, uint32_t interval, UpdateHandler handler, void* context);
+
+    // The same sweep for a coroutine: co_await gives the AssembledSweep, which it then owns
+    template <typename Record>
+    SweepAwaitable requestByType(uint32_t radiusMeters, uint32_t objectType = TRAFFIC_OBJECT_TYPE_AIRCRAFT)
+    {
+        static_assert(RecordDefinition<Record>::byType, "only state records come in sweeps");
+        return SweepAwaitable(*this, RecordDefinition<Record>::id, radiusMeters, objectType);
+    }
+
+    // Data on one object once (TRAFFIC_PERIOD_ONCE), for a coroutine: co_await gives the ObjectUpdate
+    template <typename Record>
+    UpdateAwaitable requestOnObject(uint32_t objectId)
+    {
+        return UpdateAwaitable(*this, RecordDefinition<Record>::id, objectId, 0);
+    }
+
+    // Stop a request: no handler runs for it after this. A subscription also tells the simulator to stop sending.
+    bool cancel(RequestHandle handle);
+
+    // Offer one raw message. True when it belongs to this client, so nothing else needs to look at it.
+    bool onMessage(const void* data, uint32_t size);
+
+    // Close sweeps open for longer than the sweep timeout at now, then run every handler and resume every coroutine
+    // that is due. Returns the number of both.
+    size_t runReady(double now);
+
+    size_t inFlight() const { return m_requests.size(); }
+    const ClientStats& stats() const { return m_stats; }
+    void setSweepTimeout(double seconds) { m_sweeps.timeoutSeconds = seconds; }
+
+    double (*clock)();          // seconds, trafficClockSeconds unless set; when a sweep's first entry arrived, on the scale of runReady's now
+    size_t maxInFlight;
+
+private:
+    template <typename Result> friend class RequestAwaitable;
+
+    struct Request
+    {
+        uint32_t defineId;
+        uint32_t objectId;      // subscriptions
+        uint32_t period;
+        SweepHandler onSweep;   // exactly one of the handlers or waiters is set
+        UpdateHandler onUpdate;
+        void* context;
+        SweepAwaitable* sweepWaiter;
+        UpdateAwaitable* updateWaiter;
+    };
+
+    RequestHandle add(const Request& request);
+    RequestHandle sendSweep(const Request& request, uint32_t radiusMeters, uint32_t objectType);
+    RequestHandle sendSubscription(const Request& request, uint32_t flags, uint32_t interval);
+    RequestHandle await(SweepAwaitable& waiter);
+    RequestHandle await(UpdateAwaitable& waiter);
+
+    RequestSink& m_sink;
+    uint32_t m_nextRequestId;
+    std::unordered_map<uint32_t, Request> m_requests;
+    SweepAssembler m_sweeps;
+    std::vector<ObjectUpdate> m_updates;
+    std::vector<ObjectUpdate> m_running;    // m_updates, taken by runReady()
+    ClientStats m_stats;
+};
+
+template <typename Result>
+bool RequestAwaitable<Result>::await_ready()
+{
+    m_handle = m_client.await(*this);
+    m_done = m_handle == 0;
+    return m_done;
+}
+
+template <typename Result>
+RequestAwaitable<Result>::~RequestAwaitable()
+{
+    if (m_handle != 0 && !m_done)
+        m_client.cancel(m_handle);
+}
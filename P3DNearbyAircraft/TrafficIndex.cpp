@@ -0,0 +1,196 @@
+#include <algorithm>
+#include <math.h>
+#include <numeric>
+
+#include "TrafficIndex.h"
+#include "Geo.h"
+
+typedef geo::Geo<double, geo::Spherical> Sphere;
+
+static constexpr double NM_PER_DEGREE = geo::Spherical::radiusNm * geo::units::pi<double> / 180;
+
+TrafficIndex::TrafficIndex(double cellSizeNm)
+    : m_cellSizeNm(cellSizeNm)
+    , m_cellSizeDeg(cellSizeNm / NM_PER_DEGREE)
+    , m_rows((int)ceil(180 / m_cellSizeDeg))
+    , m_built(false)
+{
+}
+
+void TrafficIndex::clear()
+{
+    m_objectIds.clear();
+    m_latitudes.clear();
+    m_longitudes.clear();
+    m_altitudes.clear();
+    m_keys.clear();
+    m_cells.clear();
+    m_built = false;
+}
+
+void TrafficIndex::insert(uint32_t objectId, double lat, double lon, double altFt)
+{
+    m_objectIds.push_back(objectId);
+    m_latitudes.push_back(lat);
+    m_longitudes.push_back(lon);
+    m_altitudes.push_back(altFt);
+    m_built = false;
+}
+
+int TrafficIndex::rowOf(double lat) const
+{
+    int row = (int)floor((lat + 90) / m_cellSizeDeg);
+    return row < 0 ? 0 : (row >= m_rows ? m_rows - 1 : row);
+}
+
+int TrafficIndex::columnsIn(int row) const
+{
+    double centre = -90 + (row + 0.5) * m_cellSizeDeg;
+    int columns = (int)floor(360 * cos(geo::units::degToRad(centre)) / m_cellSizeDeg);
+    return columns < 1 ? 1 : columns;
+}
+
+int TrafficIndex::columnOf(int row, double lon) const
+{
+    int columns = columnsIn(row);
+    int column = (int)floor((lon + 180) * columns / 360);
+    return ((column % columns) + columns) % columns;
+}
+
+/**
+* Sort the aircraft by cell so each cell is one contiguous run of slots, then record where each run starts.
+*/
+void TrafficIndex::build()
+{
+    size_t count = m_objectIds.size();
+    m_keys.resize(count);
+    for (size_t i = 0; i < count; i++)
+    {
+        int row = rowOf(m_latitudes[i]);
+        m_keys[i] = cellKey(row, columnOf(row, m_longitudes[i]));
+    }
+
+    std::vector<uint32_t> order(count);
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [this](uint32_t a, uint32_t b) { return m_keys[a] < m_keys[b]; });
+
+    auto permute = [&order](auto& values) {
+        auto sorted = values;
+        for (size_t i = 0; i < order.size(); i++)
+            sorted[i] = values[order[i]];
+        values.swap(sorted);
+    };
+    permute(m_objectIds);
+    permute(m_latitudes);
+    permute(m_longitudes);
+    permute(m_altitudes);
+    permute(m_keys);
+
+    m_cells.clear();
+    for (size_t i = 0; i < count; )
+    {
+        size_t end = i + 1;
+        while (end < count && m_keys[end] == m_keys[i])
+            end++;
+        m_cells[m_keys[i]] = { (uint32_t)i, (uint32_t)end };
+        i = end;
+    }
+
+    m_built = true;
+}
+
+void TrafficIndex::search(double lat, double lon, double radiusNm, bool filterAltitude, double minAltFt, double maxAltFt, std::vector<TrafficNeighbor>& out) const
+{
+    out.clear();
+    if (!m_built || radiusNm < 0)
+        return;
+
+    double latSpan = radiusNm / NM_PER_DEGREE;
+    double latMin = lat - latSpan;
+    double latMax = lat + latSpan;
+
+    // Widest longitude offset of a circle of angular radius latSpan around lat; the whole row once it reaches a pole
+    double sinRadius = sin(geo::units::degToRad(fmin(latSpan, 90.0)));
+    double cosLat = cos(geo::units::degToRad(lat));
+    bool wholeRows = latMax >= 90 || latMin <= -90 || sinRadius >= cosLat;
+    double lonSpan = wholeRows ? 180 : geo::units::radToDeg(asin(sinRadius / cosLat));
+
+    int rowMin = rowOf(latMin);
+    int rowMax = rowOf(latMax);
+    for (int row = rowMin; row <= rowMax; row++)
+    {
+        int columns = columnsIn(row);
+        int first = 0;
+        int last = columns - 1;
+        if (!wholeRows)
+        {
+            first = (int)floor((lon - lonSpan + 180) * columns / 360);
+            last = (int)floor((lon + lonSpan + 180) * columns / 360);
+            if (last - first + 1 >= columns)
+            {
+                first = 0;
+                last = columns - 1;
+            }
+        }
+
+        for (int c = first; c <= last; c++)
+        {
+            int column = ((c % columns) + columns) % columns;
+            auto cell = m_cells.find(cellKey(row, column));
+            if (cell == m_cells.end())
+                continue;
+
+            for (uint32_t slot = cell->second.begin; slot < cell->second.end; slot++)
+            {
+                if (filterAltitude && (m_altitudes[slot] < minAltFt || m_altitudes[slot] > maxAltFt))
+                    continue;
+
+                double range = Sphere::distanceNm(lat, lon, m_latitudes[slot], m_longitudes[slot]);
+                if (range <= radiusNm)
+                    out.push_back({ m_objectIds[slot], slot, range });
+            }
+        }
+    }
+}
+
+void TrafficIndex::withinRadius(double lat, double lon, double radiusNm, std::vector<TrafficNeighbor>& out) const
+{
+    search(lat, lon, radiusNm, false, 0, 0, out);
+}
+
+void TrafficIndex::withinAltitudeBand(double lat, double lon, double radiusNm, double minAltFt, double maxAltFt, std::vector<TrafficNeighbor>& out) const
+{
+    search(lat, lon, radiusNm, true, minAltFt, maxAltFt, out);
+}
+
+/**
+* Grow the search radius from one cell until it holds at least k aircraft; everything closer than that
+* radius has then been seen, so the k smallest ranges found are the true k nearest.
+*/
+void TrafficIndex::nearest(double lat, double lon, size_t k, std::vector<TrafficNeighbor>& out) const
+{
+    out.clear();
+    if (!m_built || k == 0 || m_objectIds.empty())
+        return;
+
+    const double halfCircumferenceNm = NM_PER_DEGREE * 180;
+    double radiusNm = m_cellSizeNm;
+    for (;;)
+    {
+        search(lat, lon, radiusNm, false, 0, 0, out);
+        if (out.size() >= k || radiusNm >= halfCircumferenceNm)
+            break;
+        radiusNm *= 2;
+    }
+
+    auto closer = [](const TrafficNeighbor& a, const TrafficNeighbor& b) { return a.rangeNm < b.rangeNm; };
+    if (out.size() > k)
+    {
+        std::partial_sort(out.begin(), out.begin() + k, out.end(), closer);
+        out.resize(k);
+    }
+    else
+    {
+        std::sort(out.begin(), out.end(), closer);
+    }
+}
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <unordered_map>
+#include <vector>
+
+/**
+* One hit from a TrafficIndex query.
+*/
+struct TrafficNeighbor
+{
+    uint32_t objectId;
+    size_t slot;            // position in the index, valid until the next build()
+    double rangeNm;         // great-circle distance from the query point (altitude ignored)
+};
+
+/**
+* Lat/lon cell grid over the aircraft of one sweep.
+*
+* Rows are cellSizeNm tall; each row is split into as many longitude columns as fit cellSizeNm wide at its
+* centre latitude, so cells stay roughly square from the equator to the poles. Positions are sorted by cell
+* in build(), after which a query only visits the cells its radius overlaps and checks their aircraft exactly.
+*
+* Usage per sweep: clear(), insert() every aircraft, build(), then query as often as needed.
+*/
+class TrafficIndex
+{
+public:
+    explicit TrafficIndex(double cellSizeNm = 5);
+
+    void clear();
+    void insert(uint32_t objectId, double lat, double lon, double altFt);
+    void build();
+
+    size_t size() const { return m_objectIds.size(); }
+
+    // All aircraft within radiusNm of the point, in index order
+    void withinRadius(double lat, double lon, double radiusNm, std::vector<TrafficNeighbor>& out) const;
+
+    // Same as withinRadius() but only aircraft with minAltFt <= altitude <= maxAltFt
+    void withinAltitudeBand(double lat, double lon, double radiusNm, double minAltFt, double maxAltFt, std::vector<TrafficNeighbor>& out) const;
+
+    // The k closest aircraft to the point, nearest first
+    void nearest(double lat, double lon, size_t k, std::vector<TrafficNeighbor>& out) const;
+
+    uint32_t objectId(size_t slot) const { return m_objectIds[slot]; }
+    double latitude(size_t slot) const { return m_latitudes[slot]; }
+    double longitude(size_t slot) const { return m_longitudes[slot]; }
+    double altitude(size_t slot) const { return m_altitudes[slot]; }
+
+private:
+    struct CellRange
+    {
+        uint32_t begin;
+        uint32_t end;
+    };
+
+    int rowOf(double lat) const;
+    int columnsIn(int row) const;
+    int columnOf(int row, double lon) const;
+    static uint64_t cellKey(int row, int column) { return ((uint64_t)(uint32_t)row << 32) | (uint32_t)column; }
+
+    void search(double lat, double lon, double radiusNm, bool filterAltitude, double minAltFt, double maxAltFt, std::vector<TrafficNeighbor>& out) const;
+
+    double m_cellSizeNm;
+    double m_cellSizeDeg;
+    int m_rows;
+    bool m_built;
+
+    std::vector<uint32_t> m_objectIds;
+    std::vector<double> m_latitudes;
+    std::vector<double> m_longitudes;
+    std::vector<double> m_altitudes;
+    std::vector<uint64_t> m_keys;
+
+    std::unordered_map<uint64_t, CellRange> m_cells;
+};
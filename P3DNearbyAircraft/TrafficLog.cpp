@@ -0,0 +1,173 @@
+#include <array>
+#include <string.h>
+
+#include "TrafficLog.h"
+
+typedef std::array<std::array<uint32_t, 256>, 8> CrcTables;
+
+/**
+* Slicing-by-8 tables: tables[k][b] is the CRC of byte b followed by k zero bytes
+*/
+static CrcTables makeCrcTables()
+{
+    CrcTables tables;
+    for (uint32_t i = 0; i < 256; i++)
+    {
+        uint32_t value = i;
+        for (int bit = 0; bit < 8; bit++)
+            value = (value & 1) ? (value >> 1) ^ 0xEDB88320u : value >> 1;
+        tables[0][i] = value;
+    }
+    for (uint32_t i = 0; i < 256; i++)
+    {
+        for (int k = 1; k < 8; k++)
+            tables[k][i] = (tables[k - 1][i] >> 8) ^ tables[0][tables[k - 1][i] & 0xFF];
+    }
+    return tables;
+}
+
+static int seekTo(FILE* file, uint64_t offset)
+{
+#ifdef _WIN32
+    return _fseeki64(file, (long long)offset, SEEK_SET);
+#else
+    return fseeko(file, (off_t)offset, SEEK_SET);
+#endif
+}
+
+/**
+* CRC-32 (IEEE 802.3, reflected, polynomial 0xEDB88320), the same as zlib's crc32().
+* Eight bytes per step; the recorder checksums every byte it writes, so this is on the dispatch thread.
+*/
+uint32_t crc32(const void* data, size_t size, uint32_t crc)
+{
+    static const CrcTables tables = makeCrcTables();
+
+    const uint8_t* bytes = (const uint8_t*)data;
+    crc = ~crc;
+    for (; size >= 8; size -= 8, bytes += 8)
+    {
+        uint32_t low;
+        uint32_t high;
+        memcpy(&low, bytes, 4);         // little-endian, as on every target this builds for
+        memcpy(&high, bytes + 4, 4);
+        low ^= crc;
+        crc = tables[7][low & 0xFF] ^ tables[6][(low >> 8) & 0xFF] ^ tables[5][(low >> 16) & 0xFF] ^ tables[4][low >> 24] ^
+            tables[3][high & 0xFF] ^ tables[2][(high >> 8) & 0xFF] ^ tables[1][(high >> 16) & 0xFF] ^ tables[0][high >> 24];
+    }
+    for (; size > 0; size--)
+        crc = tables[0][(crc ^ *bytes++) & 0xFF] ^ (crc >> 8);
+    return ~crc;
+}
+
+TrafficLogReader::TrafficLogReader()
+    : m_file(NULL)
+    , m_chunkSize(0)
+    , m_sequence(0)
+    , m_offset(0)
+    , m_end(0)
+    , m_stats()
+{
+}
+
+TrafficLogReader::~TrafficLogReader()
+{
+    close();
+}
+
+bool TrafficLogReader::open(const char* path)
+{
+    close();
+    m_file = fopen(path, "rb");
+    if (!m_file)
+        return false;
+
+    TrafficChunkHeader header;
+    if (fread(&header, sizeof(header), 1, m_file) != 1 || header.magic != TRAFFIC_CHUNK_MAGIC ||
+        header.version != TRAFFIC_LOG_VERSION || header.chunkSize <= sizeof(header))
+    {
+        close();
+        return false;
+    }
+
+    m_chunkSize = header.chunkSize;
+    m_chunk.resize(m_chunkSize);
+    rewind();
+    return true;
+}
+
+void TrafficLogReader::close()
+{
+    if (m_file)
+        fclose(m_file);
+    m_file = NULL;
+}
+
+void TrafficLogReader::rewind()
+{
+    m_sequence = 0;
+    m_offset = 0;
+    m_end = 0;
+    m_stats = TrafficLogStats();
+}
+
+/**
+* Read the next chunk with a sane header. Returns false at the end of the file.
+*/
+bool TrafficLogReader::loadChunk()
+{
+    while (m_file)
+    {
+        if (seekTo(m_file, (uint64_t)m_sequence * m_chunkSize) != 0)
+            return false;
+        size_t bytes = fread(m_chunk.data(), 1, m_chunkSize, m_file);
+        if (bytes < sizeof(TrafficChunkHeader))
+            return false;
+        m_sequence++;
+        m_stats.chunks++;
+
+        TrafficChunkHeader header;
+        memcpy(&header, m_chunk.data(), sizeof(header));
+        bool valid = header.magic == TRAFFIC_CHUNK_MAGIC && header.headerSize == sizeof(header) &&
+            header.payloadBytes <= bytes - sizeof(header);
+        if (valid && header.sealed)
+            valid = crc32(&m_chunk[sizeof(header)], header.payloadBytes) == header.crc32;
+        if (!valid)
+        {
+            m_stats.corruptChunks++;
+            continue;
+        }
+
+        if (!header.sealed)
+            m_stats.unsealedChunks++;
+        m_offset = sizeof(header);
+        m_end = sizeof(header) + header.payloadBytes;
+        return true;
+    }
+    return false;
+}
+
+bool TrafficLogReader::next(TrafficLogRecord& record)
+{
+    for (;;)
+    {
+        if (m_offset + sizeof(TrafficRecordHeader) <= m_end)
+        {
+            TrafficRecordHeader header;
+            memcpy(&header, &m_chunk[m_offset], sizeof(header));
+            size_t span = trafficRecordSpan(header.size);
+            if (header.size <= m_end - m_offset && m_offset + span <= m_end)
+            {
+                record.timestampNs = header.timestampNs;
+                record.data = &m_chunk[m_offset + sizeof(header)];
+                record.size = header.size;
+                m_offset += span;
+                m_stats.records++;
+                return true;
+            }
+        }
+
+        if (!loadChunk())
+            return false;
+    }
+}
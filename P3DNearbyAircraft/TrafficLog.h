@@ -0,0 +1,102 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <vector>
+
+/**
+* On-disk format of a traffic recording (.p3drec).
+*
+* The file is a sequence of fixed-size chunks, each starting with a TrafficChunkHeader at offset
+* sequence * chunkSize. A chunk's records follow its header back to back: a TrafficRecordHeader and the raw
+* SimConnect message, padded to 8 bytes. Only the last chunk may be shorter than chunkSize.
+*
+* The recorder keeps payloadBytes and recordCount current on every append, and writes the CRC-32 of the
+* payload when the chunk is sealed. A chunk left unsealed by a crash is still readable, just not verified.
+*/
+constexpr uint32_t TRAFFIC_CHUNK_MAGIC = 0x43524450;   // "PDRC"
+constexpr uint16_t TRAFFIC_LOG_VERSION = 1;
+constexpr uint32_t TRAFFIC_CHUNK_SIZE = 1 << 20;        // a multiple of the 64 KiB Windows mapping granularity
+
+struct TrafficChunkHeader
+{
+    uint32_t magic;
+    uint16_t version;
+    uint16_t headerSize;
+    uint32_t chunkSize;
+    uint32_t sequence;
+    uint32_t payloadBytes;
+    uint32_t recordCount;
+    uint32_t crc32;             // of the payloadBytes after the header, valid once sealed
+    uint32_t sealed;
+    uint64_t firstTimestampNs;
+    uint64_t lastTimestampNs;
+    uint8_t reserved[16];
+};
+
+struct TrafficRecordHeader
+{
+    uint64_t timestampNs;       // since the recording started
+    uint32_t size;              // message bytes that follow
+    uint32_t reserved;
+};
+
+static_assert(sizeof(TrafficChunkHeader) == 64, "chunk header layout is part of the file format");
+static_assert(sizeof(TrafficRecordHeader) == 16, "record header layout is part of the file format");
+
+constexpr uint32_t trafficRecordSpan(uint32_t messageSize)
+{
+    return (uint32_t)sizeof(TrafficRecordHeader) + ((messageSize + 7) & ~7u);
+}
+
+uint32_t crc32(const void* data, size_t size, uint32_t crc = 0);
+
+/**
+* One recorded message; data stays valid until the next TrafficLogReader::next().
+*/
+struct TrafficLogRecord
+{
+    uint64_t timestampNs;
+    const void* data;
+    uint32_t size;
+};
+
+struct TrafficLogStats
+{
+    uint64_t chunks;
+    uint64_t records;
+    uint64_t corruptChunks;     // bad header or checksum; their records are skipped
+    uint64_t unsealedChunks;    // read without verification (recording was not closed)
+};
+
+/**
+* Sequential reader for a recording, one chunk in memory at a time.
+*/
+class TrafficLogReader
+{
+public:
+    TrafficLogReader();
+    ~TrafficLogReader();
+
+    bool open(const char* path);
+    void close();
+
+    // Back to the first record
+    void rewind();
+
+    bool next(TrafficLogRecord& record);
+
+    const TrafficLogStats& stats() const { return m_stats; }
+
+private:
+    bool loadChunk();
+
+    FILE* m_file;
+    uint32_t m_chunkSize;
+    uint32_t m_sequence;
+    std::vector<uint8_t> m_chunk;
+    size_t m_offset;
+    size_t m_end;
+    TrafficLogStats m_stats;
+};
@@ -0,0 +1,173 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <vector>
+
+#include "AircraftInfo.h"
+
+/**
+* Wire layout of SIMCONNECT_RECV_SIMOBJECT_DATA and SIMCONNECT_RECV_SIMOBJECT_DATA_BYTYPE, for code that must parse or build raw messages
+* without SimConnect.h (recorder, replay, benchmarks). Every field is a DWORD, so the layout is the same
+* whether or not the SDK's 1-byte packing applies. The data definition starts where dwData is.
+*/
+struct TrafficMessageHeader
+{
+    uint32_t size;          // dwSize
+    uint32_t version;       // dwVersion
+    uint32_t id;            // dwID
+    uint32_t requestId;     // dwRequestID
+    uint32_t objectId;      // dwObjectID
+    uint32_t defineId;      // dwDefineID
+    uint32_t flags;         // dwFlags
+    uint32_t entryNumber;   // dwentrynumber, 1-based
+    uint32_t outOf;         // dwoutof
+    uint32_t defineCount;   // dwDefineCount
+};
+
+static_assert(sizeof(TrafficMessageHeader) == 40, "must match the SimConnect header");
+
+constexpr uint32_t TRAFFIC_RECV_ID_SIMOBJECT_DATA = 8;          // SIMCONNECT_RECV_ID_SIMOBJECT_DATA
+constexpr uint32_t TRAFFIC_RECV_ID_SIMOBJECT_DATA_BYTYPE = 9;   // SIMCONNECT_RECV_ID_SIMOBJECT_DATA_BYTYPE
+
+constexpr uint32_t TRAFFIC_DATA_REQUEST_FLAG_CHANGED = 0x1;     // SIMCONNECT_DATA_REQUEST_FLAG_CHANGED
+constexpr uint32_t TRAFFIC_DATA_REQUEST_FLAG_TAGGED = 0x2;      // SIMCONNECT_DATA_REQUEST_FLAG_TAGGED; set in dwFlags of tagged data
+
+constexpr uint32_t TRAFFIC_PERIOD_NEVER = 0;                    // SIMCONNECT_PERIOD_NEVER: ends a per-object request
+constexpr uint32_t TRAFFIC_PERIOD_ONCE = 1;                     // SIMCONNECT_PERIOD_ONCE
+constexpr uint32_t TRAFFIC_PERIOD_SIM_FRAME = 3;                // SIMCONNECT_PERIOD_SIM_FRAME
+constexpr uint32_t TRAFFIC_PERIOD_SECOND = 4;                   // SIMCONNECT_PERIOD_SECOND
+
+constexpr uint32_t TRAFFIC_OBJECT_TYPE_ALL = 1;                 // SIMCONNECT_SIMOBJECT_TYPE_ALL
+constexpr uint32_t TRAFFIC_OBJECT_TYPE_AIRCRAFT = 2;            // SIMCONNECT_SIMOBJECT_TYPE_AIRCRAFT
+
+// A tagged datum on the wire: its DatumID, then the value at its type's size. Pairs are packed, so the values are unaligned.
+constexpr uint32_t TAGGED_DATUM_ID_SIZE = sizeof(uint32_t);
+
+/**
+* Data definition IDs, shared by the client and everything that reads its messages back.
+*/
+enum TrafficDefinition : uint32_t
+{
+    TRAFFIC_DEFINITION_COMBINED = 0,    // AircraftInfo: title and state together (older recordings)
+    TRAFFIC_DEFINITION_STATE = 1,       // AircraftState, every sweep (older recordings)
+    TRAFFIC_DEFINITION_TITLE = 2,       // AircraftTitle, once per ObjectID
+    TRAFFIC_DEFINITION_OWNSHIP = 3,     // OwnshipState, every sim frame for the user aircraft
+    TRAFFIC_DEFINITION_PACKED_STATE = 4,    // PackedAircraftState, every sweep and for tracked aircraft
+    TRAFFIC_DEFINITION_IDENTITY = 5,    // AircraftIdentity, once per ObjectID of each aggregated simulator
+};
+
+/**
+* The datums of a state definition, indexed by DatumID (AircraftStateField), or NULL when defineId is not one.
+*/
+inline const WireField* stateDefinitionFields(uint32_t defineId)
+{
+    if (defineId == TRAFFIC_DEFINITION_PACKED_STATE)
+        return WireRecord<PackedAircraftState>::fields;
+    if (defineId == TRAFFIC_DEFINITION_STATE)
+        return WireRecord<AircraftState>::fields;
+    return NULL;
+}
+
+/**
+* Append one message carrying payload to out, laid out as SimConnect delivers it.
+*/
+inline void appendTrafficMessage(std::vector<uint8_t>& out, uint32_t recvId, uint32_t requestId, uint32_t defineId, uint32_t defineCount,
+    uint32_t objectId, uint32_t entryNumber, uint32_t outOf, const void* payload, uint32_t payloadSize)
+{
+    TrafficMessageHeader header = {};
+    header.size = (uint32_t)sizeof(header) + payloadSize;
+    header.version = 4;
+    header.id = recvId;
+    header.requestId = requestId;
+    header.objectId = objectId;
+    header.defineId = defineId;
+    header.entryNumber = entryNumber;
+    header.outOf = outOf;
+    header.defineCount = defineCount;
+
+    size_t offset = out.size();
+    out.resize(offset + header.size);
+    memcpy(&out[offset], &header, sizeof(header));
+    memcpy(&out[offset + sizeof(header)], payload, payloadSize);
+}
+
+/**
+* One SIMOBJECT_DATA_BYTYPE message with the combined definition.
+*/
+inline void appendTrafficMessage(std::vector<uint8_t>& out, uint32_t requestId, uint32_t objectId, uint32_t entryNumber, uint32_t outOf, const AircraftInfo& aircraft)
+{
+    appendTrafficMessage(out, TRAFFIC_RECV_ID_SIMOBJECT_DATA_BYTYPE, requestId, TRAFFIC_DEFINITION_COMBINED, 8, objectId, entryNumber, outOf, &aircraft, sizeof(aircraft));
+}
+
+/**
+* One SIMOBJECT_DATA_BYTYPE message with the unpacked state definition.
+*/
+inline void appendTrafficMessage(std::vector<uint8_t>& out, uint32_t requestId, uint32_t objectId, uint32_t entryNumber, uint32_t outOf, const AircraftState& state)
+{
+    appendTrafficMessage(out, TRAFFIC_RECV_ID_SIMOBJECT_DATA_BYTYPE, requestId, TRAFFIC_DEFINITION_STATE, STATE_FIELD_COUNT, objectId, entryNumber, outOf, &state, sizeof(state));
+}
+
+/**
+* One SIMOBJECT_DATA_BYTYPE message with the packed state definition, as live sweeps arrive.
+*/
+inline void appendTrafficMessage(std::vector<uint8_t>& out, uint32_t requestId, uint32_t objectId, uint32_t entryNumber, uint32_t outOf, const PackedAircraftState& state)
+{
+    appendTrafficMessage(out, TRAFFIC_RECV_ID_SIMOBJECT_DATA_BYTYPE, requestId, TRAFFIC_DEFINITION_PACKED_STATE, STATE_FIELD_COUNT, objectId, entryNumber, outOf, &state, sizeof(state));
+}
+
+/**
+* One SIMOBJECT_DATA message answering a title request for objectId.
+*/
+inline void appendTitleMessage(std::vector<uint8_t>& out, uint32_t requestId, uint32_t objectId, const AircraftTitle& title)
+{
+    appendTrafficMessage(out, TRAFFIC_RECV_ID_SIMOBJECT_DATA, requestId, TRAFFIC_DEFINITION_TITLE, 1, objectId, 1, 1, &title, sizeof(title));
+}
+
+/**
+* One SIMOBJECT_DATA message answering an identity request for objectId.
+*/
+inline void appendIdentityMessage(std::vector<uint8_t>& out, uint32_t requestId, uint32_t objectId, const AircraftIdentity& identity)
+{
+    appendTrafficMessage(out, TRAFFIC_RECV_ID_SIMOBJECT_DATA, requestId, TRAFFIC_DEFINITION_IDENTITY, 2, objectId, 1, 1, &identity, sizeof(identity));
+}
+
+/**
+* One SIMOBJECT_DATA message of the per-frame ownship request.
+*/
+inline void appendOwnshipMessage(std::vector<uint8_t>& out, uint32_t requestId, const OwnshipState& ownship)
+{
+    appendTrafficMessage(out, TRAFFIC_RECV_ID_SIMOBJECT_DATA, requestId, TRAFFIC_DEFINITION_OWNSHIP, 6, 1, 1, 1, &ownship, sizeof(ownship));
+}
+
+/**
+* One SIMOBJECT_DATA message of a tagged per-object request carrying the fields of state set in fields
+* (bits of AircraftStateField), each as its DatumID followed by the value in the type defineId gives it.
+*/
+inline void appendTaggedStateMessage(std::vector<uint8_t>& out, uint32_t requestId, uint32_t objectId, const AircraftState& state, uint32_t fields,
+    uint32_t defineId = TRAFFIC_DEFINITION_PACKED_STATE)
+{
+    const WireField* definition = stateDefinitionFields(defineId);
+    if (!definition)
+        return;
+
+    uint8_t payload[STATE_FIELD_COUNT * (TAGGED_DATUM_ID_SIZE + sizeof(double))];
+    uint32_t count = 0, payloadSize = 0;
+    for (uint32_t field = 0; field < STATE_FIELD_COUNT; field++)
+    {
+        if (!(fields & (1u << field)))
+            continue;
+        double value;
+        memcpy(&value, (const char*)&state + field * sizeof(double), sizeof(value));
+        memcpy(payload + payloadSize, &field, sizeof(field));
+        writeWireValue(definition[field].type, value, payload + payloadSize + TAGGED_DATUM_ID_SIZE);
+        payloadSize += TAGGED_DATUM_ID_SIZE + definition[field].size;
+        count++;
+    }
+
+    size_t offset = out.size();
+    appendTrafficMessage(out, TRAFFIC_RECV_ID_SIMOBJECT_DATA, requestId, defineId, count, objectId, 1, 1, payload, payloadSize);
+    uint32_t flags = TRAFFIC_DATA_REQUEST_FLAG_CHANGED | TRAFFIC_DATA_REQUEST_FLAG_TAGGED;
+    memcpy(&out[offset + offsetof(TrafficMessageHeader, flags)], &flags, sizeof(flags));
+}
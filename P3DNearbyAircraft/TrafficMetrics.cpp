@@ -0,0 +1,43 @@
+#include "TrafficMetrics.h"
+
+void snapshotMetrics(const TrafficMetrics& metrics, const AsyncOutput& output, MetricsSnapshot& out)
+{
+    OutputStats outputStats = output.stats();
+    out.uptimeSeconds = (monotonicNs() - metrics.startedNs) / 1e9;
+    out.messages = metrics.messages.load();
+    out.bytes = metrics.bytes.load();
+    out.written = outputStats.written;
+    out.dropped = outputStats.dropped;
+    out.incompleteSweeps = metrics.incompleteSweeps.load();
+    out.dispatch = metrics.dispatchNs.summary();
+    out.queue = metrics.queueNs.summary();
+    out.compute = metrics.computeNs.summary();
+    out.commit = metrics.commitNs.summary();
+    out.output = metrics.outputNs.summary();
+    out.sweeps = metrics.sweepRecords.summary();
+}
+
+static void writeLatency(FILE* out, const char* name, const HistogramSummary& summary)
+{
+    fprintf(out, "%-22s %10llu %10.1f %10.1f %10.1f %10.1f %10.1f %10.1f\n", name, (unsigned long long)summary.count, summary.mean / 1e3,
+        summary.p50 / 1e3, summary.p90 / 1e3, summary.p99 / 1e3, summary.p999 / 1e3, summary.max / 1e3);
+}
+
+void writeMetrics(FILE* out, const MetricsSnapshot& snapshot)
+{
+    double seconds = snapshot.uptimeSeconds > 0 ? snapshot.uptimeSeconds : 1;
+    fprintf(out, "\n[metrics at %.1f s] %llu messages (%.0f/s), %llu bytes (%.0f/s), %llu report records, %llu dropped\n",
+        snapshot.uptimeSeconds, (unsigned long long)snapshot.messages, snapshot.messages / seconds, (unsigned long long)snapshot.bytes,
+        snapshot.bytes / seconds, (unsigned long long)snapshot.written, (unsigned long long)snapshot.dropped);
+    fprintf(out, "%-22s %10s %10s %10s %10s %10s %10s %10s\n", "latency (us)", "count", "mean", "p50", "p90", "p99", "p99.9", "max");
+    writeLatency(out, "dispatch call", snapshot.dispatch);
+    writeLatency(out, "receive -> compute", snapshot.queue);
+    writeLatency(out, "compute", snapshot.compute);
+    writeLatency(out, "receive -> commit", snapshot.commit);
+    writeLatency(out, "receive -> output", snapshot.output);
+    fprintf(out, "%-22s %10llu %10.1f %10llu %10llu %10llu %10llu %10llu\n", "records per sweep", (unsigned long long)snapshot.sweeps.count,
+        snapshot.sweeps.mean, (unsigned long long)snapshot.sweeps.p50, (unsigned long long)snapshot.sweeps.p90,
+        (unsigned long long)snapshot.sweeps.p99, (unsigned long long)snapshot.sweeps.p999, (unsigned long long)snapshot.sweeps.max);
+    fprintf(out, "%-22s %10llu\n", "incomplete sweeps", (unsigned long long)snapshot.incompleteSweeps);
+    fflush(out);
+}
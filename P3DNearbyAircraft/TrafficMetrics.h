@@ -0,0 +1,76 @@
+#pragma once
+
+#include <atomic>
+#include <stdint.h>
+#include <stdio.h>
+
+#include "AsyncOutput.h"
+#include "LatencyHistogram.h"
+
+/**
+* A counter with a single writer thread; readers on other threads see it without locks.
+*/
+struct MetricCounter
+{
+    MetricCounter() : value(0) {}
+
+    void add(uint64_t amount) { value.store(value.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed); }
+    uint64_t load() const { return value.load(std::memory_order_relaxed); }
+
+    std::atomic<uint64_t> value;
+};
+
+/**
+* Where the time goes on the traffic path, from the moment a message is received to the moment its report
+* line is written. Every field has one writer thread, noted below; TrafficStages, TrafficPipeline and
+* AsyncOutput each record into theirs once given the pointer, and snapshotMetrics() may run on any thread.
+*
+* Latencies are measured from the receive time of the batch a message travelled in (TrafficStages stamps
+* the batch when its first message arrives), so they include the time spent waiting for the batch to fill
+* up, which is at most one receive wakeup.
+*/
+struct TrafficMetrics
+{
+    TrafficMetrics() : startedNs(monotonicNs()) {}
+
+    uint64_t startedNs;
+
+    // Receive thread
+    LatencyHistogram dispatchNs;        // one pass of the receive loop over everything SimConnect had queued
+    MetricCounter messages;             // traffic messages submitted
+    MetricCounter bytes;
+
+    // Commit thread
+    LatencyHistogram queueNs;           // received -> a compute worker starts decoding
+    LatencyHistogram computeNs;         // decoding and solving one batch
+    LatencyHistogram commitNs;          // received -> applied to the traffic table
+    LatencyHistogram sweepRecords;      // records per wide sweep (a count, not a time)
+    MetricCounter incompleteSweeps;     // closed by timeout or by the next sweep with records missing
+
+    // Output thread
+    LatencyHistogram outputNs;          // received -> report line written
+};
+
+/**
+* Everything in TrafficMetrics at one moment, plus the output's drop count.
+*/
+struct MetricsSnapshot
+{
+    double uptimeSeconds;
+    uint64_t messages;
+    uint64_t bytes;
+    uint64_t written;                   // report records
+    uint64_t dropped;
+    uint64_t incompleteSweeps;
+    HistogramSummary dispatch;
+    HistogramSummary queue;
+    HistogramSummary compute;
+    HistogramSummary commit;
+    HistogramSummary output;
+    HistogramSummary sweeps;
+};
+
+void snapshotMetrics(const TrafficMetrics& metrics, const AsyncOutput& output, MetricsSnapshot& out);
+
+// A block of one line per histogram (count, mean, p50, p90, p99, p99.9, max in microseconds) and the counters
+void writeMetrics(FILE* out, const MetricsSnapshot& snapshot);
@@ -0,0 +1,429 @@
+#include <algorithm>
+#include <string.h>
+#include <vector>
+
+#include "TrafficPipeline.h"
+#include "TrafficMessage.h"
+#include "TrafficMetrics.h"
+#include "TrafficSnapshot.h"
+#include "Utilities.h"
+
+TrafficPipeline::TrafficPipeline(AsyncOutput& output, double lat, double lon, double altFt)
+    : nearestCount(3)
+    , staleSweeps(2)
+    , detectConflicts(true)
+    , metrics(NULL)
+    , receivedNs(0)
+    , snapshots(NULL)
+    , snapshotIntervalSeconds(0.2)
+    , clock(trafficClockSeconds)
+    , m_output(output)
+    , m_ownship(lat, lon, altFt)
+    , m_sweepTime(0)
+    , m_snapshotTime(0)
+    , m_records(0)
+    , m_trackedRecords(0)
+    , m_partialRecords(0)
+    , m_partialDropped(0)
+    , m_sweeps(0)
+{
+}
+
+bool TrafficPipeline::onMessage(const void* data, uint32_t size)
+{
+    DecodedMessage message;
+    return decodeTrafficMessage(data, size, message) && apply(message);
+}
+
+bool TrafficPipeline::apply(const DecodedMessage& message)
+{
+    switch (message.kind)
+    {
+    case DECODED_SWEEP:
+        sweepRecord(message);
+        return true;
+    case DECODED_OWNSHIP:
+    {
+        OwnshipSample sample;
+        sample.latitude = message.state.latitude;
+        sample.longitude = message.state.longitude;
+        sample.altitude = message.state.altitude;
+        sample.trueHeading = message.state.trueHeading;
+        sample.groundSpeed = message.state.groundSpeed;
+        sample.verticalSpeed = message.state.verticalSpeed;
+        sample.time = clock();
+        m_ownshipCell.store(sample);
+        return true;
+    }
+    case DECODED_TRACKED:
+    {
+        m_trackedRecords++;
+        double now = clock();
+        refreshOwnship();
+        const TargetGeometry* geometry = solvedFromOwnship(message) ? &message.geometry : NULL;
+        if (message.fields != STATE_ALL_FIELDS)
+        {
+            // A tagged update names only what changed; the rest is what the table already holds
+            size_t slot = m_table.find(message.objectId);
+            if (slot == TrafficTable::NOT_FOUND)
+            {
+                m_partialDropped++;
+                return true;
+            }
+            AircraftState state = m_table.state(slot);
+            mergeStateFields(state, message.state, message.fields);
+            m_partialRecords++;
+            record(message.objectId, state, NULL, now, NULL);
+        }
+        else
+        {
+            record(message.objectId, message.state, NULL, now, geometry);
+        }
+        if (snapshots && now - m_snapshotTime >= snapshotIntervalSeconds)
+            publishSnapshot(now);
+        return true;
+    }
+    case DECODED_TITLE:
+        onTitle(message.objectId, *(const AircraftTitle*)message.title);
+        return true;
+    default:
+        return false;
+    }
+}
+
+void TrafficPipeline::onAircraft(uint32_t objectId, uint32_t entryNumber, uint32_t outOf, const AircraftState& state)
+{
+    DecodedMessage message = {};
+    message.kind = DECODED_SWEEP;
+    message.objectId = objectId;
+    message.entryNumber = entryNumber;
+    message.outOf = outOf;
+    message.state = state;
+    sweepRecord(message);
+}
+
+void TrafficPipeline::onAircraft(uint32_t objectId, uint32_t entryNumber, uint32_t outOf, const AircraftInfo& aircraft)
+{
+    DecodedMessage message = {};
+    message.kind = DECODED_SWEEP;
+    message.objectId = objectId;
+    message.entryNumber = entryNumber;
+    message.outOf = outOf;
+    message.state = stateOf(aircraft);
+    message.title = aircraft.title;
+    sweepRecord(message);
+}
+
+void TrafficPipeline::onTrackedAircraft(uint32_t objectId, const AircraftState& state)
+{
+    m_trackedRecords++;
+    record(objectId, state, NULL, clock(), NULL);
+}
+
+void TrafficPipeline::onTitle(uint32_t objectId, const AircraftTitle& title)
+{
+    if (memchr(title.title, '\0', sizeof(title.title)) == NULL) // security check
+        return;
+
+    // The aircraft may have left since the request went out
+    size_t slot = m_table.find(objectId);
+    if (slot != TrafficTable::NOT_FOUND)
+        m_table.setTitle(slot, m_titles.intern(title.title, strlen(title.title)));
+}
+
+size_t TrafficPipeline::takeTitleRequests(std::vector<uint32_t>& out)
+{
+    out.clear();
+    out.swap(m_titleRequests);
+    return out.size();
+}
+
+size_t TrafficPipeline::takeTierChanges(std::vector<TierChange>& out)
+{
+    out.clear();
+    out.swap(m_tierChanges);
+    return out.size();
+}
+
+bool TrafficPipeline::predict(uint32_t objectId, double time, PredictedPosition& out) const
+{
+    size_t slot = m_table.find(objectId);
+    if (slot == TrafficTable::NOT_FOUND)
+        return false;
+
+    out = m_predictor.predict(m_table, slot, time);
+    return true;
+}
+
+size_t TrafficPipeline::expireSweeps()
+{
+    return m_assembler.expire(clock()) ? processSweeps() : 0;
+}
+
+size_t TrafficPipeline::closeSweeps()
+{
+    return m_assembler.closeAll() ? processSweeps() : 0;
+}
+
+void TrafficPipeline::sweepRecord(const DecodedMessage& message)
+{
+    if (m_assembler.add(message, clock))
+        processSweeps();
+}
+
+size_t TrafficPipeline::processSweeps()
+{
+    size_t processed = 0;
+    while (AssembledSweep* sweep = m_assembler.nextReady())
+    {
+        processSweep(*sweep);
+        m_assembler.release(sweep);
+        processed++;
+    }
+    return processed;
+}
+
+/**
+* Move the ownship to the newest sample of its own request. False if there has been none, in which case the
+* user aircraft records of the sweeps keep moving it.
+*/
+bool TrafficPipeline::refreshOwnship()
+{
+    OwnshipSample sample;
+    if (!m_ownshipCell.load(sample))
+        return false;
+    if (sample.latitude != m_ownship.latitude() || sample.longitude != m_ownship.longitude() || sample.altitude != m_ownship.altitude())
+        m_ownship.update(sample.latitude, sample.longitude, sample.altitude);
+    return true;
+}
+
+bool TrafficPipeline::solvedFromOwnship(const DecodedMessage& message) const
+{
+    // The compute stage follows the ownship message by message, which runs ahead of it while a sweep is collected
+    return message.hasGeometry && message.ownLat == m_ownship.latitude() && message.ownLon == m_ownship.longitude() &&
+        message.ownAlt == m_ownship.altitude();
+}
+
+void TrafficPipeline::processSweep(AssembledSweep& sweep)
+{
+    // Keep every aircraft between sweeps; anything missing for more than staleSweeps sweeps is dropped
+    m_table.beginSweep();
+    m_sweepTime = sweep.openedAt;
+
+    // The freshest ownship, or without its own request the user aircraft's position in this sweep, so all of
+    // its traffic is solved from the same moment
+    bool ownshipLive = refreshOwnship();
+    for (size_t i = 0; !ownshipLive && i < sweep.entries.size(); i++)
+    {
+        const DecodedMessage& entry = sweep.entries[i];
+        if (entry.state.isUser && isReported(entry.state, entry.title))
+        {
+            m_ownship.update(entry.state.latitude, entry.state.longitude, m_ownship.altitude());
+            break;
+        }
+    }
+
+    // Geometry for the whole sweep in one pass, reusing what the compute stage solved against the same ownship
+    for (DecodedMessage& entry : sweep.entries)
+    {
+        if (entry.state.isUser || !isReported(entry.state, entry.title))
+            continue;
+        if (solvedFromOwnship(entry))
+            continue;
+        entry.geometry = m_ownship.solve(entry.state.latitude, entry.state.longitude, entry.state.altitude);
+        entry.hasGeometry = true;
+    }
+
+    for (const DecodedMessage& entry : sweep.entries)
+        record(entry.objectId, entry.state, entry.title, m_sweepTime, entry.hasGeometry ? &entry.geometry : NULL);
+
+    if (metrics)
+    {
+        metrics->sweepRecords.record(sweep.entries.size());
+        if (!sweep.complete)
+            metrics->incompleteSweeps.add(1);
+    }
+    endSweep();
+}
+
+void TrafficPipeline::record(uint32_t objectId, const AircraftState& state, const char* title, double sampleTime, const TargetGeometry* geometry)
+{
+    m_records++;
+
+    // Where the aircraft was being shown when this sample arrived, so its new track can blend in from there
+    size_t previous = m_table.find(objectId);
+    PredictedPosition shown = {};
+    if (previous != TrafficTable::NOT_FOUND)
+        shown = m_predictor.predict(m_table, previous, sampleTime);
+
+    size_t slot = m_table.update(objectId, state);
+    bool isNew = previous == TrafficTable::NOT_FOUND;
+    m_predictor.startTrack(m_table, slot, sampleTime, isNew ? NULL : &shown);
+
+    if (title != NULL)
+    {
+        if (memchr(title, '\0', sizeof(AircraftTitle::title)) != NULL) // security check
+            m_table.setTitle(slot, m_titles.intern(title, strlen(title)));
+    }
+    else if (isNew)
+    {
+        m_titleRequests.push_back(objectId);
+    }
+
+    uint32_t titleId = m_table.titleIds()[slot];
+    if (!isReported(state, title))
+        return;
+
+    // Formatting and console I/O happen on the output thread, never here
+    const std::string& name = m_titles.title(titleId);
+    OutputRecord record = {};
+    record.objectId = objectId;
+    record.receivedNs = receivedNs;
+    memcpy(record.title, name.data(), name.size() < sizeof(record.title) ? name.size() : sizeof(record.title));
+    record.latitude = state.latitude;
+    record.longitude = state.longitude;
+    record.altitude = state.altitude;
+    record.trueHeading = state.trueHeading * (180 / M_PI);
+    record.magHeading = state.magHeading * (180 / M_PI);
+    record.onGround = state.onGround;
+
+    if (state.isUser)
+    {
+        record.kind = OUTPUT_USER_AIRCRAFT;
+        if (m_ownshipCell.updates() == 0)
+            m_ownship.update(state.latitude, state.longitude, m_ownship.altitude());
+    }
+    else
+    {
+        TargetGeometry solved = geometry ? *geometry : m_ownship.solve(state.latitude, state.longitude, state.altitude);
+        record.kind = OUTPUT_TRAFFIC;
+        record.rangeNm = solved.rangeNm;
+        record.bearingDeg = solved.bearingDeg;
+        record.elevationDeg = solved.elevationDeg;
+    }
+    m_output.push(record);
+}
+
+void TrafficPipeline::endSweep()
+{
+    m_sweeps++;
+    m_table.evictStale(staleSweeps);
+
+    // Index the table so any number of radius, nearest and altitude queries can share it
+    const double* latitudes = m_table.latitudes();
+    const double* longitudes = m_table.longitudes();
+    const double* altitudes = m_table.altitudes();
+    m_index.clear();
+    for (size_t slot = 0; slot < m_table.size(); slot++)
+        m_index.insert(m_table.objectIds()[slot], latitudes[slot], longitudes[slot], altitudes[slot]);
+    m_index.build();
+
+    // Changes wait until the client takes them; a later change for the same aircraft replaces the earlier one
+    m_scheduler.plan(m_table, m_index, m_ownship.latitude(), m_ownship.longitude(), m_planned);
+    for (const TierChange& change : m_planned)
+    {
+        auto pending = std::find_if(m_tierChanges.begin(), m_tierChanges.end(), [&change](const TierChange& c) { return c.objectId == change.objectId; });
+        if (pending == m_tierChanges.end())
+            m_tierChanges.push_back(change);
+        else if (pending->from == change.to)
+            m_tierChanges.erase(pending);
+        else
+            pending->to = change.to;
+    }
+
+    std::vector<TrafficNeighbor> nearest;
+    m_index.nearest(m_ownship.latitude(), m_ownship.longitude(), nearestCount + 1, nearest);   // +1 for the user aircraft itself
+
+    OutputRecord record = {};
+    record.kind = OUTPUT_SWEEP;
+    record.receivedNs = receivedNs;
+    record.aircraftCount = (uint32_t)m_index.size();
+    for (const TrafficNeighbor& neighbor : nearest)
+    {
+        if (record.nearestCount == OUTPUT_NEAREST_MAX)
+            break;
+        record.nearestIds[record.nearestCount] = neighbor.objectId;
+        record.nearestRangeNm[record.nearestCount] = neighbor.rangeNm;
+        record.nearestCount++;
+    }
+    m_output.push(record);
+
+    if (detectConflicts)
+        probeConflicts();
+    if (snapshots)
+        publishSnapshot(m_sweepTime);
+}
+
+void TrafficPipeline::probeConflicts()
+{
+    // Aircraft that missed this sweep are still in the table; fly everything to the same moment first
+    size_t count = m_table.size();
+    m_sweepLatitudes.resize(count);
+    m_sweepLongitudes.resize(count);
+    m_sweepAltitudes.resize(count);
+    m_predictor.predictAll(m_table, m_sweepTime, m_sweepLatitudes.data(), m_sweepLongitudes.data(), m_sweepAltitudes.data());
+    m_conflicts.detect(m_table, m_sweepLatitudes.data(), m_sweepLongitudes.data(), m_sweepAltitudes.data(),
+        m_ownship.latitude(), m_ownship.longitude(), m_alerts);
+
+    for (const ConflictAlert& alert : m_alerts)
+    {
+        OutputRecord record = {};
+        record.kind = alert.event == CONFLICT_NEW ? OUTPUT_CONFLICT : OUTPUT_CONFLICT_CLEARED;
+        record.receivedNs = receivedNs;
+        record.objectId = alert.conflict.firstId;
+        record.otherId = alert.conflict.secondId;
+        record.lossSeconds = alert.conflict.lossSeconds;
+        record.cpaSeconds = alert.conflict.cpaSeconds;
+        record.cpaRangeNm = alert.conflict.cpaRangeNm;
+        record.cpaVerticalFt = alert.conflict.cpaVerticalFt;
+        m_output.push(record);
+    }
+}
+
+void TrafficPipeline::publishSnapshot(double time)
+{
+    // Written straight into the shared buffer; readers see none of it until publish()
+    SnapshotAircraft* aircraft = snapshots->begin();
+    if (!aircraft)
+        return;
+
+    size_t count = m_table.size() < snapshots->capacity() ? m_table.size() : snapshots->capacity();
+    for (size_t slot = 0; slot < count; slot++)
+    {
+        SnapshotAircraft& entry = aircraft[slot];
+        entry.objectId = m_table.objectIds()[slot];
+        entry.isUser = m_table.isUser()[slot];
+        entry.onGround = m_table.onGround()[slot];
+        entry.latitude = m_table.latitudes()[slot];
+        entry.longitude = m_table.longitudes()[slot];
+        entry.altitude = m_table.altitudes()[slot];
+        entry.trueHeading = m_table.trueHeadings()[slot] * (180 / M_PI);
+        entry.groundSpeed = m_table.groundSpeeds()[slot];
+        entry.verticalSpeed = m_table.verticalSpeeds()[slot];
+        entry.sampleTime = m_table.sampleTimes()[slot];
+        entry.rangeNm = 0;
+        entry.bearingDeg = 0;
+        if (!entry.isUser)
+        {
+            TargetGeometry geometry = m_ownship.solve(entry.latitude, entry.longitude, entry.altitude);
+            entry.rangeNm = geometry.rangeNm;
+            entry.bearingDeg = geometry.bearingDeg;
+        }
+
+        const std::string& title = m_titles.title(m_table.titleIds()[slot]);
+        size_t length = title.size() < sizeof(entry.title) - 1 ? title.size() : sizeof(entry.title) - 1;
+        memcpy(entry.title, title.data(), length);
+        entry.title[length] = '\0';
+    }
+
+    SnapshotInfo info = {};
+    info.sweeps = m_sweeps;
+    info.time = time;
+    info.ownLat = m_ownship.latitude();
+    info.ownLon = m_ownship.longitude();
+    info.ownAlt = m_ownship.altitude();
+    info.count = (uint32_t)count;
+    info.total = (uint32_t)m_table.size();
+    snapshots->publish(info);
+    m_snapshotTime = time;
+}
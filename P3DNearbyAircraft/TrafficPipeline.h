@@ -0,0 +1,160 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <vector>
+
+#include "AircraftInfo.h"
+#include "AsyncOutput.h"
+#include "ConflictDetector.h"
+#include "DecodedMessage.h"
+#include "DeadReckoning.h"
+#include "OwnshipCell.h"
+#include "ReferenceFrame.h"
+#include "SweepAssembler.h"
+#include "TrafficIndex.h"
+#include "TrafficTable.h"
+#include "TitleTable.h"
+#include "TrafficScheduler.h"
+
+struct TrafficMetrics;
+class SnapshotPublisher;
+
+/**
+* Everything the tool does with a SIMOBJECT_DATA_BYTYPE record, independent of where it came from.
+*
+* The dispatch callback, the replay tool and the benchmarks all feed records through here, so a recorded
+* or synthetic session exercises exactly the code that runs against the simulator.
+*
+* Sweep records are collected by a SweepAssembler and processed once the whole sweep is in (or has timed
+* out, see expireSweeps()): geometry is solved over the batch, and the table, report, tiers and conflict
+* probe all see the sweep at once.
+*
+* The ownship comes from the user aircraft's own per-frame request (TRAFFIC_DEFINITION_OWNSHIP), which goes
+* into ownshipCell() as it arrives; every sweep and tracked record is solved against the newest sample in
+* the cell. Until the first sample (or in recordings made without that request) the ownship is taken from
+* the user aircraft record of each sweep instead, with the altitude given to the constructor.
+*
+* Sweeps carry only AircraftState. The first time an ObjectID shows up, its title is still unknown and the
+* ObjectID is queued for takeTitleRequests(); the client asks for that one title and hands the answer to
+* onTitle(), which interns it. Aircraft are reported with an empty title until it arrives.
+*
+* After each sweep the scheduler re-tiers the traffic by range. takeTierChanges() hands the client the
+* aircraft whose per-object request should start, change rate or stop; those requests come back through
+* onTrackedAircraft() between sweeps. A changed-only request sends tagged records carrying just the fields
+* that moved by more than their epsilon; apply() merges those into the aircraft's slot, and drops them for
+* an aircraft no longer in the table, since there is nothing to merge them into.
+*
+* With a SnapshotPublisher attached, the table is published to shared memory after every sweep and, as
+* tracked updates come in, at most every snapshotIntervalSeconds in between.
+*
+* Every sweep also ends with a conflict probe over the whole table, with each aircraft dead-reckoned to the
+* sweep time. Pairs that go into or out of conflict are reported as they change.
+*/
+class TrafficPipeline
+{
+public:
+    TrafficPipeline(AsyncOutput& output, double lat, double lon, double altFt);
+
+    // A raw SIMOBJECT_DATA(_BYTYPE) message for one of the TrafficDefinition layouts. Returns false for anything else or a truncated message.
+    bool onMessage(const void* data, uint32_t size);
+
+    // A message decoded by decodeTrafficMessage(), possibly on another thread. Returns false for DECODED_NONE.
+    bool apply(const DecodedMessage& message);
+
+    // One record of a sweep; entryNumber runs 1..outOf. The sweep is processed when its last record arrives.
+    void onAircraft(uint32_t objectId, uint32_t entryNumber, uint32_t outOf, const AircraftState& state);
+
+    // Same, for the combined definition of older recordings
+    void onAircraft(uint32_t objectId, uint32_t entryNumber, uint32_t outOf, const AircraftInfo& aircraft);
+
+    // A per-object update between sweeps, for an aircraft in TIER_NEAR or TIER_MID
+    void onTrackedAircraft(uint32_t objectId, const AircraftState& state);
+
+    // Process the sweeps still missing records after assembler().timeoutSeconds; call regularly from the thread
+    // that applies messages. Returns how many were processed.
+    size_t expireSweeps();
+
+    // Process every sweep still being collected, complete or not, e.g. at the end of a recording
+    size_t closeSweeps();
+
+    // The answer to a title request
+    void onTitle(uint32_t objectId, const AircraftTitle& title);
+
+    // Move the ObjectIDs whose titles should be requested into out. Returns how many there are.
+    size_t takeTitleRequests(std::vector<uint32_t>& out);
+
+    // Move the tier changes planned since the last call into out. Returns how many there are.
+    size_t takeTierChanges(std::vector<TierChange>& out);
+
+    // Dead-reckoned position of an aircraft at time (on clock()), between or after sweeps. False if it is not in the table.
+    bool predict(uint32_t objectId, double time, PredictedPosition& out) const;
+
+    const OwnshipFrame& ownship() const { return m_ownship; }
+    const OwnshipCell& ownshipCell() const { return m_ownshipCell; }
+    OwnshipCell& ownshipCell() { return m_ownshipCell; }   // TrafficStages stores into it from the receive thread
+    AsyncOutput& output() const { return m_output; }
+    const TrafficTable& table() const { return m_table; }
+    const TrafficIndex& index() const { return m_index; }
+    const TitleTable& titles() const { return m_titles; }
+    const DeadReckoning& predictor() const { return m_predictor; }
+    DeadReckoning& predictor() { return m_predictor; }
+    const TrafficScheduler& scheduler() const { return m_scheduler; }
+    TrafficScheduler& scheduler() { return m_scheduler; }
+    const SweepAssembler& assembler() const { return m_assembler; }
+    SweepAssembler& assembler() { return m_assembler; }
+    const ConflictDetector& conflicts() const { return m_conflicts; }
+    ConflictDetector& conflicts() { return m_conflicts; }
+
+    uint64_t records() const { return m_records; }
+    uint64_t trackedRecords() const { return m_trackedRecords; }
+    uint64_t partialRecords() const { return m_partialRecords; }     // tagged tracked records merged into the table
+    uint64_t partialDropped() const { return m_partialDropped; }     // tagged tracked records for aircraft not in the table
+    uint64_t sweeps() const { return m_sweeps; }
+
+    size_t nearestCount;        // aircraft listed per sweep, besides the user aircraft
+    uint32_t staleSweeps;       // sweeps an aircraft may miss before it leaves the table
+    bool detectConflicts;       // probe traffic-to-traffic conflicts after each sweep
+    TrafficMetrics* metrics;    // records per sweep go here when set; written from the thread that applies messages
+    uint64_t receivedNs;        // monotonicNs() when the messages being applied arrived, stamped on their report records
+    SnapshotPublisher* snapshots;       // publish the table here when set
+    double snapshotIntervalSeconds;     // between sweeps, tracked updates are published no more often than this
+    double (*clock)();          // seconds; each sweep is stamped with it when its first record arrives
+
+private:
+    void sweepRecord(const DecodedMessage& message);
+    size_t processSweeps();
+    void processSweep(AssembledSweep& sweep);
+    bool solvedFromOwnship(const DecodedMessage& message) const;
+    bool refreshOwnship();
+    void record(uint32_t objectId, const AircraftState& state, const char* title, double sampleTime, const TargetGeometry* geometry);
+    void endSweep();
+    void probeConflicts();
+    void publishSnapshot(double time);
+
+    AsyncOutput& m_output;
+    OwnshipFrame m_ownship;
+    OwnshipCell m_ownshipCell;
+    TrafficTable m_table;
+    TrafficIndex m_index;
+    TitleTable m_titles;
+    DeadReckoning m_predictor;
+    TrafficScheduler m_scheduler;
+    SweepAssembler m_assembler;
+    std::vector<TierChange> m_tierChanges;
+    std::vector<TierChange> m_planned;
+    ConflictDetector m_conflicts;
+    std::vector<ConflictAlert> m_alerts;
+    std::vector<double> m_sweepLatitudes;     // the table dead-reckoned to the sweep time
+    std::vector<double> m_sweepLongitudes;
+    std::vector<double> m_sweepAltitudes;
+    double m_sweepTime;
+    double m_snapshotTime;
+    std::vector<uint32_t> m_titleRequests;
+    uint64_t m_records;
+    uint64_t m_trackedRecords;
+    uint64_t m_partialRecords;
+    uint64_t m_partialDropped;
+    uint64_t m_sweeps;
+};
@@ -0,0 +1,199 @@
+#include <stdio.h>
+#include <string.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+#include "TrafficRecorder.h"
+
+TrafficRecorder::TrafficRecorder()
+    : m_chunkSize(0)
+    , m_sequence(0)
+    , m_view(NULL)
+    , m_fileEnd(0)
+    , m_records(0)
+    , m_dropped(0)
+#ifdef _WIN32
+    , m_file(INVALID_HANDLE_VALUE)
+    , m_mapping(NULL)
+#else
+    , m_file(-1)
+#endif
+{
+}
+
+TrafficRecorder::~TrafficRecorder()
+{
+    close();
+}
+
+bool TrafficRecorder::open(const char* path, uint32_t chunkSize)
+{
+    close();
+    if (chunkSize <= sizeof(TrafficChunkHeader) || chunkSize % (64 * 1024) != 0)
+        return false;
+
+#ifdef _WIN32
+    m_file = CreateFileA(path, GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ, NULL, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (m_file == INVALID_HANDLE_VALUE)
+        return false;
+#else
+    m_file = ::open(path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (m_file < 0)
+        return false;
+#endif
+
+    m_chunkSize = chunkSize;
+    m_records = 0;
+    m_dropped = 0;
+    m_start = std::chrono::steady_clock::now();
+    if (!mapChunk(0))
+    {
+        close();
+        return false;
+    }
+    return true;
+}
+
+/**
+* Grow the file to hold chunk sequence, map it and write a fresh header.
+*/
+bool TrafficRecorder::mapChunk(uint32_t sequence)
+{
+    uint64_t offset = (uint64_t)sequence * m_chunkSize;
+    uint64_t end = offset + m_chunkSize;
+
+#ifdef _WIN32
+    m_mapping = CreateFileMappingA(m_file, NULL, PAGE_READWRITE, (DWORD)(end >> 32), (DWORD)end, NULL);
+    if (!m_mapping)
+        return false;
+    m_view = (uint8_t*)MapViewOfFile(m_mapping, FILE_MAP_WRITE, (DWORD)(offset >> 32), (DWORD)offset, m_chunkSize);
+    if (!m_view)
+    {
+        CloseHandle(m_mapping);
+        m_mapping = NULL;
+        return false;
+    }
+#else
+    if (ftruncate(m_file, (off_t)end) != 0)
+        return false;
+    void* view = mmap(NULL, m_chunkSize, PROT_READ | PROT_WRITE, MAP_SHARED, m_file, (off_t)offset);
+    if (view == MAP_FAILED)
+        return false;
+    m_view = (uint8_t*)view;
+#endif
+
+    TrafficChunkHeader header = {};
+    header.magic = TRAFFIC_CHUNK_MAGIC;
+    header.version = TRAFFIC_LOG_VERSION;
+    header.headerSize = sizeof(header);
+    header.chunkSize = m_chunkSize;
+    header.sequence = sequence;
+    memcpy(m_view, &header, sizeof(header));
+
+    m_sequence = sequence;
+    m_fileEnd = offset + sizeof(header);
+    return true;
+}
+
+void TrafficRecorder::sealChunk()
+{
+    TrafficChunkHeader* header = (TrafficChunkHeader*)m_view;
+    header->crc32 = crc32(m_view + sizeof(TrafficChunkHeader), header->payloadBytes);
+    header->sealed = 1;
+}
+
+void TrafficRecorder::unmapChunk()
+{
+    if (!m_view)
+        return;
+
+#ifdef _WIN32
+    UnmapViewOfFile(m_view);
+    CloseHandle(m_mapping);
+    m_mapping = NULL;
+#else
+    munmap(m_view, m_chunkSize);
+#endif
+    m_view = NULL;
+}
+
+bool TrafficRecorder::append(const void* data, uint32_t size)
+{
+    uint64_t timestampNs = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - m_start).count();
+    return append(data, size, timestampNs);
+}
+
+bool TrafficRecorder::append(const void* data, uint32_t size, uint64_t timestampNs)
+{
+    uint64_t span = trafficRecordSpan(size);
+    if (!m_view || sizeof(TrafficChunkHeader) + span > m_chunkSize)
+    {
+        m_dropped++;
+        return false;
+    }
+
+    TrafficChunkHeader* header = (TrafficChunkHeader*)m_view;
+    if (sizeof(TrafficChunkHeader) + header->payloadBytes + span > m_chunkSize)
+    {
+        sealChunk();
+        unmapChunk();
+        if (!mapChunk(m_sequence + 1))
+        {
+            m_dropped++;
+            return false;
+        }
+        header = (TrafficChunkHeader*)m_view;
+    }
+
+    uint8_t* out = m_view + sizeof(TrafficChunkHeader) + header->payloadBytes;
+    TrafficRecordHeader record = { timestampNs, size, 0 };
+    memcpy(out, &record, sizeof(record));
+    memcpy(out + sizeof(record), data, size);
+    memset(out + sizeof(record) + size, 0, span - sizeof(record) - size);
+
+    if (header->recordCount == 0)
+        header->firstTimestampNs = timestampNs;
+    header->lastTimestampNs = timestampNs;
+    header->recordCount++;
+    header->payloadBytes += (uint32_t)span;
+
+    m_fileEnd += span;
+    m_records++;
+    return true;
+}
+
+void TrafficRecorder::close()
+{
+    if (m_view)
+    {
+        sealChunk();
+        unmapChunk();
+    }
+
+#ifdef _WIN32
+    if (m_file != INVALID_HANDLE_VALUE)
+    {
+        LARGE_INTEGER end;
+        end.QuadPart = (LONGLONG)m_fileEnd;
+        SetFilePointerEx(m_file, end, NULL, FILE_BEGIN);
+        SetEndOfFile(m_file);
+        CloseHandle(m_file);
+        m_file = INVALID_HANDLE_VALUE;
+    }
+#else
+    if (m_file >= 0)
+    {
+        // If the trim fails the records are still intact; the reader skips the zero tail as a bad chunk
+        if (ftruncate(m_file, (off_t)m_fileEnd) != 0)
+            perror("TrafficRecorder");
+        ::close(m_file);
+        m_file = -1;
+    }
+#endif
+}
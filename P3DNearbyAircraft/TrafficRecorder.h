@@ -0,0 +1,55 @@
+#pragma once
+
+#include <chrono>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "TrafficLog.h"
+
+/**
+* Appends raw SimConnect messages to a recording (see TrafficLog.h for the format).
+*
+* Only the chunk being filled is mapped; append() is a memcpy into it, so recording costs the dispatch
+* thread no system call except when a chunk fills up and the next one is mapped. close() seals the last
+* chunk and trims the file to the bytes actually written.
+*/
+class TrafficRecorder
+{
+public:
+    TrafficRecorder();
+    ~TrafficRecorder();
+
+    bool open(const char* path, uint32_t chunkSize = TRAFFIC_CHUNK_SIZE);
+    void close();
+    bool isOpen() const { return m_view != NULL; }
+
+    // Record one message stamped with the time since open(). Returns false if it was not recorded.
+    bool append(const void* data, uint32_t size);
+
+    // Same, with an explicit timestamp (for tools that convert or generate recordings)
+    bool append(const void* data, uint32_t size, uint64_t timestampNs);
+
+    uint64_t records() const { return m_records; }
+    uint64_t dropped() const { return m_dropped; }
+    uint64_t bytesWritten() const { return m_fileEnd; }
+
+private:
+    bool mapChunk(uint32_t sequence);
+    void sealChunk();
+    void unmapChunk();
+
+    std::chrono::steady_clock::time_point m_start;
+    uint32_t m_chunkSize;
+    uint32_t m_sequence;
+    uint8_t* m_view;                // mapped chunk, starting with its TrafficChunkHeader
+    uint64_t m_fileEnd;             // offset just past the last byte written
+    uint64_t m_records;
+    uint64_t m_dropped;
+
+#ifdef _WIN32
+    void* m_file;
+    void* m_mapping;
+#else
+    int m_file;
+#endif
+};
@@ -0,0 +1,72 @@
+#include <algorithm>
+
+#include "TrafficScheduler.h"
+
+TrafficScheduler::TrafficScheduler(const TierSettings& settings)
+    : m_settings(settings)
+    , m_near(0)
+    , m_mid(0)
+{
+}
+
+TrafficTier TrafficScheduler::tierOf(uint32_t objectId) const
+{
+    auto found = m_tiers.find(objectId);
+    return found == m_tiers.end() ? TIER_FAR : found->second;
+}
+
+size_t TrafficScheduler::plan(const TrafficTable& table, const TrafficIndex& index, double ownLat, double ownLon, std::vector<TierChange>& changes)
+{
+    changes.clear();
+    double keepNear = m_settings.nearNm * (1 + m_settings.hysteresis);
+    double keepMid = m_settings.midNm * (1 + m_settings.hysteresis);
+
+    // Everything that could be in a per-object tier, closest first so the caps keep the closest
+    index.withinRadius(ownLat, ownLon, keepMid, m_candidates);
+    std::sort(m_candidates.begin(), m_candidates.end(), [](const TrafficNeighbor& a, const TrafficNeighbor& b) { return a.rangeNm < b.rangeNm; });
+
+    m_next.clear();
+    size_t nearCount = 0;
+    size_t midCount = 0;
+    for (const TrafficNeighbor& candidate : m_candidates)
+    {
+        size_t slot = table.find(candidate.objectId);
+        if (slot == TrafficTable::NOT_FOUND || table.isUser()[slot])
+            continue;
+
+        TrafficTier current = tierOf(candidate.objectId);
+        TrafficTier wanted = TIER_FAR;
+        if (candidate.rangeNm <= m_settings.nearNm || (current == TIER_NEAR && candidate.rangeNm <= keepNear))
+            wanted = TIER_NEAR;
+        else if (candidate.rangeNm <= m_settings.midNm || (current >= TIER_MID && candidate.rangeNm <= keepMid))
+            wanted = TIER_MID;
+
+        if (wanted == TIER_NEAR && nearCount == m_settings.maxNear)
+            wanted = TIER_MID;
+        if (wanted == TIER_MID && midCount == m_settings.maxMid)
+            wanted = TIER_FAR;
+
+        if (wanted == TIER_NEAR)
+            nearCount++;
+        else if (wanted == TIER_MID)
+            midCount++;
+        else
+            continue;
+
+        m_next[candidate.objectId] = wanted;
+        if (wanted != current)
+            changes.push_back({ candidate.objectId, current, wanted });
+    }
+
+    // Whatever had a tier and did not get one again drops to the wide sweeps
+    for (const auto& entry : m_tiers)
+    {
+        if (m_next.find(entry.first) == m_next.end())
+            changes.push_back({ entry.first, entry.second, TIER_FAR });
+    }
+
+    m_tiers.swap(m_next);
+    m_near = nearCount;
+    m_mid = midCount;
+    return changes.size();
+}
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <unordered_map>
+#include <vector>
+
+#include "TrafficIndex.h"
+#include "TrafficTable.h"
+
+/**
+* How often an aircraft is refreshed, by range from the user aircraft.
+*/
+enum TrafficTier : uint8_t
+{
+    TIER_FAR,       // only through the wide sweeps
+    TIER_MID,       // its own request, once a second
+    TIER_NEAR,      // its own request, every few sim frames
+};
+
+struct TierSettings
+{
+    double nearNm;                  // closer than this: TIER_NEAR
+    double midNm;                   // closer than this: TIER_MID
+    double hysteresis;              // an aircraft keeps its tier until it is this fraction beyond the edge
+    uint32_t nearFrameInterval;     // sim frames skipped between TIER_NEAR updates (SimConnect's interval)
+    uint32_t maxNear;               // per-object requests are limited; the closest win
+    uint32_t maxMid;
+    uint32_t farSweepMs;            // interval of the wide sweeps that cover TIER_FAR and find new aircraft
+};
+
+constexpr TierSettings DEFAULT_TIER_SETTINGS = { 2, 5, 0.1, 5, 16, 64, 5000 };
+
+/**
+* An aircraft that should move from one tier to another. The client turns it into a per-object request
+* (TIER_NEAR, TIER_MID) or cancels the per-object request (TIER_FAR).
+*/
+struct TierChange
+{
+    uint32_t objectId;
+    TrafficTier from;
+    TrafficTier to;
+};
+
+/**
+* Places the aircraft of each sweep into range tiers, so close traffic gets frequent per-object updates and
+* far traffic waits for the next wide sweep.
+*
+* plan() runs after every sweep over the sweep's spatial index. An aircraft is promoted as soon as it
+* crosses into a tier and only demoted once it is hysteresis beyond the edge, so traffic hovering at a
+* boundary does not flap between request rates. Aircraft that have left the table fall back to TIER_FAR,
+* which cancels their request.
+*/
+class TrafficScheduler
+{
+public:
+    explicit TrafficScheduler(const TierSettings& settings = DEFAULT_TIER_SETTINGS);
+
+    // Re-tier every aircraft around the ownship; the user aircraft (isUser) always stays TIER_FAR. Returns changes.size().
+    size_t plan(const TrafficTable& table, const TrafficIndex& index, double ownLat, double ownLon, std::vector<TierChange>& changes);
+
+    TrafficTier tierOf(uint32_t objectId) const;
+    size_t count(TrafficTier tier) const { return tier == TIER_NEAR ? m_near : (tier == TIER_MID ? m_mid : 0); }
+
+    const TierSettings& settings() const { return m_settings; }
+    void setSettings(const TierSettings& settings) { m_settings = settings; }
+
+private:
+    TierSettings m_settings;
+    std::unordered_map<uint32_t, TrafficTier> m_tiers;     // TIER_NEAR and TIER_MID only
+    std::unordered_map<uint32_t, TrafficTier> m_next;
+    std::vector<TrafficNeighbor> m_candidates;
+    size_t m_near;
+    size_t m_mid;
+};
@@ -0,0 +1,283 @@
+#include <stdio.h>
+#include <string.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "TrafficSnapshot.h"
+
+static const size_t SNAPSHOT_ALIGN = 64;        // keep every buffer header on its own cache line
+
+static size_t alignUp(size_t size)
+{
+    return (size + SNAPSHOT_ALIGN - 1) & ~(SNAPSHOT_ALIGN - 1);
+}
+
+static size_t bufferBytes(uint32_t capacity)
+{
+    return alignUp(alignUp(sizeof(SnapshotBufferHeader)) + (size_t)capacity * sizeof(SnapshotAircraft));
+}
+
+static SnapshotBufferHeader* bufferAt(uint8_t* region, uint64_t publish)
+{
+    const SnapshotRegionHeader* header = (const SnapshotRegionHeader*)region;
+    return (SnapshotBufferHeader*)(region + alignUp(sizeof(SnapshotRegionHeader)) + (publish % header->buffers) * header->bufferBytes);
+}
+
+static SnapshotAircraft* aircraftOf(SnapshotBufferHeader* buffer)
+{
+    return (SnapshotAircraft*)((uint8_t*)buffer + alignUp(sizeof(SnapshotBufferHeader)));
+}
+
+SharedRegion::SharedRegion()
+    : m_view(NULL)
+    , m_size(0)
+    , m_owner(false)
+#ifdef _WIN32
+    , m_mapping(NULL)
+#endif
+{
+    m_name[0] = '\0';
+}
+
+SharedRegion::~SharedRegion()
+{
+    close();
+}
+
+bool SharedRegion::create(const char* name, size_t size)
+{
+    close();
+#ifdef _WIN32
+    m_mapping = CreateFileMappingA(INVALID_HANDLE_VALUE, NULL, PAGE_READWRITE, (DWORD)((uint64_t)size >> 32), (DWORD)size, name);
+    if (!m_mapping)
+        return false;
+    m_view = (uint8_t*)MapViewOfFile(m_mapping, FILE_MAP_ALL_ACCESS, 0, 0, size);
+    if (!m_view)
+    {
+        close();
+        return false;
+    }
+#else
+    snprintf(m_name, sizeof(m_name), "/%s", name);
+    int file = shm_open(m_name, O_RDWR | O_CREAT, 0644);
+    if (file < 0)
+        return false;
+    m_owner = true;
+    void* view = ftruncate(file, (off_t)size) == 0 ? mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, file, 0) : MAP_FAILED;
+    ::close(file);
+    if (view == MAP_FAILED)
+    {
+        close();
+        return false;
+    }
+    m_view = (uint8_t*)view;
+#endif
+    m_size = size;
+    return true;
+}
+
+bool SharedRegion::openExisting(const char* name)
+{
+    close();
+#ifdef _WIN32
+    m_mapping = OpenFileMappingA(FILE_MAP_READ, FALSE, name);
+    if (!m_mapping)
+        return false;
+    m_view = (uint8_t*)MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0);
+    MEMORY_BASIC_INFORMATION region;
+    if (!m_view || VirtualQuery(m_view, &region, sizeof(region)) == 0)
+    {
+        close();
+        return false;
+    }
+    m_size = region.RegionSize;
+#else
+    snprintf(m_name, sizeof(m_name), "/%s", name);
+    int file = shm_open(m_name, O_RDONLY, 0);
+    if (file < 0)
+        return false;
+    struct stat status;
+    void* view = MAP_FAILED;
+    if (fstat(file, &status) == 0 && status.st_size > 0)
+        view = mmap(NULL, (size_t)status.st_size, PROT_READ, MAP_SHARED, file, 0);
+    ::close(file);
+    if (view == MAP_FAILED)
+        return false;
+    m_view = (uint8_t*)view;
+    m_size = (size_t)status.st_size;
+#endif
+    return true;
+}
+
+void SharedRegion::close()
+{
+#ifdef _WIN32
+    if (m_view)
+        UnmapViewOfFile(m_view);
+    if (m_mapping)
+        CloseHandle(m_mapping);
+    m_mapping = NULL;
+#else
+    if (m_view)
+        munmap(m_view, m_size);
+    if (m_owner)
+        shm_unlink(m_name);
+#endif
+    m_view = NULL;
+    m_size = 0;
+    m_owner = false;
+}
+
+SnapshotPublisher::SnapshotPublisher()
+    : m_publish(0)
+    , m_writing(NULL)
+{
+}
+
+bool SnapshotPublisher::open(const char* name, uint32_t capacity)
+{
+    size_t perBuffer = bufferBytes(capacity);
+    if (capacity == 0 || !m_region.create(name, alignUp(sizeof(SnapshotRegionHeader)) + SNAPSHOT_BUFFERS * perBuffer))
+        return false;
+
+    // A region left behind by an earlier run (still mapped by a reader) is taken over and reset
+    SnapshotRegionHeader* header = (SnapshotRegionHeader*)m_region.data();
+    header->latest.store(0, std::memory_order_release);
+    header->magic = SNAPSHOT_MAGIC;
+    header->version = SNAPSHOT_VERSION;
+    header->capacity = capacity;
+    header->buffers = SNAPSHOT_BUFFERS;
+    header->bufferBytes = perBuffer;
+    for (uint32_t buffer = 0; buffer < SNAPSHOT_BUFFERS; buffer++)
+        bufferAt(m_region.data(), buffer)->sequence.store(0, std::memory_order_release);
+    m_publish = 0;
+    m_writing = NULL;
+    return true;
+}
+
+uint32_t SnapshotPublisher::capacity() const
+{
+    return isOpen() ? ((const SnapshotRegionHeader*)m_region.data())->capacity : 0;
+}
+
+SnapshotAircraft* SnapshotPublisher::begin()
+{
+    if (!isOpen())
+        return NULL;
+
+    // Odd while writing; readers that started on this buffer see the change at end()
+    m_writing = bufferAt(m_region.data(), m_publish + 1);
+    uint64_t sequence = m_writing->sequence.load(std::memory_order_relaxed);
+    m_writing->sequence.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    return aircraftOf(m_writing);
+}
+
+void SnapshotPublisher::publish(const SnapshotInfo& info)
+{
+    if (!m_writing)
+        return;
+
+    m_publish++;
+    m_writing->info = info;
+    m_writing->info.publish = m_publish;
+    if (m_writing->info.count > capacity())
+        m_writing->info.count = capacity();
+    m_writing->sequence.store(m_writing->sequence.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    ((SnapshotRegionHeader*)m_region.data())->latest.store(m_publish, std::memory_order_release);
+    m_writing = NULL;
+}
+
+SnapshotReader::SnapshotReader()
+    : m_reading(NULL)
+    , m_sequence(0)
+    , m_retries(0)
+{
+}
+
+bool SnapshotReader::open(const char* name)
+{
+    if (!m_region.openExisting(name))
+        return false;
+
+    // security check: the layout must be ours and fit in what was mapped
+    const SnapshotRegionHeader* header = (const SnapshotRegionHeader*)m_region.data();
+    if (m_region.size() < sizeof(SnapshotRegionHeader) || header->magic != SNAPSHOT_MAGIC || header->version != SNAPSHOT_VERSION ||
+        header->buffers == 0 || header->bufferBytes < bufferBytes(header->capacity) ||
+        m_region.size() < alignUp(sizeof(SnapshotRegionHeader)) + header->buffers * header->bufferBytes)
+    {
+        m_region.close();
+        return false;
+    }
+    return true;
+}
+
+uint64_t SnapshotReader::latest() const
+{
+    return isOpen() ? ((const SnapshotRegionHeader*)m_region.data())->latest.load(std::memory_order_acquire) : 0;
+}
+
+const SnapshotInfo* SnapshotReader::begin(const SnapshotAircraft*& aircraft)
+{
+    m_reading = NULL;
+    uint64_t publish = latest();
+    if (publish == 0)
+        return NULL;
+
+    SnapshotBufferHeader* buffer = bufferAt(m_region.data(), publish);
+    uint64_t sequence = buffer->sequence.load(std::memory_order_acquire);
+    if (sequence & 1)
+    {
+        // The writer has lapped us and is already refilling this buffer
+        m_retries++;
+        return NULL;
+    }
+    m_reading = buffer;
+    m_sequence = sequence;
+    aircraft = aircraftOf(buffer);
+    return &buffer->info;
+}
+
+bool SnapshotReader::end()
+{
+    if (!m_reading)
+        return false;
+
+    std::atomic_thread_fence(std::memory_order_acquire);
+    bool unchanged = m_reading->sequence.load(std::memory_order_relaxed) == m_sequence;
+    m_reading = NULL;
+    if (!unchanged)
+        m_retries++;
+    return unchanged;
+}
+
+bool SnapshotReader::read(SnapshotInfo& info, std::vector<SnapshotAircraft>& aircraft, int maxAttempts)
+{
+    uint32_t capacity = isOpen() ? ((const SnapshotRegionHeader*)m_region.data())->capacity : 0;
+    for (int attempt = 0; attempt < maxAttempts; attempt++)
+    {
+        const SnapshotAircraft* entries;
+        const SnapshotInfo* snapshot = begin(entries);
+        if (!snapshot)
+        {
+            if (latest() == 0)
+                return false;
+            continue;
+        }
+
+        info = *snapshot;
+        uint32_t count = info.count < capacity ? info.count : capacity;     // may be torn until end()
+        aircraft.resize(count);
+        memcpy(aircraft.data(), entries, count * sizeof(SnapshotAircraft));
+        if (end())
+            return true;
+    }
+    return false;
+}
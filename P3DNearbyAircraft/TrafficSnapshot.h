@@ -0,0 +1,179 @@
+#pragma once
+
+#include <atomic>
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+/**
+* The traffic picture as P3DNearbyAircraft publishes it into shared memory, for local tools (moving map,
+* logger, ATC console) that would otherwise each open SimConnect and run the same radius query.
+*
+* The region holds SNAPSHOT_BUFFERS snapshot buffers after a SnapshotRegionHeader. Publish n is written into
+* buffer n % SNAPSHOT_BUFFERS, under that buffer's own sequence counter (odd while it is being written),
+* and only then announced in the header's latest. A reader takes the latest buffer, notes its sequence,
+* reads the aircraft in place and checks the sequence again: unchanged means nothing it read was being
+* written. With three buffers the writer comes back to a buffer two publishes later, so a reader has a whole
+* publish interval to finish before it has to retry.
+*
+* Only this file and TrafficSnapshot.cpp are needed to read the region; they have no SimConnect dependency.
+*/
+
+constexpr uint32_t SNAPSHOT_MAGIC = 0x50414E53;        // "SNAP"
+constexpr uint32_t SNAPSHOT_VERSION = 1;
+constexpr uint32_t SNAPSHOT_BUFFERS = 3;
+constexpr size_t SNAPSHOT_TITLE_LENGTH = 128;           // longer titles are truncated
+constexpr uint32_t DEFAULT_SNAPSHOT_CAPACITY = 8192;
+constexpr const char* DEFAULT_SNAPSHOT_NAME = "P3DNearbyAircraftTraffic";
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free, "the sequence counters are shared between processes");
+
+/**
+* One aircraft in a snapshot. Positions are the latest sample, taken at sampleTime; dead-reckon with the
+* velocities to show it at another moment.
+*/
+struct SnapshotAircraft
+{
+    uint32_t objectId;
+    uint8_t isUser;
+    uint8_t onGround;
+    uint8_t reserved[2];
+    double latitude;            // degrees
+    double longitude;
+    double altitude;            // feet
+    double trueHeading;         // degrees
+    double groundSpeed;         // knots
+    double verticalSpeed;       // feet per minute
+    double sampleTime;          // seconds, on the publisher's clock
+    double rangeNm;             // from the ownship; 0 for the user aircraft
+    double bearingDeg;
+    char title[SNAPSHOT_TITLE_LENGTH];  // empty until the title has been received
+};
+
+/**
+* What a snapshot describes, apart from its aircraft.
+*/
+struct SnapshotInfo
+{
+    uint64_t publish;           // 1 for the first snapshot published
+    uint64_t sweeps;            // wide sweeps processed so far
+    double time;                // seconds, on the publisher's clock
+    double ownLat;
+    double ownLon;
+    double ownAlt;
+    uint32_t count;             // aircraft in the snapshot
+    uint32_t total;             // aircraft in the publisher's table; more than count when capacity ran out
+};
+
+struct SnapshotRegionHeader
+{
+    uint32_t magic;
+    uint32_t version;
+    uint32_t capacity;          // aircraft per buffer
+    uint32_t buffers;
+    uint64_t bufferBytes;
+    std::atomic<uint64_t> latest;   // the newest complete publish; 0 before the first
+};
+
+struct SnapshotBufferHeader
+{
+    std::atomic<uint64_t> sequence; // odd while the buffer is being written
+    SnapshotInfo info;
+};
+
+/**
+* A named shared memory region: a file mapping on Windows, POSIX shared memory elsewhere.
+*/
+class SharedRegion
+{
+public:
+    SharedRegion();
+    ~SharedRegion();
+
+    bool create(const char* name, size_t size);
+    bool openExisting(const char* name);
+    void close();
+
+    uint8_t* data() const { return m_view; }
+    size_t size() const { return m_size; }
+
+private:
+    SharedRegion(const SharedRegion&) = delete;
+    SharedRegion& operator=(const SharedRegion&) = delete;
+
+    uint8_t* m_view;
+    size_t m_size;
+    bool m_owner;
+    char m_name[128];
+#ifdef _WIN32
+    void* m_mapping;
+#endif
+};
+
+/**
+* Writes snapshots into the region; one writer thread. begin() hands out the aircraft array of the next
+* buffer to fill in place, and publish() makes it the latest.
+*/
+class SnapshotPublisher
+{
+public:
+    SnapshotPublisher();
+
+    bool open(const char* name = DEFAULT_SNAPSHOT_NAME, uint32_t capacity = DEFAULT_SNAPSHOT_CAPACITY);
+    void close() { m_region.close(); }
+    bool isOpen() const { return m_region.data() != NULL; }
+
+    uint32_t capacity() const;
+
+    // capacity() entries to fill; valid until publish()
+    SnapshotAircraft* begin();
+    void publish(const SnapshotInfo& info);
+
+    uint64_t published() const { return m_publish; }
+
+private:
+    SharedRegion m_region;
+    uint64_t m_publish;
+    SnapshotBufferHeader* m_writing;
+};
+
+/**
+* Reads snapshots in place.
+*
+*   const SnapshotAircraft* aircraft;
+*   const SnapshotInfo* info = reader.begin(aircraft);
+*   ... use info->count entries of aircraft ...
+*   if (!reader.end()) discard what was read and try again
+*
+* Until end() returns true the data may be torn, so decide nothing on it before then. read() does the
+* retrying and copies the snapshot out, for callers that want to keep it.
+*/
+class SnapshotReader
+{
+public:
+    SnapshotReader();
+
+    bool open(const char* name = DEFAULT_SNAPSHOT_NAME);
+    void close() { m_region.close(); }
+    bool isOpen() const { return m_region.data() != NULL; }
+
+    // Number of the newest snapshot (0 before the first), to poll for a new one cheaply
+    uint64_t latest() const;
+
+    // The newest snapshot, or NULL if none has been published or the writer is in the buffer right now
+    const SnapshotInfo* begin(const SnapshotAircraft*& aircraft);
+
+    // True if the snapshot from begin() was not touched by the writer while it was read
+    bool end();
+
+    // A consistent copy of the newest snapshot, retrying up to maxAttempts times. Returns false if there was none.
+    bool read(SnapshotInfo& info, std::vector<SnapshotAircraft>& aircraft, int maxAttempts = 100);
+
+    uint64_t retries() const { return m_retries; }
+
+private:
+    SharedRegion m_region;
+    const SnapshotBufferHeader* m_reading;
+    uint64_t m_sequence;
+    uint64_t m_retries;
+};
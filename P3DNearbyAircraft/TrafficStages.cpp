@@ -0,0 +1,450 @@
+#include <chrono>
+#include <stddef.h>
+#include <string.h>
+
+#include "TrafficStages.h"
+#include "TrafficMessage.h"
+#include "TrafficMetrics.h"
+
+static const int IDLE_WAIT_US = 200;        // an empty stage sleeps this long between polls; traffic arrives in bursts
+
+// Every counter has a single writer, so a load/store pair is enough
+static void addTo(std::atomic<uint64_t>& counter, uint64_t amount)
+{
+    counter.store(counter.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+}
+
+static void raiseTo(std::atomic<uint64_t>& highWater, uint64_t depth)
+{
+    if (depth > highWater.load(std::memory_order_relaxed))
+        highWater.store(depth, std::memory_order_relaxed);
+}
+
+static uint32_t workersFor(const StageSettings& settings)
+{
+    if (settings.workers != 0)
+        return settings.workers;
+
+    unsigned cores = std::thread::hardware_concurrency();
+    return cores > 3 ? cores - 3 : 1;
+}
+
+TrafficStages::TrafficStages(TrafficPipeline& pipeline, const StageSettings& settings)
+    : m_pipeline(pipeline)
+    , m_settings(settings)
+    , m_metrics(NULL)
+    , m_pool(settings.batchesInFlight > 2 ? settings.batchesInFlight : 2)
+    , m_free(m_pool.size())
+    , m_stopping(false)
+    , m_filling(NULL)
+    , m_submitted(0)
+    , m_batchStart(0)
+    , m_ownLat(pipeline.ownship().latitude())
+    , m_ownLon(pipeline.ownship().longitude())
+    , m_ownAlt(pipeline.ownship().altitude())
+    , m_committed(0)
+    , m_receiveCounters()
+    , m_computeCounters(workersFor(settings))
+    , m_commitCounters()
+{
+    if (m_settings.batchMessages == 0)
+        m_settings.batchMessages = 1;
+
+    // Every ring can hold the whole pool, so pushes between stages never fail; only the pool runs dry
+    for (size_t worker = 0; worker < m_computeCounters.size(); worker++)
+    {
+        m_work.emplace_back(new SpscRing<Batch*>(m_pool.size()));
+        m_done.emplace_back(new SpscRing<Batch*>(m_pool.size()));
+    }
+    for (Batch& batch : m_pool)
+    {
+        batch.bytes.reserve(m_settings.batchMessages * (sizeof(TrafficMessageHeader) + sizeof(AircraftState)));
+        batch.ends.reserve(m_settings.batchMessages);
+        batch.decoded.reserve(m_settings.batchMessages);
+        m_free.tryPush(&batch);
+    }
+}
+
+TrafficStages::~TrafficStages()
+{
+    stop();
+}
+
+void TrafficStages::start()
+{
+    if (running())
+        return;
+
+    m_stopping.store(false);
+    for (size_t worker = 0; worker < m_work.size(); worker++)
+        m_threads.emplace_back(&TrafficStages::workerLoop, this, worker);
+    m_threads.emplace_back(&TrafficStages::commitLoop, this);
+}
+
+void TrafficStages::stop()
+{
+    if (!running())
+        return;
+
+    drain();
+    m_stopping.store(true, std::memory_order_release);
+    for (std::thread& thread : m_threads)
+        thread.join();
+    m_threads.clear();
+}
+
+void TrafficStages::submit(const void* data, uint32_t size)
+{
+    if (m_metrics)
+    {
+        m_metrics->messages.add(1);
+        m_metrics->bytes.add(size);
+    }
+
+    if (!running())
+    {
+        uint64_t received = monotonicNs();
+        m_pipeline.receivedNs = received;
+        m_pipeline.onMessage(data, size);
+        if (m_metrics)
+            m_metrics->commitNs.record(monotonicNs() - received);
+        return;
+    }
+
+    // The ownship skips the queue: workers and commit read the newest sample straight from the cell
+    const uint8_t* bytes = (const uint8_t*)data;
+    if (storeOwnship(bytes, size))
+        return;
+
+    if (!m_filling)
+        m_filling = nextFreeBatch();
+
+    m_filling->bytes.insert(m_filling->bytes.end(), bytes, bytes + size);
+    m_filling->ends.push_back((uint32_t)m_filling->bytes.size());
+    trackOwnship(bytes, size);
+
+    if (m_filling->ends.size() >= m_settings.batchMessages)
+        flush();
+}
+
+void TrafficStages::flush()
+{
+    if (!running())
+    {
+        m_pipeline.expireSweeps();
+        return;
+    }
+    if (!m_filling)
+        return;
+
+    Batch* batch = m_filling;
+    m_filling = NULL;
+    m_work[m_submitted % m_work.size()]->tryPush(batch);
+    m_submitted++;
+
+    addTo(m_receiveCounters.batches, 1);
+    addTo(m_receiveCounters.messages, batch->ends.size());
+    addTo(m_receiveCounters.busyNs, monotonicNs() - m_batchStart);
+    raiseTo(m_receiveCounters.highWater, m_submitted - m_committed.load(std::memory_order_acquire));
+}
+
+void TrafficStages::drain()
+{
+    flush();
+    while (running() && m_committed.load(std::memory_order_acquire) < m_submitted)
+        std::this_thread::yield();
+}
+
+size_t TrafficStages::takeTitleRequests(std::vector<uint32_t>& out)
+{
+    if (!running())
+        return m_pipeline.takeTitleRequests(out);
+
+    out.clear();
+    std::lock_guard<std::mutex> lock(m_requestLock);
+    out.swap(m_titleRequests);
+    return out.size();
+}
+
+size_t TrafficStages::takeTierChanges(std::vector<TierChange>& out)
+{
+    if (!running())
+        return m_pipeline.takeTierChanges(out);
+
+    out.clear();
+    std::lock_guard<std::mutex> lock(m_requestLock);
+    out.swap(m_tierChanges);
+    return out.size();
+}
+
+void TrafficStages::stats(std::vector<StageStats>& out) const
+{
+    out.clear();
+    uint64_t committed = m_committed.load(std::memory_order_acquire);
+    out.push_back(stageStats("receive", 0, m_receiveCounters, m_submitted - committed));
+    size_t finished = 0;
+    for (size_t worker = 0; worker < m_work.size(); worker++)
+    {
+        out.push_back(stageStats("compute", (uint32_t)worker + 1, m_computeCounters[worker], m_work[worker]->size()));
+        finished += m_done[worker]->size();
+    }
+    out.push_back(stageStats("commit", 0, m_commitCounters, finished));
+
+    // The writer is not one of ours, but it is the last stage; its queue is counted in records, not batches
+    OutputStats output = m_pipeline.output().stats();
+    out.back().stalledNs += output.blockedNs;
+    StageStats writer = {};
+    writer.name = "output";
+    writer.batches = output.batches;
+    writer.messages = output.written;
+    writer.busyNs = output.busyNs;
+    writer.queued = output.queued - output.written;
+    writer.highWater = output.highWater;
+    out.push_back(writer);
+}
+
+StageStats TrafficStages::stageStats(const char* name, uint32_t instance, const Counters& counters, uint64_t queued)
+{
+    StageStats stats;
+    stats.name = name;
+    stats.instance = instance;
+    stats.batches = counters.batches.load(std::memory_order_relaxed);
+    stats.messages = counters.messages.load(std::memory_order_relaxed);
+    stats.busyNs = counters.busyNs.load(std::memory_order_relaxed);
+    stats.stalledNs = counters.stalledNs.load(std::memory_order_relaxed);
+    stats.queued = queued;
+    stats.highWater = counters.highWater.load(std::memory_order_relaxed);
+    return stats;
+}
+
+TrafficStages::Batch* TrafficStages::nextFreeBatch()
+{
+    // Backpressure: everything downstream is full, so the receive stage waits for commit to return a batch
+    Batch* batch;
+    if (!m_free.tryPop(batch))
+    {
+        uint64_t start = monotonicNs();
+        while (!m_free.tryPop(batch))
+            std::this_thread::yield();
+        addTo(m_receiveCounters.stalledNs, monotonicNs() - start);
+    }
+
+    batch->sequence = m_submitted;
+    batch->ownLat = m_ownLat;
+    batch->ownLon = m_ownLon;
+    batch->ownAlt = m_ownAlt;
+    batch->bytes.clear();
+    batch->ends.clear();
+    m_batchStart = monotonicNs();
+    batch->receivedNs = m_batchStart;
+    return batch;
+}
+
+bool TrafficStages::storeOwnship(const uint8_t* data, uint32_t size)
+{
+    TrafficMessageHeader header;
+    if (size < sizeof(header))
+        return false;
+    memcpy(&header, data, sizeof(header));
+    if (header.id != TRAFFIC_RECV_ID_SIMOBJECT_DATA || header.defineId != TRAFFIC_DEFINITION_OWNSHIP)
+        return false;
+
+    // A truncated ownship message is dropped here like any other the pipeline cannot decode
+    DecodedMessage message;
+    if (decodeTrafficMessage(data, size, message))
+    {
+        OwnshipSample sample;
+        sample.latitude = message.state.latitude;
+        sample.longitude = message.state.longitude;
+        sample.altitude = message.state.altitude;
+        sample.trueHeading = message.state.trueHeading;
+        sample.groundSpeed = message.state.groundSpeed;
+        sample.verticalSpeed = message.state.verticalSpeed;
+        sample.time = m_pipeline.clock();
+        m_pipeline.ownshipCell().store(sample);
+    }
+    return true;
+}
+
+void TrafficStages::trackOwnship(const uint8_t* data, uint32_t size)
+{
+    // Only the user aircraft moves the ownship, so look at that one flag and decode nothing else
+    TrafficMessageHeader header;
+    if (size < sizeof(header))
+        return;
+    memcpy(&header, data, sizeof(header));
+    if (header.id != TRAFFIC_RECV_ID_SIMOBJECT_DATA_BYTYPE && header.id != TRAFFIC_RECV_ID_SIMOBJECT_DATA)
+        return;
+
+    // Tagged records come from per-object requests for traffic, never from the user aircraft
+    size_t isUserOffset = sizeof(header);
+    WireType isUserType = WIRE_FLOAT64;
+    if (header.flags & TRAFFIC_DATA_REQUEST_FLAG_TAGGED)
+        return;
+    if (header.defineId == TRAFFIC_DEFINITION_COMBINED)
+        isUserOffset += offsetof(AircraftInfo, isUser);
+    else if (header.defineId == TRAFFIC_DEFINITION_PACKED_STATE)
+    {
+        isUserOffset += offsetof(PackedAircraftState, isUser);
+        isUserType = WIRE_INT32;
+    }
+    else if (header.defineId != TRAFFIC_DEFINITION_STATE)
+        return;
+    if (size < isUserOffset + wireTypeSize(isUserType))
+        return;
+
+    if (readWireValue(isUserType, data + isUserOffset) == 0)
+        return;
+
+    DecodedMessage message;
+    if (decodeTrafficMessage(data, size, message) && message.kind != DECODED_TITLE && isReported(message.state, message.title))
+    {
+        m_ownLat = message.state.latitude;
+        m_ownLon = message.state.longitude;
+    }
+}
+
+void TrafficStages::workerLoop(size_t worker)
+{
+    SpscRing<Batch*>& input = *m_work[worker];
+    SpscRing<Batch*>& output = *m_done[worker];
+    Counters& counters = m_computeCounters[worker];
+    OwnshipFrame ownship;
+    Batch* batch;
+
+    for (;;)
+    {
+        if (!input.tryPop(batch))
+        {
+            if (m_stopping.load(std::memory_order_acquire))
+                break;
+            std::this_thread::sleep_for(std::chrono::microseconds(IDLE_WAIT_US));
+            continue;
+        }
+
+        uint64_t start = monotonicNs();
+        batch->computeStartNs = start;
+        raiseTo(counters.highWater, input.size() + 1);
+
+        // Solve against the newest ownship sample, or without one follow the ownship through the batch exactly
+        // as TrafficPipeline::record() will
+        OwnshipSample live;
+        bool ownshipLive = m_pipeline.ownshipCell().load(live);
+        if (ownshipLive)
+            ownship.update(live.latitude, live.longitude, live.altitude);
+        else
+            ownship.update(batch->ownLat, batch->ownLon, batch->ownAlt);
+        batch->decoded.resize(batch->ends.size());
+        uint32_t begin = 0;
+        for (size_t i = 0; i < batch->ends.size(); i++)
+        {
+            DecodedMessage& message = batch->decoded[i];
+            decodeTrafficMessage(&batch->bytes[begin], batch->ends[i] - begin, message);
+            begin = batch->ends[i];
+            if ((message.kind != DECODED_SWEEP && message.kind != DECODED_TRACKED) || !isReported(message.state, message.title))
+                continue;
+            if (message.kind == DECODED_TRACKED && message.fields != STATE_ALL_FIELDS)
+                continue;       // a partial position is only known once commit merges it into the table
+
+            if (message.state.isUser)
+            {
+                if (!ownshipLive)
+                    ownship.update(message.state.latitude, message.state.longitude, ownship.altitude());
+            }
+            else
+            {
+                message.geometry = ownship.solve(message.state.latitude, message.state.longitude, message.state.altitude);
+                message.hasGeometry = true;
+                message.ownLat = ownship.latitude();
+                message.ownLon = ownship.longitude();
+                message.ownAlt = ownship.altitude();
+            }
+        }
+
+        uint64_t end = monotonicNs();
+        batch->computeEndNs = end;
+        output.tryPush(batch);
+        addTo(counters.batches, 1);
+        addTo(counters.messages, batch->ends.size());
+        addTo(counters.busyNs, end - start);
+    }
+}
+
+void TrafficStages::commitLoop()
+{
+    std::vector<uint32_t> titleRequests;
+    std::vector<TierChange> tierChanges;
+    uint64_t sequence = 0;
+    Batch* batch;
+
+    for (;;)
+    {
+        // Collect in the order the receive stage dealt the batches out
+        SpscRing<Batch*>& input = *m_done[sequence % m_done.size()];
+        if (!input.tryPop(batch))
+        {
+            if (m_stopping.load(std::memory_order_acquire))
+                break;
+            if (m_pipeline.expireSweeps() != 0)
+                handOverRequests(titleRequests, tierChanges);
+            std::this_thread::sleep_for(std::chrono::microseconds(IDLE_WAIT_US));
+            continue;
+        }
+
+        uint64_t start = monotonicNs();
+        uint64_t waiting = 1;
+        for (const std::unique_ptr<SpscRing<Batch*>>& done : m_done)
+            waiting += done->size();
+        raiseTo(m_commitCounters.highWater, waiting);
+
+        m_pipeline.receivedNs = batch->receivedNs;
+        for (const DecodedMessage& message : batch->decoded)
+            m_pipeline.apply(message);
+        if (m_metrics)
+        {
+            m_metrics->queueNs.record(batch->computeStartNs - batch->receivedNs);
+            m_metrics->computeNs.record(batch->computeEndNs - batch->computeStartNs);
+            m_metrics->commitNs.record(monotonicNs() - batch->receivedNs);
+        }
+
+        handOverRequests(titleRequests, tierChanges);
+
+        addTo(m_commitCounters.batches, 1);
+        addTo(m_commitCounters.messages, batch->decoded.size());
+        addTo(m_commitCounters.busyNs, monotonicNs() - start);
+
+        m_free.tryPush(batch);
+        m_committed.store(++sequence, std::memory_order_release);
+    }
+}
+
+void TrafficStages::handOverRequests(std::vector<uint32_t>& titleRequests, std::vector<TierChange>& tierChanges)
+{
+    m_pipeline.takeTitleRequests(titleRequests);
+    m_pipeline.takeTierChanges(tierChanges);
+    if (!titleRequests.empty() || !tierChanges.empty())
+    {
+        std::lock_guard<std::mutex> lock(m_requestLock);
+        m_titleRequests.insert(m_titleRequests.end(), titleRequests.begin(), titleRequests.end());
+        m_tierChanges.insert(m_tierChanges.end(), tierChanges.begin(), tierChanges.end());
+    }
+}
+
+void printStageStats(FILE* out, const std::vector<StageStats>& stats, double wallSeconds)
+{
+    double wallNs = wallSeconds > 0 ? wallSeconds * 1e9 : 1;
+    fprintf(out, "%-10s %9s %11s %7s %8s %7s %7s %12s\n", "stage", "batches", "messages", "busy", "stalled", "queued", "max", "msgs/busy s");
+    for (const StageStats& stage : stats)
+    {
+        char name[32];
+        if (stage.instance != 0)
+            snprintf(name, sizeof(name), "%s %u", stage.name, stage.instance);
+        else
+            snprintf(name, sizeof(name), "%s", stage.name);
+
+        fprintf(out, "%-10s %9llu %11llu %6.1f%% %7.1f%% %7llu %7llu %12.0f\n", name, (unsigned long long)stage.batches,
+            (unsigned long long)stage.messages, 100 * stage.busyNs / wallNs, 100 * stage.stalledNs / wallNs,
+            (unsigned long long)stage.queued, (unsigned long long)stage.highWater,
+            stage.busyNs > 0 ? stage.messages / (stage.busyNs / 1e9) : 0.0);
+    }
+}
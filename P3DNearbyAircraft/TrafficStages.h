@@ -0,0 +1,171 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <thread>
+#include <vector>
+
+#include "OutputRing.h"
+#include "TrafficPipeline.h"
+
+struct TrafficMetrics;
+
+struct StageSettings
+{
+    uint32_t workers;           // compute threads; 0 = one per core left over after receive, commit and output
+    uint32_t batchMessages;     // a batch is handed on once it holds this many messages (or at flush())
+    uint32_t batchesInFlight;   // size of the batch pool, which bounds everything queued between receive and commit
+};
+
+constexpr StageSettings DEFAULT_STAGE_SETTINGS = { 0, 256, 32 };
+
+/**
+* Counters of one stage. Compare busy and stalled time against the wall clock to find the bottleneck:
+* the busiest stage limits throughput, and the stages in front of it show stalls and deep queues.
+* The output stage's queue is counted in records rather than batches.
+*/
+struct StageStats
+{
+    const char* name;
+    uint32_t instance;          // compute workers are numbered from 1; 0 for the single stages
+    uint64_t batches;
+    uint64_t messages;
+    uint64_t busyNs;            // working on batches
+    uint64_t stalledNs;         // waiting on a full downstream stage (receive: for a free batch)
+    uint64_t queued;            // batches waiting in front of the stage now (receive: batches in flight)
+    uint64_t highWater;         // the most that have ever waited
+};
+
+/**
+* Runs a TrafficPipeline as a chain of threads so a dense traffic picture is spread over the cores:
+*
+*   receive (the caller)  copies raw messages into batches                    submit(), flush()
+*   compute (workers)     decodes them and solves range/bearing/elevation     decodeTrafficMessage(), OwnshipFrame
+*   commit (one thread)   applies them in order to the table and scheduler    TrafficPipeline::apply()
+*   output                formats and writes the report                       AsyncOutput's writer
+*
+* Batches come from a fixed pool and travel through SpscRings, so no stage takes a lock per message and the memory
+* in flight is bounded: when every batch is queued, submit() waits for commit to hand one back. Batch n goes
+* to worker n % workers and commit collects them in the same rotation, which keeps message order without a
+* reorder buffer.
+*
+* Geometry is solved before commit. Ownship messages never enter a batch: the receive stage stores them
+* straight into the pipeline's OwnshipCell, and each worker solves its batch against the newest sample
+* there. Without ownship messages each batch carries the ownship position as of its first message instead;
+* the receive stage tracks the user aircraft as messages go by and the worker follows it through the batch.
+* Either way each solution is tagged with the ownship it used, and commit re-solves the few that disagree
+* with the pipeline's: records of a sweep that arrived ahead of its user aircraft, which gives exactly the
+* results of the serial pipeline, or records solved before the ownship moved again, which commit solves
+* against the newer sample.
+*
+* While idle, the commit thread also closes sweeps that have timed out (TrafficPipeline::expireSweeps()).
+*
+* The pipeline belongs to the commit thread between start() and stop(). Title requests and tier changes
+* come back through takeTitleRequests() and takeTierChanges(), to be called on the receive thread, which
+* owns the SimConnect handle. Before start() (or after stop()) submit() runs the pipeline in line.
+*/
+class TrafficStages
+{
+public:
+    TrafficStages(TrafficPipeline& pipeline, const StageSettings& settings = DEFAULT_STAGE_SETTINGS);
+    ~TrafficStages();
+
+    void start();
+
+    // Commit everything submitted, then stop the threads
+    void stop();
+
+    // Record message counts and per-batch latencies into metrics; call before start()
+    void setMetrics(TrafficMetrics* metrics) { m_metrics = metrics; }
+
+    bool running() const { return !m_threads.empty(); }
+    uint32_t workers() const { return (uint32_t)m_work.size(); }
+
+    // Receive stage: queue one raw SimConnect message
+    void submit(const void* data, uint32_t size);
+
+    // Hand on the batch being filled, even if it is not full; call after each receive wakeup. Before start(), closes timed out sweeps.
+    void flush();
+
+    // flush() and wait until commit has applied everything submitted so far
+    void drain();
+
+    // Move the ObjectIDs whose titles should be requested into out. Returns how many there are.
+    size_t takeTitleRequests(std::vector<uint32_t>& out);
+
+    // Move the tier changes planned so far into out, oldest first. Returns how many there are.
+    size_t takeTierChanges(std::vector<TierChange>& out);
+
+    // receive, compute 1..n, commit, output
+    void stats(std::vector<StageStats>& out) const;
+
+private:
+    struct Batch
+    {
+        uint64_t sequence;
+        uint64_t receivedNs;        // when the first message arrived
+        uint64_t computeStartNs;    // stamped by the worker
+        uint64_t computeEndNs;
+        double ownLat;              // the ownship as of the first message
+        double ownLon;
+        double ownAlt;
+        std::vector<uint8_t> bytes;
+        std::vector<uint32_t> ends; // end offset of each message in bytes
+        std::vector<DecodedMessage> decoded;
+    };
+
+    struct alignas(64) Counters
+    {
+        std::atomic<uint64_t> batches;
+        std::atomic<uint64_t> messages;
+        std::atomic<uint64_t> busyNs;
+        std::atomic<uint64_t> stalledNs;
+        std::atomic<uint64_t> highWater;
+    };
+
+    static StageStats stageStats(const char* name, uint32_t instance, const Counters& counters, uint64_t queued);
+
+    void workerLoop(size_t worker);
+    void commitLoop();
+    void handOverRequests(std::vector<uint32_t>& titleRequests, std::vector<TierChange>& tierChanges);
+    Batch* nextFreeBatch();
+    bool storeOwnship(const uint8_t* data, uint32_t size);     // true if it was an ownship message
+    void trackOwnship(const uint8_t* data, uint32_t size);
+
+    TrafficPipeline& m_pipeline;
+    StageSettings m_settings;
+    TrafficMetrics* m_metrics;
+
+    std::vector<Batch> m_pool;
+    SpscRing<Batch*> m_free;                                    // commit -> receive
+    std::vector<std::unique_ptr<SpscRing<Batch*>>> m_work;     // receive -> worker n
+    std::vector<std::unique_ptr<SpscRing<Batch*>>> m_done;     // worker n -> commit
+    std::vector<std::thread> m_threads;
+    std::atomic<bool> m_stopping;
+
+    // Receive stage, caller's thread only
+    Batch* m_filling;
+    uint64_t m_submitted;
+    uint64_t m_batchStart;
+    double m_ownLat;
+    double m_ownLon;
+    double m_ownAlt;
+
+    std::atomic<uint64_t> m_committed;
+
+    // Commit -> receive; touched once per batch at most, so a lock is cheaper than another pair of rings
+    std::mutex m_requestLock;
+    std::vector<uint32_t> m_titleRequests;
+    std::vector<TierChange> m_tierChanges;
+
+    Counters m_receiveCounters;
+    std::vector<Counters> m_computeCounters;
+    Counters m_commitCounters;
+};
+
+// One line per stage: busy and stalled time as a share of wallSeconds, queue depth and throughput
+void printStageStats(FILE* out, const std::vector<StageStats>& stats, double wallSeconds);
@@ -0,0 +1,230 @@
+#include "TrafficTable.h"
+
+TrafficTable::TrafficTable(size_t expectedAircraft)
+    : m_generation(0)
+    , m_inserted(0)
+    , m_evicted(0)
+{
+    size_t buckets = 16;
+    while (buckets < expectedAircraft * 2)
+        buckets *= 2;
+    m_buckets.assign(buckets, { EMPTY_KEY, 0 });
+}
+
+/**
+* Fibonacci hashing; SimConnect hands out ObjectIDs sequentially, which the multiply spreads over the table.
+*/
+size_t TrafficTable::bucketOf(uint32_t objectId) const
+{
+    return (size_t)((objectId * 0x9E3779B97F4A7C15ull) >> 32) & (m_buckets.size() - 1);
+}
+
+size_t TrafficTable::probe(uint32_t objectId) const
+{
+    size_t mask = m_buckets.size() - 1;
+    size_t bucket = bucketOf(objectId);
+    while (m_buckets[bucket].objectId != objectId && m_buckets[bucket].objectId != EMPTY_KEY)
+        bucket = (bucket + 1) & mask;
+    return bucket;
+}
+
+size_t TrafficTable::find(uint32_t objectId) const
+{
+    if (objectId == EMPTY_KEY)
+        return NOT_FOUND;
+
+    const Bucket& bucket = m_buckets[probe(objectId)];
+    return bucket.objectId == objectId ? bucket.slot : NOT_FOUND;
+}
+
+void TrafficTable::rehash(size_t buckets)
+{
+    m_buckets.assign(buckets, { EMPTY_KEY, 0 });
+    for (size_t slot = 0; slot < m_objectIds.size(); slot++)
+        m_buckets[probe(m_objectIds[slot])] = { m_objectIds[slot], (uint32_t)slot };
+}
+
+size_t TrafficTable::update(uint32_t objectId, const AircraftState& state)
+{
+    if (objectId == EMPTY_KEY)
+        return NOT_FOUND;
+
+    size_t bucket = probe(objectId);
+    size_t slot;
+    if (m_buckets[bucket].objectId == objectId)
+    {
+        slot = m_buckets[bucket].slot;
+    }
+    else
+    {
+        if ((m_objectIds.size() + 1) * 2 > m_buckets.size())
+        {
+            rehash(m_buckets.size() * 2);
+            bucket = probe(objectId);
+        }
+
+        slot = m_objectIds.size();
+        m_buckets[bucket] = { objectId, (uint32_t)slot };
+        m_objectIds.push_back(objectId);
+        m_lastSeen.push_back(0);
+        m_isUser.push_back(0);
+        m_onGround.push_back(0);
+        m_trueHeadings.push_back(0);
+        m_magHeadings.push_back(0);
+        m_altitudes.push_back(0);
+        m_latitudes.push_back(0);
+        m_longitudes.push_back(0);
+        m_titleIds.push_back(0);
+        m_groundSpeeds.push_back(0);
+        m_groundTracks.push_back(0);
+        m_verticalSpeeds.push_back(0);
+        m_sampleTimes.push_back(0);
+        m_blendNorth.push_back(0);
+        m_blendEast.push_back(0);
+        m_blendUp.push_back(0);
+        m_inserted++;
+    }
+
+    m_lastSeen[slot] = m_generation;
+    m_isUser[slot] = state.isUser != 0;
+    m_onGround[slot] = state.onGround != 0;
+    m_trueHeadings[slot] = state.trueHeading;
+    m_magHeadings[slot] = state.magHeading;
+    m_altitudes[slot] = state.altitude;
+    m_latitudes[slot] = state.latitude;
+    m_longitudes[slot] = state.longitude;
+    m_groundSpeeds[slot] = state.groundSpeed;
+    m_groundTracks[slot] = state.groundTrack;
+    m_verticalSpeeds[slot] = state.verticalSpeed;
+
+    return slot;
+}
+
+AircraftState TrafficTable::state(size_t slot) const
+{
+    AircraftState state;
+    state.isUser = m_isUser[slot];
+    state.onGround = m_onGround[slot];
+    state.trueHeading = m_trueHeadings[slot];
+    state.magHeading = m_magHeadings[slot];
+    state.altitude = m_altitudes[slot];
+    state.latitude = m_latitudes[slot];
+    state.longitude = m_longitudes[slot];
+    state.groundSpeed = m_groundSpeeds[slot];
+    state.groundTrack = m_groundTracks[slot];
+    state.verticalSpeed = m_verticalSpeeds[slot];
+    return state;
+}
+
+/**
+* Backward-shift deletion: pull later members of the probe run into the hole so lookups never need tombstones.
+*/
+void TrafficTable::eraseBucket(size_t bucket)
+{
+    size_t mask = m_buckets.size() - 1;
+    size_t hole = bucket;
+    size_t next = (hole + 1) & mask;
+    while (m_buckets[next].objectId != EMPTY_KEY)
+    {
+        size_t home = bucketOf(m_buckets[next].objectId);
+        // Move it only if its home is not cyclically within (hole, next]
+        if (((next - home) & mask) >= ((next - hole) & mask))
+        {
+            m_buckets[hole] = m_buckets[next];
+            hole = next;
+        }
+        next = (next + 1) & mask;
+    }
+    m_buckets[hole].objectId = EMPTY_KEY;
+}
+
+void TrafficTable::removeSlot(size_t slot)
+{
+    eraseBucket(probe(m_objectIds[slot]));
+
+    size_t last = m_objectIds.size() - 1;
+    if (slot != last)
+    {
+        m_objectIds[slot] = m_objectIds[last];
+        m_lastSeen[slot] = m_lastSeen[last];
+        m_isUser[slot] = m_isUser[last];
+        m_onGround[slot] = m_onGround[last];
+        m_trueHeadings[slot] = m_trueHeadings[last];
+        m_magHeadings[slot] = m_magHeadings[last];
+        m_altitudes[slot] = m_altitudes[last];
+        m_latitudes[slot] = m_latitudes[last];
+        m_longitudes[slot] = m_longitudes[last];
+        m_titleIds[slot] = m_titleIds[last];
+        m_groundSpeeds[slot] = m_groundSpeeds[last];
+        m_groundTracks[slot] = m_groundTracks[last];
+        m_verticalSpeeds[slot] = m_verticalSpeeds[last];
+        m_sampleTimes[slot] = m_sampleTimes[last];
+        m_blendNorth[slot] = m_blendNorth[last];
+        m_blendEast[slot] = m_blendEast[last];
+        m_blendUp[slot] = m_blendUp[last];
+        m_buckets[probe(m_objectIds[slot])].slot = (uint32_t)slot;
+    }
+
+    m_objectIds.pop_back();
+    m_lastSeen.pop_back();
+    m_isUser.pop_back();
+    m_onGround.pop_back();
+    m_trueHeadings.pop_back();
+    m_magHeadings.pop_back();
+    m_altitudes.pop_back();
+    m_latitudes.pop_back();
+    m_longitudes.pop_back();
+    m_titleIds.pop_back();
+    m_groundSpeeds.pop_back();
+    m_groundTracks.pop_back();
+    m_verticalSpeeds.pop_back();
+    m_sampleTimes.pop_back();
+    m_blendNorth.pop_back();
+    m_blendEast.pop_back();
+    m_blendUp.pop_back();
+}
+
+size_t TrafficTable::evictStale(uint32_t maxMissedSweeps)
+{
+    size_t removed = 0;
+    size_t slot = 0;
+    while (slot < m_objectIds.size())
+    {
+        if (m_generation - m_lastSeen[slot] > maxMissedSweeps)
+        {
+            removeSlot(slot);   // the last slot moves in here, so look at this slot again
+            removed++;
+        }
+        else
+        {
+            slot++;
+        }
+    }
+
+    m_evicted += removed;
+    return removed;
+}
+
+void TrafficTable::clear()
+{
+    for (Bucket& bucket : m_buckets)
+        bucket.objectId = EMPTY_KEY;
+
+    m_objectIds.clear();
+    m_lastSeen.clear();
+    m_isUser.clear();
+    m_onGround.clear();
+    m_trueHeadings.clear();
+    m_magHeadings.clear();
+    m_altitudes.clear();
+    m_latitudes.clear();
+    m_longitudes.clear();
+    m_titleIds.clear();
+    m_groundSpeeds.clear();
+    m_groundTracks.clear();
+    m_verticalSpeeds.clear();
+    m_sampleTimes.clear();
+    m_blendNorth.clear();
+    m_blendEast.clear();
+    m_blendUp.clear();
+}
@@ -0,0 +1,114 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+#include "AircraftInfo.h"
+
+/**
+* Every aircraft seen in recent sweeps, kept as structure-of-arrays so per-sweep passes walk dense columns.
+*
+* Slots 0..size()-1 are always occupied. An ObjectID finds its slot through an open-addressing hash table
+* (linear probing, no tombstones). Each sweep bumps the generation. update() stamps the slot with that
+* generation, and evictStale() drops aircraft that have missed too many sweeps. An eviction moves the last
+* slot into the hole, so a slot number is only valid until the next evictStale().
+*
+* Usage per sweep: beginSweep(), update() every record, evictStale().
+*/
+class TrafficTable
+{
+public:
+    static constexpr size_t NOT_FOUND = (size_t)-1;
+
+    explicit TrafficTable(size_t expectedAircraft = 64);
+
+    void beginSweep() { m_generation++; }
+
+    // Insert the aircraft or overwrite its slot in place. Returns the slot.
+    size_t update(uint32_t objectId, const AircraftState& state);
+
+    // The slot's latest state, as update() stored it; the base a tagged partial update is applied on
+    AircraftState state(size_t slot) const;
+
+    // Titles arrive separately from the state; a new slot starts with titleId 0 (TitleTable::TITLE_UNKNOWN)
+    void setTitle(size_t slot, uint32_t titleId) { m_titleIds[slot] = titleId; }
+
+    // Dead-reckoning track of the latest sample: when it was taken and the blend offset at that moment (see DeadReckoning)
+    void setTrack(size_t slot, double sampleTime, double blendNorthNm, double blendEastNm, double blendUpFt)
+    {
+        m_sampleTimes[slot] = sampleTime;
+        m_blendNorth[slot] = blendNorthNm;
+        m_blendEast[slot] = blendEastNm;
+        m_blendUp[slot] = blendUpFt;
+    }
+
+    // Remove aircraft not updated in the last maxMissedSweeps sweeps (0 keeps only this sweep). Returns the number removed.
+    size_t evictStale(uint32_t maxMissedSweeps = 0);
+
+    void clear();
+
+    size_t find(uint32_t objectId) const;
+    size_t size() const { return m_objectIds.size(); }
+    uint32_t generation() const { return m_generation; }
+
+    uint64_t inserted() const { return m_inserted; }
+    uint64_t evicted() const { return m_evicted; }
+
+    // Dense columns, size() entries each
+    const uint32_t* objectIds() const { return m_objectIds.data(); }
+    const uint32_t* lastSeen() const { return m_lastSeen.data(); }
+    const uint8_t* isUser() const { return m_isUser.data(); }
+    const uint8_t* onGround() const { return m_onGround.data(); }
+    const double* trueHeadings() const { return m_trueHeadings.data(); }
+    const double* magHeadings() const { return m_magHeadings.data(); }
+    const double* altitudes() const { return m_altitudes.data(); }
+    const double* latitudes() const { return m_latitudes.data(); }
+    const double* longitudes() const { return m_longitudes.data(); }
+    const double* groundSpeeds() const { return m_groundSpeeds.data(); }
+    const double* groundTracks() const { return m_groundTracks.data(); }
+    const double* verticalSpeeds() const { return m_verticalSpeeds.data(); }
+    const uint32_t* titleIds() const { return m_titleIds.data(); }
+    const double* sampleTimes() const { return m_sampleTimes.data(); }
+    const double* blendNorth() const { return m_blendNorth.data(); }
+    const double* blendEast() const { return m_blendEast.data(); }
+    const double* blendUp() const { return m_blendUp.data(); }
+
+private:
+    static constexpr uint32_t EMPTY_KEY = 0xFFFFFFFFu;
+
+    struct Bucket
+    {
+        uint32_t objectId;
+        uint32_t slot;
+    };
+
+    size_t bucketOf(uint32_t objectId) const;
+    size_t probe(uint32_t objectId) const;      // bucket holding objectId, or the empty bucket where it would go
+    void eraseBucket(size_t bucket);
+    void rehash(size_t buckets);
+    void removeSlot(size_t slot);
+
+    std::vector<Bucket> m_buckets;              // power-of-two size, at most half full
+    uint32_t m_generation;
+    uint64_t m_inserted;
+    uint64_t m_evicted;
+
+    std::vector<uint32_t> m_objectIds;
+    std::vector<uint32_t> m_lastSeen;
+    std::vector<uint8_t> m_isUser;
+    std::vector<uint8_t> m_onGround;
+    std::vector<double> m_trueHeadings;
+    std::vector<double> m_magHeadings;
+    std::vector<double> m_altitudes;
+    std::vector<double> m_latitudes;
+    std::vector<double> m_longitudes;
+    std::vector<double> m_groundSpeeds;
+    std::vector<double> m_groundTracks;
+    std::vector<double> m_verticalSpeeds;
+    std::vector<uint32_t> m_titleIds;           // into the pipeline's TitleTable
+    std::vector<double> m_sampleTimes;
+    std::vector<double> m_blendNorth;
+    std::vector<double> m_blendEast;
+    std::vector<double> m_blendUp;
+};
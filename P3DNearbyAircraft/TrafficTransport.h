@@ -0,0 +1,22 @@
+#pragma once
+
+#include <stdint.h>
+
+/**
+* Source of raw SimConnect messages (a SIMCONNECT_RECV header followed by its payload).
+*
+* SimConnectTransport wraps a live connection; MockTransport is fed by hand so the receive path
+* can be built and measured without the simulator.
+*/
+class TrafficTransport
+{
+public:
+    virtual ~TrafficTransport() {}
+
+    // Block until at least one message is queued or timeoutMs elapses. Returns false on timeout.
+    virtual bool waitForMessages(uint32_t timeoutMs) = 0;
+
+    // Take the next queued message without blocking. Returns false when the queue is empty.
+    // The data stays valid until the next call.
+    virtual bool nextMessage(const void** data, uint32_t* size) = 0;
+};
@@ -1,4 +1,5 @@
 #include "Utilities.h"
+#include "FastMath.h"
 
 /**
 * Get the bearing (forward azimuth) in degrees between 2 sets of lat/lon coordinates
@@ -6,12 +7,41 @@
 */
 double getBearing(double srcLat, double srcLon, double destLat, double destLon)
 {
+    srcLat *= M_PI / 180;
+    srcLon *= M_PI / 180;
+    destLat *= M_PI / 180;
+    destLon *= M_PI / 180;
+
     double y = sin(destLon - srcLon) * cos(destLat);
     double x = cos(srcLat) * sin(destLat) - sin(srcLat) * cos(destLat) * cos(destLon - srcLon);
 	double radians = atan2(y, x);
 
     double degrees = radians * (180.0 / M_PI);
-    return fmod(degrees + 180, 360);
+    return fmod(degrees + 360, 360);
+}
+
+/**
+* getBearing() with a selectable trig implementation.
+* The fast path uses the half-angle form of the denominator so that short baselines stay accurate
+* even with the approximate sin/cos.
+*/
+double getBearing(double srcLat, double srcLon, double destLat, double destLon, MathMode mode)
+{
+    if (mode == MATH_PRECISE)
+        return getBearing(srcLat, srcLon, destLat, destLon);
+
+    double srcLatRad = geo::units::degToRad(srcLat);
+    double destLatRad = geo::units::degToRad(destLat);
+    double sinHalfDLat, cosHalfDLat, sinHalfDLon, cosHalfDLon;
+    fastSinCos((destLatRad - srcLatRad) * 0.5, sinHalfDLat, cosHalfDLat);
+    fastSinCos(geo::units::degToRad(destLon - srcLon) * 0.5, sinHalfDLon, cosHalfDLon);
+    double cosDestLat = fastCos(destLatRad);
+
+    double y = 2 * sinHalfDLon * cosHalfDLon * cosDestLat;
+    double x = 2 * sinHalfDLat * cosHalfDLat + 2 * fastSin(srcLatRad) * cosDestLat * sinHalfDLon * sinHalfDLon;
+
+    double degrees = geo::units::radToDeg(fastAtan2(y, x));
+    return degrees < 0 ? degrees + 360 : degrees;
 }
 
 
@@ -22,7 +52,7 @@ double getBearing(double srcLat, double srcLon, double destLat, double destLon)
 */
 double nmToMeters(double nm)
 {
-	return round(nm * 1852);
+	return round(geo::units::nmToMeters(nm));
 }
 
 
@@ -32,7 +62,19 @@ double nmToMeters(double nm)
 */
 double metersToNm(double meters)
 {
-	return meters / 1852;
+	return geo::units::metersToNm(meters);
+}
+
+/**
+* Bring a longitude, or the difference of two, back into [-180, 180] after it crossed the antimeridian
+*/
+double wrapLongitude(double lon)
+{
+    if (lon > 180)
+        return lon - 360;
+    if (lon < -180)
+        return lon + 360;
+    return lon;
 }
 
 /** 
@@ -41,8 +83,7 @@ double metersToNm(double meters)
 */
 long double toRadians(const long double degree)
 {
-    long double one_deg = (M_PI) / 180;
-    return (one_deg * degree);
+    return geo::units::degToRad(degree);
 }
 
 long double distance(long double lat1, long double long1, long double lat2, long double long2)
@@ -68,7 +109,7 @@ long double distance(long double lat1, long double long1, long double lat2, long
     // Radius of Earth in
     // Kilometers, R = 6371
     // Use R = 3956 for miles
-    long double R = 3443.9308855292; // Nuatical miles
+    long double R = EARTH_RADIUS_NM; // Nuatical miles
 
 
     // Calculate the result
@@ -78,17 +119,130 @@ long double distance(long double lat1, long double long1, long double lat2, long
 }
 
 
+/**
+* Haversine distance in nautical miles with a selectable trig implementation.
+*/
+double distance(double lat1, double long1, double lat2, double long2, MathMode mode)
+{
+    if (mode == MATH_PRECISE)
+        return (double)distance((long double)lat1, (long double)long1, (long double)lat2, (long double)long2);
+
+    double lat1Rad = geo::units::degToRad(lat1);
+    double lat2Rad = geo::units::degToRad(lat2);
+    double sinHalfDLat = fastSin((lat2Rad - lat1Rad) * 0.5);
+    double sinHalfDLon = fastSin(geo::units::degToRad(long2 - long1) * 0.5);
+
+    double a = sinHalfDLat * sinHalfDLat + fastCos(lat1Rad) * fastCos(lat2Rad) * sinHalfDLon * sinHalfDLon;
+    return 2 * fastAsin(sqrt(a > 1 ? 1 : a)) * EARTH_RADIUS_NM;
+}
+
+double rangeWithAlt(double x1, double y1, double alt1, double x2, double y2, double alt2, MathMode mode)
+{
+    double range = distance(x1, y1, x2, y2, mode);
+    double deltaHeight = geo::units::feetToNm(alt1 - alt2);
+
+    return sqrt(range * range + deltaHeight * deltaHeight);
+}
+
 double rangeWithAlt(double x1, double y1, double alt1, double x2, double y2, double alt2)
 {
-    double deltaHeight;
-    double alt1Nm = alt1 / 6076;
-    double alt2Nm = alt2 / 6076;
-    double range = distance(x1, y1, x2, y2);
-
-    if (alt1 > alt2)
-        deltaHeight = alt1Nm - alt2Nm;
-    else
-        deltaHeight = alt1Nm - alt2Nm;
-
-    return sqrtf(powf(range, 2) + powf(deltaHeight, 2));
-}
\ No newline at end of file
+    return rangeWithAlt(x1, y1, alt1, x2, y2, alt2, MATH_PRECISE);
+}
+
+RangeOrigin makeRangeOrigin(double lat, double lon, double alt)
+{
+    double latRad = geo::units::degToRad(lat);
+    RangeOrigin origin = { lat, lon, alt, sin(latRad), cos(latRad) };
+    return origin;
+}
+
+// Headroom for rounding in the bound arithmetic, far below the width of any bracket
+static const double RANGE_BOUND_SLACK = 1e-9;
+
+/**
+* Squared bounds, in nm, of the slant range. With y and x the latitude and longitude differences in radians,
+* phi the mean latitude and theta the central angle, the haversine is exactly
+*
+*     4 sin^2(theta/2) = 4 sin^2(y/2) (1 - sin^2(x/2)) + 4 cos^2(phi) sin^2(x/2)
+*
+* and u^2 (1 - u^2/12) <= 4 sin^2(u/2) <= u^2 brackets each term by the flat-earth D^2 = y^2 + cos^2(phi) x^2:
+*
+*     D^2 (1 - y^2/12 - x^2/4) <= 4 sin^2(theta/2) <= D^2,    2s <= theta = 2 asin(s) <= 2s / sqrt(1 - s^2)
+*
+* cos(phi) itself comes from the origin's sin/cos by a second-order step of y/2, off by at most |y/2|^3 / 6.
+*/
+static void rangeBoundsSquared(const RangeOrigin& origin, double lat, double lon, double alt, double& lowerSq, double& upperSq)
+{
+    double dLon = lon - origin.longitude;
+    if (dLon > 180)
+        dLon -= 360;
+    else if (dLon < -180)
+        dLon += 360;
+    double y = geo::units::degToRad(lat - origin.latitude);
+    double x = geo::units::degToRad(dLon);
+
+    double half = y * 0.5;
+    double cosMid = origin.cosLat * (1 - half * half * 0.5) - origin.sinLat * half;
+    double cosError = fabs(half * half * half) / 6;
+    double cosLow = cosMid - cosError > 0 ? cosMid - cosError : 0;
+    double cosHigh = cosMid + cosError < 1 ? cosMid + cosError : 1;
+
+    double ySq = y * y;
+    double xSq = x * x;
+    double flatLowSq = ySq + cosLow * cosLow * xSq;
+    double flatHighSq = ySq + cosHigh * cosHigh * xSq;
+    double shrink = 1 - ySq / 12 - xSq / 4;
+    double thetaLowSq = shrink > 0 ? flatLowSq * shrink : 0;
+    if (thetaLowSq < ySq)
+        thetaLowSq = ySq;       // never shorter than the latitude difference, which still holds far away
+    double thetaHighSq = flatHighSq < 4 ? flatHighSq / (1 - flatHighSq / 4) : M_PI * M_PI;
+    if (thetaHighSq > M_PI * M_PI)
+        thetaHighSq = M_PI * M_PI;
+
+    double height = geo::units::feetToNm(alt - origin.altitude);
+    double heightSq = height * height;
+    const double radiusSq = EARTH_RADIUS_NM * EARTH_RADIUS_NM;
+    lowerSq = (thetaLowSq * radiusSq + heightSq) * (1 - RANGE_BOUND_SLACK);
+    upperSq = (thetaHighSq * radiusSq + heightSq) * (1 + RANGE_BOUND_SLACK);
+}
+
+RangeBounds rangeBounds(const RangeOrigin& origin, double lat, double lon, double alt)
+{
+    double lowerSq, upperSq;
+    rangeBoundsSquared(origin, lat, lon, alt, lowerSq, upperSq);
+    RangeBounds bounds = { sqrt(lowerSq), sqrt(upperSq) };
+    return bounds;
+}
+
+size_t classifyRange(const RangeOrigin& origin, double lat, double lon, double alt, const double* ringsNm, size_t ringCount)
+{
+    double lowerSq, upperSq;
+    rangeBoundsSquared(origin, lat, lon, alt, lowerSq, upperSq);
+
+    // Rings below the lower bound are certainly inside the range, rings at or past the upper bound certainly not
+    size_t below = 0;
+    while (below < ringCount && ringsNm[below] * ringsNm[below] < lowerSq)
+        below++;
+    size_t ring = below;
+    while (ring < ringCount && ringsNm[ring] * ringsNm[ring] < upperSq)
+        ring++;
+    if (ring == below)
+        return ring;
+
+    double range = rangeWithAlt(origin.latitude, origin.longitude, origin.altitude, lat, lon, alt);
+    while (below < ringCount && ringsNm[below] < range)
+        below++;
+    return below;
+}
+
+bool withinRange(const RangeOrigin& origin, double lat, double lon, double alt, double limitNm)
+{
+    double lowerSq, upperSq;
+    rangeBoundsSquared(origin, lat, lon, alt, lowerSq, upperSq);
+    double limitSq = limitNm * limitNm;
+    if (upperSq <= limitSq)
+        return true;
+    if (lowerSq > limitSq)
+        return false;
+    return rangeWithAlt(origin.latitude, origin.longitude, origin.altitude, lat, lon, alt) <= limitNm;
+}
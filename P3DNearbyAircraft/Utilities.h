@@ -2,14 +2,79 @@
 
 //#include <cmath>
 #include <math.h>
+#include <stddef.h>
+#ifdef _MSC_VER
 #include <corecrt_math.h>
+#endif
 
+#include "Geo.h"
+
+#ifndef M_PI
 constexpr auto M_PI = 3.14159265358979323846;
+#endif
+
+constexpr double EARTH_RADIUS_NM = geo::Spherical::radiusNm;
+constexpr double FEET_PER_NM = geo::units::FEET_PER_NM;
+
+/**
+* Precision of the trig behind getBearing()/distance()/rangeWithAlt(). MATH_FAST swaps the CRT for the
+* polynomials in FastMath.h: bearing is within 0.001 deg of MATH_PRECISE, range within 1 m at any distance
+* and under a millimetre for local traffic. That is plenty for bearing display and range-ring binning.
+*/
+enum MathMode
+{
+    MATH_PRECISE,
+    MATH_FAST,
+};
 
 double getBearing(double x1, double y1, double x2, double y2);
+double getBearing(double x1, double y1, double x2, double y2, MathMode mode);
 
 double nmToMeters(double nm);
 double metersToNm(double meters);
 
+// Longitude or longitude difference in degrees, brought back into [-180, 180] across the antimeridian
+double wrapLongitude(double lon);
+
 long double distance(long double lat1, long double long1, long double lat2, long double long2);
+double distance(double lat1, double long1, double lat2, double long2, MathMode mode);
 double rangeWithAlt(double x1, double y1, double alt1, double x2, double y2, double alt2);
+double rangeWithAlt(double x1, double y1, double alt1, double x2, double y2, double alt2, MathMode mode);
+
+/**
+* The fixed end of classifyRange()/withinRange(), worked out once per sweep. Altitude in feet.
+*/
+struct RangeOrigin
+{
+    double latitude;
+    double longitude;
+    double altitude;
+    double sinLat;
+    double cosLat;
+};
+
+RangeOrigin makeRangeOrigin(double lat, double lon, double alt);
+
+/**
+* Bracket of the slant range rangeWithAlt() would give, from a flat-earth distance with the longitude scaled by
+* the cosine of the mean latitude. No trig per target. Both bounds are proven (Taylor remainders of the haversine
+* terms) rather than fitted, and hold anywhere on the sphere; they are within about 3e-4 of the range at 100 nm
+* and close in as the square of the distance.
+*/
+struct RangeBounds
+{
+    double lowerNm;
+    double upperNm;
+};
+
+RangeBounds rangeBounds(const RangeOrigin& origin, double lat, double lon, double alt);
+
+/**
+* The ring a target falls in: the first i with range <= ringsNm[i] (rings ascending), or ringCount beyond the last.
+* Only a target whose bracket straddles a ring falls back to rangeWithAlt(), so the answer is always the one the
+* exact range gives.
+*/
+size_t classifyRange(const RangeOrigin& origin, double lat, double lon, double alt, const double* ringsNm, size_t ringCount);
+
+// range <= limitNm, decided the same way
+bool withinRange(const RangeOrigin& origin, double lat, double lon, double alt, double limitNm);
@@ -0,0 +1,190 @@
+#pragma once
+
+/**
+* Stand-in for the Prepar3D SDK's SimConnect.h, covering the subset of the API the traffic tools use.
+*
+* Put this directory on the include path instead of the SDK's and link SimConnectStandIn.cpp instead of
+* SimConnect.lib. Declarations, enum values and message layouts match the SDK, so code written against
+* the real header builds unchanged - on Linux as well. See SimConnectStandIn.h for the simulated traffic.
+*/
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <stdint.h>
+
+typedef uint32_t DWORD;
+typedef int32_t HRESULT;
+typedef void* HANDLE;
+typedef void* HWND;
+typedef const char* LPCSTR;
+
+#define CALLBACK
+#define S_OK ((HRESULT)0)
+#define E_FAIL ((HRESULT)0x80004005)
+#define E_INVALIDARG ((HRESULT)0x80070057)
+#define SUCCEEDED(hr) (((HRESULT)(hr)) >= 0)
+#define FAILED(hr) (((HRESULT)(hr)) < 0)
+#endif
+
+#ifdef _WIN32
+#define SIMCONNECTAPI extern "C" HRESULT __stdcall
+#else
+#define SIMCONNECTAPI extern "C" HRESULT
+#endif
+
+typedef DWORD SIMCONNECT_OBJECT_ID;
+typedef DWORD SIMCONNECT_DATA_DEFINITION_ID;
+typedef DWORD SIMCONNECT_DATA_REQUEST_ID;
+typedef DWORD SIMCONNECT_DATA_REQUEST_FLAG;
+
+static const DWORD SIMCONNECT_DATA_REQUEST_FLAG_DEFAULT = 0x00000000;
+static const DWORD SIMCONNECT_DATA_REQUEST_FLAG_CHANGED = 0x00000001;
+static const DWORD SIMCONNECT_DATA_REQUEST_FLAG_TAGGED = 0x00000002;
+
+static const DWORD SIMCONNECT_UNUSED = 0xFFFFFFFF;
+static const DWORD SIMCONNECT_OBJECT_ID_USER = 0;
+
+enum SIMCONNECT_RECV_ID
+{
+    SIMCONNECT_RECV_ID_NULL,
+    SIMCONNECT_RECV_ID_EXCEPTION,
+    SIMCONNECT_RECV_ID_OPEN,
+    SIMCONNECT_RECV_ID_QUIT,
+    SIMCONNECT_RECV_ID_EVENT,
+    SIMCONNECT_RECV_ID_EVENT_OBJECT_ADDREMOVE,
+    SIMCONNECT_RECV_ID_EVENT_FILENAME,
+    SIMCONNECT_RECV_ID_EVENT_FRAME,
+    SIMCONNECT_RECV_ID_SIMOBJECT_DATA,
+    SIMCONNECT_RECV_ID_SIMOBJECT_DATA_BYTYPE,
+};
+
+enum SIMCONNECT_DATATYPE
+{
+    SIMCONNECT_DATATYPE_INVALID,
+    SIMCONNECT_DATATYPE_INT32,
+    SIMCONNECT_DATATYPE_INT64,
+    SIMCONNECT_DATATYPE_FLOAT32,
+    SIMCONNECT_DATATYPE_FLOAT64,
+    SIMCONNECT_DATATYPE_STRING8,
+    SIMCONNECT_DATATYPE_STRING32,
+    SIMCONNECT_DATATYPE_STRING64,
+    SIMCONNECT_DATATYPE_STRING128,
+    SIMCONNECT_DATATYPE_STRING256,
+    SIMCONNECT_DATATYPE_STRING260,
+};
+
+enum SIMCONNECT_EXCEPTION
+{
+    SIMCONNECT_EXCEPTION_NONE,
+    SIMCONNECT_EXCEPTION_ERROR,
+    SIMCONNECT_EXCEPTION_SIZE_MISMATCH,
+    SIMCONNECT_EXCEPTION_UNRECOGNIZED_ID,
+    SIMCONNECT_EXCEPTION_UNOPENED,
+    SIMCONNECT_EXCEPTION_VERSION_MISMATCH,
+    SIMCONNECT_EXCEPTION_TOO_MANY_GROUPS,
+    SIMCONNECT_EXCEPTION_NAME_UNRECOGNIZED,
+    SIMCONNECT_EXCEPTION_TOO_MANY_EVENT_NAMES,
+    SIMCONNECT_EXCEPTION_EVENT_ID_DUPLICATE,
+    SIMCONNECT_EXCEPTION_TOO_MANY_MAPS,
+    SIMCONNECT_EXCEPTION_TOO_MANY_OBJECTS,
+    SIMCONNECT_EXCEPTION_TOO_MANY_REQUESTS,
+    SIMCONNECT_EXCEPTION_WEATHER_INVALID_PORT,
+    SIMCONNECT_EXCEPTION_WEATHER_INVALID_METAR,
+    SIMCONNECT_EXCEPTION_WEATHER_UNABLE_TO_GET_OBSERVATION,
+    SIMCONNECT_EXCEPTION_WEATHER_UNABLE_TO_CREATE_STATION,
+    SIMCONNECT_EXCEPTION_WEATHER_UNABLE_TO_REMOVE_STATION,
+    SIMCONNECT_EXCEPTION_INVALID_DATA_TYPE,
+    SIMCONNECT_EXCEPTION_INVALID_DATA_SIZE,
+    SIMCONNECT_EXCEPTION_DATA_ERROR,
+    SIMCONNECT_EXCEPTION_INVALID_ARRAY,
+    SIMCONNECT_EXCEPTION_CREATE_OBJECT_FAILED,
+    SIMCONNECT_EXCEPTION_LOAD_FLIGHTPLAN_FAILED,
+    SIMCONNECT_EXCEPTION_OPERATION_INVALID_FOR_OBJECT_TYPE,
+    SIMCONNECT_EXCEPTION_ILLEGAL_OPERATION,
+    SIMCONNECT_EXCEPTION_ALREADY_SUBSCRIBED,
+    SIMCONNECT_EXCEPTION_INVALID_ENUM,
+    SIMCONNECT_EXCEPTION_DEFINITION_ERROR,
+};
+
+enum SIMCONNECT_PERIOD
+{
+    SIMCONNECT_PERIOD_NEVER,
+    SIMCONNECT_PERIOD_ONCE,
+    SIMCONNECT_PERIOD_VISUAL_FRAME,
+    SIMCONNECT_PERIOD_SIM_FRAME,
+    SIMCONNECT_PERIOD_SECOND,
+};
+
+enum SIMCONNECT_SIMOBJECT_TYPE
+{
+    SIMCONNECT_SIMOBJECT_TYPE_USER,
+    SIMCONNECT_SIMOBJECT_TYPE_ALL,
+    SIMCONNECT_SIMOBJECT_TYPE_AIRCRAFT,
+    SIMCONNECT_SIMOBJECT_TYPE_HELICOPTER,
+    SIMCONNECT_SIMOBJECT_TYPE_BOAT,
+    SIMCONNECT_SIMOBJECT_TYPE_GROUND,
+};
+
+#pragma pack(push, 1)
+
+struct SIMCONNECT_RECV
+{
+    DWORD dwSize;
+    DWORD dwVersion;
+    DWORD dwID;
+};
+
+struct SIMCONNECT_RECV_EXCEPTION : public SIMCONNECT_RECV
+{
+    DWORD dwException;
+    DWORD dwSendID;
+    DWORD dwIndex;
+};
+
+struct SIMCONNECT_RECV_OPEN : public SIMCONNECT_RECV
+{
+    char szApplicationName[256];
+    DWORD dwApplicationVersionMajor;
+    DWORD dwApplicationVersionMinor;
+    DWORD dwApplicationBuildMajor;
+    DWORD dwApplicationBuildMinor;
+    DWORD dwSimConnectVersionMajor;
+    DWORD dwSimConnectVersionMinor;
+    DWORD dwSimConnectBuildMajor;
+    DWORD dwSimConnectBuildMinor;
+    DWORD dwReserved1;
+    DWORD dwReserved2;
+};
+
+struct SIMCONNECT_RECV_QUIT : public SIMCONNECT_RECV
+{
+};
+
+struct SIMCONNECT_RECV_SIMOBJECT_DATA : public SIMCONNECT_RECV
+{
+    DWORD dwRequestID;
+    DWORD dwObjectID;
+    DWORD dwDefineID;
+    DWORD dwFlags;
+    DWORD dwentrynumber;
+    DWORD dwoutof;
+    DWORD dwDefineCount;
+    DWORD dwData;
+};
+
+struct SIMCONNECT_RECV_SIMOBJECT_DATA_BYTYPE : public SIMCONNECT_RECV_SIMOBJECT_DATA
+{
+};
+
+#pragma pack(pop)
+
+typedef void (CALLBACK* DispatchProc)(SIMCONNECT_RECV* pData, DWORD cbData, void* pContext);
+
+SIMCONNECTAPI SimConnect_Open(HANDLE* phSimConnect, LPCSTR szName, HWND hWnd, DWORD UserEventWin32, HANDLE hEventHandle, DWORD ConfigIndex);
+SIMCONNECTAPI SimConnect_Close(HANDLE hSimConnect);
+SIMCONNECTAPI SimConnect_AddToDataDefinition(HANDLE hSimConnect, SIMCONNECT_DATA_DEFINITION_ID DefineID, const char* DatumName, const char* UnitsName, SIMCONNECT_DATATYPE DatumType = SIMCONNECT_DATATYPE_FLOAT64, float fEpsilon = 0, DWORD DatumID = SIMCONNECT_UNUSED);
+SIMCONNECTAPI SimConnect_RequestDataOnSimObject(HANDLE hSimConnect, SIMCONNECT_DATA_REQUEST_ID RequestID, SIMCONNECT_DATA_DEFINITION_ID DefineID, SIMCONNECT_OBJECT_ID ObjectID, SIMCONNECT_PERIOD Period, SIMCONNECT_DATA_REQUEST_FLAG Flags = 0, DWORD origin = 0, DWORD interval = 0, DWORD limit = 0);
+SIMCONNECTAPI SimConnect_RequestDataOnSimObjectType(HANDLE hSimConnect, SIMCONNECT_DATA_REQUEST_ID RequestID, SIMCONNECT_DATA_DEFINITION_ID DefineID, DWORD dwRadiusMeters, SIMCONNECT_SIMOBJECT_TYPE type);
+SIMCONNECTAPI SimConnect_CallDispatch(HANDLE hSimConnect, DispatchProc pfcnDispatch, void* pContext);
+SIMCONNECTAPI SimConnect_GetNextDispatch(HANDLE hSimConnect, SIMCONNECT_RECV** ppData, DWORD* pcbData);
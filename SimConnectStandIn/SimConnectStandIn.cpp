@@ -0,0 +1,846 @@
+#include <chrono>
+#include <ctype.h>
+#include <deque>
+#include <map>
+#include <math.h>
+#include <random>
+#include <stdio.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+#include "SimConnectStandIn.h"
+
+static const double PI = 3.14159265358979323846;
+static const double EARTH_RADIUS_NM = 3443.9308855292;
+static const double METERS_PER_NM = 1852;
+static const double METERS_PER_FOOT = 0.3048;
+static const double STANDARD_RATE_DEG_PER_SEC = 3;
+
+static const char* const LIVERIES[] = {
+    "Boeing 737-800 Paint1", "Boeing 737-800 Paint3", "Airbus A321 Paint2", "Boeing 777-300ER Paint1",
+    "Bombardier CRJ700 Paint4", "Embraer E175 Paint2", "Beechcraft King Air 350 Paint1", "Cessna Skyhawk 172SP Paint2",
+};
+
+enum StandInPath
+{
+    PATH_STRAIGHT,
+    PATH_ORBIT,
+    PATH_PARKED,
+};
+
+struct SimAircraft
+{
+    uint32_t objectId;
+    uint32_t registration;      // the number in the ATC ID, the same on every connection
+    const char* title;
+    StandInPath path;
+    bool user;
+    double latitude;
+    double longitude;
+    double altitudeFt;
+    double headingDeg;          // true
+    double speedKts;            // true airspeed, along the heading; see groundVelocity()
+    double turnRateDegPerSec;   // + right, - left
+    double verticalSpeedFpm;
+};
+
+enum Quantity
+{
+    QUANTITY_STRING,
+    QUANTITY_BOOL,
+    QUANTITY_ANGLE,             // native unit degrees
+    QUANTITY_LENGTH,            // feet
+    QUANTITY_SPEED,             // knots
+    QUANTITY_CLIMB,             // feet per minute
+};
+
+struct Datum
+{
+    int variable;               // index into VARIABLES
+    double scale;               // native value to requested units
+    SIMCONNECT_DATATYPE type;
+    double epsilon;             // a changed-only request sends the datum again once it has moved more than this
+    DWORD datumId;              // names the datum in tagged data
+};
+
+struct Variable
+{
+    const char* name;
+    Quantity quantity;
+};
+
+enum
+{
+    VAR_TITLE,
+    VAR_ATC_ID,
+    VAR_IS_USER_SIM,
+    VAR_SIM_ON_GROUND,
+    VAR_HEADING_TRUE,
+    VAR_HEADING_MAGNETIC,
+    VAR_ALTITUDE,
+    VAR_LATITUDE,
+    VAR_LONGITUDE,
+    VAR_GROUND_VELOCITY,
+    VAR_GROUND_TRACK,
+    VAR_AIRSPEED_TRUE,
+    VAR_VERTICAL_SPEED,
+    VAR_PITCH,
+    VAR_BANK,
+};
+
+static const Variable VARIABLES[] = {
+    { "TITLE", QUANTITY_STRING },
+    { "ATC ID", QUANTITY_STRING },
+    { "IS USER SIM", QUANTITY_BOOL },
+    { "SIM ON GROUND", QUANTITY_BOOL },
+    { "PLANE HEADING DEGREES TRUE", QUANTITY_ANGLE },
+    { "PLANE HEADING DEGREES MAGNETIC", QUANTITY_ANGLE },
+    { "PLANE ALTITUDE", QUANTITY_LENGTH },
+    { "PLANE LATITUDE", QUANTITY_ANGLE },
+    { "PLANE LONGITUDE", QUANTITY_ANGLE },
+    { "GROUND VELOCITY", QUANTITY_SPEED },
+    { "GPS GROUND TRUE TRACK", QUANTITY_ANGLE },
+    { "AIRSPEED TRUE", QUANTITY_SPEED },
+    { "VERTICAL SPEED", QUANTITY_CLIMB },
+    { "PLANE PITCH DEGREES", QUANTITY_ANGLE },
+    { "PLANE BANK DEGREES", QUANTITY_ANGLE },
+};
+
+/**
+* A periodic RequestDataOnSimObject.
+*/
+struct Subscription
+{
+    DWORD requestId;
+    DWORD defineId;
+    size_t aircraft;            // index into StandInConnection::aircraft
+    double spacing;             // seconds between transmissions
+    double nextDue;             // sim time of the next transmission
+    DWORD remaining;            // transmissions left, 0 for no limit
+    DWORD flags;                // SIMCONNECT_DATA_REQUEST_FLAG_*
+    std::vector<double> sent;   // CHANGED: each datum's value when it was last sent; empty before the first transmission
+};
+
+/**
+* Per-connection state; the HANDLE given out by SimConnect_Open points at one of these.
+*/
+struct StandInConnection
+{
+    StandInSettings settings;
+    HANDLE hEvent;
+    std::map<SIMCONNECT_DATA_DEFINITION_ID, std::vector<Datum>> definitions;
+    std::vector<SimAircraft> aircraft;
+    std::deque<std::vector<uint8_t>> queue;
+    std::vector<uint8_t> current;       // message last handed out by SimConnect_GetNextDispatch
+    std::vector<Subscription> subscriptions;
+    std::vector<bool> changed;          // scratch for changedDatums()
+    double simTime;
+    std::chrono::steady_clock::time_point lastStep;
+    StandInStats stats;
+};
+
+static StandInSettings configuredSettings = defaultStandInSettings();
+
+StandInSettings defaultStandInSettings()
+{
+    StandInSettings settings;
+    settings.aircraft = 500;
+    settings.centreLat = 32.951917;
+    settings.centreLon = -97.264323;
+    settings.spawnRadiusNm = 60;
+    settings.orbitShare = 0.2;
+    settings.parkedShare = 0.1;
+    settings.magneticVariationDeg = 3.5;
+    settings.windFromDeg = 270;
+    settings.windKts = 25;
+    settings.seed = 1;
+    settings.timeScale = 1;
+    settings.maxRadiusMeters = 200000;
+    settings.frameRate = 30;
+    settings.firstObjectId = 2;
+    return settings;
+}
+
+void configureStandIn(const StandInSettings& settings)
+{
+    configuredSettings = settings;
+}
+
+static double toRadians(double degrees)
+{
+    return degrees * (PI / 180);
+}
+
+static double wrapDegrees(double degrees)
+{
+    degrees = fmod(degrees, 360);
+    return degrees < 0 ? degrees + 360 : degrees;
+}
+
+static double distanceNm(double lat1, double lon1, double lat2, double lon2)
+{
+    double sinHalfDLat = sin(toRadians(lat2 - lat1) / 2);
+    double sinHalfDLon = sin(toRadians(lon2 - lon1) / 2);
+    double a = sinHalfDLat * sinHalfDLat + cos(toRadians(lat1)) * cos(toRadians(lat2)) * sinHalfDLon * sinHalfDLon;
+    return 2 * atan2(sqrt(a), sqrt(1 - a)) * EARTH_RADIUS_NM;
+}
+
+static double bearingDeg(double lat1, double lon1, double lat2, double lon2)
+{
+    double dLon = toRadians(lon2 - lon1);
+    double y = sin(dLon) * cos(toRadians(lat2));
+    double x = cos(toRadians(lat1)) * sin(toRadians(lat2)) - sin(toRadians(lat1)) * cos(toRadians(lat2)) * cos(dLon);
+    return wrapDegrees(atan2(y, x) * (180 / PI));
+}
+
+static void spawnTraffic(StandInConnection& connection)
+{
+    const StandInSettings& settings = connection.settings;
+    std::mt19937 rng(settings.seed);
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+    double cosLat = cos(toRadians(settings.centreLat));
+
+    // The user aircraft circles the centre slowly so ranges and bearings keep changing
+    SimAircraft user = {};
+    user.objectId = 1;
+    user.registration = 1;
+    user.title = "Mooney Bravo";
+    user.path = PATH_ORBIT;
+    user.user = true;
+    user.latitude = settings.centreLat;
+    user.longitude = settings.centreLon;
+    user.altitudeFt = 3799;
+    user.speedKts = 150;
+    user.turnRateDegPerSec = 0.5;
+    connection.aircraft.push_back(user);
+
+    for (uint32_t i = 0; i < settings.aircraft; i++)
+    {
+        SimAircraft aircraft = {};
+        aircraft.objectId = settings.firstObjectId + i;
+        aircraft.registration = i + 2;
+        aircraft.title = LIVERIES[i % (sizeof(LIVERIES) / sizeof(LIVERIES[0]))];
+
+        double pick = unit(rng);
+        aircraft.path = pick < settings.parkedShare ? PATH_PARKED : (pick < settings.parkedShare + settings.orbitShare ? PATH_ORBIT : PATH_STRAIGHT);
+
+        double r = settings.spawnRadiusNm * sqrt(unit(rng));
+        double theta = 2 * PI * unit(rng);
+        aircraft.latitude = settings.centreLat + r * cos(theta) / 60;
+        aircraft.longitude = settings.centreLon + r * sin(theta) / (60 * cosLat);
+        aircraft.headingDeg = 360 * unit(rng);
+
+        if (aircraft.path == PATH_PARKED)
+        {
+            aircraft.altitudeFt = 600;
+        }
+        else
+        {
+            aircraft.altitudeFt = 2000 + 39000 * unit(rng);
+            aircraft.speedKts = 140 + 340 * unit(rng);
+            if (aircraft.path == PATH_ORBIT)
+                aircraft.turnRateDegPerSec = unit(rng) < 0.5 ? -STANDARD_RATE_DEG_PER_SEC : STANDARD_RATE_DEG_PER_SEC;
+            else if (unit(rng) < 0.5)
+                aircraft.verticalSpeedFpm = 3000 * unit(rng) - 1500;   // half the straight-path traffic climbs or descends
+        }
+        connection.aircraft.push_back(aircraft);
+    }
+}
+
+/**
+* Velocity over the ground: the true airspeed along the heading plus the wind. Orbits are flown over the ground,
+* so the wind only carries the straight-path traffic off its heading; an orbit would otherwise drift downwind
+* and take the user aircraft away from the traffic.
+*/
+static void groundVelocity(const StandInSettings& settings, const SimAircraft& aircraft, double& northKts, double& eastKts)
+{
+    double heading = toRadians(aircraft.headingDeg);
+    double windKts = aircraft.path == PATH_STRAIGHT ? settings.windKts : 0;
+    double windTo = toRadians(settings.windFromDeg + 180);
+    northKts = aircraft.speedKts * cos(heading) + windKts * cos(windTo);
+    eastKts = aircraft.speedKts * sin(heading) + windKts * sin(windTo);
+}
+
+static void stepTraffic(StandInConnection& connection, double seconds)
+{
+    const StandInSettings& settings = connection.settings;
+    for (SimAircraft& aircraft : connection.aircraft)
+    {
+        if (aircraft.path == PATH_PARKED || seconds <= 0)
+            continue;
+
+        // Short steps keep circles round when a long interval is advanced at once
+        double remaining = seconds;
+        while (remaining > 0)
+        {
+            double dt = remaining < 1 ? remaining : 1;
+            remaining -= dt;
+
+            aircraft.headingDeg = wrapDegrees(aircraft.headingDeg + aircraft.turnRateDegPerSec * dt);
+            double northKts, eastKts;
+            groundVelocity(settings, aircraft, northKts, eastKts);
+            aircraft.latitude += northKts * dt / 3600 / 60;
+            aircraft.longitude += eastKts * dt / 3600 / (60 * cos(toRadians(aircraft.latitude)));
+            aircraft.altitudeFt += aircraft.verticalSpeedFpm * dt / 60;
+
+            // Climbers and descenders turn around at the edges of the altitude band
+            if ((aircraft.altitudeFt < 2000 && aircraft.verticalSpeedFpm < 0) || (aircraft.altitudeFt > 41000 && aircraft.verticalSpeedFpm > 0))
+                aircraft.verticalSpeedFpm = -aircraft.verticalSpeedFpm;
+        }
+
+        if (aircraft.path == PATH_STRAIGHT &&
+            distanceNm(settings.centreLat, settings.centreLon, aircraft.latitude, aircraft.longitude) > settings.spawnRadiusNm)
+            aircraft.headingDeg = bearingDeg(aircraft.latitude, aircraft.longitude, settings.centreLat, settings.centreLon);
+    }
+}
+
+static void enqueue(StandInConnection& connection, std::vector<uint8_t>&& message)
+{
+    connection.queue.push_back(std::move(message));
+    connection.stats.messagesQueued++;
+#ifdef _WIN32
+    if (connection.hEvent)
+        SetEvent(connection.hEvent);
+#endif
+}
+
+static void enqueueException(StandInConnection& connection, SIMCONNECT_EXCEPTION exception, DWORD index)
+{
+    SIMCONNECT_RECV_EXCEPTION message = {};
+    message.dwSize = sizeof(message);
+    message.dwVersion = 4;
+    message.dwID = SIMCONNECT_RECV_ID_EXCEPTION;
+    message.dwException = exception;
+    message.dwIndex = index;
+
+    const uint8_t* bytes = (const uint8_t*)&message;
+    enqueue(connection, std::vector<uint8_t>(bytes, bytes + sizeof(message)));
+}
+
+static size_t datumSize(SIMCONNECT_DATATYPE type)
+{
+    switch (type)
+    {
+    case SIMCONNECT_DATATYPE_INT32: return 4;
+    case SIMCONNECT_DATATYPE_INT64: return 8;
+    case SIMCONNECT_DATATYPE_FLOAT32: return 4;
+    case SIMCONNECT_DATATYPE_FLOAT64: return 8;
+    case SIMCONNECT_DATATYPE_STRING8: return 8;
+    case SIMCONNECT_DATATYPE_STRING32: return 32;
+    case SIMCONNECT_DATATYPE_STRING64: return 64;
+    case SIMCONNECT_DATATYPE_STRING128: return 128;
+    case SIMCONNECT_DATATYPE_STRING256: return 256;
+    case SIMCONNECT_DATATYPE_STRING260: return 260;
+    default: return 0;
+    }
+}
+
+static std::string upper(const char* text)
+{
+    std::string result = text ? text : "";
+    for (char& c : result)
+        c = (char)toupper((unsigned char)c);
+    return result;
+}
+
+/**
+* Factor from the variable's native unit to the requested one, or a negative value for units that do not fit.
+*/
+static double unitScale(Quantity quantity, const std::string& units)
+{
+    switch (quantity)
+    {
+    case QUANTITY_STRING:
+        return 1;
+    case QUANTITY_BOOL:
+        return units.empty() || units == "BOOL" || units == "BOOLEAN" || units == "NUMBER" ? 1 : -1;
+    case QUANTITY_ANGLE:
+        if (units.empty() || units == "DEGREES" || units == "DEGREE")
+            return 1;
+        return units == "RADIANS" || units == "RADIAN" ? PI / 180 : -1;
+    case QUANTITY_LENGTH:
+        if (units.empty() || units == "FEET" || units == "FOOT")
+            return 1;
+        return units == "METERS" || units == "METER" ? METERS_PER_FOOT : -1;
+    case QUANTITY_SPEED:
+        if (units.empty() || units == "KNOTS" || units == "KNOT")
+            return 1;
+        if (units == "FEET PER SECOND")
+            return METERS_PER_NM / METERS_PER_FOOT / 3600;
+        if (units == "FEET PER MINUTE")
+            return METERS_PER_NM / METERS_PER_FOOT / 60;
+        return units == "METERS PER SECOND" ? METERS_PER_NM / 3600 : -1;
+    case QUANTITY_CLIMB:
+        if (units.empty() || units == "FEET PER MINUTE")
+            return 1;
+        if (units == "FEET PER SECOND")
+            return 1.0 / 60;
+        return units == "METERS PER SECOND" ? METERS_PER_FOOT / 60 : -1;
+    }
+    return -1;
+}
+
+static double variableValue(const StandInConnection& connection, const SimAircraft& aircraft, int variable)
+{
+    double northKts = 0, eastKts = 0;
+    if (variable == VAR_GROUND_VELOCITY || variable == VAR_GROUND_TRACK)
+        groundVelocity(connection.settings, aircraft, northKts, eastKts);
+
+    switch (variable)
+    {
+    case VAR_IS_USER_SIM: return aircraft.user ? 1 : 0;
+    case VAR_SIM_ON_GROUND: return aircraft.path == PATH_PARKED ? 1 : 0;
+    case VAR_HEADING_TRUE: return aircraft.headingDeg;
+    case VAR_HEADING_MAGNETIC: return wrapDegrees(aircraft.headingDeg - connection.settings.magneticVariationDeg);
+    case VAR_ALTITUDE: return aircraft.altitudeFt;
+    case VAR_LATITUDE: return aircraft.latitude;
+    case VAR_LONGITUDE: return aircraft.longitude;
+    case VAR_GROUND_VELOCITY: return aircraft.path == PATH_PARKED ? 0 : sqrt(northKts * northKts + eastKts * eastKts);
+    case VAR_GROUND_TRACK: return aircraft.path == PATH_PARKED ? aircraft.headingDeg : wrapDegrees(atan2(eastKts, northKts) * (180 / PI));
+    case VAR_AIRSPEED_TRUE: return aircraft.speedKts;
+    case VAR_VERTICAL_SPEED: return aircraft.verticalSpeedFpm;
+    case VAR_BANK: return aircraft.turnRateDegPerSec > 0 ? -25 : (aircraft.turnRateDegPerSec < 0 ? 25 : 0);   // SimConnect reports right bank as negative
+    default: return 0;
+    }
+}
+
+static void writeDatum(uint8_t* out, const Datum& datum, const StandInConnection& connection, const SimAircraft& aircraft)
+{
+    size_t size = datumSize(datum.type);
+    if (datum.type >= SIMCONNECT_DATATYPE_STRING8)
+    {
+        char text[260] = {};
+        if (datum.variable == VAR_TITLE)
+            snprintf(text, sizeof(text), "%s", aircraft.title);
+        else if (datum.variable == VAR_ATC_ID)
+            snprintf(text, sizeof(text), "N%uSI", aircraft.registration);
+        memcpy(out, text, size);
+        out[size - 1] = '\0';
+        return;
+    }
+
+    double value = variableValue(connection, aircraft, datum.variable) * datum.scale;
+    switch (datum.type)
+    {
+    case SIMCONNECT_DATATYPE_INT32: { int32_t v = (int32_t)value; memcpy(out, &v, sizeof(v)); break; }
+    case SIMCONNECT_DATATYPE_INT64: { int64_t v = (int64_t)value; memcpy(out, &v, sizeof(v)); break; }
+    case SIMCONNECT_DATATYPE_FLOAT32: { float v = (float)value; memcpy(out, &v, sizeof(v)); break; }
+    default: memcpy(out, &value, sizeof(value)); break;
+    }
+}
+
+/**
+* Queue one SIMOBJECT_DATA or SIMOBJECT_DATA_BYTYPE message carrying definition for aircraft; the two share a layout.
+* With SIMCONNECT_DATA_REQUEST_FLAG_TAGGED in flags only the datums marked in include are sent, each after its DatumID.
+*/
+static void enqueueData(StandInConnection& connection, SIMCONNECT_RECV_ID id, DWORD requestId, DWORD defineId, const std::vector<Datum>& definition,
+    const SimAircraft& aircraft, DWORD entryNumber, DWORD outOf, DWORD flags = 0, const std::vector<bool>* include = NULL)
+{
+    bool tagged = (flags & SIMCONNECT_DATA_REQUEST_FLAG_TAGGED) != 0;
+    size_t dataSize = 0;
+    DWORD count = 0;
+    for (size_t i = 0; i < definition.size(); i++)
+    {
+        if (tagged && include && !(*include)[i])
+            continue;
+        dataSize += datumSize(definition[i].type) + (tagged ? sizeof(DWORD) : 0);
+        count++;
+    }
+
+    SIMCONNECT_RECV_SIMOBJECT_DATA header = {};
+    size_t headerSize = sizeof(header) - sizeof(header.dwData);
+    header.dwSize = (DWORD)(headerSize + dataSize);
+    header.dwVersion = 4;
+    header.dwID = id;
+    header.dwRequestID = requestId;
+    header.dwObjectID = aircraft.objectId;
+    header.dwDefineID = defineId;
+    header.dwFlags = flags;
+    header.dwentrynumber = entryNumber;
+    header.dwoutof = outOf;
+    header.dwDefineCount = count;
+
+    std::vector<uint8_t> message(header.dwSize);
+    memcpy(message.data(), &header, headerSize);
+    uint8_t* out = message.data() + headerSize;
+    for (size_t i = 0; i < definition.size(); i++)
+    {
+        if (tagged && include && !(*include)[i])
+            continue;
+        if (tagged)
+        {
+            memcpy(out, &definition[i].datumId, sizeof(DWORD));
+            out += sizeof(DWORD);
+        }
+        writeDatum(out, definition[i], connection, aircraft);
+        out += datumSize(definition[i].type);
+    }
+    enqueue(connection, std::move(message));
+}
+
+/**
+* For a changed-only subscription, mark the datums that moved by more than their epsilon since they were last
+* sent and remember their new values. Returns false when nothing changed and nothing should go out.
+* Strings never change in the stand-in's world, so they go out with the first transmission only.
+*/
+static bool changedDatums(const StandInConnection& connection, Subscription& subscription, const std::vector<Datum>& definition,
+    const SimAircraft& aircraft, std::vector<bool>& include)
+{
+    bool first = subscription.sent.size() != definition.size();
+    if (first)
+        subscription.sent.assign(definition.size(), 0);
+
+    bool any = false;
+    include.assign(definition.size(), first);
+    for (size_t i = 0; i < definition.size(); i++)
+    {
+        const Datum& datum = definition[i];
+        if (datum.type >= SIMCONNECT_DATATYPE_STRING8)
+            continue;
+        double value = variableValue(connection, aircraft, datum.variable) * datum.scale;
+        if (first || fabs(value - subscription.sent[i]) > datum.epsilon)
+        {
+            include[i] = true;
+            subscription.sent[i] = value;
+        }
+        any |= include[i];
+    }
+    return any || first;
+}
+
+/**
+* Send every periodic request that has come due by the current sim time.
+*/
+static void serviceSubscriptions(StandInConnection& connection)
+{
+    for (size_t i = 0; i < connection.subscriptions.size(); )
+    {
+        Subscription& subscription = connection.subscriptions[i];
+        auto definition = connection.definitions.find(subscription.defineId);
+        if (connection.simTime + 1e-9 < subscription.nextDue || definition == connection.definitions.end())
+        {
+            i++;
+            continue;
+        }
+
+        // A changed-only request skips the transmission when nothing moved past its epsilon, but keeps its schedule
+        const SimAircraft& aircraft = connection.aircraft[subscription.aircraft];
+        if (!(subscription.flags & SIMCONNECT_DATA_REQUEST_FLAG_CHANGED))
+        {
+            enqueueData(connection, SIMCONNECT_RECV_ID_SIMOBJECT_DATA, subscription.requestId, subscription.defineId, definition->second,
+                aircraft, 1, 1, subscription.flags);
+        }
+        else if (changedDatums(connection, subscription, definition->second, aircraft, connection.changed))
+        {
+            enqueueData(connection, SIMCONNECT_RECV_ID_SIMOBJECT_DATA, subscription.requestId, subscription.defineId, definition->second,
+                aircraft, 1, 1, subscription.flags, &connection.changed);
+        }
+        else
+        {
+            connection.stats.unchanged++;
+        }
+
+        // A slow client gets one message per due period, not a burst to catch up
+        subscription.nextDue += subscription.spacing;
+        if (subscription.nextDue <= connection.simTime)
+            subscription.nextDue = connection.simTime + subscription.spacing;
+
+        if (subscription.remaining != 0 && --subscription.remaining == 0)
+            connection.subscriptions.erase(connection.subscriptions.begin() + i);
+        else
+            i++;
+    }
+}
+
+/**
+* Advance sim time. Periodic requests need the world stepped frame by frame so each one sees its own position.
+*/
+static void stepWorld(StandInConnection& connection, double seconds)
+{
+    if (seconds <= 0)
+        return;
+
+    if (connection.subscriptions.empty())
+    {
+        stepTraffic(connection, seconds);
+        connection.simTime += seconds;
+        return;
+    }
+
+    double frame = 1 / connection.settings.frameRate;
+    while (seconds > 1e-12)
+    {
+        double dt = seconds < frame ? seconds : frame;
+        seconds -= dt;
+        stepTraffic(connection, dt);
+        connection.simTime += dt;
+        serviceSubscriptions(connection);
+    }
+}
+
+static void catchUp(StandInConnection& connection)
+{
+    auto now = std::chrono::steady_clock::now();
+    double wallSeconds = std::chrono::duration<double>(now - connection.lastStep).count();
+    connection.lastStep = now;
+    if (connection.settings.timeScale > 0)
+        stepWorld(connection, wallSeconds * connection.settings.timeScale);
+}
+
+// Where ObjectID sits in StandInConnection::aircraft; past the end when no aircraft has it
+static size_t objectIndex(const StandInConnection& connection, DWORD ObjectID)
+{
+    if (ObjectID == SIMCONNECT_OBJECT_ID_USER || ObjectID == connection.aircraft[0].objectId)
+        return 0;
+    if (ObjectID < connection.settings.firstObjectId)
+        return connection.aircraft.size();
+    return (size_t)(ObjectID - connection.settings.firstObjectId) + 1;
+}
+
+static StandInConnection* connectionOf(HANDLE hSimConnect)
+{
+    return (StandInConnection*)hSimConnect;
+}
+
+SIMCONNECTAPI SimConnect_Open(HANDLE* phSimConnect, LPCSTR szName, HWND hWnd, DWORD UserEventWin32, HANDLE hEventHandle, DWORD ConfigIndex)
+{
+    if (!phSimConnect)
+        return E_INVALIDARG;
+
+    StandInConnection* connection = new StandInConnection();
+    connection->settings = configuredSettings;
+    connection->hEvent = hEventHandle;
+    connection->simTime = 0;
+    connection->lastStep = std::chrono::steady_clock::now();
+    connection->stats = StandInStats();
+    spawnTraffic(*connection);
+
+    SIMCONNECT_RECV_OPEN open = {};
+    open.dwSize = sizeof(open);
+    open.dwVersion = 4;
+    open.dwID = SIMCONNECT_RECV_ID_OPEN;
+    snprintf(open.szApplicationName, sizeof(open.szApplicationName), "SimConnect stand-in");
+    open.dwApplicationVersionMajor = 5;
+    open.dwApplicationVersionMinor = 3;
+    open.dwSimConnectVersionMajor = 5;
+    open.dwSimConnectVersionMinor = 3;
+    const uint8_t* bytes = (const uint8_t*)&open;
+    enqueue(*connection, std::vector<uint8_t>(bytes, bytes + sizeof(open)));
+
+    *phSimConnect = connection;
+    return S_OK;
+}
+
+SIMCONNECTAPI SimConnect_Close(HANDLE hSimConnect)
+{
+    if (!hSimConnect)
+        return E_FAIL;
+
+    delete connectionOf(hSimConnect);
+    return S_OK;
+}
+
+SIMCONNECTAPI SimConnect_AddToDataDefinition(HANDLE hSimConnect, SIMCONNECT_DATA_DEFINITION_ID DefineID, const char* DatumName, const char* UnitsName, SIMCONNECT_DATATYPE DatumType, float fEpsilon, DWORD DatumID)
+{
+    StandInConnection* connection = connectionOf(hSimConnect);
+    if (!connection)
+        return E_FAIL;
+
+    std::vector<Datum>& definition = connection->definitions[DefineID];
+    DWORD index = (DWORD)definition.size();
+
+    // Like the simulator, a bad datum is reported later as an exception message rather than by the call
+    std::string name = upper(DatumName);
+    int variable = -1;
+    for (int i = 0; i < (int)(sizeof(VARIABLES) / sizeof(VARIABLES[0])); i++)
+    {
+        if (name == VARIABLES[i].name)
+            variable = i;
+    }
+    if (variable < 0)
+    {
+        enqueueException(*connection, SIMCONNECT_EXCEPTION_NAME_UNRECOGNIZED, index);
+        return S_OK;
+    }
+
+    Quantity quantity = VARIABLES[variable].quantity;
+    bool isString = DatumType >= SIMCONNECT_DATATYPE_STRING8 && DatumType <= SIMCONNECT_DATATYPE_STRING260;
+    double scale = unitScale(quantity, upper(UnitsName));
+    if (datumSize(DatumType) == 0 || isString != (quantity == QUANTITY_STRING))
+    {
+        enqueueException(*connection, SIMCONNECT_EXCEPTION_INVALID_DATA_TYPE, index);
+        return S_OK;
+    }
+    if (scale < 0)
+    {
+        enqueueException(*connection, SIMCONNECT_EXCEPTION_NAME_UNRECOGNIZED, index);
+        return S_OK;
+    }
+
+    definition.push_back({ variable, scale, DatumType, fEpsilon > 0 ? fEpsilon : 0, DatumID });
+    return S_OK;
+}
+
+SIMCONNECTAPI SimConnect_RequestDataOnSimObject(HANDLE hSimConnect, SIMCONNECT_DATA_REQUEST_ID RequestID, SIMCONNECT_DATA_DEFINITION_ID DefineID, SIMCONNECT_OBJECT_ID ObjectID, SIMCONNECT_PERIOD Period, SIMCONNECT_DATA_REQUEST_FLAG Flags, DWORD origin, DWORD interval, DWORD limit)
+{
+    StandInConnection* connection = connectionOf(hSimConnect);
+    if (!connection)
+        return E_FAIL;
+
+    // ObjectIDs are handed out in order after the user aircraft; 0 means the user aircraft
+    auto found = connection->definitions.find(DefineID);
+    size_t index = objectIndex(*connection, ObjectID);
+    if (found == connection->definitions.end() || index >= connection->aircraft.size())
+    {
+        enqueueException(*connection, SIMCONNECT_EXCEPTION_UNRECOGNIZED_ID, 0);
+        return S_OK;
+    }
+
+    catchUp(*connection);
+    connection->stats.requests++;
+
+    // A new request with the same RequestID replaces the old one; NEVER only cancels
+    std::vector<Subscription>& subscriptions = connection->subscriptions;
+    for (size_t i = 0; i < subscriptions.size(); i++)
+    {
+        if (subscriptions[i].requestId == RequestID)
+        {
+            subscriptions.erase(subscriptions.begin() + i);
+            break;
+        }
+    }
+
+    double period;
+    switch (Period)
+    {
+    case SIMCONNECT_PERIOD_NEVER:
+        return S_OK;
+    case SIMCONNECT_PERIOD_ONCE:
+        enqueueData(*connection, SIMCONNECT_RECV_ID_SIMOBJECT_DATA, RequestID, DefineID, found->second, connection->aircraft[index], 1, 1, Flags);
+        return S_OK;
+    case SIMCONNECT_PERIOD_VISUAL_FRAME:
+    case SIMCONNECT_PERIOD_SIM_FRAME:
+        period = 1 / connection->settings.frameRate;
+        break;
+    case SIMCONNECT_PERIOD_SECOND:
+        period = 1;
+        break;
+    default:
+        enqueueException(*connection, SIMCONNECT_EXCEPTION_INVALID_ENUM, 0);
+        return S_OK;
+    }
+
+    Subscription subscription;
+    subscription.requestId = RequestID;
+    subscription.defineId = DefineID;
+    subscription.aircraft = index;
+    subscription.spacing = period * (interval + 1);
+    subscription.nextDue = connection->simTime + period * origin;
+    subscription.remaining = limit;
+    subscription.flags = Flags;
+    subscriptions.push_back(subscription);
+
+    // With origin 0 the first transmission goes out right away, as the first frame after the request would send it
+    if (origin == 0)
+        serviceSubscriptions(*connection);
+    return S_OK;
+}
+
+SIMCONNECTAPI SimConnect_RequestDataOnSimObjectType(HANDLE hSimConnect, SIMCONNECT_DATA_REQUEST_ID RequestID, SIMCONNECT_DATA_DEFINITION_ID DefineID, DWORD dwRadiusMeters, SIMCONNECT_SIMOBJECT_TYPE type)
+{
+    StandInConnection* connection = connectionOf(hSimConnect);
+    if (!connection)
+        return E_FAIL;
+
+    auto found = connection->definitions.find(DefineID);
+    if (found == connection->definitions.end())
+    {
+        enqueueException(*connection, SIMCONNECT_EXCEPTION_UNRECOGNIZED_ID, 0);
+        return S_OK;
+    }
+    const std::vector<Datum>& definition = found->second;
+
+    catchUp(*connection);
+    connection->stats.requests++;
+
+    // The stand-in world has aircraft only; the user aircraft is always aircraft[0]
+    std::vector<const SimAircraft*> selected;
+    const SimAircraft& user = connection->aircraft[0];
+    if (type == SIMCONNECT_SIMOBJECT_TYPE_USER)
+    {
+        selected.push_back(&user);
+    }
+    else if (type == SIMCONNECT_SIMOBJECT_TYPE_ALL || type == SIMCONNECT_SIMOBJECT_TYPE_AIRCRAFT)
+    {
+        DWORD radius = dwRadiusMeters < connection->settings.maxRadiusMeters ? dwRadiusMeters : connection->settings.maxRadiusMeters;
+        double radiusNm = radius / METERS_PER_NM;
+        for (const SimAircraft& aircraft : connection->aircraft)
+        {
+            if (distanceNm(user.latitude, user.longitude, aircraft.latitude, aircraft.longitude) <= radiusNm)
+                selected.push_back(&aircraft);
+        }
+    }
+
+    for (size_t i = 0; i < selected.size(); i++)
+        enqueueData(*connection, SIMCONNECT_RECV_ID_SIMOBJECT_DATA_BYTYPE, RequestID, DefineID, definition, *selected[i], (DWORD)(i + 1), (DWORD)selected.size());
+    return S_OK;
+}
+
+SIMCONNECTAPI SimConnect_GetNextDispatch(HANDLE hSimConnect, SIMCONNECT_RECV** ppData, DWORD* pcbData)
+{
+    StandInConnection* connection = connectionOf(hSimConnect);
+    if (!connection || connection->queue.empty())
+        return E_FAIL;
+
+    connection->current.swap(connection->queue.front());
+    connection->queue.pop_front();
+    connection->stats.messagesDelivered++;
+    connection->stats.bytesDelivered += connection->current.size();
+
+    *ppData = (SIMCONNECT_RECV*)connection->current.data();
+    *pcbData = (DWORD)connection->current.size();
+    return S_OK;
+}
+
+SIMCONNECTAPI SimConnect_CallDispatch(HANDLE hSimConnect, DispatchProc pfcnDispatch, void* pContext)
+{
+    StandInConnection* connection = connectionOf(hSimConnect);
+    if (!connection)
+        return E_FAIL;
+
+    // Deliver what is queued now; messages queued by the callback wait for the next call
+    size_t pending = connection->queue.size();
+    SIMCONNECT_RECV* pData;
+    DWORD cbData;
+    for (size_t i = 0; i < pending && SUCCEEDED(SimConnect_GetNextDispatch(hSimConnect, &pData, &cbData)); i++)
+        pfcnDispatch(pData, cbData, pContext);
+    return S_OK;
+}
+
+void advanceStandIn(HANDLE hSimConnect, double seconds)
+{
+    StandInConnection* connection = connectionOf(hSimConnect);
+    if (connection)
+        stepWorld(*connection, seconds);
+}
+
+void quitStandIn(HANDLE hSimConnect)
+{
+    StandInConnection* connection = connectionOf(hSimConnect);
+    if (!connection)
+        return;
+
+    SIMCONNECT_RECV_QUIT quit = {};
+    quit.dwSize = sizeof(quit);
+    quit.dwVersion = 4;
+    quit.dwID = SIMCONNECT_RECV_ID_QUIT;
+    const uint8_t* bytes = (const uint8_t*)&quit;
+    enqueue(*connection, std::vector<uint8_t>(bytes, bytes + sizeof(quit)));
+}
+
+StandInStats standInStats(HANDLE hSimConnect)
+{
+    StandInConnection* connection = connectionOf(hSimConnect);
+    return connection ? connection->stats : StandInStats();
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <stdint.h>
+
+#include "SimConnect.h"
+
+/**
+* Traffic simulated by the SimConnect stand-in.
+*
+* Each connection owns its own world: a user aircraft circling the centre point and `aircraft` AI aircraft
+* spawned within spawnRadiusNm of it. Straight-path aircraft fly a constant heading and turn back toward the
+* centre when they leave the spawn area; half of them also climb or descend between 2000 and 41000 ft.
+* Orbiting aircraft fly standard-rate circles; parked aircraft sit on the ground.
+*
+* RequestDataOnSimObjectType returns every aircraft within the requested radius of the user aircraft, user
+* included, as one SIMOBJECT_DATA_BYTYPE message each with dwentrynumber 1..dwoutof.
+* RequestDataOnSimObject answers SIMCONNECT_PERIOD_ONCE at once with one SIMOBJECT_DATA message. SIM_FRAME,
+* VISUAL_FRAME and SECOND requests repeat every interval + 1 periods of sim time, after origin periods and
+* up to limit times, until the same RequestID is requested again with SIMCONNECT_PERIOD_NEVER. A frame is
+* 1 / frameRate seconds; while periodic requests are active the world advances one frame at a time.
+*
+* With SIMCONNECT_DATA_REQUEST_FLAG_CHANGED a periodic request only transmits when some datum has moved by
+* more than the fEpsilon it was added with since it was last sent; skipped transmissions are counted in
+* unchanged. Adding SIMCONNECT_DATA_REQUEST_FLAG_TAGGED sends just those datums, each as its DatumID followed
+* by its value, with dwDefineCount the number sent. The first transmission of a request carries every datum.
+*
+* Connections opened with the same seed hold the same aircraft, like the nodes of one multiplayer session.
+* The ATC ID goes with the aircraft rather than its ObjectID, so with different firstObjectIds the nodes name
+* the same aircraft alike under different ObjectIDs.
+*/
+struct StandInSettings
+{
+    uint32_t aircraft;              // AI aircraft, not counting the user aircraft
+    double centreLat;
+    double centreLon;
+    double spawnRadiusNm;
+    double orbitShare;              // fraction of the AI aircraft flying circles
+    double parkedShare;             // fraction parked on the ground; the rest fly straight
+    double magneticVariationDeg;    // east positive, applied to every heading
+    double windFromDeg;             // true; the same at every altitude, it sets the straight-path traffic's track off its heading
+    double windKts;
+    uint32_t seed;
+    double timeScale;               // sim seconds per wall-clock second; 0 moves traffic only in advanceStandIn()
+    uint32_t maxRadiusMeters;       // the simulator caps RequestDataOnSimObjectType at 200 km
+    double frameRate;               // sim frames per second
+    uint32_t firstObjectId;         // ObjectID of the first AI aircraft, 2 or more; nodes of one shared world number it differently
+};
+
+struct StandInStats
+{
+    uint64_t requests;
+    uint64_t messagesQueued;
+    uint64_t messagesDelivered;
+    uint64_t bytesDelivered;
+    uint64_t unchanged;             // transmissions a changed-only request skipped
+};
+
+StandInSettings defaultStandInSettings();
+
+// Settings for connections opened after this call
+void configureStandIn(const StandInSettings& settings);
+
+// Move the traffic of one connection forward by seconds of sim time
+void advanceStandIn(HANDLE hSimConnect, double seconds);
+
+// Queue SIMCONNECT_RECV_ID_QUIT, as when the user closes the simulator
+void quitStandIn(HANDLE hSimConnect);
+
+StandInStats standInStats(HANDLE hSimConnect);
@@ -0,0 +1,239 @@
+#include <atomic>
+#include <chrono>
+#include <stdio.h>
+#include <string.h>
+#include <thread>
+#include <vector>
+
+#include "BenchCommon.h"
+#include "LatencyHistogram.h"
+#include "TrafficAggregator.h"
+#include "TrafficMessage.h"
+
+static const size_t SHARED = 300;           // aircraft every node of the shared session sees
+static const size_t OWN = 200;              // aircraft only the third node sees...
+static const size_t NAMESAKES = 100;        // ...of which this many have the identity of a shared aircraft, far from it
+static const double CENTRE_LAT = 32.951917;
+static const double CENTRE_LON = -97.264323;
+static const double STALE_SECONDS = 0.1;
+static const int MERGE_EVERY_MS = 5;
+
+static double benchClock()
+{
+    return monotonicNs() / 1e9;
+}
+
+struct NodeAircraft
+{
+    AircraftState state;
+    AircraftIdentity identity;
+};
+
+/**
+* A simulator node: a sweep of its aircraft on every poll, under ObjectIDs of its own. It can be stalled inside
+* poll(), as a node on a loaded machine or a dead link would be, and closed.
+*/
+class FakeNode : public TrafficSource
+{
+public:
+    FakeNode(const std::vector<NodeAircraft>& aircraft, uint32_t firstObjectId)
+        : stalled(false)
+        , closed(false)
+        , stuck(false)
+        , sweeps(0)
+        , m_aircraft(aircraft)
+        , m_firstObjectId(firstObjectId)
+    {
+    }
+
+    bool poll(uint32_t timeoutMs, MessageHandler handler, void* context) override
+    {
+        while (stalled.load())
+        {
+            stuck.store(true);
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        stuck.store(false);
+        if (closed.load())
+            return false;
+
+        m_stream.clear();
+        uint32_t outOf = (uint32_t)m_aircraft.size();
+        for (uint32_t i = 0; i < outOf; i++)
+            appendTrafficMessage(m_stream, 1, m_firstObjectId + i, i + 1, outOf, packState(m_aircraft[i].state));
+        for (uint32_t objectId : m_identityRequests)
+            appendIdentityMessage(m_stream, 2, objectId, m_aircraft[objectId - m_firstObjectId].identity);
+        m_identityRequests.clear();
+
+        for (size_t offset = 0; offset < m_stream.size(); )
+        {
+            TrafficMessageHeader header;
+            memcpy(&header, &m_stream[offset], sizeof(header));
+            handler(&m_stream[offset], header.size, context);
+            offset += header.size;
+        }
+        sweeps.fetch_add(1);
+        std::this_thread::sleep_for(std::chrono::milliseconds(timeoutMs < 2 ? timeoutMs : 2));
+        return true;
+    }
+
+    void requestIdentity(uint32_t objectId) override
+    {
+        m_identityRequests.push_back(objectId);
+    }
+
+    std::atomic<bool> stalled;
+    std::atomic<bool> closed;
+    std::atomic<bool> stuck;                // a poll is waiting out the stall
+    std::atomic<uint64_t> sweeps;
+
+private:
+    std::vector<NodeAircraft> m_aircraft;
+    uint32_t m_firstObjectId;
+    std::vector<uint32_t> m_identityRequests;
+    std::vector<uint8_t> m_stream;
+};
+
+static NodeAircraft makeAircraft(const TrafficSample& sample, size_t i, uint32_t registration)
+{
+    NodeAircraft aircraft = {};
+    aircraft.state.trueHeading = 0.01 * (i % 628);
+    aircraft.state.magHeading = aircraft.state.trueHeading;
+    aircraft.state.altitude = 2000 + sample.altitude[i] * 0.8;
+    aircraft.state.latitude = sample.latitude[i];
+    aircraft.state.longitude = sample.longitude[i];
+    aircraft.state.groundSpeed = 250;
+    snprintf(aircraft.identity.title, sizeof(aircraft.identity.title), "Airliner %zu", i % 7);
+    snprintf(aircraft.identity.atcId, sizeof(aircraft.identity.atcId), "N%uSI", registration);
+    return aircraft;
+}
+
+/**
+* Merge stats over a run of merges, for the timing at the end.
+*/
+struct MergeTotals
+{
+    uint64_t records;
+    double ns;
+    double maxNs;
+};
+
+static void mergeFor(TrafficAggregator& aggregator, int milliseconds, MergeTotals& totals)
+{
+    auto end = std::chrono::steady_clock::now() + std::chrono::milliseconds(milliseconds);
+    while (std::chrono::steady_clock::now() < end)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(MERGE_EVERY_MS));
+        Stopwatch clock;
+        totals.records += aggregator.merge(benchClock());
+        double ns = clock.elapsedNs();
+        totals.ns += ns;
+        if (ns > totals.maxNs)
+            totals.maxNs = ns;
+    }
+}
+
+static size_t countWithSources(const TrafficAggregator& aggregator, uint64_t sources)
+{
+    size_t count = 0;
+    for (const AggregatedAircraft& aircraft : aggregator.aircraft())
+    {
+        if (aircraft.sources == sources)
+            count++;
+    }
+    return count;
+}
+
+int runAggregateBench()
+{
+    TrafficSample sample = makeTrafficSample(SHARED + OWN, CENTRE_LAT, CENTRE_LON, 60, 37);
+
+    // Two nodes of the shared session see the same aircraft a little apart, as their clocks differ
+    std::vector<NodeAircraft> shared, nearby, own;
+    for (size_t i = 0; i < SHARED; i++)
+    {
+        shared.push_back(makeAircraft(sample, i, (uint32_t)i + 2));
+        nearby.push_back(shared.back());
+        nearby.back().state.latitude += 0.002;
+        nearby.back().state.altitude += 40;
+    }
+    // The third has traffic of its own; some of it is named like shared traffic but flies 5 nm away
+    for (size_t i = 0; i < OWN; i++)
+    {
+        NodeAircraft aircraft = makeAircraft(sample, SHARED + i, (uint32_t)(SHARED + i) + 2);
+        if (i < NAMESAKES)
+        {
+            aircraft = shared[i];
+            aircraft.state.latitude += 5.0 / 60;
+        }
+        own.push_back(aircraft);
+    }
+
+    FakeNode first(shared, 2), second(nearby, 100002), third(own, 200002);
+    AggregatorSettings settings = DEFAULT_AGGREGATOR_SETTINGS;
+    settings.pollMs = 2;
+    settings.staleSeconds = STALE_SECONDS;
+    TrafficAggregator aggregator(settings);
+    aggregator.clock = benchClock;
+    aggregator.addSource(first);
+    aggregator.addSource(second);
+    aggregator.addSource(third);
+    aggregator.start();
+    int failures = 0;
+
+    // Every shared aircraft once, reported by both session nodes; the namesakes stay apart
+    MergeTotals totals = {};
+    mergeFor(aggregator, 200, totals);
+    size_t merged = aggregator.aircraft().size();
+    size_t bothNodes = countWithSources(aggregator, 3);
+    size_t thirdOnly = countWithSources(aggregator, 4);
+    printf("3 nodes: %zu aircraft merged (%zu from the first two, %zu from the third alone), %llu matches\n", merged, bothNodes, thirdOnly,
+        (unsigned long long)aggregator.matched());
+    if (merged != SHARED + OWN || bothNodes != SHARED || thirdOnly != OWN)
+    {
+        printf("FAIL: aircraft were not merged across nodes exactly once\n");
+        failures++;
+    }
+
+    // A stuck node holds back only itself: its aircraft go stale, the rest keep flowing and the merge never waits
+    second.stalled.store(true);
+    while (!second.stuck.load())
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    uint64_t firstBefore = first.sweeps.load(), secondBefore = second.sweeps.load();
+    MergeTotals stalledTotals = {};
+    mergeFor(aggregator, 300, stalledTotals);
+    uint64_t firstDuring = first.sweeps.load() - firstBefore, secondDuring = second.sweeps.load() - secondBefore;
+    size_t withoutSecond = countWithSources(aggregator, 1);
+    second.stalled.store(false);
+    mergeFor(aggregator, 100, totals);
+    size_t rejoined = countWithSources(aggregator, 3);
+    printf("stalled node: %llu sweeps from the first node and %llu from the stalled one meanwhile, %zu aircraft left to the first, "
+        "slowest merge %.2f ms; %zu rejoined after\n", (unsigned long long)firstDuring, (unsigned long long)secondDuring, withoutSecond,
+        stalledTotals.maxNs / 1e6, rejoined);
+    if (firstDuring == 0 || secondDuring != 0 || withoutSecond != SHARED || rejoined != SHARED || stalledTotals.maxNs > 20e6)
+    {
+        printf("FAIL: a stalled node held back the others or did not rejoin\n");
+        failures++;
+    }
+
+    // A node that goes away takes its aircraft with it at the next merge
+    third.closed.store(true);
+    mergeFor(aggregator, 50, totals);
+    SourceStats thirdStats = aggregator.sourceStats(2);
+    printf("closed node: %zu aircraft left, node reports %zu (%s)\n", aggregator.aircraft().size(), thirdStats.aircraft,
+        thirdStats.closed ? "closed" : "OPEN");
+    if (aggregator.aircraft().size() != SHARED || !thirdStats.closed || thirdStats.aircraft != 0)
+    {
+        printf("FAIL: a closed node's aircraft stayed in the table\n");
+        failures++;
+    }
+    aggregator.stop();
+
+    totals.records += stalledTotals.records;
+    totals.ns += stalledTotals.ns;
+    double nsPerRecord = totals.ns / (totals.records > 0 ? totals.records : 1);
+    printf("merge: %llu records, %.1f ns/record\n", (unsigned long long)totals.records, nsPerRecord);
+    if (!checkSpeed("aggregate.merge", nsPerRecord))
+        failures++;
+    return failures;
+}
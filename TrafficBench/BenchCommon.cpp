@@ -0,0 +1,56 @@
+#include <stdio.h>
+#include <map>
+#include <string>
+
+#include "BenchCommon.h"
+
+volatile double benchSink;
+
+BenchOptions benchOptions = { nullptr, nullptr, 0.25 };
+
+static std::map<std::string, double> baselineTimings;
+static std::map<std::string, double> measuredTimings;
+
+bool loadSpeedBaseline(const char* path)
+{
+    FILE* file = fopen(path, "r");
+    if (!file)
+        return false;
+
+    char name[128];
+    double nsPerOp;
+    while (fscanf(file, "%127s %lf", name, &nsPerOp) == 2)
+        baselineTimings[name] = nsPerOp;
+
+    fclose(file);
+    return true;
+}
+
+bool writeSpeedBaseline(const char* path)
+{
+    FILE* file = fopen(path, "w");
+    if (!file)
+        return false;
+
+    for (const auto& timing : measuredTimings)
+        fprintf(file, "%s %.3f\n", timing.first.c_str(), timing.second);
+
+    fclose(file);
+    return true;
+}
+
+bool checkSpeed(const char* name, double nsPerOp)
+{
+    measuredTimings[name] = nsPerOp;
+
+    auto baseline = baselineTimings.find(name);
+    if (baseline == baselineTimings.end())
+        return true;
+
+    double limit = baseline->second * (1 + benchOptions.speedTolerance);
+    if (nsPerOp <= limit)
+        return true;
+
+    printf("FAIL: %s took %.2f ns/op, baseline %.2f ns/op (limit %.2f)\n", name, nsPerOp, baseline->second, limit);
+    return false;
+}
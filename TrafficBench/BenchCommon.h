@@ -0,0 +1,120 @@
+#pragma once
+
+#include <chrono>
+#include <math.h>
+#include <random>
+#include <stddef.h>
+#include <vector>
+
+#include "Utilities.h"
+
+/**
+* One benchmark suite. run() prints its own report and returns the number of failed checks.
+*/
+struct BenchSuite
+{
+    const char* name;
+    const char* description;
+    int (*run)();
+};
+
+int runFrameBench();
+int runGeodesyBench();
+int runIndexBench();
+int runReceiveBench();
+int runTableBench();
+int runOutputBench();
+int runRecorderBench();
+int runTitleBench();
+int runPredictBench();
+int runSchedulerBench();
+int runStagesBench();
+int runConflictBench();
+int runMetricsBench();
+int runSweepBench();
+int runSnapshotBench();
+int runTaggedBench();
+int runOwnshipBench();
+int runRecordBench();
+int runClientBench();
+int runAggregateBench();
+
+/**
+* Command line options shared by all suites.
+*/
+struct BenchOptions
+{
+    const char* baselinePath;       // --baseline <file>: fail when a timing regresses against this file
+    const char* writeBaselinePath;  // --write-baseline <file>: save this run's timings
+    double speedTolerance;          // --speed-tolerance <ratio>: allowed slowdown before a timing fails
+};
+
+extern BenchOptions benchOptions;
+
+bool loadSpeedBaseline(const char* path);
+bool writeSpeedBaseline(const char* path);
+
+/**
+* Record a timing under name and compare it with the loaded baseline.
+* Returns false if it is slower than the baseline by more than speedTolerance.
+*/
+bool checkSpeed(const char* name, double nsPerOp);
+
+/**
+* Monotonic wall clock for timing loops.
+*/
+class Stopwatch
+{
+public:
+    Stopwatch() : m_start(std::chrono::steady_clock::now()) {}
+
+    double elapsedNs() const
+    {
+        return (double)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - m_start).count();
+    }
+
+private:
+    std::chrono::steady_clock::time_point m_start;
+};
+
+/**
+* Keep a result alive so the optimizer cannot drop the loop that produced it.
+*/
+extern volatile double benchSink;
+
+inline void keepResult(double value)
+{
+    benchSink = value;
+}
+
+/**
+* Traffic positions scattered uniformly within radiusNm of a centre point, as structure-of-arrays.
+*/
+struct TrafficSample
+{
+    std::vector<double> latitude;
+    std::vector<double> longitude;
+    std::vector<double> altitude;
+};
+
+inline TrafficSample makeTrafficSample(size_t count, double centreLat, double centreLon, double radiusNm, unsigned seed)
+{
+    std::mt19937_64 rng(seed);
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+    TrafficSample sample;
+    sample.latitude.resize(count);
+    sample.longitude.resize(count);
+    sample.altitude.resize(count);
+
+    const double degPerNm = 1.0 / 60.0;
+    const double cosLat = cos(centreLat * (M_PI / 180));
+    for (size_t i = 0; i < count; i++)
+    {
+        double r = radiusNm * sqrt(unit(rng));
+        double theta = 2 * M_PI * unit(rng);
+        sample.latitude[i] = centreLat + r * cos(theta) * degPerNm;
+        sample.longitude[i] = centreLon + r * sin(theta) * degPerNm / cosLat;
+        sample.altitude[i] = 45000 * unit(rng);
+    }
+    return sample;
+}
@@ -0,0 +1,475 @@
+#include <coroutine>
+#include <exception>
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+
+#include "BenchCommon.h"
+#include "DeadReckoning.h"
+#include "TrafficClient.h"
+#include "TrafficMessage.h"
+#include "Utilities.h"
+
+static const size_t AIRCRAFT = 1000;
+static const uint32_t PROBES = 48;
+static const uint32_t SUBSCRIPTIONS = 16;
+static const uint32_t CANCEL_AFTER = 3;
+static const double CENTRE_LAT = 32.951917;
+static const double CENTRE_LON = -97.264323;
+
+static double benchClock()
+{
+    return 0;
+}
+
+/**
+* Answers the client's requests the way the simulator would, but only when asked, so a test decides how the
+* answers of different requests interleave.
+*/
+class FakeSim : public RequestSink
+{
+public:
+    struct Subscription
+    {
+        uint32_t requestId;
+        uint32_t defineId;
+        uint32_t objectId;
+        uint32_t period;
+    };
+
+    FakeSim(const TrafficSample& sample)
+        : refuse(false)
+        , m_sample(sample)
+        , m_ended(0)
+    {
+    }
+
+    bool requestByType(uint32_t requestId, uint32_t, uint32_t radiusMeters, uint32_t) override
+    {
+        if (refuse)
+            return false;
+        std::vector<uint32_t> inRange;
+        for (size_t i = 0; i < m_sample.latitude.size(); i++)
+        {
+            if (nmToMeters(distance(CENTRE_LAT, CENTRE_LON, m_sample.latitude[i], m_sample.longitude[i], MATH_FAST)) <= radiusMeters)
+                inRange.push_back((uint32_t)(i + 1));
+        }
+        m_sweeps.push_back(requestId);
+        m_sweepObjects.push_back(inRange);
+        return true;
+    }
+
+    bool requestOnObject(uint32_t requestId, uint32_t defineId, uint32_t objectId, uint32_t period, uint32_t, uint32_t) override
+    {
+        if (refuse)
+            return false;
+        if (period == TRAFFIC_PERIOD_NEVER)
+        {
+            for (size_t i = 0; i < m_subscriptions.size(); i++)
+            {
+                if (m_subscriptions[i].requestId == requestId)
+                {
+                    m_subscriptions.erase(m_subscriptions.begin() + i);
+                    m_ended++;
+                    break;
+                }
+            }
+            return true;
+        }
+        Subscription subscription = { requestId, defineId, objectId, period };
+        m_subscriptions.push_back(subscription);
+        return true;
+    }
+
+    // Every sweep requested since the last call, entries of all of them interleaved; dropEvery > 0 leaves out every dropEvery-th entry
+    void answerSweeps(std::vector<uint8_t>& out, size_t dropEvery = 0)
+    {
+        size_t longest = 0;
+        for (const std::vector<uint32_t>& objects : m_sweepObjects)
+            longest = objects.size() > longest ? objects.size() : longest;
+        size_t sent = 0;
+        for (size_t entry = 0; entry < longest; entry++)
+        {
+            for (size_t request = 0; request < m_sweeps.size(); request++)
+            {
+                const std::vector<uint32_t>& objects = m_sweepObjects[request];
+                if (entry >= objects.size() || (dropEvery != 0 && ++sent % dropEvery == 0))
+                    continue;
+                appendTrafficMessage(out, m_sweeps[request], objects[entry], (uint32_t)(entry + 1), (uint32_t)objects.size(), packState(stateOf(objects[entry])));
+            }
+        }
+        m_sweeps.clear();
+        m_sweepObjects.clear();
+    }
+
+    // One round of every subscription: a state update for periodic ones; titles answer and end once requests
+    void answerSubscriptions(std::vector<uint8_t>& out)
+    {
+        for (size_t i = 0; i < m_subscriptions.size(); )
+        {
+            const Subscription& subscription = m_subscriptions[i];
+            if (subscription.defineId == TRAFFIC_DEFINITION_TITLE)
+            {
+                AircraftTitle title = {};
+                snprintf(title.title, sizeof(title.title), "Aircraft %u", subscription.objectId);
+                appendTitleMessage(out, subscription.requestId, subscription.objectId, title);
+            }
+            else
+            {
+                PackedAircraftState state = packState(stateOf(subscription.objectId));
+                appendTrafficMessage(out, TRAFFIC_RECV_ID_SIMOBJECT_DATA, subscription.requestId, TRAFFIC_DEFINITION_PACKED_STATE, STATE_FIELD_COUNT,
+                    subscription.objectId, 1, 1, &state, sizeof(state));
+            }
+            if (subscription.period == TRAFFIC_PERIOD_ONCE)
+                m_subscriptions.erase(m_subscriptions.begin() + i);
+            else
+                i++;
+        }
+    }
+
+    // Subscriptions still being answered
+    size_t active() const { return m_subscriptions.size(); }
+    uint32_t ended() const { return m_ended; }
+
+    bool refuse;
+
+private:
+    AircraftState stateOf(uint32_t objectId) const
+    {
+        AircraftState state = {};
+        state.isUser = objectId == 1;
+        state.altitude = m_sample.altitude[objectId - 1];
+        state.latitude = m_sample.latitude[objectId - 1];
+        state.longitude = m_sample.longitude[objectId - 1];
+        state.groundSpeed = 200;
+        return state;
+    }
+
+    const TrafficSample& m_sample;
+    std::vector<uint32_t> m_sweeps;
+    std::vector<std::vector<uint32_t>> m_sweepObjects;
+    std::vector<Subscription> m_subscriptions;
+    uint32_t m_ended;
+};
+
+static void deliver(TrafficClient& client, const std::vector<uint8_t>& stream, size_t& claimed)
+{
+    for (size_t offset = 0; offset < stream.size(); )
+    {
+        TrafficMessageHeader header;
+        memcpy(&header, &stream[offset], sizeof(header));
+        if (client.onMessage(&stream[offset], header.size))
+            claimed++;
+        offset += header.size;
+    }
+}
+
+/**
+* A coroutine the bench starts and forgets: it runs up to its first co_await when called, and frees itself once done.
+*/
+struct BenchTask
+{
+    struct promise_type
+    {
+        BenchTask get_return_object() { return BenchTask(); }
+        std::suspend_never initial_suspend() { return {}; }
+        std::suspend_never final_suspend() noexcept { return {}; }
+        void return_void() {}
+        void unhandled_exception() { std::terminate(); }
+    };
+};
+
+struct Probe
+{
+    double radiusNm;
+    size_t expected;            // aircraft within radiusNm
+    size_t sweeps;
+    size_t entries;
+    bool complete;
+    bool misrouted;
+    bool outOfRange;
+    uint32_t farthestObject;    // whose title the probe went on to ask for
+    AircraftTitle title;
+    size_t titles;
+};
+
+// Each probe awaits its sweep, checks it and goes on to await the title of its farthest entry
+static BenchTask runProbe(TrafficClient& client, Probe& probe)
+{
+    SweepAwaitable request = client.requestByType<PackedAircraftState>((uint32_t)nmToMeters(probe.radiusNm));
+    AssembledSweep sweep = co_await request;
+    probe.sweeps++;
+    probe.entries = sweep.entries.size();
+    probe.complete = sweep.complete;
+    if (request.handle() == 0 || sweep.requestId != request.handle())
+        probe.misrouted = true;
+
+    double farthest = -1;
+    for (const DecodedMessage& entry : sweep.entries)
+    {
+        double rangeNm = distance(CENTRE_LAT, CENTRE_LON, entry.state.latitude, entry.state.longitude, MATH_FAST);
+        if (entry.requestId != request.handle())
+            probe.misrouted = true;
+        if (rangeNm > probe.radiusNm + 1e-6)
+            probe.outOfRange = true;
+        if (rangeNm > farthest)
+        {
+            farthest = rangeNm;
+            probe.farthestObject = entry.objectId;
+        }
+    }
+    if (probe.farthestObject == 0)
+        co_return;
+
+    ObjectUpdate title = co_await client.requestOnObject<AircraftTitle>(probe.farthestObject);
+    probe.titles++;
+    if (title.message.kind != DECODED_TITLE || title.message.objectId != probe.farthestObject)
+        probe.misrouted = true;
+    memcpy(probe.title.title, title.names.title, sizeof(probe.title.title));
+}
+
+// Dozens of sweeps of different radii in flight at once, their entries interleaved, each resuming its own coroutine
+static int checkConcurrentSweeps(const TrafficSample& sample)
+{
+    FakeSim sim(sample);
+    TrafficClient client(sim);
+    client.clock = benchClock;
+
+    std::vector<Probe> probes(PROBES);
+    for (uint32_t i = 0; i < PROBES; i++)
+    {
+        Probe& probe = probes[i];
+        probe = Probe();
+        probe.radiusNm = 1 + i * 40.0 / PROBES;
+        for (size_t a = 0; a < AIRCRAFT; a++)
+        {
+            if (nmToMeters(distance(CENTRE_LAT, CENTRE_LON, sample.latitude[a], sample.longitude[a], MATH_FAST)) <= (uint32_t)nmToMeters(probe.radiusNm))
+                probe.expected++;
+        }
+        runProbe(client, probe);
+    }
+    size_t inFlight = client.inFlight();
+
+    std::vector<uint8_t> stream;
+    sim.answerSweeps(stream);
+    size_t claimed = 0;
+    deliver(client, stream, claimed);
+    size_t ran = client.runReady(0);
+
+    // The probes' follow-up requests are answered in the next round
+    stream.clear();
+    sim.answerSubscriptions(stream);
+    deliver(client, stream, claimed);
+    ran += client.runReady(0);
+
+    size_t wrong = 0;
+    for (const Probe& probe : probes)
+    {
+        char expectedTitle[sizeof(AircraftTitle::title)];
+        snprintf(expectedTitle, sizeof(expectedTitle), "Aircraft %u", probe.farthestObject);
+        bool titled = probe.titles == 1 && strcmp(probe.title.title, expectedTitle) == 0;
+        if (probe.sweeps != 1 || probe.entries != probe.expected || !probe.complete || probe.misrouted || probe.outOfRange || !titled)
+            wrong++;
+    }
+    printf("%u concurrent sweeps of 1-%.0f nm: %zu in flight, %zu messages claimed, %zu coroutines resumed, %zu wrong, %zu left in flight\n", PROBES,
+        probes.back().radiusNm, inFlight, claimed, ran, wrong, client.inFlight());
+    if (inFlight != PROBES || wrong != 0 || client.inFlight() != 0 || ran != 2 * PROBES || client.stats().late != 0)
+    {
+        printf("FAIL: concurrent sweeps were not each delivered whole to their own coroutine\n");
+        return 1;
+    }
+    return 0;
+}
+
+struct Follower
+{
+    TrafficClient* client;
+    uint32_t objectId;
+    size_t updates;
+    bool misrouted;
+};
+
+// Each subscription cancels itself after a few updates, from inside its handler
+static void onFollow(RequestHandle handle, const DecodedMessage& message, void* context)
+{
+    Follower* follower = (Follower*)context;
+    follower->updates++;
+    if (message.objectId != follower->objectId || message.kind != DECODED_TRACKED)
+        follower->misrouted = true;
+    if (follower->updates == CANCEL_AFTER)
+        follower->client->cancel(handle);
+}
+
+static int checkSubscriptions(const TrafficSample& sample)
+{
+    FakeSim sim(sample);
+    TrafficClient client(sim);
+    client.clock = benchClock;
+
+    std::vector<Follower> followers(SUBSCRIPTIONS);
+    for (uint32_t i = 0; i < SUBSCRIPTIONS; i++)
+    {
+        followers[i] = { &client, i * 7 + 2, 0, false };
+        client.subscribe(TRAFFIC_DEFINITION_PACKED_STATE, followers[i].objectId, TRAFFIC_PERIOD_SECOND, 0, 0, onFollow, &followers[i]);
+    }
+
+    // Two rounds arrive between runs of the executor, so the round after a cancel is already on its way
+    size_t claimed = 0;
+    for (int round = 0; round < 4; round++)
+    {
+        std::vector<uint8_t> stream;
+        sim.answerSubscriptions(stream);
+        sim.answerSubscriptions(stream);
+        deliver(client, stream, claimed);
+        client.runReady(0);
+    }
+
+    size_t wrong = 0;
+    for (const Follower& follower : followers)
+    {
+        if (follower.updates != CANCEL_AFTER || follower.misrouted)
+            wrong++;
+    }
+    const ClientStats& stats = client.stats();
+    printf("%u subscriptions cancelled after %u updates: %llu updates run, %llu late, %u ended at the simulator, %zu wrong\n", SUBSCRIPTIONS,
+        CANCEL_AFTER, (unsigned long long)stats.updates, (unsigned long long)stats.late, sim.ended(), wrong);
+    if (wrong != 0 || sim.ended() != SUBSCRIPTIONS || sim.active() != 0 || client.inFlight() != 0 || stats.late != SUBSCRIPTIONS)
+    {
+        printf("FAIL: subscriptions were misrouted or outlived their cancel\n");
+        return 1;
+    }
+    return 0;
+}
+
+struct TimeoutProbe
+{
+    size_t calls;
+    size_t entries;
+    bool complete;
+};
+
+static void onTimeoutSweep(RequestHandle, const AssembledSweep& sweep, void* context)
+{
+    TimeoutProbe* probe = (TimeoutProbe*)context;
+    probe->calls++;
+    probe->entries = sweep.entries.size();
+    probe->complete = sweep.complete;
+}
+
+// A request the client cannot make does not suspend the coroutine awaiting it
+static BenchTask awaitRefused(TrafficClient& client, AssembledSweep& sweep, bool& resumed)
+{
+    sweep = co_await client.requestByType<PackedAircraftState>(1000);
+    resumed = true;
+}
+
+// A sweep that never completes is handed over with what arrived once it times out; refused requests get no handle
+static int checkTimeoutAndRefusal(const TrafficSample& sample)
+{
+    FakeSim sim(sample);
+    TrafficClient client(sim);
+    client.clock = benchClock;
+    client.setSweepTimeout(1);
+
+    TimeoutProbe probe = {};
+    client.requestByType(TRAFFIC_DEFINITION_PACKED_STATE, (uint32_t)nmToMeters(20), TRAFFIC_OBJECT_TYPE_AIRCRAFT, onTimeoutSweep, &probe);
+    std::vector<uint8_t> stream;
+    sim.answerSweeps(stream, 10);
+    size_t claimed = 0;
+    deliver(client, stream, claimed);
+    client.runReady(0.5);
+    size_t callsBefore = probe.calls;
+    client.runReady(1.5);
+
+    sim.refuse = true;
+    RequestHandle refused = client.requestByType(TRAFFIC_DEFINITION_PACKED_STATE, 1000, TRAFFIC_OBJECT_TYPE_AIRCRAFT, onTimeoutSweep, &probe);
+    AssembledSweep refusedSweep = {};
+    refusedSweep.requestId = 1;
+    bool resumed = false;
+    awaitRefused(client, refusedSweep, resumed);
+    sim.refuse = false;
+    client.maxInFlight = 0;
+    RequestHandle overLimit = client.requestByType(TRAFFIC_DEFINITION_PACKED_STATE, 1000, TRAFFIC_OBJECT_TYPE_AIRCRAFT, onTimeoutSweep, &probe);
+
+    bool awaitedRefusal = resumed && refusedSweep.requestId == 0 && refusedSweep.entries.empty();
+    printf("timed out sweep: %zu calls before the timeout, then %zu with %zu of %zu entries (%s); refused %s, awaited %s, over the limit %s\n",
+        callsBefore, probe.calls, probe.entries, claimed, probe.complete ? "complete" : "incomplete", refused == 0 ? "no handle" : "HANDLE",
+        awaitedRefusal ? "no handle" : "SUSPENDED", overLimit == 0 ? "no handle" : "HANDLE");
+    if (callsBefore != 0 || probe.calls != 1 || probe.complete || probe.entries != claimed || refused != 0 || !awaitedRefusal || overLimit != 0 ||
+        client.inFlight() != 0 || client.stats().refused != 3)
+    {
+        printf("FAIL: timeout or refusal handling\n");
+        return 1;
+    }
+    return 0;
+}
+
+// Left unset, the client stamps sweeps on trafficClockSeconds, the scale a dispatch loop passes to runReady
+static int checkDefaultClock(const TrafficSample& sample)
+{
+    FakeSim sim(sample);
+    TrafficClient client(sim);
+
+    TimeoutProbe probe = {};
+    client.requestByType(TRAFFIC_DEFINITION_PACKED_STATE, (uint32_t)nmToMeters(20), TRAFFIC_OBJECT_TYPE_AIRCRAFT, onTimeoutSweep, &probe);
+    std::vector<uint8_t> stream;
+    sim.answerSweeps(stream, 10);
+    size_t claimed = 0;
+    deliver(client, stream, claimed);
+    client.runReady(trafficClockSeconds());
+    size_t callsBefore = probe.calls;
+    client.runReady(trafficClockSeconds() + 1);
+
+    printf("default clock: %zu calls right after the entries arrived, %zu a timeout later\n", callsBefore, probe.calls);
+    if (callsBefore != 0 || probe.calls != 1 || probe.complete || probe.entries != claimed)
+    {
+        printf("FAIL: an open sweep expired before its timeout on the default clock\n");
+        return 1;
+    }
+    return 0;
+}
+
+static void countSweep(RequestHandle, const AssembledSweep& sweep, void* context)
+{
+    *(size_t*)context += sweep.entries.size();
+}
+
+// Claiming, assembling and handing over one message, with every probe in flight
+static double messageNs(const TrafficSample& sample)
+{
+    FakeSim sim(sample);
+    TrafficClient client(sim);
+    client.clock = benchClock;
+
+    size_t entries = 0, claimed = 0;
+    double ns = 0;
+    std::vector<uint8_t> stream;
+    for (int round = 0; round < 20; round++)
+    {
+        for (uint32_t i = 0; i < PROBES; i++)
+            client.requestByType(TRAFFIC_DEFINITION_PACKED_STATE, (uint32_t)nmToMeters(1 + i * 40.0 / PROBES), TRAFFIC_OBJECT_TYPE_AIRCRAFT, countSweep, &entries);
+        stream.clear();
+        sim.answerSweeps(stream);
+        Stopwatch clock;
+        deliver(client, stream, claimed);
+        client.runReady(0);
+        ns += clock.elapsedNs();
+    }
+    keepResult((double)entries);
+    return ns / (claimed > 0 ? claimed : 1);
+}
+
+int runClientBench()
+{
+    TrafficSample sample = makeTrafficSample(AIRCRAFT, CENTRE_LAT, CENTRE_LON, 40, 53);
+    int failures = checkConcurrentSweeps(sample);
+    failures += checkSubscriptions(sample);
+    failures += checkTimeoutAndRefusal(sample);
+    failures += checkDefaultClock(sample);
+
+    double ns = messageNs(sample);
+    printf("client: %.1f ns/message with %u sweeps in flight\n", ns, PROBES);
+    if (!checkSpeed("client.message", ns))
+        failures++;
+    return failures;
+}
@@ -0,0 +1,298 @@
+#include <algorithm>
+#include <random>
+#include <stdio.h>
+#include <vector>
+
+#include "BenchCommon.h"
+#include "ConflictDetector.h"
+#include "TrafficTable.h"
+#include "Utilities.h"
+
+static const double OWN_LAT = 32.951917;
+static const double OWN_LON = -97.264323;
+static const size_t DENSE_AIRCRAFT = 5000;
+static const double DENSE_RADIUS_NM = 100;
+static const int TIMED_PROBES = 10;
+static const size_t KERNEL_PAIRS = 100000;
+static const int KERNEL_REPEATS = 20;
+
+struct ScriptedAircraft
+{
+    uint32_t objectId;
+    double northNm;         // from the ownship
+    double eastNm;
+    double altitude;
+    double headingDeg;
+    double speedKts;
+    double verticalFpm;
+    double crabDeg = 0;     // heading minus ground track: the wind blows the aircraft this far to the left of its nose
+};
+
+/**
+* A table of scripted aircraft, probed with their sampled positions as they stand.
+*/
+class ConflictHarness
+{
+public:
+    explicit ConflictHarness(const ConflictSettings& settings = DEFAULT_CONFLICT_SETTINGS)
+        : detector(settings)
+        , originLat(OWN_LAT)
+        , originLon(OWN_LON)
+    {
+    }
+
+    size_t probe(const std::vector<ScriptedAircraft>& aircraft)
+    {
+        m_table.beginSweep();
+        for (const ScriptedAircraft& entry : aircraft)
+        {
+            AircraftState state = {};
+            state.latitude = originLat + entry.northNm / 60;
+            state.longitude = wrapLongitude(originLon + entry.eastNm / (60 * cos(originLat * (M_PI / 180))));
+            state.altitude = entry.altitude;
+            state.trueHeading = entry.headingDeg * (M_PI / 180);
+            state.groundTrack = (entry.headingDeg - entry.crabDeg) * (M_PI / 180);
+            state.groundSpeed = entry.speedKts;
+            state.verticalSpeed = entry.verticalFpm;
+            m_table.update(entry.objectId, state);
+        }
+        m_table.evictStale(0);
+        return detector.detect(m_table, m_table.latitudes(), m_table.longitudes(), m_table.altitudes(), originLat, originLon, alerts);
+    }
+
+    const TrafficTable& table() const { return m_table; }
+
+    ConflictDetector detector;
+    std::vector<ConflictAlert> alerts;
+    double originLat;           // the scripted offsets and the detector's reference point
+    double originLon;
+
+private:
+    TrafficTable m_table;
+};
+
+static std::vector<ScriptedAircraft> makeDenseTraffic(size_t count, unsigned seed)
+{
+    TrafficSample sample = makeTrafficSample(count, OWN_LAT, OWN_LON, DENSE_RADIUS_NM, seed);
+    std::mt19937_64 rng(seed + 1);
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+    double nmPerDegLon = 60 * cos(OWN_LAT * (M_PI / 180));
+    std::vector<ScriptedAircraft> aircraft(count);
+    for (size_t i = 0; i < count; i++)
+    {
+        ScriptedAircraft& entry = aircraft[i];
+        entry.objectId = (uint32_t)(100 + i);
+        entry.northNm = (sample.latitude[i] - OWN_LAT) * 60;
+        entry.eastNm = (sample.longitude[i] - OWN_LON) * nmPerDegLon;
+        entry.altitude = sample.altitude[i];
+        entry.headingDeg = 360 * unit(rng);
+        entry.speedKts = 120 + 360 * unit(rng);
+        entry.verticalFpm = unit(rng) < 0.5 ? 0 : 4000 * unit(rng) - 2000;
+    }
+    return aircraft;
+}
+
+static bool samePairs(const std::vector<Conflict>& a, const std::vector<Conflict>& b)
+{
+    if (a.size() != b.size())
+        return false;
+    for (size_t i = 0; i < a.size(); i++)
+    {
+        if (a[i].firstId != b[i].firstId || a[i].secondId != b[i].secondId || a[i].lossSeconds != b[i].lossSeconds)
+            return false;
+    }
+    return true;
+}
+
+int runConflictBench()
+{
+    int failures = 0;
+    const ConflictSettings settings = DEFAULT_CONFLICT_SETTINGS;
+
+    // Head-on at the same level, 10 nm apart and closing at 500 kt: the minimum is broken after 7 nm
+    ConflictHarness headOn;
+    headOn.probe({ { 2, 0, 0, 10000, 0, 250, 0 }, { 3, 10, 0, 10000, 180, 250, 0 } });
+    double expectedLoss = (10 - settings.separationNm) / (500.0 / 3600);
+    bool headOnOk = headOn.alerts.size() == 1 && headOn.alerts[0].event == CONFLICT_NEW && headOn.alerts[0].conflict.firstId == 2 &&
+        headOn.alerts[0].conflict.secondId == 3 && fabs(headOn.alerts[0].conflict.lossSeconds - expectedLoss) < 0.1 &&
+        headOn.alerts[0].conflict.cpaRangeNm < 0.01;
+    if (!headOn.alerts.empty())
+    {
+        const Conflict& conflict = headOn.alerts[0].conflict;
+        printf("head-on: loss of separation in %.1f s (expected %.1f), CPA %.2f nm %.0f ft in %.1f s\n", conflict.lossSeconds,
+            expectedLoss, conflict.cpaRangeNm, conflict.cpaVerticalFt, conflict.cpaSeconds);
+    }
+
+    // The same pair next sweep: still in conflict, so no new alert; then one turns away and it clears
+    headOn.probe({ { 2, 0.35, 0, 10000, 0, 250, 0 }, { 3, 9.65, 0, 10000, 180, 250, 0 } });
+    headOnOk = headOnOk && headOn.alerts.empty() && headOn.detector.conflicts().size() == 1;
+    headOn.probe({ { 2, 0.7, 0, 10000, 0, 250, 0 }, { 3, 9.3, 0, 10000, 90, 250, 0 } });
+    headOnOk = headOnOk && headOn.alerts.size() == 1 && headOn.alerts[0].event == CONFLICT_CLEARED && headOn.detector.conflicts().empty();
+    if (!headOnOk)
+    {
+        printf("FAIL: a head-on pair should alert once, stay quiet while the conflict lasts and clear when one turns away\n");
+        failures++;
+    }
+
+    // Pairs that keep their separation: head-on 2000 ft apart, parallel 5 nm apart, diverging
+    ConflictHarness separated;
+    size_t separatedCount = separated.probe({
+        { 2, 0, 0, 10000, 0, 250, 0 }, { 3, 10, 0, 12000, 180, 250, 0 },
+        { 4, 0, 20, 8000, 0, 300, 0 }, { 5, 0, 25, 8000, 0, 300, 0 },
+        { 6, 0, -20, 6000, 270, 250, 0 }, { 7, 0, -16, 6000, 90, 250, 0 } });
+    printf("separated: %zu conflicts among level traffic 2000 ft apart, parallel tracks 5 nm apart and a diverging pair\n", separatedCount);
+    if (separatedCount != 0)
+    {
+        printf("FAIL: none of the separated pairs should be in conflict\n");
+        failures++;
+    }
+
+    // A climb into occupied levels: 4 nm in trail and closing at 200 kt, the follower 1500 ft below and climbing at
+    // 1000 fpm. The horizontal minimum goes first, so separation is lost when the vertical one follows.
+    ConflictHarness climb;
+    climb.probe({ { 2, 4, 0, 9000, 0, 200, 0 }, { 3, 0, 0, 7500, 0, 400, 1000 } });
+    double horizontalLoss = (4 - settings.separationNm) / (200.0 / 3600);
+    double verticalLoss = (1500 - settings.separationFt) / (1000.0 / 60);
+    bool climbOk = climb.alerts.size() == 1 && fabs(climb.alerts[0].conflict.lossSeconds - verticalLoss) < 0.1;
+    printf("climb: %zu alerts, loss of separation in %.1f s (horizontal minimum broken at %.1f s, vertical at %.1f s)\n",
+        climb.alerts.size(), climb.alerts.empty() ? 0.0 : climb.alerts[0].conflict.lossSeconds, horizontalLoss, verticalLoss);
+    if (!climbOk)
+    {
+        printf("FAIL: separation is lost once both minima are broken, i.e. at the later of the two\n");
+        failures++;
+    }
+
+    // Head-on across the antimeridian over the Pacific: 8 nm apart, one each side of 180, closing at 500 kt
+    ConflictHarness dateline;
+    dateline.originLat = 52;
+    dateline.originLon = 179.95;
+    dateline.probe({ { 2, 0, -4, 35000, 90, 250, 0 }, { 3, 0, 4, 35000, 270, 250, 0 } });
+    double datelineLoss = (8 - settings.separationNm) / (500.0 / 3600);
+    bool datelineOk = dateline.alerts.size() == 1 && fabs(dateline.alerts[0].conflict.lossSeconds - datelineLoss) < 0.5;
+    printf("antimeridian: %zu alerts for a pair at longitudes %.3f and %.3f, loss of separation in %.1f s (expected %.1f)\n",
+        dateline.alerts.size(), dateline.table().longitudes()[0], dateline.table().longitudes()[1],
+        dateline.alerts.empty() ? 0.0 : dateline.alerts[0].conflict.lossSeconds, datelineLoss);
+    if (!datelineOk)
+    {
+        printf("FAIL: a conflict across the antimeridian was missed\n");
+        failures++;
+    }
+
+    // Crosswind at cruise: the nose is 10 degrees off the track. Two aircraft on parallel tracks 3.5 nm apart, one
+    // crabbing toward the other, stay separated; one track converging with its neighbour's while its nose points
+    // parallel to it does not.
+    ConflictHarness crosswind;
+    crosswind.probe({
+        { 2, 0, 0, 35000, 10, 480, 0, 10 }, { 3, 0, 3.5, 35000, 0, 480, 0 },
+        { 4, 0, 40, 30000, 0, 480, 0, -10 }, { 5, 0, 43.5, 30000, 0, 480, 0 } });
+    double driftLoss = (3.5 - settings.separationNm) / (480 * sin(10 * (M_PI / 180)) / 3600);
+    const std::vector<Conflict>& crabbed = crosswind.detector.conflicts();
+    bool crosswindOk = crabbed.size() == 1 && crabbed[0].firstId == 4 && crabbed[0].secondId == 5 &&
+        fabs(crabbed[0].lossSeconds - driftLoss) < 0.5;
+    printf("crosswind: %zu conflicts (expected the converging tracks 4/5 alone, loss in %.1f s)", crabbed.size(), driftLoss);
+    for (const Conflict& conflict : crabbed)
+        printf(", %u/%u in %.1f s", conflict.firstId, conflict.secondId, conflict.lossSeconds);
+    printf("\n");
+    if (!crosswindOk)
+    {
+        printf("FAIL: tracks must be flown along the ground track, not the heading\n");
+        failures++;
+    }
+
+    // Dense traffic: the grid search must find exactly the conflicts of testing every pair
+    std::vector<ScriptedAircraft> dense = makeDenseTraffic(DENSE_AIRCRAFT, 7);
+    ConflictSettings everyPair = settings;
+    everyPair.cellNm = 0;
+    ConflictHarness grid(settings);
+    ConflictHarness brute(everyPair);
+    grid.probe(dense);
+    brute.probe(dense);
+    printf("%zu aircraft within %.0f nm: %zu conflicts, %zu candidate pairs (every pair: %zu with overlapping boxes of %zu)\n",
+        DENSE_AIRCRAFT, DENSE_RADIUS_NM, grid.detector.conflicts().size(), grid.detector.candidates(), brute.detector.candidates(),
+        DENSE_AIRCRAFT * (DENSE_AIRCRAFT - 1) / 2);
+    if (grid.detector.conflicts().empty() || !samePairs(grid.detector.conflicts(), brute.detector.conflicts()) ||
+        grid.detector.candidates() != brute.detector.candidates())
+    {
+        printf("FAIL: the grid search found %zu conflicts, testing every pair %zu\n", grid.detector.conflicts().size(),
+            brute.detector.conflicts().size());
+        failures++;
+    }
+
+    const TrafficTable& table = grid.table();
+    std::vector<ConflictAlert> alerts;
+    Stopwatch gridClock;
+    for (int probe = 0; probe < TIMED_PROBES; probe++)
+        grid.detector.detect(table, table.latitudes(), table.longitudes(), table.altitudes(), OWN_LAT, OWN_LON, alerts);
+    double gridNs = gridClock.elapsedNs() / (double(TIMED_PROBES) * DENSE_AIRCRAFT);
+
+    Stopwatch bruteClock;
+    brute.detector.detect(table, table.latitudes(), table.longitudes(), table.altitudes(), OWN_LAT, OWN_LON, alerts);
+    double bruteNs = bruteClock.elapsedNs() / DENSE_AIRCRAFT;
+    printf("probe: grid %.1f ns/aircraft (%.2f ms per sweep), every pair %.1f ns/aircraft, speedup %.1fx\n", gridNs,
+        gridNs * DENSE_AIRCRAFT / 1e6, bruteNs, bruteNs / gridNs);
+
+    // The vector kernel against the scalar reference over random encounters
+    std::mt19937_64 rng(11);
+    std::uniform_real_distribution<double> unit(-1.0, 1.0);
+    std::vector<double> columns[6];
+    for (std::vector<double>& column : columns)
+        column.resize(KERNEL_PAIRS);
+    for (size_t i = 0; i < KERNEL_PAIRS; i++)
+    {
+        columns[0][i] = 20 * unit(rng);
+        columns[1][i] = 20 * unit(rng);
+        columns[2][i] = i % 7 == 0 ? 0 : 3000 * unit(rng);
+        columns[3][i] = 0.25 * unit(rng);
+        columns[4][i] = 0.25 * unit(rng);
+        columns[5][i] = i % 3 == 0 ? 0 : 50 * unit(rng);
+    }
+    CpaPairs pairs = { columns[0].data(), columns[1].data(), columns[2].data(), columns[3].data(), columns[4].data(), columns[5].data(), KERNEL_PAIRS };
+    std::vector<double> vectorResults[4];
+    std::vector<double> scalar[4];
+    for (int i = 0; i < 4; i++)
+    {
+        vectorResults[i].resize(KERNEL_PAIRS);
+        scalar[i].resize(KERNEL_PAIRS);
+    }
+    CpaResults vectorOut = { vectorResults[0].data(), vectorResults[1].data(), vectorResults[2].data(), vectorResults[3].data() };
+    CpaResults scalarOut = { scalar[0].data(), scalar[1].data(), scalar[2].data(), scalar[3].data() };
+
+    Stopwatch scalarClock;
+    for (int repeat = 0; repeat < KERNEL_REPEATS; repeat++)
+        cpaBatchScalar(pairs, settings, scalarOut);
+    double scalarNs = scalarClock.elapsedNs() / (double(KERNEL_REPEATS) * KERNEL_PAIRS);
+    Stopwatch vectorClock;
+    for (int repeat = 0; repeat < KERNEL_REPEATS; repeat++)
+        cpaBatch(pairs, settings, vectorOut);
+    double vectorNs = vectorClock.elapsedNs() / (double(KERNEL_REPEATS) * KERNEL_PAIRS);
+
+    size_t conflicts = 0;
+    double maxLoss = 0;
+    double maxCpa = 0;
+    double maxRange = 0;
+    double maxVertical = 0;
+    for (size_t i = 0; i < KERNEL_PAIRS; i++)
+    {
+        conflicts += vectorResults[0][i] < CPA_NO_LOSS;
+        maxLoss = std::max(maxLoss, fabs(vectorResults[0][i] - scalar[0][i]));
+        maxCpa = std::max(maxCpa, fabs(vectorResults[1][i] - scalar[1][i]));
+        maxRange = std::max(maxRange, fabs(vectorResults[2][i] - scalar[2][i]));
+        maxVertical = std::max(maxVertical, fabs(vectorResults[3][i] - scalar[3][i]));
+    }
+    keepResult(vectorResults[0][KERNEL_PAIRS / 2]);
+    printf("kernel (%s): %.2f ns/pair, scalar %.2f ns/pair, speedup %.2fx, %zu of %zu random pairs in conflict\n", cpaBatchIsa(),
+        vectorNs, scalarNs, scalarNs / vectorNs, conflicts, KERNEL_PAIRS);
+    printf("        max diff: loss %.2e s  cpa %.2e s  range %.2e nm  vertical %.2e ft\n", maxLoss, maxCpa, maxRange, maxVertical);
+    if (maxLoss > CPA_TOLERANCE_SECONDS || maxCpa > CPA_TOLERANCE_SECONDS || maxRange > CPA_TOLERANCE_NM || maxVertical > CPA_TOLERANCE_FT)
+    {
+        printf("FAIL: the vector kernel disagrees with cpaBatchScalar()\n");
+        failures++;
+    }
+
+    if (!checkSpeed("conflicts.probe", gridNs))
+        failures++;
+    if (!checkSpeed("conflicts.cpa", vectorNs))
+        failures++;
+
+    return failures;
+}
@@ -0,0 +1,85 @@
+#include <stdio.h>
+
+#include "BenchCommon.h"
+#include "ReferenceFrame.h"
+#include "Utilities.h"
+
+static const size_t TARGETS = 2000;
+static const int SWEEPS = 200;
+
+// Sanity limits: the frame is WGS84 chord geometry, the haversine path a sphere, so they never agree exactly
+static const double MAX_RANGE_DIFF_RATIO = 0.006;
+static const double MAX_BEARING_DIFF_DEG = 0.5;
+
+int runFrameBench()
+{
+    const double ownLat = 32.951917;
+    const double ownLon = -97.264323;
+    const double ownAlt = 3799;
+    int failures = 0;
+
+    for (double radiusNm : { 10.0, 60.0, 250.0 })
+    {
+        TrafficSample sample = makeTrafficSample(TARGETS, ownLat, ownLon, radiusNm, 42);
+        double checksum = 0;
+
+        Stopwatch haversineClock;
+        for (int sweep = 0; sweep < SWEEPS; sweep++)
+        {
+            for (size_t i = 0; i < TARGETS; i++)
+            {
+                checksum += rangeWithAlt(ownLat, ownLon, ownAlt, sample.latitude[i], sample.longitude[i], sample.altitude[i]);
+                checksum += getBearing(ownLat, ownLon, sample.latitude[i], sample.longitude[i]);
+            }
+        }
+        double haversineNs = haversineClock.elapsedNs() / (double(SWEEPS) * TARGETS);
+
+        // The frame is rebuilt every sweep, as it would be when a new ownship position arrives
+        Stopwatch frameClock;
+        for (int sweep = 0; sweep < SWEEPS; sweep++)
+        {
+            OwnshipFrame frame(ownLat, ownLon, ownAlt);
+            for (size_t i = 0; i < TARGETS; i++)
+            {
+                TargetGeometry geometry = frame.solve(sample.latitude[i], sample.longitude[i], sample.altitude[i]);
+                checksum += geometry.rangeNm + geometry.bearingDeg + geometry.elevationDeg;
+            }
+        }
+        double frameNs = frameClock.elapsedNs() / (double(SWEEPS) * TARGETS);
+        keepResult(checksum);
+
+        OwnshipFrame frame(ownLat, ownLon, ownAlt);
+        double maxRangeRatio = 0;
+        double maxRangeNm = 0;
+        double maxBearing = 0;
+        for (size_t i = 0; i < TARGETS; i++)
+        {
+            TargetGeometry geometry = frame.solve(sample.latitude[i], sample.longitude[i], sample.altitude[i]);
+            double range = rangeWithAlt(ownLat, ownLon, ownAlt, sample.latitude[i], sample.longitude[i], sample.altitude[i]);
+            double bearing = getBearing(ownLat, ownLon, sample.latitude[i], sample.longitude[i]);
+
+            double rangeDiff = fabs(geometry.rangeNm - range);
+            double bearingDiff = fabs(geometry.bearingDeg - bearing);
+            if (bearingDiff > 180)
+                bearingDiff = 360 - bearingDiff;
+
+            maxRangeNm = fmax(maxRangeNm, rangeDiff);
+            maxRangeRatio = fmax(maxRangeRatio, rangeDiff / range);
+            if (range > 0.1)
+                maxBearing = fmax(maxBearing, bearingDiff);
+        }
+
+        printf("radius %6.1f nm: haversine %7.1f ns/target  frame %7.1f ns/target  speedup %.2fx\n",
+            radiusNm, haversineNs, frameNs, haversineNs / frameNs);
+        printf("                  max range diff %.4f nm (%.3f%%)  max bearing diff %.4f deg\n",
+            maxRangeNm, maxRangeRatio * 100, maxBearing);
+
+        if (maxRangeRatio > MAX_RANGE_DIFF_RATIO || maxBearing > MAX_BEARING_DIFF_DEG)
+        {
+            printf("FAIL: frame geometry disagrees with haversine beyond the earth-model difference\n");
+            failures++;
+        }
+    }
+
+    return failures;
+}
@@ -0,0 +1,579 @@
+#include <stdio.h>
+#include <array>
+#include <string>
+#include <vector>
+
+#include "BenchCommon.h"
+#include "Geo.h"
+#include "GeoBatch.h"
+#include "ReferenceFrame.h"
+#include "Utilities.h"
+
+/**
+* Cost and accuracy of every range/bearing path we have.
+*
+* Accuracy is measured against the same formulas evaluated in long double (Geo<long double, ...>), so it
+* captures numerical error rather than earth model differences. MSVC maps long double to double, where the
+* reference is only as good as a careful double evaluation; the limits below were set from an x87 build.
+*/
+
+static const size_t SWEEP_TARGETS = 64;
+static const size_t TIMING_TARGETS = 4096;
+static const int TIMING_SWEEPS = 40;
+static const int TIMING_REPETITIONS = 5;
+
+typedef geo::Geo<long double, geo::Spherical> ReferenceSphere;
+typedef geo::Geo<long double, geo::WGS84> ReferenceEllipsoid;
+
+/**
+* Targets around one ownship position, so the batch kernels see the same inputs as the scalar functions.
+*/
+struct Sweep
+{
+    double ownLat;
+    double ownLon;
+    double ownAlt;
+    TrafficSample targets;
+};
+
+struct CaseSet
+{
+    const char* name;
+    std::vector<Sweep> sweeps;
+};
+
+static Sweep makeSweep(double ownLat, double ownLon, double ownAlt)
+{
+    Sweep sweep = { ownLat, ownLon, ownAlt, TrafficSample() };
+    return sweep;
+}
+
+static void addTarget(Sweep& sweep, double lat, double lon, double alt)
+{
+    sweep.targets.latitude.push_back(lat);
+    sweep.targets.longitude.push_back(lon);
+    sweep.targets.altitude.push_back(alt);
+}
+
+static std::vector<CaseSet> makeCaseSets()
+{
+    std::mt19937_64 rng(2024);
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+    auto randomLat = [&]() { return asin(2 * unit(rng) - 1) * (180 / M_PI); };
+    auto randomLon = [&]() { return 360 * unit(rng) - 180; };
+    auto randomAlt = [&]() { return 45000 * unit(rng); };
+
+    std::vector<CaseSet> sets;
+
+    // Realistic traffic: within 100 nm of a random ownship
+    CaseSet local = { "local", {} };
+    for (int s = 0; s < 32; s++)
+    {
+        double lat = 80 * unit(rng) - 40;
+        double lon = randomLon();
+        Sweep sweep = makeSweep(lat, lon, randomAlt());
+        sweep.targets = makeTrafficSample(SWEEP_TARGETS, lat, lon, 100, (unsigned)s);
+        local.sweeps.push_back(sweep);
+    }
+    sets.push_back(local);
+
+    // Uniform over the globe
+    CaseSet global = { "global", {} };
+    for (int s = 0; s < 32; s++)
+    {
+        Sweep sweep = makeSweep(randomLat(), randomLon(), randomAlt());
+        for (size_t i = 0; i < SWEEP_TARGETS; i++)
+            addTarget(sweep, randomLat(), randomLon(), randomAlt());
+        global.sweeps.push_back(sweep);
+    }
+    sets.push_back(global);
+
+    // Ownship just east of the antimeridian with traffic on both sides of it
+    CaseSet antimeridian = { "antimeridian", {} };
+    for (int s = 0; s < 16; s++)
+    {
+        double lat = 120 * unit(rng) - 60;
+        double lon = s % 2 == 0 ? 179.99 : -179.99;
+        Sweep sweep = makeSweep(lat, lon, randomAlt());
+        for (size_t i = 0; i < SWEEP_TARGETS; i++)
+            addTarget(sweep, lat + 2 * unit(rng) - 1, wrapLongitude(lon + 2 * unit(rng) - 1), randomAlt());
+        antimeridian.sweeps.push_back(sweep);
+    }
+    sets.push_back(antimeridian);
+
+    // At and around the poles, including targets on the pole itself
+    CaseSet polar = { "polar", {} };
+    for (int s = 0; s < 16; s++)
+    {
+        double pole = s % 2 == 0 ? 90 : -90;
+        double lat = s % 4 < 2 ? pole : pole - copysign(0.5 * unit(rng), pole);
+        Sweep sweep = makeSweep(lat, randomLon(), randomAlt());
+        for (size_t i = 0; i < SWEEP_TARGETS; i++)
+        {
+            double targetLat = i % 8 == 0 ? pole : pole - copysign(2 * unit(rng), pole);
+            addTarget(sweep, targetLat, randomLon(), randomAlt());
+        }
+        polar.sweeps.push_back(sweep);
+    }
+    sets.push_back(polar);
+
+    // Identical positions and targets within a metre or so
+    CaseSet coincident = { "coincident", {} };
+    for (int s = 0; s < 16; s++)
+    {
+        double lat = randomLat();
+        double lon = randomLon();
+        Sweep sweep = makeSweep(lat, lon, 1000);
+        for (size_t i = 0; i < SWEEP_TARGETS; i++)
+        {
+            double offset = i % 4 == 0 ? 0 : 1e-5 * (2 * unit(rng) - 1);
+            addTarget(sweep, lat + offset, lon - offset, i % 2 == 0 ? 1000 : randomAlt());
+        }
+        coincident.sweeps.push_back(sweep);
+    }
+    sets.push_back(coincident);
+
+    // 5000 nm out to 1 degree short of the antipode
+    CaseSet longBaseline = { "long", {} };
+    for (int s = 0; s < 16; s++)
+    {
+        double lat = randomLat();
+        double lon = randomLon();
+        Sweep sweep = makeSweep(lat, lon, randomAlt());
+        while (sweep.targets.latitude.size() < SWEEP_TARGETS)
+        {
+            double targetLat = -lat + 80 * unit(rng) - 40;
+            double targetLon = wrapLongitude(lon + 180 + 80 * unit(rng) - 40);
+            if (targetLat > 90 || targetLat < -90)
+                continue;
+            double range = (double)ReferenceSphere::distanceNm(lat, lon, targetLat, targetLon);
+            if (range > 5000 && range < 10740)
+                addTarget(sweep, targetLat, targetLon, randomAlt());
+        }
+        longBaseline.sweeps.push_back(sweep);
+    }
+    sets.push_back(longBaseline);
+
+    return sets;
+}
+
+/**
+* Largest errors of one path over one case set, and the limits it must stay within.
+*/
+struct ErrorStats
+{
+    double rangeNm;
+    double bearingDeg;
+};
+
+static double bearingError(double a, double b)
+{
+    double diff = fabs(a - b);
+    return diff > 180 ? 360 - diff : diff;
+}
+
+// Bearing is undefined for coincident points and only meaningful to ~1e-3 deg within a few metres
+static const double MIN_BEARING_RANGE_NM = 1e-4;
+
+static void accumulate(ErrorStats& stats, double range, double bearing, long double refRange, const geo::Inverse<long double>& ref)
+{
+    stats.rangeNm = fmax(stats.rangeNm, fabs(range - (double)refRange));
+    if (ref.distanceNm > MIN_BEARING_RANGE_NM)
+        stats.bearingDeg = fmax(stats.bearingDeg, bearingError(bearing, (double)ref.initialBearingDeg));
+}
+
+enum GeoPath
+{
+    PATH_DISTANCE,
+    PATH_RANGE_WITH_ALT,
+    PATH_GET_BEARING,
+    PATH_BATCH,
+    PATH_BATCH_SCALAR,
+    PATH_FAST_GEO,
+    PATH_PRECISE_GEO,
+    PATH_FAST_MATH,
+    PATH_COUNT,
+};
+
+static const char* pathNames[PATH_COUNT] = {
+    "distance",
+    "rangeWithAlt",
+    "getBearing",
+    "rangeBearingBatch",
+    "rangeBearingBatchScalar",
+    "Geo<float,Spherical>",
+    "Geo<double,WGS84>",
+    "MATH_FAST",
+};
+
+/**
+* Error limits per path and case set, in nm and degrees, roughly 10x above what the current code achieves.
+* A negative limit means "not checked" (the path has no bearing, or the case is outside its design range).
+*/
+struct ErrorLimit
+{
+    const char* set;
+    ErrorStats limits[PATH_COUNT];
+};
+
+static const ErrorLimit errorLimits[] = {
+    //                       distance        rangeWithAlt    getBearing      batch           batchScalar     float sphere    WGS84           MATH_FAST
+    { "local",        { { 1e-9, -1 },   { 1e-9, -1 },   { -1, 1e-9 },   { 1e-9, 1e-9 }, { 1e-9, 1e-9 }, { 5e-3, 2e-2 }, { 1e-9, 1e-8 }, { 5e-5, 1e-3 } } },
+    { "global",       { { 1e-8, -1 },   { 1e-8, -1 },   { -1, 1e-9 },   { 1e-8, 1e-9 }, { 1e-8, 1e-9 }, { 2e-1, 2e-3 }, { 1e-8, 1e-9 }, { 5e-4, 1e-3 } } },
+    { "antimeridian", { { 1e-9, -1 },   { 1e-9, -1 },   { -1, 1e-9 },   { 1e-9, 1e-9 }, { 1e-9, 1e-9 }, { 2e-2, 5e-2 }, { 1e-9, 1e-9 }, { 5e-5, 1e-3 } } },
+    { "polar",        { { 1e-9, -1 },   { 1e-9, -1 },   { -1, 1e-9 },   { 1e-9, 1e-9 }, { 1e-9, 1e-9 }, { 5e-3, 2e-1 }, { 1e-9, 1e-9 }, { 5e-5, 1e-3 } } },
+    { "coincident",   { { 1e-9, -1 },   { 1e-9, -1 },   { -1, 5e-6 },   { 1e-9, 5e-6 }, { 1e-9, 5e-6 }, { 5e-3, -1 },   { 1e-9, 5e-5 }, { 5e-5, 1e-3 } } },
+    { "long",         { { 1e-8, -1 },   { 1e-8, -1 },   { -1, 1e-9 },   { 1e-8, 1e-9 }, { 1e-8, 1e-9 }, { 1e-1, 5e-3 }, { 1e-8, 1e-9 }, { 5e-4, 1e-3 } } },
+};
+
+static const ErrorLimit* findLimits(const char* set)
+{
+    for (const ErrorLimit& limit : errorLimits)
+    {
+        if (std::string(limit.set) == set)
+            return &limit;
+    }
+    return nullptr;
+}
+
+static void measureErrors(const CaseSet& set, ErrorStats stats[PATH_COUNT])
+{
+    for (int p = 0; p < PATH_COUNT; p++)
+        stats[p] = { 0, 0 };
+
+    for (const Sweep& sweep : set.sweeps)
+    {
+        const TrafficSample& t = sweep.targets;
+        size_t count = t.latitude.size();
+        TrafficPositions positions = { t.latitude.data(), t.longitude.data(), t.altitude.data(), count };
+
+        std::vector<double> batchRange(count), batchBearing(count), scalarRange(count), scalarBearing(count);
+        rangeBearingBatch(positions, sweep.ownLat, sweep.ownLon, sweep.ownAlt, batchRange.data(), batchBearing.data());
+        rangeBearingBatchScalar(positions, sweep.ownLat, sweep.ownLon, sweep.ownAlt, scalarRange.data(), scalarBearing.data());
+
+        for (size_t i = 0; i < count; i++)
+        {
+            double lat = t.latitude[i];
+            double lon = t.longitude[i];
+            double alt = t.altitude[i];
+
+            geo::Inverse<long double> sphere = ReferenceSphere::inverse(sweep.ownLat, sweep.ownLon, lat, lon);
+            long double slant = ReferenceSphere::slantRangeNm(sweep.ownLat, sweep.ownLon, sweep.ownAlt, lat, lon, alt);
+            geo::Inverse<long double> ellipsoid = ReferenceEllipsoid::inverse(sweep.ownLat, sweep.ownLon, lat, lon);
+
+            double refBearing = (double)sphere.initialBearingDeg;
+            accumulate(stats[PATH_DISTANCE], (double)distance(sweep.ownLat, sweep.ownLon, lat, lon), refBearing, sphere.distanceNm, sphere);
+            accumulate(stats[PATH_RANGE_WITH_ALT], rangeWithAlt(sweep.ownLat, sweep.ownLon, sweep.ownAlt, lat, lon, alt), refBearing, slant, sphere);
+            accumulate(stats[PATH_GET_BEARING], (double)sphere.distanceNm, getBearing(sweep.ownLat, sweep.ownLon, lat, lon), sphere.distanceNm, sphere);
+            accumulate(stats[PATH_BATCH], batchRange[i], batchBearing[i], slant, sphere);
+            accumulate(stats[PATH_BATCH_SCALAR], scalarRange[i], scalarBearing[i], slant, sphere);
+
+            geo::Inverse<float> fast = geo::FastGeo::inverse((float)sweep.ownLat, (float)sweep.ownLon, (float)lat, (float)lon);
+            accumulate(stats[PATH_FAST_GEO], fast.distanceNm, fast.initialBearingDeg, sphere.distanceNm, sphere);
+
+            accumulate(stats[PATH_FAST_MATH], rangeWithAlt(sweep.ownLat, sweep.ownLon, sweep.ownAlt, lat, lon, alt, MATH_FAST),
+                getBearing(sweep.ownLat, sweep.ownLon, lat, lon, MATH_FAST), slant, sphere);
+
+            geo::Inverse<double> precise = geo::PreciseGeo::inverse(sweep.ownLat, sweep.ownLon, lat, lon);
+            accumulate(stats[PATH_PRECISE_GEO], precise.distanceNm, precise.initialBearingDeg, ellipsoid.distanceNm, ellipsoid);
+        }
+    }
+}
+
+static int runAccuracy(const std::vector<CaseSet>& sets)
+{
+    int failures = 0;
+
+    printf("\nMax error vs long double reference (range nm / bearing deg)\n");
+    printf("%-26s", "");
+    for (const CaseSet& set : sets)
+        printf(" %21s", set.name);
+    printf("\n");
+
+    std::vector<std::array<ErrorStats, PATH_COUNT>> stats(sets.size());
+    for (size_t s = 0; s < sets.size(); s++)
+        measureErrors(sets[s], stats[s].data());
+
+    for (int p = 0; p < PATH_COUNT; p++)
+    {
+        printf("%-26s", pathNames[p]);
+        for (size_t s = 0; s < sets.size(); s++)
+            printf(" %10.2e/%10.2e", stats[s][p].rangeNm, stats[s][p].bearingDeg);
+        printf("\n");
+    }
+
+    for (size_t s = 0; s < sets.size(); s++)
+    {
+        const ErrorLimit* limit = findLimits(sets[s].name);
+        for (int p = 0; p < PATH_COUNT && limit; p++)
+        {
+            const ErrorStats& max = limit->limits[p];
+            if (max.rangeNm >= 0 && stats[s][p].rangeNm > max.rangeNm)
+            {
+                printf("FAIL: %s range error %.3e nm on '%s' exceeds %.1e\n", pathNames[p], stats[s][p].rangeNm, sets[s].name, max.rangeNm);
+                failures++;
+            }
+            if (max.bearingDeg >= 0 && stats[s][p].bearingDeg > max.bearingDeg)
+            {
+                printf("FAIL: %s bearing error %.3e deg on '%s' exceeds %.1e\n", pathNames[p], stats[s][p].bearingDeg, sets[s].name, max.bearingDeg);
+                failures++;
+            }
+        }
+    }
+
+    // nmToMeters rounds to the nearest metre by design
+    double worstRounding = 0;
+    for (double nm = 0; nm < 500; nm += 0.0137)
+        worstRounding = fmax(worstRounding, fabs(nmToMeters(nm) - nm * 1852));
+    printf("nmToMeters max rounding error %.3f m\n", worstRounding);
+    if (worstRounding > 0.5)
+    {
+        printf("FAIL: nmToMeters is off by more than half a metre\n");
+        failures++;
+    }
+
+    return failures;
+}
+
+static const double RINGS_NM[] = { 5, 10, 20, 40, 80 };
+static const size_t RING_COUNT = sizeof(RINGS_NM) / sizeof(RINGS_NM[0]);
+
+static size_t exactRing(double range)
+{
+    size_t ring = 0;
+    while (ring < RING_COUNT && RINGS_NM[ring] < range)
+        ring++;
+    return ring;
+}
+
+/**
+* Targets placed at a ring plus or minus a hair, in random directions: the cases the bracket cannot settle.
+*/
+static CaseSet makeRingEdges()
+{
+    std::mt19937_64 rng(77);
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+    CaseSet edges = { "ring edges", {} };
+    for (int s = 0; s < 16; s++)
+    {
+        double lat = 170 * unit(rng) - 85;
+        double lon = 360 * unit(rng) - 180;
+        Sweep sweep = makeSweep(lat, lon, 45000 * unit(rng));
+        for (size_t i = 0; i < SWEEP_TARGETS; i++)
+        {
+            double target = RINGS_NM[i % RING_COUNT] + (i % 3 == 0 ? 0 : (i % 3 == 1 ? 1 : -1) * pow(10, -2 - 7 * unit(rng)));
+            double alt = 45000 * unit(rng);
+            double theta = 2 * M_PI * unit(rng);
+            double dLat = cos(theta), dLon = sin(theta) / fmax(cos(lat * (M_PI / 180)), 0.05);
+
+            // Bisect the step along that direction until the slant range is the target
+            double low = 0, high = 3;
+            for (int iteration = 0; iteration < 100; iteration++)
+            {
+                double mid = (low + high) / 2;
+                if (rangeWithAlt(lat, lon, sweep.ownAlt, fmin(fmax(lat + mid * dLat, -90), 90), wrapLongitude(lon + mid * dLon), alt) < target)
+                    low = mid;
+                else
+                    high = mid;
+            }
+            addTarget(sweep, fmin(fmax(lat + low * dLat, -90), 90), wrapLongitude(lon + low * dLon), alt);
+        }
+        edges.sweeps.push_back(sweep);
+    }
+    return edges;
+}
+
+/**
+* classifyRange() and withinRange() must give exactly the rings and limits the exact range gives, everywhere,
+* while falling back to it for almost none of the local traffic.
+*/
+static int runRangeClassification(std::vector<CaseSet> sets)
+{
+    sets.push_back(makeRingEdges());
+    int failures = 0;
+
+    printf("\nRing classification (%zu rings of %.0f-%.0f nm): bracket vs rangeWithAlt\n", RING_COUNT, RINGS_NM[0], RINGS_NM[RING_COUNT - 1]);
+    printf("%-14s %8s %10s %12s %10s %10s\n", "", "targets", "outside", "max width", "fallback", "wrong");
+    for (const CaseSet& set : sets)
+    {
+        size_t targets = 0, outside = 0, fallbacks = 0, wrong = 0;
+        double maxWidth = 0;
+        for (const Sweep& sweep : set.sweeps)
+        {
+            RangeOrigin origin = makeRangeOrigin(sweep.ownLat, sweep.ownLon, sweep.ownAlt);
+            const TrafficSample& t = sweep.targets;
+            for (size_t i = 0; i < t.latitude.size(); i++)
+            {
+                double range = rangeWithAlt(sweep.ownLat, sweep.ownLon, sweep.ownAlt, t.latitude[i], t.longitude[i], t.altitude[i]);
+                RangeBounds bounds = rangeBounds(origin, t.latitude[i], t.longitude[i], t.altitude[i]);
+                targets++;
+                if (range < bounds.lowerNm || range > bounds.upperNm)
+                    outside++;
+                if (range > 1e-3)
+                    maxWidth = fmax(maxWidth, (bounds.upperNm - bounds.lowerNm) / range);
+
+                size_t ring = exactRing(range);
+                if (exactRing(bounds.lowerNm) != exactRing(bounds.upperNm))
+                    fallbacks++;
+                if (classifyRange(origin, t.latitude[i], t.longitude[i], t.altitude[i], RINGS_NM, RING_COUNT) != ring)
+                    wrong++;
+                for (double limit : RINGS_NM)
+                {
+                    if (withinRange(origin, t.latitude[i], t.longitude[i], t.altitude[i], limit) != (range <= limit))
+                        wrong++;
+                }
+            }
+        }
+        printf("%-14s %8zu %10zu %12.2e %9.2f%% %10zu\n", set.name, targets, outside, maxWidth, 100.0 * fallbacks / targets, wrong);
+        if (outside != 0 || wrong != 0)
+        {
+            printf("FAIL: ring classification on '%s' disagrees with the exact range\n", set.name);
+            failures++;
+        }
+        if (std::string(set.name) == "local" && fallbacks * 100 > targets)
+        {
+            printf("FAIL: more than 1%% of local traffic needed the exact range\n");
+            failures++;
+        }
+    }
+    return failures;
+}
+
+/**
+* Time one path over a dense local sweep and check it against the speed baseline.
+* The fastest of several repetitions is reported, which is far more stable run to run than the mean.
+*/
+template <typename Body>
+static bool timePath(const char* name, Body body)
+{
+    double bestNs = 0;
+    double checksum = 0;
+    for (int repetition = 0; repetition < TIMING_REPETITIONS; repetition++)
+    {
+        Stopwatch clock;
+        for (int sweep = 0; sweep < TIMING_SWEEPS; sweep++)
+            checksum += body();
+        double elapsed = clock.elapsedNs();
+        if (repetition == 0 || elapsed < bestNs)
+            bestNs = elapsed;
+    }
+    keepResult(checksum);
+
+    double nsPerOp = bestNs / (double(TIMING_SWEEPS) * TIMING_TARGETS);
+    printf("%-26s %8.2f ns/op %9.2f Mop/s\n", name, nsPerOp, 1000 / nsPerOp);
+    return checkSpeed((std::string("geodesy.") + name).c_str(), nsPerOp);
+}
+
+static int runTimings()
+{
+    const double ownLat = 32.951917;
+    const double ownLon = -97.264323;
+    const double ownAlt = 3799;
+    TrafficSample sample = makeTrafficSample(TIMING_TARGETS, ownLat, ownLon, 100, 7);
+    TrafficPositions positions = { sample.latitude.data(), sample.longitude.data(), sample.altitude.data(), TIMING_TARGETS };
+    std::vector<double> range(TIMING_TARGETS), bearing(TIMING_TARGETS);
+    int failures = 0;
+
+    printf("\nTiming over %zu local targets x %d sweeps, best of %d (batch ISA: %s)\n", TIMING_TARGETS, TIMING_SWEEPS, TIMING_REPETITIONS, rangeBearingBatchIsa());
+
+    failures += !timePath("distance", [&]() {
+        double sum = 0;
+        for (size_t i = 0; i < TIMING_TARGETS; i++)
+            sum += (double)distance(ownLat, ownLon, sample.latitude[i], sample.longitude[i]);
+        return sum;
+    });
+    failures += !timePath("rangeWithAlt", [&]() {
+        double sum = 0;
+        for (size_t i = 0; i < TIMING_TARGETS; i++)
+            sum += rangeWithAlt(ownLat, ownLon, ownAlt, sample.latitude[i], sample.longitude[i], sample.altitude[i]);
+        return sum;
+    });
+    failures += !timePath("getBearing", [&]() {
+        double sum = 0;
+        for (size_t i = 0; i < TIMING_TARGETS; i++)
+            sum += getBearing(ownLat, ownLon, sample.latitude[i], sample.longitude[i]);
+        return sum;
+    });
+    failures += !timePath("rangeWithAlt(MATH_FAST)", [&]() {
+        double sum = 0;
+        for (size_t i = 0; i < TIMING_TARGETS; i++)
+            sum += rangeWithAlt(ownLat, ownLon, ownAlt, sample.latitude[i], sample.longitude[i], sample.altitude[i], MATH_FAST);
+        return sum;
+    });
+    failures += !timePath("getBearing(MATH_FAST)", [&]() {
+        double sum = 0;
+        for (size_t i = 0; i < TIMING_TARGETS; i++)
+            sum += getBearing(ownLat, ownLon, sample.latitude[i], sample.longitude[i], MATH_FAST);
+        return sum;
+    });
+    failures += !timePath("nmToMeters", [&]() {
+        double sum = 0;
+        for (size_t i = 0; i < TIMING_TARGETS; i++)
+            sum += nmToMeters(sample.altitude[i]);
+        return sum;
+    });
+    failures += !timePath("rangeBearingBatch", [&]() {
+        rangeBearingBatch(positions, ownLat, ownLon, ownAlt, range.data(), bearing.data());
+        return range[0] + bearing[TIMING_TARGETS - 1];
+    });
+    failures += !timePath("rangeBearingBatchScalar", [&]() {
+        rangeBearingBatchScalar(positions, ownLat, ownLon, ownAlt, range.data(), bearing.data());
+        return range[0] + bearing[TIMING_TARGETS - 1];
+    });
+    failures += !timePath("FastGeo", [&]() {
+        float sum = 0;
+        for (size_t i = 0; i < TIMING_TARGETS; i++)
+        {
+            geo::Inverse<float> r = geo::FastGeo::inverse((float)ownLat, (float)ownLon, (float)sample.latitude[i], (float)sample.longitude[i]);
+            sum += r.distanceNm + r.initialBearingDeg;
+        }
+        return (double)sum;
+    });
+    failures += !timePath("PreciseGeo", [&]() {
+        double sum = 0;
+        for (size_t i = 0; i < TIMING_TARGETS; i++)
+        {
+            geo::Inverse<double> r = geo::PreciseGeo::inverse(ownLat, ownLon, sample.latitude[i], sample.longitude[i]);
+            sum += r.distanceNm + r.initialBearingDeg;
+        }
+        return sum;
+    });
+    failures += !timePath("rings(rangeWithAlt)", [&]() {
+        double sum = 0;
+        for (size_t i = 0; i < TIMING_TARGETS; i++)
+            sum += (double)exactRing(rangeWithAlt(ownLat, ownLon, ownAlt, sample.latitude[i], sample.longitude[i], sample.altitude[i]));
+        return sum;
+    });
+    failures += !timePath("classifyRange", [&]() {
+        RangeOrigin origin = makeRangeOrigin(ownLat, ownLon, ownAlt);
+        double sum = 0;
+        for (size_t i = 0; i < TIMING_TARGETS; i++)
+            sum += (double)classifyRange(origin, sample.latitude[i], sample.longitude[i], sample.altitude[i], RINGS_NM, RING_COUNT);
+        return sum;
+    });
+    failures += !timePath("withinRange", [&]() {
+        RangeOrigin origin = makeRangeOrigin(ownLat, ownLon, ownAlt);
+        double sum = 0;
+        for (size_t i = 0; i < TIMING_TARGETS; i++)
+            sum += withinRange(origin, sample.latitude[i], sample.longitude[i], sample.altitude[i], 50) ? 1 : 0;
+        return sum;
+    });
+    failures += !timePath("OwnshipFrame", [&]() {
+        OwnshipFrame frame(ownLat, ownLon, ownAlt);
+        double sum = 0;
+        for (size_t i = 0; i < TIMING_TARGETS; i++)
+            sum += frame.solve(sample.latitude[i], sample.longitude[i], sample.altitude[i]).rangeNm;
+        return sum;
+    });
+
+    return failures;
+}
+
+int runGeodesyBench()
+{
+    std::vector<CaseSet> sets = makeCaseSets();
+    int failures = runAccuracy(sets);
+    failures += runRangeClassification(sets);
+    failures += runTimings();
+    return failures;
+}
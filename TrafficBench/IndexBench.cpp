@@ -0,0 +1,113 @@
+#include <algorithm>
+#include <stdio.h>
+
+#include "BenchCommon.h"
+#include "Geo.h"
+#include "TrafficIndex.h"
+
+typedef geo::Geo<double, geo::Spherical> Sphere;
+
+static const int QUERIES = 200;
+
+/**
+* Reference answer: range to every aircraft.
+*/
+static size_t linearWithin(const TrafficSample& sample, double lat, double lon, double radiusNm)
+{
+    size_t found = 0;
+    for (size_t i = 0; i < sample.latitude.size(); i++)
+    {
+        if (Sphere::distanceNm(lat, lon, sample.latitude[i], sample.longitude[i]) <= radiusNm)
+            found++;
+    }
+    return found;
+}
+
+static double linearKthRange(const TrafficSample& sample, double lat, double lon, size_t k)
+{
+    std::vector<double> ranges(sample.latitude.size());
+    for (size_t i = 0; i < ranges.size(); i++)
+        ranges[i] = Sphere::distanceNm(lat, lon, sample.latitude[i], sample.longitude[i]);
+    std::nth_element(ranges.begin(), ranges.begin() + (k - 1), ranges.end());
+    return ranges[k - 1];
+}
+
+int runIndexBench()
+{
+    int failures = 0;
+
+    // A wide sweep around DFW plus a cluster straddling the antimeridian and one over the pole
+    struct Scenario { const char* name; double lat; double lon; double radiusNm; };
+    const Scenario scenarios[] = {
+        { "dfw", 32.951917, -97.264323, 250 },
+        { "antimeridian", 52.0, 179.95, 120 },
+        { "pole", 89.5, 30.0, 120 },
+    };
+
+    for (const Scenario& scenario : scenarios)
+    {
+        for (size_t count : { 1000u, 10000u })
+        {
+            TrafficSample sample = makeTrafficSample(count, scenario.lat, scenario.lon, scenario.radiusNm, 11);
+            for (size_t i = 0; i < count; i++)
+            {
+                // Fold samples that went over the pole back onto the globe
+                double& lat = sample.latitude[i];
+                double& lon = sample.longitude[i];
+                if (lat > 90)
+                {
+                    lat = 180 - lat;
+                    lon += 180;
+                }
+                lon = fmod(lon + 540, 360) - 180;
+            }
+
+            Stopwatch buildClock;
+            TrafficIndex index(5);
+            for (size_t i = 0; i < count; i++)
+                index.insert((uint32_t)i, sample.latitude[i], sample.longitude[i], sample.altitude[i]);
+            index.build();
+            double buildUs = buildClock.elapsedNs() / 1000;
+
+            std::vector<TrafficNeighbor> hits;
+            size_t mismatches = 0;
+            double linearNs = 0;
+            double indexNs = 0;
+            double nearestNs = 0;
+
+            for (int q = 0; q < QUERIES; q++)
+            {
+                double lat = sample.latitude[q % count];
+                double lon = sample.longitude[q % count];
+                double radiusNm = 5 + (q % 4) * 10;
+
+                Stopwatch linearClock;
+                size_t expected = linearWithin(sample, lat, lon, radiusNm);
+                linearNs += linearClock.elapsedNs();
+
+                Stopwatch indexClock;
+                index.withinRadius(lat, lon, radiusNm, hits);
+                indexNs += indexClock.elapsedNs();
+                if (hits.size() != expected)
+                    mismatches++;
+
+                Stopwatch nearestClock;
+                index.nearest(lat, lon, 8, hits);
+                nearestNs += nearestClock.elapsedNs();
+                if (hits.size() != 8 || fabs(hits.back().rangeNm - linearKthRange(sample, lat, lon, 8)) > 1e-9)
+                    mismatches++;
+            }
+
+            printf("%-12s %6zu aircraft: build %8.1f us  radius query %8.2f us (linear %8.2f us)  8-nearest %8.2f us\n",
+                scenario.name, count, buildUs, indexNs / QUERIES / 1000, linearNs / QUERIES / 1000, nearestNs / QUERIES / 1000);
+
+            if (mismatches)
+            {
+                printf("FAIL: %zu index queries disagree with a linear scan\n", mismatches);
+                failures++;
+            }
+        }
+    }
+
+    return failures;
+}
@@ -0,0 +1,214 @@
+#include <algorithm>
+#include <random>
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+
+#include "AsyncOutput.h"
+#include "BenchCommon.h"
+#include "LatencyHistogram.h"
+#include "TrafficMessage.h"
+#include "TrafficMetrics.h"
+#include "TrafficPipeline.h"
+#include "TrafficStages.h"
+
+static const size_t SAMPLES = 1000000;
+static const size_t RECORDS = 20000000;
+static const size_t AIRCRAFT = 1000;
+static const uint32_t SWEEPS = 10;
+
+static double benchClock()
+{
+    return 0;
+}
+
+// Every value maps to a bucket whose top is at or above it and within 1/SUB_BUCKETS of it
+static int checkBuckets()
+{
+    int failures = 0;
+    double worst = 0;
+    std::mt19937_64 rng(17);
+    for (size_t i = 0; i < SAMPLES; i++)
+    {
+        uint64_t value = rng() >> (rng() % 64);
+        if (value > LatencyHistogram::MAX_VALUE)
+            value = LatencyHistogram::MAX_VALUE;
+        size_t bucket = LatencyHistogram::bucketOf(value);
+        uint64_t top = LatencyHistogram::bucketTop(bucket);
+        if (bucket >= LatencyHistogram::BUCKETS || top < value || LatencyHistogram::bucketOf(top) != bucket)
+        {
+            printf("FAIL: value %llu lands in bucket %zu with top %llu\n", (unsigned long long)value, bucket, (unsigned long long)top);
+            failures++;
+            break;
+        }
+        if (value > 0)
+            worst = std::max(worst, (double)(top - value) / value);
+    }
+    printf("buckets    %zu of them, worst overstatement %.2f%% (limit %.2f%%)\n", LatencyHistogram::BUCKETS, worst * 100,
+        100.0 / LatencyHistogram::SUB_BUCKETS);
+    if (worst > 1.0 / LatencyHistogram::SUB_BUCKETS)
+    {
+        printf("FAIL: buckets are wider than 1/%llu of their values\n", (unsigned long long)LatencyHistogram::SUB_BUCKETS);
+        failures++;
+    }
+    return failures;
+}
+
+// Long-tailed latencies like the receive path's, against the exact order statistics
+static int checkPercentiles()
+{
+    int failures = 0;
+    std::mt19937_64 rng(23);
+    std::lognormal_distribution<double> latency(9.0, 1.2);     // median about 8 us with a tail into milliseconds
+    std::vector<uint64_t> values(SAMPLES);
+    LatencyHistogram histogram;
+    for (uint64_t& value : values)
+    {
+        value = (uint64_t)latency(rng);
+        histogram.record(value);
+    }
+    std::sort(values.begin(), values.end());
+
+    HistogramSummary summary = histogram.summary();
+    const double quantiles[] = { 0.5, 0.9, 0.99, 0.999 };
+    const uint64_t reported[] = { summary.p50, summary.p90, summary.p99, summary.p999 };
+    printf("%-10s %12s %12s %8s\n", "quantile", "exact ns", "histogram", "error");
+    for (size_t i = 0; i < 4; i++)
+    {
+        size_t rank = (size_t)(quantiles[i] * SAMPLES + 0.5);
+        uint64_t exact = values[rank - 1];
+        double error = ((double)reported[i] - (double)exact) / exact;
+        printf("p%-9g %12llu %12llu %7.2f%%\n", quantiles[i] * 100, (unsigned long long)exact, (unsigned long long)reported[i], error * 100);
+        if (error < 0 || error > 1.0 / LatencyHistogram::SUB_BUCKETS || histogram.percentile(quantiles[i]) != reported[i])
+        {
+            printf("FAIL: p%g is %llu, exact %llu\n", quantiles[i] * 100, (unsigned long long)reported[i], (unsigned long long)exact);
+            failures++;
+        }
+    }
+    if (summary.count != SAMPLES || summary.max != values.back())
+    {
+        printf("FAIL: count %llu max %llu, expected %zu and %llu\n", (unsigned long long)summary.count, (unsigned long long)summary.max,
+            SAMPLES, (unsigned long long)values.back());
+        failures++;
+    }
+    return failures;
+}
+
+static double recordNs()
+{
+    LatencyHistogram histogram;
+    Stopwatch clock;
+    uint64_t value = 1;
+    for (size_t i = 0; i < RECORDS; i++)
+    {
+        value = value * 6364136223846793005ull + 1442695040888963407ull;
+        histogram.record(value >> 44);
+    }
+    double ns = clock.elapsedNs() / RECORDS;
+    keepResult((double)histogram.summary().count);
+    return ns;
+}
+
+static std::vector<uint8_t> makeSession()
+{
+    TrafficSample sample = makeTrafficSample(AIRCRAFT, 32.951917, -97.264323, 40, 9);
+    std::vector<uint8_t> bytes;
+    for (uint32_t sweep = 0; sweep < SWEEPS; sweep++)
+    {
+        for (size_t i = 0; i < AIRCRAFT; i++)
+        {
+            AircraftState state = {};
+            state.altitude = sample.altitude[i];
+            state.latitude = sample.latitude[i] + sweep * 1e-4;
+            state.longitude = sample.longitude[i];
+            state.groundSpeed = 250;
+            appendTrafficMessage(bytes, 0, (uint32_t)(i + 1), (uint32_t)(i + 1), (uint32_t)AIRCRAFT, state);
+        }
+    }
+    return bytes;
+}
+
+// A staged session with metrics attached: every stage records, and the counts tie up with what went through
+static int checkStagedSession()
+{
+    int failures = 0;
+    std::vector<uint8_t> bytes = makeSession();
+    FILE* sink = tmpfile();
+    AsyncOutput output(sink, 1 << 16, OVERFLOW_BLOCK);
+    TrafficPipeline pipeline(output, 32.951917, -97.264323, 3799);
+    pipeline.clock = benchClock;
+    TrafficMetrics metrics;
+    pipeline.metrics = &metrics;
+    output.setLatencyHistogram(&metrics.outputNs);
+    StageSettings settings = DEFAULT_STAGE_SETTINGS;
+    settings.workers = 1;
+    TrafficStages stages(pipeline, settings);
+    stages.setMetrics(&metrics);
+
+    output.start();
+    stages.start();
+    uint64_t messages = 0;
+    for (size_t offset = 0; offset < bytes.size(); messages++)
+    {
+        TrafficMessageHeader header;
+        memcpy(&header, &bytes[offset], sizeof(header));
+        stages.submit(&bytes[offset], header.size);
+        offset += header.size;
+    }
+    stages.stop();
+    output.stop();
+    fclose(sink);
+
+    std::vector<StageStats> stats;
+    stages.stats(stats);
+    MetricsSnapshot snapshot;
+    snapshotMetrics(metrics, output, snapshot);
+    writeMetrics(stdout, snapshot);
+
+    uint64_t batches = stats[0].batches;
+    if (snapshot.messages != messages || snapshot.bytes != bytes.size())
+    {
+        printf("FAIL: counted %llu messages and %llu bytes, submitted %llu and %zu\n", (unsigned long long)snapshot.messages,
+            (unsigned long long)snapshot.bytes, (unsigned long long)messages, bytes.size());
+        failures++;
+    }
+    if (snapshot.queue.count != batches || snapshot.compute.count != batches || snapshot.commit.count != batches)
+    {
+        printf("FAIL: %llu batches, but %llu queue, %llu compute and %llu commit latencies\n", (unsigned long long)batches,
+            (unsigned long long)snapshot.queue.count, (unsigned long long)snapshot.compute.count, (unsigned long long)snapshot.commit.count);
+        failures++;
+    }
+    if (snapshot.output.count != snapshot.written || snapshot.written == 0)
+    {
+        printf("FAIL: %llu output latencies for %llu report records\n", (unsigned long long)snapshot.output.count,
+            (unsigned long long)snapshot.written);
+        failures++;
+    }
+    if (snapshot.sweeps.count != SWEEPS || snapshot.sweeps.max != AIRCRAFT)
+    {
+        printf("FAIL: %llu sweeps of up to %llu records, expected %u of %zu\n", (unsigned long long)snapshot.sweeps.count,
+            (unsigned long long)snapshot.sweeps.max, SWEEPS, AIRCRAFT);
+        failures++;
+    }
+    if (snapshot.commit.p50 < snapshot.queue.p50 || snapshot.output.max < snapshot.commit.p50)
+    {
+        printf("FAIL: latencies out of order along the path\n");
+        failures++;
+    }
+    return failures;
+}
+
+int runMetricsBench()
+{
+    int failures = 0;
+    failures += checkBuckets();
+    failures += checkPercentiles();
+
+    double ns = recordNs();
+    printf("record     %7.2f ns/event\n", ns);
+    if (!checkSpeed("metrics.record", ns))
+        failures++;
+
+    failures += checkStagedSession();
+    return failures;
+}
@@ -0,0 +1,174 @@
+#include <random>
+#include <stdio.h>
+#include <string.h>
+#include <string>
+
+#include "AsyncOutput.h"
+#include "BenchCommon.h"
+
+static const size_t RECORDS = 20000;
+
+static std::vector<OutputRecord> makeRecords(size_t count, unsigned seed)
+{
+    std::mt19937_64 rng(seed);
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+    std::vector<OutputRecord> records(count);
+    for (size_t i = 0; i < count; i++)
+    {
+        OutputRecord& record = records[i];
+        memset(&record, 0, sizeof(record));
+        record.kind = i % 50 == 0 ? OUTPUT_SWEEP : (i % 50 == 1 ? OUTPUT_USER_AIRCRAFT : OUTPUT_TRAFFIC);
+        record.objectId = (uint32_t)(i + 1);
+        record.latitude = 180 * unit(rng) - 90;
+        record.longitude = 360 * unit(rng) - 180;
+        record.altitude = 45000 * unit(rng);
+        record.trueHeading = 360 * unit(rng);
+        record.magHeading = 360 * unit(rng);
+        record.onGround = i % 7 == 0;
+        record.rangeNm = 250 * unit(rng);
+        record.bearingDeg = 360 * unit(rng);
+        record.elevationDeg = 20 * unit(rng) - 10;
+        record.aircraftCount = (uint32_t)(unit(rng) * 5000);
+        record.nearestCount = (uint32_t)(i % (OUTPUT_NEAREST_MAX + 1));
+        for (size_t n = 0; n < OUTPUT_NEAREST_MAX; n++)
+        {
+            record.nearestIds[n] = (uint32_t)(i * 3 + n);
+            record.nearestRangeNm[n] = 60 * unit(rng);
+        }
+        snprintf(record.title, sizeof(record.title), "Boeing 737-800 Paint%zu", i % 13);
+    }
+    return records;
+}
+
+/**
+* The printf calls the dispatch callback used before, as the reference for formatOutputRecord().
+*/
+static int printfRecord(const OutputRecord& r, char* buffer, size_t size)
+{
+    switch (r.kind)
+    {
+    case OUTPUT_SWEEP:
+    {
+        int length = snprintf(buffer, size, "\nSweep indexed: %u aircraft, nearest:", r.aircraftCount);
+        for (uint32_t i = 0; i < r.nearestCount; i++)
+            length += snprintf(buffer + length, size - length, "  %u (%.2fnm)", r.nearestIds[i], r.nearestRangeNm[i]);
+        return length + snprintf(buffer + length, size - length, "\n");
+    }
+    case OUTPUT_USER_AIRCRAFT:
+        return snprintf(buffer, size, "\nUSER AIRCRAFT!!!\nObjectID=%u  Title=\"%s\"\nLat=%f  Lon=%f  Alt=%fft  HdgT=%.2f  HdgM=%.2f  OnGround=%f\n",
+            r.objectId, r.title, r.latitude, r.longitude, r.altitude, r.trueHeading, r.magHeading, r.onGround);
+    default:
+        return snprintf(buffer, size, "\nObjectID=%u  Title=\"%s\"\nLat=%f  Lon=%f  Alt=%fft  HdgT=%.2f  HdgM=%.2f  OnGround=%f  Range=%.2fnm  Brng=%.2f  Elev=%.2f\n",
+            r.objectId, r.title, r.latitude, r.longitude, r.altitude, r.trueHeading, r.magHeading, r.onGround, r.rangeNm, r.bearingDeg, r.elevationDeg);
+    }
+}
+
+static long fileLength(FILE* file)
+{
+    fflush(file);
+    fseek(file, 0, SEEK_END);
+    return ftell(file);
+}
+
+int runOutputBench()
+{
+    int failures = 0;
+    std::vector<OutputRecord> records = makeRecords(RECORDS, 3);
+
+    // Text must match the old printf output byte for byte
+    size_t mismatches = 0;
+    long expectedBytes = 0;
+    char expected[OUTPUT_MAX_RECORD_TEXT];
+    char actual[OUTPUT_MAX_RECORD_TEXT];
+    for (const OutputRecord& record : records)
+    {
+        int expectedLength = printfRecord(record, expected, sizeof(expected));
+        size_t actualLength = formatOutputRecord(record, actual, sizeof(actual));
+        expectedBytes += expectedLength;
+        if (actualLength != (size_t)expectedLength || memcmp(expected, actual, actualLength) != 0)
+        {
+            if (mismatches++ == 0)
+                printf("first mismatch:\n  printf:  %.*s\n  to_chars: %.*s\n", expectedLength, expected, (int)actualLength, actual);
+        }
+    }
+    printf("format parity: %zu of %zu records differ from printf\n", mismatches, RECORDS);
+    if (mismatches != 0)
+        failures++;
+
+    // Cost on the dispatch thread: printf to a file vs a push into the ring
+    FILE* direct = tmpfile();
+    FILE* async = tmpfile();
+    if (!direct || !async)
+    {
+        printf("FAIL: could not create temporary files\n");
+        return failures + 1;
+    }
+
+    Stopwatch printfClock;
+    for (const OutputRecord& record : records)
+    {
+        int length = printfRecord(record, expected, sizeof(expected));
+        fwrite(expected, 1, length, direct);
+    }
+    double printfNs = printfClock.elapsedNs() / RECORDS;
+
+    // Sized so one sweep-sized burst fits; a smaller ring would time the writer through blocked pushes instead
+    AsyncOutput output(async, RECORDS, OVERFLOW_BLOCK);
+    output.start();
+    Stopwatch pushClock;
+    for (const OutputRecord& record : records)
+        output.push(record);
+    double pushNs = pushClock.elapsedNs() / RECORDS;
+    output.stop();
+    double writerNs = pushClock.elapsedNs() / RECORDS;
+    OutputStats stats = output.stats();
+
+    printf("dispatch thread: printf %6.1f ns/record  push %6.1f ns/record  (%.1fx)\n", printfNs, pushNs, printfNs / pushNs);
+    printf("writer thread:   %6.1f ns/record to format and write\n", writerNs);
+    printf("writer: %llu written in %llu batches, %llu blocked pushes, ring high water %llu\n", (unsigned long long)stats.written,
+        (unsigned long long)stats.batches, (unsigned long long)stats.blocked, (unsigned long long)stats.highWater);
+
+    long directBytes = fileLength(direct);
+    long asyncBytes = fileLength(async);
+    fclose(direct);
+    fclose(async);
+    if (stats.written != RECORDS || stats.dropped != 0 || asyncBytes != expectedBytes || directBytes != expectedBytes)
+    {
+        printf("FAIL: OVERFLOW_BLOCK lost output (%llu records, %ld of %ld bytes)\n", (unsigned long long)stats.written, asyncBytes, expectedBytes);
+        failures++;
+    }
+
+    // With no writer running, a 16 entry ring takes 16 records and the policy decides the rest
+    for (OverflowPolicy policy : { OVERFLOW_DROP, OVERFLOW_COUNT })
+    {
+        FILE* sink = tmpfile();
+        AsyncOutput full(sink, 16, policy);
+        for (size_t i = 0; i < 100; i++)
+            full.push(records[i]);
+        OutputStats before = full.stats();
+
+        full.start();
+        full.stop();
+        OutputStats after = full.stats();
+
+        fseek(sink, 0, SEEK_SET);
+        std::string text(fileLength(sink), '\0');
+        fseek(sink, 0, SEEK_SET);
+        text.resize(fread(&text[0], 1, text.size(), sink));
+        fclose(sink);
+
+        bool reported = text.find("84 records dropped") != std::string::npos;
+        printf("%s: queued %llu dropped %llu written %llu, drop notice %s\n", policy == OVERFLOW_DROP ? "OVERFLOW_DROP " : "OVERFLOW_COUNT",
+            (unsigned long long)before.queued, (unsigned long long)before.dropped, (unsigned long long)after.written, reported ? "printed" : "not printed");
+        if (before.queued != 16 || before.dropped != 84 || after.written != 16 || reported != (policy == OVERFLOW_COUNT))
+        {
+            printf("FAIL: overflow policy did not behave as documented\n");
+            failures++;
+        }
+    }
+
+    if (!checkSpeed("output.push", pushNs))
+        failures++;
+
+    return failures;
+}
@@ -0,0 +1,279 @@
+#include <atomic>
+#include <stdio.h>
+#include <string.h>
+#include <thread>
+#include <vector>
+
+#include "AsyncOutput.h"
+#include "BenchCommon.h"
+#include "OwnshipCell.h"
+#include "TrafficMessage.h"
+#include "TrafficPipeline.h"
+#include "TrafficStages.h"
+
+static const size_t AIRCRAFT = 2000;
+static const uint32_t SWEEPS = 10;
+static const uint32_t OWNSHIP_REQUEST = 2;
+static const double RUN_SECONDS = 0.3;
+
+static double benchClock()
+{
+    return 0;
+}
+
+static std::vector<char> readAll(FILE* file)
+{
+    std::vector<char> text;
+    fflush(file);
+    rewind(file);
+    char buffer[65536];
+    size_t read;
+    while ((read = fread(buffer, 1, sizeof(buffer), file)) > 0)
+        text.insert(text.end(), buffer, buffer + read);
+    return text;
+}
+
+static OwnshipState ownshipAt(uint32_t sweep)
+{
+    OwnshipState ownship = {};
+    ownship.latitude = 32.951917 + sweep * 2e-3;
+    ownship.longitude = -97.264323;
+    ownship.altitude = 11000 + sweep * 100.0;
+    ownship.groundSpeed = 250;
+    return ownship;
+}
+
+/**
+* Each sweep is preceded by an ownship message. The sweep's own user aircraft record is left behind at the
+* start position and altitude, so a report solved from it rather than from the ownship request shows.
+*/
+static std::vector<std::vector<uint8_t>> makeSession(const TrafficSample& sample)
+{
+    std::vector<std::vector<uint8_t>> session(SWEEPS);
+    for (uint32_t sweep = 0; sweep < SWEEPS; sweep++)
+    {
+        std::vector<uint8_t>& bytes = session[sweep];
+        appendOwnshipMessage(bytes, OWNSHIP_REQUEST, ownshipAt(sweep));
+        for (size_t i = 0; i < AIRCRAFT; i++)
+        {
+            AircraftState state = {};
+            state.isUser = i == 0;
+            state.altitude = i == 0 ? 3799 : sample.altitude[i];
+            state.latitude = i == 0 ? 32.951917 : sample.latitude[i] + sweep * 1e-4;
+            state.longitude = sample.longitude[i];
+            state.groundSpeed = 250;
+            appendTrafficMessage(bytes, 0, (uint32_t)(i + 1), (uint32_t)(i + 1), (uint32_t)AIRCRAFT, state);
+        }
+    }
+    return session;
+}
+
+struct OwnshipRun
+{
+    std::vector<char> report;
+    double ownLat;
+    double ownAlt;
+    uint64_t samples;
+};
+
+// workers 0 runs the pipeline serially; the stages are drained after each sweep so both see the same ownship
+static OwnshipRun runSession(const std::vector<std::vector<uint8_t>>& session, uint32_t workers)
+{
+    FILE* sink = tmpfile();
+    AsyncOutput output(sink, 1 << 16, OVERFLOW_BLOCK);
+    TrafficPipeline pipeline(output, 32.951917, -97.264323, 3799);
+    pipeline.clock = benchClock;
+    StageSettings settings = DEFAULT_STAGE_SETTINGS;
+    settings.workers = workers;
+    TrafficStages stages(pipeline, settings);
+    output.start();
+    if (workers != 0)
+        stages.start();
+
+    for (const std::vector<uint8_t>& bytes : session)
+    {
+        for (size_t offset = 0; offset < bytes.size(); )
+        {
+            TrafficMessageHeader header;
+            memcpy(&header, &bytes[offset], sizeof(header));
+            stages.submit(&bytes[offset], header.size);
+            offset += header.size;
+        }
+        stages.drain();
+    }
+    stages.stop();
+    output.stop();
+
+    OwnshipRun run;
+    run.report = readAll(sink);
+    run.ownLat = pipeline.ownship().latitude();
+    run.ownAlt = pipeline.ownship().altitude();
+    run.samples = pipeline.ownshipCell().updates();
+    fclose(sink);
+    return run;
+}
+
+// Sweeps are solved from the ownship request, not from the user aircraft record they carry
+static int checkPipeline(const TrafficSample& sample)
+{
+    int failures = 0;
+    std::vector<std::vector<uint8_t>> session = makeSession(sample);
+    OwnshipRun serial = runSession(session, 0);
+    OwnshipRun staged = runSession(session, 2);
+    OwnshipState last = ownshipAt(SWEEPS - 1);
+
+    printf("ownship after %u sweeps: serial %.5f at %.0f ft, staged %.5f at %.0f ft (requested %.5f at %.0f ft), %llu samples\n", SWEEPS,
+        serial.ownLat, serial.ownAlt, staged.ownLat, staged.ownAlt, last.latitude, last.altitude, (unsigned long long)serial.samples);
+    if (serial.ownLat != last.latitude || serial.ownAlt != last.altitude || staged.ownLat != last.latitude || staged.ownAlt != last.altitude ||
+        serial.samples != SWEEPS || staged.samples != SWEEPS)
+    {
+        printf("FAIL: the ownship did not follow its own request\n");
+        failures++;
+    }
+    if (serial.report.empty() || staged.report != serial.report)
+    {
+        printf("FAIL: staged report differs from the serial one (%zu vs %zu bytes)\n", staged.report.size(), serial.report.size());
+        failures++;
+    }
+
+    // An ownship sample arriving while a sweep is collected is the one the sweep is solved from
+    std::vector<char> reports[2];
+    for (int run = 0; run < 2; run++)
+    {
+        FILE* sink = tmpfile();
+        AsyncOutput output(sink, 1 << 16, OVERFLOW_BLOCK);
+        TrafficPipeline pipeline(output, 32.951917, -97.264323, 3799);
+        pipeline.clock = benchClock;
+        output.start();
+
+        std::vector<uint8_t> ownship;
+        appendOwnshipMessage(ownship, OWNSHIP_REQUEST, ownshipAt(5));
+        const std::vector<uint8_t>& sweep = session[0];
+        size_t sweepStart = ownship.size();         // session[0] starts with its own ownship message; skip it
+        size_t middle = sweepStart;
+        for (size_t i = 0; i < AIRCRAFT / 2; i++)
+        {
+            TrafficMessageHeader header;
+            memcpy(&header, &sweep[middle], sizeof(header));
+            middle += header.size;
+        }
+
+        if (run == 0)
+            pipeline.onMessage(ownship.data(), (uint32_t)ownship.size());
+        for (size_t offset = sweepStart; offset < sweep.size(); )
+        {
+            if (run == 1 && offset == middle)
+                pipeline.onMessage(ownship.data(), (uint32_t)ownship.size());
+            TrafficMessageHeader header;
+            memcpy(&header, &sweep[offset], sizeof(header));
+            pipeline.onMessage(&sweep[offset], header.size);
+            offset += header.size;
+        }
+        output.stop();
+        reports[run] = readAll(sink);
+        fclose(sink);
+    }
+    bool fresh = !reports[0].empty() && reports[0] == reports[1];
+    printf("ownship moved halfway through a sweep: %s\n", fresh ? "whole sweep solved from the new position" : "FAIL");
+    if (!fresh)
+        failures++;
+    return failures;
+}
+
+struct CellReader
+{
+    uint64_t loads;
+    uint64_t torn;
+    uint64_t backwards;
+};
+
+static void readCell(const OwnshipCell* cell, const std::atomic<bool>* stop, CellReader* result)
+{
+    double last = 0;
+    while (!stop->load(std::memory_order_relaxed))
+    {
+        OwnshipSample sample;
+        if (!cell->load(sample))
+            continue;
+        result->loads++;
+        if (sample.longitude != sample.latitude || sample.altitude != sample.latitude || sample.time != sample.latitude)
+            result->torn++;
+        if (sample.latitude < last)
+            result->backwards++;
+        last = sample.latitude;
+    }
+}
+
+// One writer storing as fast as it can against readers; every load must be one whole sample, never older than the last
+static int checkCell(double& loadNs)
+{
+    OwnshipCell cell;
+    std::atomic<bool> stop(false);
+    const uint32_t readers = 2;
+    std::vector<CellReader> results(readers, CellReader());
+    std::vector<std::thread> threads;
+    for (uint32_t i = 0; i < readers; i++)
+        threads.emplace_back(readCell, &cell, &stop, &results[i]);
+
+    Stopwatch clock;
+    uint64_t stores = 0;
+    while (clock.elapsedNs() < RUN_SECONDS * 1e9)
+    {
+        for (int i = 0; i < 64; i++)
+        {
+            stores++;
+            OwnshipSample sample;
+            sample.latitude = sample.longitude = sample.altitude = sample.time = (double)stores;
+            sample.trueHeading = sample.groundSpeed = sample.verticalSpeed = 0;
+            cell.store(sample);
+        }
+        std::this_thread::yield();
+    }
+    stop.store(true);
+    for (std::thread& thread : threads)
+        thread.join();
+    double seconds = clock.elapsedNs() / 1e9;
+
+    uint64_t loads = 0, torn = 0, backwards = 0;
+    for (const CellReader& result : results)
+    {
+        loads += result.loads;
+        torn += result.torn;
+        backwards += result.backwards;
+    }
+    printf("cell: %llu stores, %u readers %.0f loads/s each, %llu torn, %llu out of order\n", (unsigned long long)stores, readers,
+        loads / seconds / readers, (unsigned long long)torn, (unsigned long long)backwards);
+
+    // Uncontended load, as a worker does once per batch
+    const int timedLoads = 1000000;
+    OwnshipSample sample = {};
+    Stopwatch loadClock;
+    double sum = 0;
+    for (int i = 0; i < timedLoads; i++)
+    {
+        cell.load(sample);
+        sum += sample.latitude;
+    }
+    loadNs = loadClock.elapsedNs() / timedLoads;
+    keepResult(sum);
+
+    if (loads == 0 || torn != 0 || backwards != 0 || cell.updates() != stores)
+    {
+        printf("FAIL: ownship cell returned torn or stale samples\n");
+        return 1;
+    }
+    return 0;
+}
+
+int runOwnshipBench()
+{
+    TrafficSample sample = makeTrafficSample(AIRCRAFT, 32.951917, -97.264323, 40, 17);
+    int failures = checkPipeline(sample);
+
+    double loadNs = 0;
+    failures += checkCell(loadNs);
+    printf("ownship cell load: %.1f ns\n", loadNs);
+    if (!checkSpeed("ownship.load", loadNs))
+        failures++;
+    return failures;
+}
@@ -0,0 +1,218 @@
+#include <math.h>
+#include <stdio.h>
+#include <vector>
+
+#include "AsyncOutput.h"
+#include "BenchCommon.h"
+#include "DeadReckoning.h"
+#include "TrafficPipeline.h"
+
+static const size_t AIRCRAFT = 1000;
+static const int SWEEPS = 30;               // one sample per aircraft per second
+static const int FRAMES_PER_SECOND = 60;
+static const double TRUTH_STEP = 0.01;      // longest step of the reference flight model, in seconds
+static const double WIND_FROM_DEG = 270;
+static const double WIND_KTS = 40;          // a strong crosswind for the slowest traffic: a crab of up to 17 degrees
+
+/**
+* Reference flight: constant airspeed, a constant turn rate (0 for straight) and a vertical speed, in a
+* constant wind.
+*/
+struct TruthAircraft
+{
+    double latitude;
+    double longitude;
+    double altitude;
+    double headingDeg;
+    double speedKts;            // true airspeed
+    double turnRateDegPerSec;
+    double verticalSpeedFpm;
+};
+
+// Velocity over the ground, in knots: the airspeed along the heading plus the wind
+static void groundVelocity(const TruthAircraft& aircraft, double& northKts, double& eastKts)
+{
+    double heading = aircraft.headingDeg * (M_PI / 180);
+    double windTo = (WIND_FROM_DEG + 180) * (M_PI / 180);
+    northKts = aircraft.speedKts * cos(heading) + WIND_KTS * cos(windTo);
+    eastKts = aircraft.speedKts * sin(heading) + WIND_KTS * sin(windTo);
+}
+
+static void stepTruth(TruthAircraft& aircraft, double seconds)
+{
+    int steps = (int)ceil(seconds / TRUTH_STEP);
+    double dt = seconds / steps;
+    for (int step = 0; step < steps; step++)
+    {
+        aircraft.headingDeg = fmod(aircraft.headingDeg + aircraft.turnRateDegPerSec * dt + 360, 360);
+        double northKts, eastKts;
+        groundVelocity(aircraft, northKts, eastKts);
+        aircraft.latitude += northKts * dt / 3600 / 60;
+        aircraft.longitude += eastKts * dt / 3600 / (60 * cos(aircraft.latitude * (M_PI / 180)));
+        aircraft.altitude += aircraft.verticalSpeedFpm * dt / 60;
+    }
+}
+
+static double separationNm(double lat1, double lon1, double lat2, double lon2)
+{
+    double north = (lat2 - lat1) * 60;
+    double east = (lon2 - lon1) * 60 * cos(lat1 * (M_PI / 180));
+    return sqrt(north * north + east * east);
+}
+
+static double benchTime = 0;
+
+static double benchClock()
+{
+    return benchTime;
+}
+
+struct PredictResult
+{
+    double straightErrorNm;     // worst prediction error for aircraft holding heading
+    double turningErrorNm;      // worst prediction error for aircraft in a turn
+    double holdErrorNm;         // worst error from showing the last sample instead
+    double maxJumpNm;           // worst difference between a displayed frame-to-frame step and the true one
+    double predictNs;           // predictAll per aircraft
+};
+
+/**
+* Fly the reference traffic for SWEEPS seconds, sampling it into a pipeline once a second and querying the
+* predictor at FRAMES_PER_SECOND in between.
+*/
+static PredictResult run(double blendSeconds)
+{
+    TrafficSample sample = makeTrafficSample(AIRCRAFT, 32.951917, -97.264323, 60, 13);
+    std::vector<TruthAircraft> truth(AIRCRAFT);
+    for (size_t i = 0; i < AIRCRAFT; i++)
+    {
+        TruthAircraft& aircraft = truth[i];
+        aircraft.latitude = sample.latitude[i];
+        aircraft.longitude = sample.longitude[i];
+        aircraft.altitude = 2000 + sample.altitude[i] * 0.8;
+        aircraft.headingDeg = fmod(i * 37.0, 360);
+        aircraft.speedKts = 140 + (i % 34) * 10;
+        aircraft.turnRateDegPerSec = i % 4 == 0 ? 3 : 0;
+        aircraft.verticalSpeedFpm = i % 3 == 0 ? 1800 : (i % 3 == 1 ? -900 : 0);
+    }
+
+    FILE* sink = tmpfile();
+    AsyncOutput output(sink, 1 << 16, OVERFLOW_BLOCK);
+    TrafficPipeline pipeline(output, 32.951917, -97.264323, 3799);
+    pipeline.clock = benchClock;
+    pipeline.predictor().blendSeconds = blendSeconds;
+    output.start();
+
+    PredictResult result = {};
+    std::vector<double> latitudes, longitudes, altitudes, lastLat, lastLon, lastTruthLat, lastTruthLon;
+    std::vector<TruthAircraft> sampled = truth;
+    double predictNs = 0;
+    size_t predictions = 0;
+    for (int sweep = 0; sweep < SWEEPS; sweep++)
+    {
+        benchTime = sweep;
+        for (size_t i = 0; i < AIRCRAFT; i++)
+        {
+            const TruthAircraft& aircraft = truth[i];
+            AircraftState state = {};
+            state.isUser = i == 0;
+            state.trueHeading = aircraft.headingDeg * (M_PI / 180);
+            state.magHeading = state.trueHeading;
+            state.altitude = aircraft.altitude;
+            state.latitude = aircraft.latitude;
+            state.longitude = aircraft.longitude;
+            double northKts, eastKts;
+            groundVelocity(aircraft, northKts, eastKts);
+            state.groundSpeed = sqrt(northKts * northKts + eastKts * eastKts);
+            state.groundTrack = atan2(eastKts, northKts);
+            state.verticalSpeed = aircraft.verticalSpeedFpm;
+            pipeline.onAircraft((uint32_t)(i + 1), (uint32_t)(i + 1), (uint32_t)AIRCRAFT, state);
+        }
+        sampled = truth;
+
+        const TrafficTable& table = pipeline.table();
+        latitudes.resize(table.size());
+        longitudes.resize(table.size());
+        altitudes.resize(table.size());
+        for (int frame = 0; frame < FRAMES_PER_SECOND; frame++)
+        {
+            for (TruthAircraft& aircraft : truth)
+                stepTruth(aircraft, 1.0 / FRAMES_PER_SECOND);
+            benchTime = sweep + (frame + 1.0) / FRAMES_PER_SECOND;
+
+            Stopwatch clock;
+            pipeline.predictor().predictAll(table, benchTime, latitudes.data(), longitudes.data(), altitudes.data());
+            predictNs += clock.elapsedNs();
+            predictions += table.size();
+
+            for (size_t slot = 0; slot < table.size(); slot++)
+            {
+                size_t i = table.objectIds()[slot] - 1;
+                double error = separationNm(truth[i].latitude, truth[i].longitude, latitudes[slot], longitudes[slot]);
+                double& worst = truth[i].turnRateDegPerSec != 0 ? result.turningErrorNm : result.straightErrorNm;
+                worst = fmax(worst, error);
+                result.holdErrorNm = fmax(result.holdErrorNm, separationNm(truth[i].latitude, truth[i].longitude, sampled[i].latitude, sampled[i].longitude));
+            }
+
+            // Compare each displayed step with the true step over the same frame; a jump shows up as the difference
+            if (!lastLat.empty())
+            {
+                for (size_t slot = 0; slot < table.size(); slot++)
+                {
+                    size_t i = table.objectIds()[slot] - 1;
+                    double north = (latitudes[slot] - lastLat[i]) - (truth[i].latitude - lastTruthLat[i]);
+                    double east = (longitudes[slot] - lastLon[i]) - (truth[i].longitude - lastTruthLon[i]);
+                    result.maxJumpNm = fmax(result.maxJumpNm, separationNm(truth[i].latitude, truth[i].longitude, truth[i].latitude + north, truth[i].longitude + east));
+                }
+            }
+            lastLat.resize(AIRCRAFT);
+            lastLon.resize(AIRCRAFT);
+            lastTruthLat.resize(AIRCRAFT);
+            lastTruthLon.resize(AIRCRAFT);
+            for (size_t slot = 0; slot < table.size(); slot++)
+            {
+                size_t i = table.objectIds()[slot] - 1;
+                lastLat[i] = latitudes[slot];
+                lastLon[i] = longitudes[slot];
+                lastTruthLat[i] = truth[i].latitude;
+                lastTruthLon[i] = truth[i].longitude;
+            }
+        }
+    }
+    keepResult(altitudes.empty() ? 0 : altitudes[0]);
+
+    output.stop();
+    fclose(sink);
+    result.predictNs = predictNs / predictions;
+    return result;
+}
+
+int runPredictBench()
+{
+    int failures = 0;
+    PredictResult blended = run(1);
+    PredictResult snapped = run(0);
+
+    printf("%zu aircraft, %d one-second sweeps, queried at %d Hz, wind %.0f at %.0f kt\n", AIRCRAFT, SWEEPS, FRAMES_PER_SECOND,
+        WIND_FROM_DEG, WIND_KTS);
+    printf("hold last sample  worst error %.4f nm\n", blended.holdErrorNm);
+    printf("dead reckoning    worst error %.4f nm straight/climbing, %.4f nm turning at 3 deg/s\n", blended.straightErrorNm, blended.turningErrorNm);
+    printf("new sample jump   %.5f nm snapped, %.5f nm blended over 1 s\n", snapped.maxJumpNm, blended.maxJumpNm);
+    printf("predictAll        %.1f ns/aircraft\n", blended.predictNs);
+
+    if (blended.straightErrorNm > 0.001 || blended.turningErrorNm > 0.05 || blended.turningErrorNm > blended.holdErrorNm / 10)
+    {
+        printf("FAIL: dead reckoning is not tracking the reference flights\n");
+        failures++;
+    }
+    if (blended.maxJumpNm > snapped.maxJumpNm / 4)
+    {
+        printf("FAIL: blending does not smooth the step at a new sample\n");
+        failures++;
+    }
+
+    if (!checkSpeed("predict.all", blended.predictNs))
+        failures++;
+
+    return failures;
+}
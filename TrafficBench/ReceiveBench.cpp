@@ -0,0 +1,161 @@
+#include <algorithm>
+#include <stdio.h>
+#include <string.h>
+#include <thread>
+#include <vector>
+
+#include "BenchCommon.h"
+#include "MockTransport.h"
+#include "ReceiveEngine.h"
+
+static const int BURSTS = 200;
+static const int BURST_SIZE = 16;
+static const int BURST_GAP_US = 2000;
+
+// The poll loop sleeps this long between drains; the old client used 1000 ms, scaled down to keep the run short
+static const int POLL_INTERVAL_MS = 50;
+
+// Generous so a loaded CI machine does not fail on scheduler noise; a poll loop cannot get near it
+static const double MAX_EVENT_P99_MS = 10;
+
+struct LatencyProbe
+{
+    std::vector<double> latenciesMs;
+    size_t largestBatch;
+    size_t currentBatch;
+};
+
+static double nowMs()
+{
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static void recordLatency(const void* data, uint32_t size, void* context)
+{
+    LatencyProbe* probe = (LatencyProbe*)context;
+    double sentMs;
+    if (size == sizeof(sentMs))
+    {
+        memcpy(&sentMs, data, sizeof(sentMs));
+        probe->latenciesMs.push_back(nowMs() - sentMs);
+    }
+    probe->currentBatch++;
+}
+
+static void produce(MockTransport* transport)
+{
+    for (int burst = 0; burst < BURSTS; burst++)
+    {
+        for (int i = 0; i < BURST_SIZE; i++)
+        {
+            double sentMs = nowMs();
+            transport->push(&sentMs, sizeof(sentMs));
+        }
+        std::this_thread::sleep_for(std::chrono::microseconds(BURST_GAP_US));
+    }
+}
+
+static double percentile(std::vector<double> values, double fraction)
+{
+    if (values.empty())
+        return 0;
+    std::sort(values.begin(), values.end());
+    return values[(size_t)(fraction * (values.size() - 1))];
+}
+
+static void report(const char* label, const LatencyProbe& probe)
+{
+    printf("%-22s %5zu msgs  p50 %7.3f ms  p99 %7.3f ms  max %7.3f ms  largest batch %zu\n", label,
+        probe.latenciesMs.size(), percentile(probe.latenciesMs, 0.5), percentile(probe.latenciesMs, 0.99),
+        percentile(probe.latenciesMs, 1.0), probe.largestBatch);
+}
+
+static LatencyProbe runEventDriven(const ReceiveSettings& settings, ReceiveStats& stats)
+{
+    MockTransport transport;
+    ReceiveEngine engine(transport, settings);
+    LatencyProbe probe = {};
+    const size_t expected = (size_t)BURSTS * BURST_SIZE;
+
+    std::thread producer(produce, &transport);
+    while (probe.latenciesMs.size() < expected)
+    {
+        probe.currentBatch = 0;
+        engine.pump(recordLatency, &probe);
+        probe.largestBatch = std::max(probe.largestBatch, probe.currentBatch);
+    }
+    producer.join();
+
+    stats = engine.stats();
+    return probe;
+}
+
+static LatencyProbe runPolling()
+{
+    MockTransport transport;
+    LatencyProbe probe = {};
+    const size_t expected = (size_t)BURSTS * BURST_SIZE;
+
+    std::thread producer(produce, &transport);
+    while (probe.latenciesMs.size() < expected)
+    {
+        probe.currentBatch = 0;
+        const void* data;
+        uint32_t size;
+        while (transport.nextMessage(&data, &size))
+            recordLatency(data, size, &probe);
+        probe.largestBatch = std::max(probe.largestBatch, probe.currentBatch);
+        std::this_thread::sleep_for(std::chrono::milliseconds(POLL_INTERVAL_MS));
+    }
+    producer.join();
+    return probe;
+}
+
+int runReceiveBench()
+{
+    int failures = 0;
+    printf("%d bursts of %d messages, %d us apart\n", BURSTS, BURST_SIZE, BURST_GAP_US);
+
+    LatencyProbe polled = runPolling();
+    char label[64];
+    snprintf(label, sizeof(label), "poll every %d ms", POLL_INTERVAL_MS);
+    report(label, polled);
+
+    for (uint32_t maxBatch : { 256u, 4u })
+    {
+        ReceiveSettings settings = { 100, maxBatch };
+        ReceiveStats stats;
+        LatencyProbe probe = runEventDriven(settings, stats);
+        snprintf(label, sizeof(label), "event, maxBatch %u", maxBatch);
+        report(label, probe);
+        printf("%-22s wakeups %llu  timeouts %llu  full batches %llu\n", "",
+            (unsigned long long)stats.wakeups, (unsigned long long)stats.timeouts, (unsigned long long)stats.fullBatches);
+
+        if (probe.largestBatch > maxBatch)
+        {
+            printf("FAIL: delivered %zu messages in one pump, maxBatch is %u\n", probe.largestBatch, maxBatch);
+            failures++;
+        }
+        if (percentile(probe.latenciesMs, 0.99) > MAX_EVENT_P99_MS)
+        {
+            printf("FAIL: event-driven p99 latency above %.1f ms\n", MAX_EVENT_P99_MS);
+            failures++;
+        }
+    }
+
+    // An idle transport must hand control back after maxLatencyMs
+    MockTransport idle;
+    ReceiveEngine engine(idle, { 20, 256 });
+    LatencyProbe probe = {};
+    double startMs = nowMs();
+    size_t delivered = engine.pump(recordLatency, &probe);
+    double waitedMs = nowMs() - startMs;
+    printf("idle pump returned %zu messages after %.1f ms (maxLatency 20 ms)\n", delivered, waitedMs);
+    if (delivered != 0 || engine.stats().timeouts != 1 || waitedMs < 15 || waitedMs > 500)
+    {
+        printf("FAIL: idle pump did not time out after maxLatencyMs\n");
+        failures++;
+    }
+
+    return failures;
+}
@@ -0,0 +1,160 @@
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+
+#include "BenchCommon.h"
+#include "DecodedMessage.h"
+#include "TrafficMessage.h"
+
+static const size_t AIRCRAFT = 2000;
+static const int ROUNDS = 200;
+
+static std::vector<AircraftState> makeStates(const TrafficSample& sample)
+{
+    std::vector<AircraftState> states(AIRCRAFT);
+    for (size_t i = 0; i < AIRCRAFT; i++)
+    {
+        AircraftState& state = states[i];
+        state.isUser = i == 0;
+        state.onGround = i % 7 == 0;
+        state.trueHeading = 6.28 * i / AIRCRAFT;
+        state.magHeading = state.trueHeading - 0.06;
+        state.altitude = sample.altitude[i] + 0.37;
+        state.latitude = sample.latitude[i];
+        state.longitude = sample.longitude[i];
+        state.groundSpeed = 180.25 + i % 300;
+        state.verticalSpeed = i % 3 ? -850 : 1500;
+        state.groundTrack = state.trueHeading + (i % 5) * 0.03 - 0.06;
+    }
+    return states;
+}
+
+// What the packed definition gives up: nothing in the flags or position, next to nothing anywhere else
+static bool closeEnough(const AircraftState& original, const AircraftState& decoded)
+{
+    return decoded.isUser == original.isUser && decoded.onGround == original.onGround && decoded.latitude == original.latitude &&
+        decoded.longitude == original.longitude && fabs(decoded.trueHeading - original.trueHeading) < 1e-6 &&
+        fabs(decoded.magHeading - original.magHeading) < 1e-6 && fabs(decoded.altitude - original.altitude) < 0.01 &&
+        fabs(decoded.groundSpeed - original.groundSpeed) < 1e-4 && fabs(decoded.verticalSpeed - original.verticalSpeed) < 1e-3 &&
+        fabs(decoded.groundTrack - original.groundTrack) < 1e-6;
+}
+
+static void printDescription()
+{
+    printf("PackedAircraftState: %zu bytes (AircraftState %zu), generated definition:\n", sizeof(PackedAircraftState), sizeof(AircraftState));
+    static const char* const TYPE_NAMES[] = { "", "INT32", "INT64", "FLOAT32", "FLOAT64", "", "", "", "", "STRING256" };
+    for (const WireField& field : WireRecord<PackedAircraftState>::fields)
+        printf("  %2u %-32s %-16s %-8s at %2u\n", field.datumId, field.name, field.units, TYPE_NAMES[field.type], field.offset);
+}
+
+// A sweep sent packed decodes to the same aircraft as one sent unpacked, in fewer bytes
+static int checkSweep(const std::vector<AircraftState>& states, std::vector<uint8_t>& packedStream, std::vector<uint8_t>& fullStream)
+{
+    packedStream.clear();
+    fullStream.clear();
+    for (size_t i = 0; i < AIRCRAFT; i++)
+    {
+        uint32_t objectId = (uint32_t)(i + 1);
+        appendTrafficMessage(packedStream, 0, objectId, objectId, (uint32_t)AIRCRAFT, packState(states[i]));
+        appendTrafficMessage(fullStream, 0, objectId, objectId, (uint32_t)AIRCRAFT, states[i]);
+    }
+
+    size_t decoded = 0, mismatched = 0;
+    for (size_t offset = 0; offset < packedStream.size(); )
+    {
+        TrafficMessageHeader header;
+        memcpy(&header, &packedStream[offset], sizeof(header));
+        DecodedMessage message;
+        if (decodeTrafficMessage(&packedStream[offset], header.size, message) && message.kind == DECODED_SWEEP)
+        {
+            decoded++;
+            if (message.objectId == 0 || message.objectId > AIRCRAFT || !closeEnough(states[message.objectId - 1], message.state))
+                mismatched++;
+        }
+        offset += header.size;
+    }
+
+    printf("sweep of %zu aircraft: packed %zu bytes, unpacked %zu bytes (%.0f%% smaller), %zu decoded, %zu mismatched\n", AIRCRAFT,
+        packedStream.size(), fullStream.size(), 100.0 * (1 - (double)packedStream.size() / fullStream.size()), decoded, mismatched);
+    if (decoded != AIRCRAFT || mismatched != 0)
+    {
+        printf("FAIL: packed sweep records do not decode to their aircraft\n");
+        return 1;
+    }
+    return 0;
+}
+
+// Tagged values are as wide as their datum, so the pairs only fit the definition they were sent with
+static int checkTagged(const std::vector<AircraftState>& states)
+{
+    const AircraftState& state = states[11];
+    uint32_t fields = (1u << STATE_ON_GROUND) | (1u << STATE_ALTITUDE) | (1u << STATE_LATITUDE);
+    std::vector<uint8_t> packed, full;
+    appendTaggedStateMessage(packed, 0x10000 + 12, 12, state, fields);
+    appendTaggedStateMessage(full, 0x10000 + 12, 12, state, fields, TRAFFIC_DEFINITION_STATE);
+
+    DecodedMessage decoded;
+    bool good = decodeTrafficMessage(packed.data(), (uint32_t)packed.size(), decoded) && decoded.kind == DECODED_TRACKED &&
+        decoded.fields == fields && decoded.state.onGround == state.onGround && decoded.state.latitude == state.latitude &&
+        fabs(decoded.state.altitude - state.altitude) < 0.01;
+
+    std::vector<uint8_t> truncated(packed.begin(), packed.end() - 1);
+    bool rejectsTruncated = !decodeTrafficMessage(truncated.data(), (uint32_t)truncated.size(), decoded);
+
+    // Read with the unpacked widths, the same pairs would run past the end
+    std::vector<uint8_t> asUnpacked = packed;
+    uint32_t defineId = TRAFFIC_DEFINITION_STATE;
+    memcpy(&asUnpacked[offsetof(TrafficMessageHeader, defineId)], &defineId, sizeof(defineId));
+    bool rejectsUnpacked = !decodeTrafficMessage(asUnpacked.data(), (uint32_t)asUnpacked.size(), decoded);
+
+    printf("tagged packed record: %zu bytes (unpacked %zu), decode %s, truncated %s, read as unpacked %s\n", packed.size(), full.size(),
+        good ? "ok" : "FAIL", rejectsTruncated ? "rejected" : "ACCEPTED", rejectsUnpacked ? "rejected" : "ACCEPTED");
+    if (!good || !rejectsTruncated || !rejectsUnpacked || packed.size() >= full.size())
+    {
+        printf("FAIL: tagged packed record validation\n");
+        return 1;
+    }
+    return 0;
+}
+
+// Decode cost per record of a whole sweep
+static double decodeNs(const std::vector<uint8_t>& stream)
+{
+    Stopwatch clock;
+    double sum = 0;
+    size_t messages = 0;
+    for (int round = 0; round < ROUNDS; round++)
+    {
+        for (size_t offset = 0; offset < stream.size(); )
+        {
+            TrafficMessageHeader header;
+            memcpy(&header, &stream[offset], sizeof(header));
+            DecodedMessage message;
+            if (decodeTrafficMessage(&stream[offset], header.size, message))
+                sum += message.state.altitude;
+            offset += header.size;
+            messages++;
+        }
+    }
+    keepResult(sum);
+    return clock.elapsedNs() / (messages > 0 ? messages : 1);
+}
+
+int runRecordBench()
+{
+    TrafficSample sample = makeTrafficSample(AIRCRAFT, 32.951917, -97.264323, 60, 23);
+    std::vector<AircraftState> states = makeStates(sample);
+    printDescription();
+
+    std::vector<uint8_t> packedStream, fullStream;
+    int failures = checkSweep(states, packedStream, fullStream);
+    failures += checkTagged(states);
+
+    double packedNs = decodeNs(packedStream);
+    double fullNs = decodeNs(fullStream);
+    printf("decode: packed %.1f ns/record, unpacked %.1f ns/record\n", packedNs, fullNs);
+    if (!checkSpeed("records.decode", packedNs))
+        failures++;
+    return failures;
+}
@@ -0,0 +1,249 @@
+#include <chrono>
+#include <stdio.h>
+#include <string.h>
+#include <string>
+
+#include "AsyncOutput.h"
+#include "BenchCommon.h"
+#include "ReceiveEngine.h"
+#include "ReplayTransport.h"
+#include "TrafficMessage.h"
+#include "TrafficPipeline.h"
+#include "TrafficRecorder.h"
+
+static const char* RECORDING_PATH = "TrafficBench.p3drec";
+static const size_t AIRCRAFT = 200;
+static const uint32_t SWEEPS = 100;
+static const uint64_t SWEEP_INTERVAL_NS = 10000000;     // 10 ms between sweeps
+static const uint32_t BENCH_CHUNK_SIZE = 64 * 1024;     // small chunks so the recording spans many
+
+struct RecordedMessage
+{
+    uint64_t timestampNs;
+    std::vector<uint8_t> bytes;
+};
+
+static std::vector<RecordedMessage> makeSession()
+{
+    TrafficSample sample = makeTrafficSample(AIRCRAFT, 32.951917, -97.264323, 60, 5);
+    std::vector<RecordedMessage> session;
+    for (uint32_t sweep = 0; sweep < SWEEPS; sweep++)
+    {
+        for (size_t i = 0; i < AIRCRAFT; i++)
+        {
+            AircraftInfo aircraft = {};
+            snprintf(aircraft.title, sizeof(aircraft.title), "Traffic %zu", i % 17);
+            aircraft.isUser = i == 0;
+            aircraft.onGround = i % 9 == 0 && i != 0;
+            aircraft.trueHeading = 0.01 * (double)i;
+            aircraft.magHeading = aircraft.trueHeading;
+            aircraft.altitude = sample.altitude[i];
+            aircraft.latitude = sample.latitude[i] + sweep * 1e-4;
+            aircraft.longitude = sample.longitude[i];
+
+            RecordedMessage message;
+            message.timestampNs = sweep * SWEEP_INTERVAL_NS + i * 1000;
+            appendTrafficMessage(message.bytes, 0, (uint32_t)(i + 1), (uint32_t)(i + 1), (uint32_t)AIRCRAFT, aircraft);
+            session.push_back(message);
+        }
+    }
+    return session;
+}
+
+static std::string readAll(FILE* file)
+{
+    fflush(file);
+    fseek(file, 0, SEEK_END);
+    std::string text(ftell(file), '\0');
+    fseek(file, 0, SEEK_SET);
+    text.resize(fread(&text[0], 1, text.size(), file));
+    return text;
+}
+
+static ReplayTransport* replaying = NULL;
+
+static double replayClock()
+{
+    return replaying->recordedSeconds();
+}
+
+// As TrafficReplay does: the pipeline runs on the recording's clock, expiring sweeps before each message
+static void dispatchMessage(const void* data, uint32_t size, void* context)
+{
+    TrafficPipeline* pipeline = (TrafficPipeline*)context;
+    pipeline->expireSweeps();
+    pipeline->onMessage(data, size);
+}
+
+/**
+* Replay the recording through a fresh pipeline and return its report text.
+*/
+static std::string replay(double speed, double& seconds, uint64_t& messages)
+{
+    TrafficLogReader reader;
+    if (!reader.open(RECORDING_PATH))
+        return std::string();
+
+    FILE* sink = tmpfile();
+    AsyncOutput output(sink, 1 << 16, OVERFLOW_BLOCK);
+    TrafficPipeline pipeline(output, 32.951917, -97.264323, 3799);
+    ReplayTransport transport(reader, speed);
+    ReceiveEngine receiver(transport);
+    replaying = &transport;
+    pipeline.clock = replayClock;
+
+    output.start();
+    Stopwatch clock;
+    while (!transport.finished())
+        receiver.pump(dispatchMessage, &pipeline);
+    seconds = clock.elapsedNs() * 1e-9;
+    output.stop();
+
+    messages = receiver.stats().messages;
+    std::string text = readAll(sink);
+    fclose(sink);
+    return text;
+}
+
+static bool patchFile(long offset, const void* bytes, size_t size)
+{
+    FILE* file = fopen(RECORDING_PATH, "r+b");
+    if (!file)
+        return false;
+    fseek(file, offset, SEEK_SET);
+    bool written = fwrite(bytes, 1, size, file) == size;
+    fclose(file);
+    return written;
+}
+
+int runRecorderBench()
+{
+    int failures = 0;
+    std::vector<RecordedMessage> session = makeSession();
+
+    // Record
+    TrafficRecorder recorder;
+    if (!recorder.open(RECORDING_PATH, BENCH_CHUNK_SIZE))
+    {
+        printf("FAIL: could not create %s\n", RECORDING_PATH);
+        return 1;
+    }
+    Stopwatch appendClock;
+    for (const RecordedMessage& message : session)
+        recorder.append(message.bytes.data(), (uint32_t)message.bytes.size(), message.timestampNs);
+    double appendNs = appendClock.elapsedNs() / session.size();
+    recorder.close();
+    printf("recorded %llu messages, %llu bytes: %.1f ns/message\n", (unsigned long long)recorder.records(),
+        (unsigned long long)recorder.bytesWritten(), appendNs);
+
+    // Read back and compare
+    TrafficLogReader reader;
+    size_t mismatches = 0;
+    size_t count = 0;
+    if (reader.open(RECORDING_PATH))
+    {
+        TrafficLogRecord record;
+        while (reader.next(record))
+        {
+            if (count >= session.size() || record.timestampNs != session[count].timestampNs ||
+                record.size != session[count].bytes.size() || memcmp(record.data, session[count].bytes.data(), record.size) != 0)
+                mismatches++;
+            count++;
+        }
+    }
+    const TrafficLogStats readStats = reader.stats();
+    reader.close();
+    printf("read back %zu messages from %llu chunks, %zu mismatches\n", count, (unsigned long long)readStats.chunks, mismatches);
+    if (count != session.size() || mismatches != 0 || readStats.corruptChunks != 0 || readStats.chunks < 2)
+    {
+        printf("FAIL: recording does not read back as written\n");
+        failures++;
+    }
+
+    // Feeding the messages straight into a pipeline must print exactly what the replay prints
+    FILE* directSink = tmpfile();
+    std::string direct;
+    {
+        AsyncOutput output(directSink, 1 << 16, OVERFLOW_BLOCK);
+        TrafficPipeline pipeline(output, 32.951917, -97.264323, 3799);
+        output.start();
+        for (const RecordedMessage& message : session)
+            pipeline.onMessage(message.bytes.data(), (uint32_t)message.bytes.size());
+        output.stop();
+        direct = readAll(directSink);
+        fclose(directSink);
+    }
+
+    double seconds = 0;
+    uint64_t messages = 0;
+    std::string replayed = replay(0, seconds, messages);
+    printf("replay --max: %llu messages in %.1f ms, %.0f messages/s, output %s\n", (unsigned long long)messages,
+        seconds * 1000, messages / seconds, replayed == direct ? "identical to a direct run" : "DIFFERS from a direct run");
+    if (replayed != direct || messages != session.size())
+    {
+        printf("FAIL: replay does not reproduce the session\n");
+        failures++;
+    }
+
+    // 10x: the recording spans (SWEEPS - 1) sweep intervals, so the replay should take a tenth of that
+    double expectedSeconds = (SWEEPS - 1) * SWEEP_INTERVAL_NS * 1e-9 / 10;
+    std::string paced = replay(10, seconds, messages);
+    printf("replay --speed 10: %.1f ms (recorded span / 10 = %.1f ms), output %s\n", seconds * 1000, expectedSeconds * 1000,
+        paced == replayed ? "identical to --max" : "DIFFERS from --max");
+    if (seconds < expectedSeconds * 0.9 || seconds > expectedSeconds * 3 + 0.2)
+    {
+        printf("FAIL: paced replay does not follow the recorded timing\n");
+        failures++;
+    }
+    if (paced != replayed)
+    {
+        printf("FAIL: replay output depends on the playback speed\n");
+        failures++;
+    }
+
+    // A flipped payload byte must fail that chunk's checksum and only that chunk
+    uint8_t flipped = 0xA5;
+    patchFile(BENCH_CHUNK_SIZE + sizeof(TrafficChunkHeader) + 100, &flipped, 1);
+    TrafficLogStats corrupt = {};
+    if (reader.open(RECORDING_PATH))
+    {
+        TrafficLogRecord record;
+        while (reader.next(record)) {}
+        corrupt = reader.stats();
+        reader.close();
+    }
+    printf("corrupted chunk 1: %llu corrupt chunks, %llu of %zu messages readable\n", (unsigned long long)corrupt.corruptChunks,
+        (unsigned long long)corrupt.records, session.size());
+    if (corrupt.corruptChunks != 1 || corrupt.records == 0 || corrupt.records >= session.size())
+    {
+        printf("FAIL: checksum did not isolate the damaged chunk\n");
+        failures++;
+    }
+
+    // A recording that was never closed leaves its last chunk unsealed; it is read without verification
+    uint32_t unsealed = 0;
+    long lastChunk = (long)((readStats.chunks - 1) * BENCH_CHUNK_SIZE);
+    patchFile(lastChunk + offsetof(TrafficChunkHeader, sealed), &unsealed, sizeof(unsealed));
+    TrafficLogStats crashed = {};
+    if (reader.open(RECORDING_PATH))
+    {
+        TrafficLogRecord record;
+        while (reader.next(record)) {}
+        crashed = reader.stats();
+        reader.close();
+    }
+    printf("unsealed last chunk: %llu unsealed, %llu messages readable\n", (unsigned long long)crashed.unsealedChunks,
+        (unsigned long long)crashed.records);
+    if (crashed.unsealedChunks != 1 || crashed.records != corrupt.records)
+    {
+        printf("FAIL: unsealed chunk was not recovered\n");
+        failures++;
+    }
+
+    remove(RECORDING_PATH);
+
+    if (!checkSpeed("recorder.append", appendNs))
+        failures++;
+
+    return failures;
+}
@@ -0,0 +1,183 @@
+#include <algorithm>
+#include <stdio.h>
+#include <vector>
+
+#include "BenchCommon.h"
+#include "TrafficIndex.h"
+#include "TrafficScheduler.h"
+#include "TrafficTable.h"
+
+static const double OWN_LAT = 32.951917;
+static const double OWN_LON = -97.264323;
+static const uint32_t USER_ID = 1;
+static const size_t TIMED_AIRCRAFT = 5000;
+static const int TIMED_SWEEPS = 100;
+
+struct SweepAircraft
+{
+    uint32_t objectId;
+    double rangeNm;         // due north of the ownship
+};
+
+/**
+* A table and index fed one sweep at a time, as TrafficPipeline does, plus the user aircraft at the centre.
+*/
+class SchedulerHarness
+{
+public:
+    explicit SchedulerHarness(const TierSettings& settings) : scheduler(settings) {}
+
+    size_t sweep(const std::vector<SweepAircraft>& aircraft)
+    {
+        m_table.beginSweep();
+        update(USER_ID, OWN_LAT, OWN_LON, true);
+        for (const SweepAircraft& entry : aircraft)
+            update(entry.objectId, OWN_LAT + entry.rangeNm / 60, OWN_LON, false);
+        m_table.evictStale();
+
+        m_index.clear();
+        for (size_t slot = 0; slot < m_table.size(); slot++)
+            m_index.insert(m_table.objectIds()[slot], m_table.latitudes()[slot], m_table.longitudes()[slot], m_table.altitudes()[slot]);
+        m_index.build();
+        return scheduler.plan(m_table, m_index, OWN_LAT, OWN_LON, changes);
+    }
+
+    TrafficScheduler scheduler;
+    std::vector<TierChange> changes;
+
+private:
+    void update(uint32_t objectId, double lat, double lon, bool user)
+    {
+        AircraftState state = {};
+        state.isUser = user;
+        state.altitude = 5000;
+        state.latitude = lat;
+        state.longitude = lon;
+        m_table.update(objectId, state);
+    }
+
+    TrafficTable m_table;
+    TrafficIndex m_index;
+};
+
+int runSchedulerBench()
+{
+    int failures = 0;
+    const TierSettings settings = DEFAULT_TIER_SETTINGS;
+
+    // One aircraft flying straight in to 0.5 nm and back out again, 0.1 nm per sweep
+    SchedulerHarness radial(settings);
+    std::vector<TierChange> transitions;
+    std::vector<double> transitionRanges;
+    for (int step = 0; step <= 150; step++)
+    {
+        double rangeNm = step <= 75 ? 8 - step * 0.1 : 0.5 + (step - 75) * 0.1;
+        radial.sweep({ { 2, rangeNm } });
+        for (const TierChange& change : radial.changes)
+        {
+            transitions.push_back(change);
+            transitionRanges.push_back(rangeNm);
+        }
+    }
+    const TrafficTier expected[][2] = { { TIER_FAR, TIER_MID }, { TIER_MID, TIER_NEAR }, { TIER_NEAR, TIER_MID }, { TIER_MID, TIER_FAR } };
+    const double expectedRange[] = { settings.midNm, settings.nearNm, settings.nearNm * (1 + settings.hysteresis),
+        settings.midNm * (1 + settings.hysteresis) };
+    bool radialOk = transitions.size() == 4;
+    for (size_t i = 0; radialOk && i < 4; i++)
+    {
+        radialOk = transitions[i].from == expected[i][0] && transitions[i].to == expected[i][1] &&
+            fabs(transitionRanges[i] - expectedRange[i]) < 0.11;
+    }
+    printf("approach and departure: %zu tier changes", transitions.size());
+    for (size_t i = 0; i < transitions.size(); i++)
+        printf("%s %d->%d at %.1f nm", i == 0 ? ":" : ",", transitions[i].from, transitions[i].to, transitionRanges[i]);
+    printf("\n");
+    if (!radialOk)
+    {
+        printf("FAIL: expected FAR->MID at %.1f, MID->NEAR at %.1f, NEAR->MID at %.1f and MID->FAR at %.1f nm\n",
+            expectedRange[0], expectedRange[1], expectedRange[2], expectedRange[3]);
+        failures++;
+    }
+
+    // An aircraft wandering back and forth across the near boundary, within the hysteresis band
+    SchedulerHarness boundary(settings);
+    size_t boundaryChanges = 0;
+    for (int sweep = 0; sweep < 100; sweep++)
+        boundaryChanges += boundary.sweep({ { 2, settings.nearNm + (sweep % 2 == 0 ? -0.05 : 0.15) } });
+    printf("boundary: %zu tier changes in 100 sweeps straddling %.1f nm\n", boundaryChanges, settings.nearNm);
+    if (boundaryChanges != 1 || boundary.scheduler.tierOf(2) != TIER_NEAR)
+    {
+        printf("FAIL: an aircraft inside the hysteresis band should be promoted once and stay TIER_NEAR\n");
+        failures++;
+    }
+
+    // More close traffic than the caps allow: the closest get the per-object requests
+    SchedulerHarness crowded(settings);
+    std::vector<SweepAircraft> crowd;
+    const uint32_t CROWD = settings.maxNear + settings.maxMid + 20;
+    for (uint32_t i = 0; i < CROWD; i++)
+        crowd.push_back({ 100 + i, 0.01 + i * 0.015 });
+    std::reverse(crowd.begin(), crowd.end());
+    crowded.sweep(crowd);
+    bool capsOk = crowded.scheduler.count(TIER_NEAR) == settings.maxNear && crowded.scheduler.count(TIER_MID) == settings.maxMid &&
+        crowded.scheduler.tierOf(USER_ID) == TIER_FAR;
+    for (uint32_t i = 0; i < CROWD; i++)
+    {
+        TrafficTier wanted = i < settings.maxNear ? TIER_NEAR : (i < settings.maxNear + settings.maxMid ? TIER_MID : TIER_FAR);
+        capsOk = capsOk && crowded.scheduler.tierOf(100 + i) == wanted;
+    }
+    printf("caps: %u aircraft within %.1f nm -> %zu near, %zu mid, user aircraft %s\n", CROWD, settings.nearNm,
+        crowded.scheduler.count(TIER_NEAR), crowded.scheduler.count(TIER_MID), crowded.scheduler.tierOf(USER_ID) == TIER_FAR ? "untracked" : "tracked");
+    if (!capsOk)
+    {
+        printf("FAIL: expected the %u closest TIER_NEAR, the next %u TIER_MID, the rest and the user aircraft TIER_FAR\n",
+            settings.maxNear, settings.maxMid);
+        failures++;
+    }
+
+    // Aircraft that leave the table cancel their per-object request
+    SchedulerHarness leaving(settings);
+    leaving.sweep({ { 2, 1 }, { 3, 4 } });
+    leaving.sweep({ { 3, 4 } });
+    leaving.sweep({ { 3, 4 } });
+    size_t leftChanges = leaving.sweep({ { 3, 4 } });
+    bool leftOk = leaving.scheduler.tierOf(2) == TIER_FAR && leaving.scheduler.tierOf(3) == TIER_MID && leftChanges == 0;
+    if (!leftOk)
+    {
+        printf("FAIL: an evicted aircraft should drop to TIER_FAR once and the others keep their tier\n");
+        failures++;
+    }
+
+    // Cost of re-tiering a dense sweep
+    TrafficSample sample = makeTrafficSample(TIMED_AIRCRAFT, OWN_LAT, OWN_LON, 20, 3);
+    TrafficTable table;
+    TrafficIndex index;
+    table.beginSweep();
+    for (size_t i = 0; i < TIMED_AIRCRAFT; i++)
+    {
+        AircraftState state = {};
+        state.altitude = sample.altitude[i];
+        state.latitude = sample.latitude[i];
+        state.longitude = sample.longitude[i];
+        table.update((uint32_t)(10 + i), state);
+    }
+    for (size_t slot = 0; slot < table.size(); slot++)
+        index.insert(table.objectIds()[slot], table.latitudes()[slot], table.longitudes()[slot], table.altitudes()[slot]);
+    index.build();
+
+    TrafficScheduler scheduler(settings);
+    std::vector<TierChange> changes;
+    size_t changeTotal = 0;
+    Stopwatch planClock;
+    for (int sweep = 0; sweep < TIMED_SWEEPS; sweep++)
+        changeTotal += scheduler.plan(table, index, OWN_LAT, OWN_LON, changes);
+    double planNs = planClock.elapsedNs() / (double(TIMED_SWEEPS) * TIMED_AIRCRAFT);
+    keepResult((double)changeTotal);
+    printf("plan: %zu aircraft within 20 nm, %zu near, %zu mid, %.1f ns/aircraft\n", TIMED_AIRCRAFT, scheduler.count(TIER_NEAR),
+        scheduler.count(TIER_MID), planNs);
+
+    if (!checkSpeed("scheduler.plan", planNs))
+        failures++;
+
+    return failures;
+}
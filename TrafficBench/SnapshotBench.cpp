@@ -0,0 +1,204 @@
+#include <atomic>
+#include <stdio.h>
+#include <string.h>
+#include <thread>
+#include <vector>
+
+#include "AsyncOutput.h"
+#include "BenchCommon.h"
+#include "TrafficMessage.h"
+#include "TrafficPipeline.h"
+#include "TrafficSnapshot.h"
+
+static const char* const BENCH_SNAPSHOT_NAME = "TrafficBenchSnapshot";
+static const size_t AIRCRAFT = 5000;
+static const double RUN_SECONDS = 0.5;
+
+static double benchClock()
+{
+    return 0;
+}
+
+// The pipeline's snapshot after a sweep matches its table
+static int checkPipelineSnapshot()
+{
+    int failures = 0;
+    TrafficSample sample = makeTrafficSample(AIRCRAFT, 32.951917, -97.264323, 60, 31);
+    FILE* sink = tmpfile();
+    AsyncOutput output(sink, 1 << 16, OVERFLOW_BLOCK);
+    TrafficPipeline pipeline(output, 32.951917, -97.264323, 3799);
+    pipeline.clock = benchClock;
+    SnapshotPublisher publisher;
+    SnapshotReader reader;
+    if (!publisher.open(BENCH_SNAPSHOT_NAME, DEFAULT_SNAPSHOT_CAPACITY) || !reader.open(BENCH_SNAPSHOT_NAME))
+    {
+        printf("FAIL: could not create and open the snapshot region\n");
+        fclose(sink);
+        return 1;
+    }
+    pipeline.snapshots = &publisher;
+    output.start();
+
+    SnapshotInfo info;
+    std::vector<SnapshotAircraft> aircraft;
+    bool emptyBefore = !reader.read(info, aircraft);
+    for (size_t i = 0; i < AIRCRAFT; i++)
+    {
+        AircraftState state = {};
+        state.isUser = i == 0;
+        state.altitude = sample.altitude[i];
+        state.latitude = sample.latitude[i];
+        state.longitude = sample.longitude[i];
+        state.trueHeading = 0.5;
+        state.groundTrack = 0.5;
+        state.groundSpeed = 220;
+        pipeline.onAircraft((uint32_t)(i + 1), (uint32_t)(i + 1), (uint32_t)AIRCRAFT, state);
+    }
+    output.stop();
+    fclose(sink);
+
+    bool read = reader.read(info, aircraft);
+    size_t mismatched = 0;
+    for (const SnapshotAircraft& entry : aircraft)
+    {
+        size_t slot = pipeline.table().find(entry.objectId);
+        if (slot == TrafficTable::NOT_FOUND || entry.latitude != pipeline.table().latitudes()[slot] ||
+            entry.altitude != pipeline.table().altitudes()[slot] || (entry.isUser != 0) != (entry.objectId == 1))
+            mismatched++;
+    }
+    printf("pipeline snapshot: publish %llu, %u of %u aircraft, %zu mismatched\n", (unsigned long long)info.publish, info.count, info.total,
+        mismatched);
+    if (!emptyBefore || !read || info.count != AIRCRAFT || info.total != AIRCRAFT || mismatched != 0 || info.sweeps != 1)
+    {
+        printf("FAIL: the snapshot does not match the pipeline's table\n");
+        failures++;
+    }
+    return failures;
+}
+
+// Every field of a synthetic snapshot carries its publish number, so a torn read shows up as a mismatch
+static void fillSnapshot(SnapshotAircraft* aircraft, size_t count, uint64_t publish)
+{
+    for (size_t i = 0; i < count; i++)
+    {
+        SnapshotAircraft& entry = aircraft[i];
+        entry.objectId = (uint32_t)(i + 1);
+        entry.latitude = (double)publish;
+        entry.longitude = (double)publish;
+        entry.altitude = (double)publish;
+        entry.sampleTime = (double)publish;
+        entry.rangeNm = (double)i;
+    }
+}
+
+struct ReaderResult
+{
+    uint64_t reads;
+    uint64_t torn;
+    uint64_t retries;
+};
+
+static void readerLoop(const std::atomic<bool>* stop, ReaderResult* result)
+{
+    SnapshotReader reader;
+    if (!reader.open(BENCH_SNAPSHOT_NAME))
+        return;
+
+    while (!stop->load(std::memory_order_relaxed))
+    {
+        const SnapshotAircraft* aircraft;
+        const SnapshotInfo* info = reader.begin(aircraft);
+        if (!info)
+            continue;
+
+        // Read in place, as a map or console would while drawing
+        double expected = (double)info->publish;
+        uint32_t count = info->count;
+        bool consistent = count == AIRCRAFT;
+        for (uint32_t i = 0; i < count && i < AIRCRAFT; i++)
+            consistent &= aircraft[i].latitude == expected && aircraft[i].altitude == expected && aircraft[i].sampleTime == expected;
+        if (!reader.end())
+            continue;
+
+        result->reads++;
+        if (!consistent)
+            result->torn++;
+    }
+    result->retries = reader.retries();
+}
+
+static int runReaders(uint32_t readers, double& readNs)
+{
+    int failures = 0;
+    SnapshotPublisher publisher;
+    if (!publisher.open(BENCH_SNAPSHOT_NAME, (uint32_t)AIRCRAFT))
+    {
+        printf("FAIL: could not create the snapshot region\n");
+        return 1;
+    }
+
+    std::atomic<bool> stop(false);
+    std::vector<ReaderResult> results(readers, ReaderResult());
+    std::vector<std::thread> threads;
+    for (uint32_t i = 0; i < readers; i++)
+        threads.emplace_back(readerLoop, &stop, &results[i]);
+
+    // The writer publishes as fast as it can, far faster than the sweeps ever come, to provoke retries
+    Stopwatch clock;
+    double publishNs = 0;
+    while (clock.elapsedNs() < RUN_SECONDS * 1e9)
+    {
+        Stopwatch publishClock;
+        SnapshotAircraft* aircraft = publisher.begin();
+        fillSnapshot(aircraft, AIRCRAFT, publisher.published() + 1);
+        SnapshotInfo info = {};
+        info.count = (uint32_t)AIRCRAFT;
+        info.total = (uint32_t)AIRCRAFT;
+        publisher.publish(info);
+        publishNs += publishClock.elapsedNs();
+        std::this_thread::yield();
+    }
+    stop.store(true);
+    for (std::thread& thread : threads)
+        thread.join();
+    double seconds = clock.elapsedNs() / 1e9;
+
+    uint64_t reads = 0, torn = 0, retries = 0;
+    for (const ReaderResult& result : results)
+    {
+        reads += result.reads;
+        torn += result.torn;
+        retries += result.retries;
+    }
+    readNs = reads > 0 ? seconds * 1e9 * readers / reads : 0;
+    printf("%u reader%s  %8.0f snapshots/s each  %6.1f us/publish  %7.2f%% retried  %llu torn\n", readers, readers == 1 ? " " : "s",
+        reads / seconds / readers, publishNs / publisher.published() / 1e3, reads + retries > 0 ? 100.0 * retries / (reads + retries) : 0.0,
+        (unsigned long long)torn);
+    if (reads == 0 || torn != 0)
+    {
+        printf("FAIL: %u readers: %llu consistent reads, %llu torn\n", readers, (unsigned long long)reads, (unsigned long long)torn);
+        failures++;
+    }
+    return failures;
+}
+
+int runSnapshotBench()
+{
+    int failures = checkPipelineSnapshot();
+
+    printf("%zu aircraft (%.0f KiB per snapshot), writer publishing continuously, %u cores\n", AIRCRAFT,
+        AIRCRAFT * sizeof(SnapshotAircraft) / 1024.0, std::thread::hardware_concurrency());
+    const uint32_t readerCounts[] = { 1, 2, 4 };
+    double singleReadNs = 0;
+    for (uint32_t readers : readerCounts)
+    {
+        double readNs;
+        failures += runReaders(readers, readNs);
+        if (readers == 1)
+            singleReadNs = readNs;
+    }
+
+    if (!checkSpeed("snapshot.read", singleReadNs))
+        failures++;
+    return failures;
+}
@@ -0,0 +1,160 @@
+#include <stdio.h>
+#include <string.h>
+#include <thread>
+#include <vector>
+
+#include "AsyncOutput.h"
+#include "BenchCommon.h"
+#include "TrafficMessage.h"
+#include "TrafficPipeline.h"
+#include "TrafficStages.h"
+
+static const size_t AIRCRAFT = 5000;
+static const uint32_t SWEEPS = 20;
+static const size_t TRACKED = 50;           // per-object updates between sweeps
+static const size_t USER_ENTRY = AIRCRAFT / 2;
+
+static double benchClock()
+{
+    return 0;
+}
+
+/**
+* Sweeps with the user aircraft halfway through and moving, so batches before and after it see different
+* ownship positions, followed by a few per-object updates.
+*/
+static std::vector<std::vector<uint8_t>> makeSession()
+{
+    TrafficSample sample = makeTrafficSample(AIRCRAFT, 32.951917, -97.264323, 80, 5);
+    std::vector<std::vector<uint8_t>> session(SWEEPS);
+    for (uint32_t sweep = 0; sweep < SWEEPS; sweep++)
+    {
+        std::vector<uint8_t>& bytes = session[sweep];
+        for (size_t i = 0; i < AIRCRAFT; i++)
+        {
+            AircraftState state = {};
+            state.isUser = i == USER_ENTRY;
+            state.onGround = i % 11 == 0 && !state.isUser;
+            state.trueHeading = 0.001 * (double)i;
+            state.magHeading = state.trueHeading;
+            state.groundTrack = state.trueHeading;
+            state.altitude = sample.altitude[i];
+            state.latitude = sample.latitude[i] + sweep * (state.isUser ? 2e-3 : 1e-4);
+            state.longitude = sample.longitude[i];
+            state.groundSpeed = 250;
+            appendTrafficMessage(bytes, 0, (uint32_t)(i + 1), (uint32_t)(i + 1), (uint32_t)AIRCRAFT, state);
+        }
+        for (size_t i = 1; i <= TRACKED; i++)
+        {
+            AircraftState state = {};
+            state.altitude = sample.altitude[i];
+            state.latitude = sample.latitude[i] + sweep * 1e-4 + 5e-5;
+            state.longitude = sample.longitude[i];
+            appendTrafficMessage(bytes, TRAFFIC_RECV_ID_SIMOBJECT_DATA, 0x10000 + (uint32_t)(i + 1), TRAFFIC_DEFINITION_STATE, 9,
+                (uint32_t)(i + 1), 1, 1, &state, sizeof(state));
+        }
+    }
+    return session;
+}
+
+static std::vector<char> readAll(FILE* file)
+{
+    std::vector<char> text;
+    fflush(file);
+    rewind(file);
+    char buffer[65536];
+    size_t read;
+    while ((read = fread(buffer, 1, sizeof(buffer), file)) > 0)
+        text.insert(text.end(), buffer, buffer + read);
+    return text;
+}
+
+struct StagesRun
+{
+    double ns;              // until every message is committed
+    double wallNs;          // until the report is written as well
+    std::vector<char> report;
+    std::vector<uint32_t> titleRequests;
+    std::vector<StageStats> stats;
+};
+
+// workers 0 runs the pipeline serially on this thread
+static StagesRun runSession(const std::vector<std::vector<uint8_t>>& session, uint32_t workers)
+{
+    FILE* sink = tmpfile();
+    AsyncOutput output(sink, 1 << 16, OVERFLOW_BLOCK);
+    TrafficPipeline pipeline(output, 32.951917, -97.264323, 3799);
+    pipeline.clock = benchClock;
+    StageSettings settings = DEFAULT_STAGE_SETTINGS;
+    settings.workers = workers;
+    TrafficStages stages(pipeline, settings);
+
+    StagesRun run;
+    std::vector<uint32_t> requests;
+    output.start();
+    if (workers != 0)
+        stages.start();
+
+    Stopwatch clock;
+    for (const std::vector<uint8_t>& bytes : session)
+    {
+        for (size_t offset = 0; offset < bytes.size(); )
+        {
+            TrafficMessageHeader header;
+            memcpy(&header, &bytes[offset], sizeof(header));
+            stages.submit(&bytes[offset], header.size);
+            offset += header.size;
+        }
+        stages.flush();
+        stages.takeTitleRequests(requests);
+        run.titleRequests.insert(run.titleRequests.end(), requests.begin(), requests.end());
+    }
+    stages.stop();
+    run.ns = clock.elapsedNs();
+
+    stages.takeTitleRequests(requests);
+    run.titleRequests.insert(run.titleRequests.end(), requests.begin(), requests.end());
+    output.stop();
+    run.wallNs = clock.elapsedNs();
+    stages.stats(run.stats);
+    run.report = readAll(sink);
+    fclose(sink);
+    return run;
+}
+
+int runStagesBench()
+{
+    int failures = 0;
+    std::vector<std::vector<uint8_t>> session = makeSession();
+    double messages = double(SWEEPS) * (AIRCRAFT + TRACKED);
+
+    StagesRun serial = runSession(session, 0);
+    printf("%zu aircraft, %u sweeps, %zu tracked updates between sweeps, %u cores\n", AIRCRAFT, SWEEPS, TRACKED,
+        std::thread::hardware_concurrency());
+    printf("serial     %7.1f ns/message  %8.0f messages/s\n", serial.ns / messages, messages / (serial.ns / 1e9));
+
+    const uint32_t workerCounts[] = { 1, 2, 4 };
+    double stagedNs = 0;
+    for (uint32_t workers : workerCounts)
+    {
+        StagesRun staged = runSession(session, workers);
+        printf("%u worker%s  %7.1f ns/message  %8.0f messages/s\n", workers, workers == 1 ? " " : "s", staged.ns / messages,
+            messages / (staged.ns / 1e9));
+        if (workers == 2)
+            stagedNs = staged.ns;
+
+        if (staged.report != serial.report || staged.titleRequests != serial.titleRequests)
+        {
+            printf("FAIL: %u workers: report differs from the serial pipeline (%zu vs %zu bytes, %zu vs %zu title requests)\n", workers,
+                staged.report.size(), serial.report.size(), staged.titleRequests.size(), serial.titleRequests.size());
+            failures++;
+        }
+        if (workers == 4)
+            printStageStats(stdout, staged.stats, staged.wallNs / 1e9);
+    }
+
+    if (!checkSpeed("stages.message", stagedNs / messages))
+        failures++;
+
+    return failures;
+}
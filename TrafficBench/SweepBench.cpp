@@ -0,0 +1,210 @@
+#include <algorithm>
+#include <random>
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+#include "AsyncOutput.h"
+#include "BenchCommon.h"
+#include "SweepAssembler.h"
+#include "TrafficMessage.h"
+#include "TrafficPipeline.h"
+
+static const size_t AIRCRAFT = 500;
+static const uint32_t REQUEST = 7;
+static const size_t TIMED_ENTRIES = 5000;
+static const int TIMED_SWEEPS = 200;
+
+static double fakeNow = 0;
+
+static double fakeClock()
+{
+    return fakeNow;
+}
+
+static AircraftState makeState(const TrafficSample& sample, size_t i, bool isUser)
+{
+    AircraftState state = {};
+    state.isUser = isUser;
+    state.altitude = sample.altitude[i];
+    state.latitude = sample.latitude[i];
+    state.longitude = sample.longitude[i];
+    state.trueHeading = 0.01 * (double)i;
+    state.groundTrack = state.trueHeading;
+    state.groundSpeed = 200;
+    return state;
+}
+
+// One sweep of AIRCRAFT entries in arrival order; entry numbers follow the order unless shuffled afterwards
+static std::vector<DecodedMessage> makeSweep(const TrafficSample& sample, uint32_t requestId, size_t userEntry)
+{
+    std::vector<DecodedMessage> sweep(AIRCRAFT);
+    for (size_t i = 0; i < AIRCRAFT; i++)
+    {
+        DecodedMessage& message = sweep[i];
+        message = DecodedMessage();
+        message.kind = DECODED_SWEEP;
+        message.requestId = requestId;
+        message.objectId = (uint32_t)(i + 1);
+        message.entryNumber = (uint32_t)(i + 1);
+        message.outOf = (uint32_t)AIRCRAFT;
+        message.state = makeState(sample, i, i == userEntry);
+    }
+    return sweep;
+}
+
+static std::vector<std::string> reportLines(FILE* sink)
+{
+    std::vector<std::string> lines;
+    fflush(sink);
+    rewind(sink);
+    char line[512];
+    while (fgets(line, sizeof(line), sink))
+        lines.push_back(line);
+    return lines;
+}
+
+static bool check(bool ok, const char* what, int& failures)
+{
+    printf("%-58s %s\n", what, ok ? "ok" : "FAIL");
+    if (!ok)
+        failures++;
+    return ok;
+}
+
+// The pipeline applies nothing until the sweep is whole, however its entries arrive
+static void checkAssembly(const TrafficSample& sample, int& failures)
+{
+    FILE* sink = tmpfile();
+    AsyncOutput output(sink, 1 << 16, OVERFLOW_BLOCK);
+    TrafficPipeline pipeline(output, 32.951917, -97.264323, 3799);
+    pipeline.clock = fakeClock;
+    fakeNow = 0;
+    output.start();
+
+    std::vector<DecodedMessage> sweep = makeSweep(sample, REQUEST, 0);
+    std::mt19937 rng(3);
+    std::shuffle(sweep.begin(), sweep.end(), rng);
+    for (size_t i = 0; i + 1 < AIRCRAFT; i++)
+        pipeline.apply(sweep[i]);
+    pipeline.apply(sweep[3]);                                   // a duplicate
+    check(pipeline.table().size() == 0 && pipeline.sweeps() == 0, "shuffled sweep: nothing applied until the last entry", failures);
+    pipeline.apply(sweep[AIRCRAFT - 1]);
+    check(pipeline.table().size() == AIRCRAFT && pipeline.sweeps() == 1, "shuffled sweep: whole sweep applied at once", failures);
+    check(pipeline.assembler().dropped() == 1 && pipeline.assembler().incomplete() == 0, "duplicate entry dropped", failures);
+
+    // One entry lost: the sweep waits for the timeout, then goes through without it
+    sweep = makeSweep(sample, REQUEST, 0);
+    for (size_t i = 0; i < AIRCRAFT; i++)
+    {
+        if (i != 10)
+            pipeline.apply(sweep[i]);
+    }
+    fakeNow = pipeline.assembler().timeoutSeconds / 2;
+    bool waited = pipeline.expireSweeps() == 0 && pipeline.sweeps() == 1;
+    fakeNow = pipeline.assembler().timeoutSeconds;
+    check(waited && pipeline.expireSweeps() == 1 && pipeline.sweeps() == 2 && pipeline.assembler().incomplete() == 1,
+        "lost entry: sweep closed incomplete at the timeout", failures);
+
+    // The request's next sweep starts before this one finished: this one goes through as it is
+    sweep = makeSweep(sample, REQUEST, 0);
+    for (size_t i = 0; i + 2 < AIRCRAFT; i++)
+        pipeline.apply(sweep[i]);
+    pipeline.apply(sweep[0]);
+    check(pipeline.sweeps() == 3 && pipeline.assembler().incomplete() == 2 && pipeline.assembler().openSweeps() == 1,
+        "superseded sweep closed incomplete by the next", failures);
+    pipeline.closeSweeps();
+
+    // Two requests interleaved entry by entry
+    std::vector<DecodedMessage> first = makeSweep(sample, REQUEST, 0);
+    std::vector<DecodedMessage> second = makeSweep(sample, REQUEST + 1, AIRCRAFT);
+    uint64_t sweepsBefore = pipeline.sweeps();
+    for (size_t i = 0; i < AIRCRAFT; i++)
+    {
+        pipeline.apply(first[i]);
+        pipeline.apply(second[i]);
+    }
+    check(pipeline.sweeps() == sweepsBefore + 2 && pipeline.assembler().openSweeps() == 0 && pipeline.assembler().incomplete() == 3,
+        "interleaved requests assembled side by side", failures);
+
+    output.stop();
+    fclose(sink);
+}
+
+// Every record of a sweep is solved from the sweep's own user aircraft, wherever it falls in the sweep
+static void checkSnapshot(const TrafficSample& sample, int& failures)
+{
+    std::vector<std::string> reports[2];
+    for (int run = 0; run < 2; run++)
+    {
+        FILE* sink = tmpfile();
+        AsyncOutput output(sink, 1 << 16, OVERFLOW_BLOCK);
+        TrafficPipeline pipeline(output, 32.951917, -97.264323, 3799);
+        pipeline.clock = fakeClock;
+        fakeNow = 0;
+        output.start();
+
+        // The same sweep, arriving with the user aircraft first and then in reverse with it last
+        std::vector<DecodedMessage> sweep = makeSweep(sample, REQUEST, 0);
+        sweep[0].state.latitude += 0.2;                         // well away from where the pipeline started
+        if (run == 1)
+            std::reverse(sweep.begin(), sweep.end());
+        for (const DecodedMessage& message : sweep)
+            pipeline.apply(message);
+
+        output.stop();
+        reports[run] = reportLines(sink);
+        fclose(sink);
+        std::sort(reports[run].begin(), reports[run].end());
+    }
+    check(!reports[0].empty() && reports[0] == reports[1], "user aircraft first or last: same report", failures);
+}
+
+static double assembleNs(const TrafficSample& sample)
+{
+    std::vector<DecodedMessage> entries(TIMED_ENTRIES);
+    for (size_t i = 0; i < TIMED_ENTRIES; i++)
+    {
+        entries[i] = DecodedMessage();
+        entries[i].kind = DECODED_SWEEP;
+        entries[i].requestId = REQUEST;
+        entries[i].objectId = (uint32_t)(i + 1);
+        entries[i].entryNumber = (uint32_t)(i + 1);
+        entries[i].outOf = (uint32_t)TIMED_ENTRIES;
+        entries[i].state = makeState(sample, i % AIRCRAFT, false);
+    }
+
+    SweepAssembler assembler;
+    size_t assembled = 0;
+    Stopwatch clock;
+    for (int sweep = 0; sweep < TIMED_SWEEPS; sweep++)
+    {
+        for (const DecodedMessage& entry : entries)
+        {
+            if (assembler.add(entry, fakeClock))
+            {
+                AssembledSweep* ready = assembler.nextReady();
+                assembled += ready->entries.size();
+                assembler.release(ready);
+            }
+        }
+    }
+    double ns = clock.elapsedNs() / ((double)TIMED_SWEEPS * TIMED_ENTRIES);
+    keepResult((double)assembled);
+    return ns;
+}
+
+int runSweepBench()
+{
+    int failures = 0;
+    TrafficSample sample = makeTrafficSample(AIRCRAFT, 32.951917, -97.264323, 30, 21);
+
+    checkAssembly(sample, failures);
+    checkSnapshot(sample, failures);
+
+    double ns = assembleNs(sample);
+    printf("assembling %zu-entry sweeps: %.1f ns/entry\n", TIMED_ENTRIES, ns);
+    if (!checkSpeed("sweeps.entry", ns))
+        failures++;
+    return failures;
+}
@@ -0,0 +1,129 @@
+#include <random>
+#include <stdio.h>
+#include <string.h>
+#include <unordered_map>
+
+#include "BenchCommon.h"
+#include "TrafficTable.h"
+
+static const size_t AIRCRAFT = 5000;
+static const int SWEEPS = 200;
+static const double TURNOVER = 0.05;   // share of the traffic replaced by new ObjectIDs each sweep
+
+/**
+* One sweep's worth of records: the live ObjectIDs with positions nudged along.
+*/
+static void nextSweep(std::vector<uint32_t>& live, uint32_t& nextObjectId, std::vector<AircraftState>& records, std::mt19937_64& rng)
+{
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+    for (uint32_t& objectId : live)
+    {
+        if (unit(rng) < TURNOVER)
+            objectId = nextObjectId++;
+    }
+
+    records.resize(live.size());
+    for (size_t i = 0; i < live.size(); i++)
+    {
+        AircraftState& state = records[i];
+        state.isUser = i == 0;
+        state.onGround = live[i] % 5 == 0;
+        state.trueHeading = unit(rng) * 6.28;
+        state.magHeading = state.trueHeading;
+        state.altitude = 45000 * unit(rng);
+        state.latitude = 32.95 + live[i] * 1e-6;
+        state.longitude = -97.26 + unit(rng);
+    }
+}
+
+int runTableBench()
+{
+    int failures = 0;
+    std::mt19937_64 rng(7);
+    std::vector<uint32_t> live(AIRCRAFT);
+    uint32_t nextObjectId = 1;
+    for (uint32_t& objectId : live)
+        objectId = nextObjectId++;
+
+    TrafficTable table;
+    std::unordered_map<uint32_t, AircraftState> reference;
+    std::vector<AircraftState> records;
+    double tableNs = 0, mapNs = 0, densePassNs = 0, mapPassNs = 0;
+    double checksum = 0;
+    size_t mismatches = 0;
+
+    for (int sweep = 0; sweep < SWEEPS; sweep++)
+    {
+        nextSweep(live, nextObjectId, records, rng);
+
+        Stopwatch tableClock;
+        table.beginSweep();
+        for (size_t i = 0; i < live.size(); i++)
+        {
+            size_t slot = table.update(live[i], records[i]);
+            if (table.titleIds()[slot] == 0)
+                table.setTitle(slot, live[i] % 37 + 1);
+        }
+        table.evictStale();
+        tableNs += tableClock.elapsedNs();
+
+        // The per-message alternative: a node-based map rebuilt from each sweep
+        Stopwatch mapClock;
+        std::unordered_map<uint32_t, AircraftState> sweepMap;
+        for (size_t i = 0; i < live.size(); i++)
+            sweepMap[live[i]] = records[i];
+        reference.swap(sweepMap);
+        mapNs += mapClock.elapsedNs();
+
+        Stopwatch denseClock;
+        const double* latitudes = table.latitudes();
+        const double* altitudes = table.altitudes();
+        for (size_t slot = 0; slot < table.size(); slot++)
+            checksum += latitudes[slot] + altitudes[slot];
+        densePassNs += denseClock.elapsedNs();
+
+        Stopwatch mapPassClock;
+        for (const auto& entry : reference)
+            checksum += entry.second.latitude + entry.second.altitude;
+        mapPassNs += mapPassClock.elapsedNs();
+
+        if (table.size() != reference.size())
+            mismatches++;
+        for (const auto& entry : reference)
+        {
+            size_t slot = table.find(entry.first);
+            if (slot == TrafficTable::NOT_FOUND || table.latitudes()[slot] != entry.second.latitude ||
+                table.titleIds()[slot] != entry.first % 37 + 1 || table.lastSeen()[slot] != table.generation())
+                mismatches++;
+        }
+    }
+    keepResult(checksum);
+
+    // Entries missing a sweep are kept until they exceed maxMissedSweeps
+    table.beginSweep();
+    size_t keptOne = table.evictStale(1);
+    table.beginSweep();
+    size_t droppedAll = table.evictStale(1);
+
+    double recordCount = double(SWEEPS) * AIRCRAFT;
+    printf("%zu aircraft, %d sweeps, %.0f%% turnover per sweep: %llu inserted, %llu evicted\n", AIRCRAFT, SWEEPS,
+        TURNOVER * 100, (unsigned long long)table.inserted(), (unsigned long long)table.evicted());
+    printf("update   table %6.1f ns/record  unordered_map %6.1f ns/record\n", tableNs / recordCount, mapNs / recordCount);
+    printf("scan     table %6.2f ns/record  unordered_map %6.2f ns/record\n", densePassNs / recordCount, mapPassNs / recordCount);
+
+    if (mismatches != 0)
+    {
+        printf("FAIL: table disagrees with the reference map in %zu lookups\n", mismatches);
+        failures++;
+    }
+    if (keptOne != 0 || droppedAll != AIRCRAFT || table.size() != 0 || table.find(live[0]) != TrafficTable::NOT_FOUND)
+    {
+        printf("FAIL: stale eviction kept %zu / removed %zu, expected 0 / %zu\n", keptOne, droppedAll, AIRCRAFT);
+        failures++;
+    }
+
+    if (!checkSpeed("table.update", tableNs / recordCount))
+        failures++;
+
+    return failures;
+}
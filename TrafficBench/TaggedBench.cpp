@@ -0,0 +1,255 @@
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+
+#include "AsyncOutput.h"
+#include "BenchCommon.h"
+#include "DecodedMessage.h"
+#include "TrafficMessage.h"
+#include "TrafficPipeline.h"
+
+static const size_t AIRCRAFT = 400;
+static const uint32_t TRACKED_REQUEST = 0x10000;
+static const int ROUNDS = 50;
+static const double PARKED_SHARE = 0.6;         // a busy airport: most of the close traffic is at the gate
+
+static double benchClock()
+{
+    return 0;
+}
+
+static std::vector<AircraftState> makeStates(const TrafficSample& sample)
+{
+    std::vector<AircraftState> states(AIRCRAFT);
+    for (size_t i = 0; i < AIRCRAFT; i++)
+    {
+        AircraftState& state = states[i];
+        state = AircraftState();
+        state.isUser = i == 0;
+        state.onGround = i > 0 && i < AIRCRAFT * PARKED_SHARE;
+        state.trueHeading = 0.01 * (double)i;
+        state.magHeading = state.trueHeading - 0.06;
+        state.altitude = state.onGround ? 600 : sample.altitude[i];
+        state.latitude = sample.latitude[i];
+        state.longitude = sample.longitude[i];
+        state.groundSpeed = state.onGround ? 0 : 250;
+        state.verticalSpeed = i % 2 ? 1500 : 0;
+        state.groundTrack = state.trueHeading;
+    }
+    return states;
+}
+
+// One round of movement: parked aircraft stay put, the rest move, climbers climb and every fourth one turns
+static void advance(std::vector<AircraftState>& states, int round)
+{
+    for (size_t i = 1; i < AIRCRAFT; i++)
+    {
+        AircraftState& state = states[i];
+        if (state.onGround)
+            continue;
+        state.latitude += 0.0005;
+        state.longitude -= 0.0003;
+        if (state.verticalSpeed != 0)
+            state.altitude += 25;
+        if (i % 4 == 0)
+        {
+            state.trueHeading += 0.05;
+            state.magHeading += 0.05;
+            state.groundTrack += 0.05;
+        }
+        if (round == ROUNDS / 2 && i % 10 == 0)
+            state.verticalSpeed = 0;        // levelling off: one field changes on its own
+    }
+}
+
+static uint32_t changedFields(const AircraftState& before, const AircraftState& after)
+{
+    uint32_t fields = 0;
+    for (uint32_t field = 0; field < STATE_FIELD_COUNT; field++)
+    {
+        if (memcmp((const char*)&before + field * sizeof(double), (const char*)&after + field * sizeof(double), sizeof(double)) != 0)
+            fields |= 1u << field;
+    }
+    return fields;
+}
+
+static bool sameTable(const TrafficTable& a, const TrafficTable& b)
+{
+    if (a.size() != b.size())
+        return false;
+    for (size_t slot = 0; slot < a.size(); slot++)
+    {
+        size_t other = b.find(a.objectIds()[slot]);
+        if (other == TrafficTable::NOT_FOUND)
+            return false;
+        AircraftState left = a.state(slot);
+        AircraftState right = b.state(other);
+        if (memcmp(&left, &right, sizeof(left)) != 0)
+            return false;
+    }
+    return true;
+}
+
+// The same movement sent as full records and as tagged changes ends in the same table, for far fewer bytes
+static int checkMerge(const TrafficSample& sample, std::vector<uint8_t>& taggedStream)
+{
+    int failures = 0;
+    FILE* sinks[2] = { tmpfile(), tmpfile() };
+    AsyncOutput fullOutput(sinks[0], 1 << 16, OVERFLOW_BLOCK);
+    AsyncOutput taggedOutput(sinks[1], 1 << 16, OVERFLOW_BLOCK);
+    TrafficPipeline full(fullOutput, 32.951917, -97.264323, 3799);
+    TrafficPipeline tagged(taggedOutput, 32.951917, -97.264323, 3799);
+    full.clock = benchClock;
+    tagged.clock = benchClock;
+    fullOutput.start();
+    taggedOutput.start();
+
+    std::vector<AircraftState> states = makeStates(sample);
+    for (size_t i = 0; i < AIRCRAFT; i++)
+    {
+        full.onAircraft((uint32_t)(i + 1), (uint32_t)(i + 1), (uint32_t)AIRCRAFT, states[i]);
+        tagged.onAircraft((uint32_t)(i + 1), (uint32_t)(i + 1), (uint32_t)AIRCRAFT, states[i]);
+    }
+
+    std::vector<uint8_t> fullStream;
+    taggedStream.clear();
+    size_t fullMessages = 0, taggedMessages = 0;
+    for (int round = 0; round < ROUNDS; round++)
+    {
+        std::vector<AircraftState> before = states;
+        advance(states, round);
+        for (size_t i = 1; i < AIRCRAFT; i++)
+        {
+            uint32_t objectId = (uint32_t)(i + 1);
+            appendTrafficMessage(fullStream, TRAFFIC_RECV_ID_SIMOBJECT_DATA, TRACKED_REQUEST + objectId, TRAFFIC_DEFINITION_STATE, STATE_FIELD_COUNT,
+                objectId, 1, 1, &states[i], sizeof(states[i]));
+            fullMessages++;
+
+            // The first update of a changed-only request carries every field; after that, only what changed
+            uint32_t fields = round == 0 ? STATE_ALL_FIELDS : changedFields(before[i], states[i]);
+            if (fields == 0)
+                continue;
+            appendTaggedStateMessage(taggedStream, TRACKED_REQUEST + objectId, objectId, states[i], fields, TRAFFIC_DEFINITION_STATE);
+            taggedMessages++;
+        }
+    }
+
+    const std::vector<uint8_t>* streams[2] = { &fullStream, &taggedStream };
+    TrafficPipeline* pipelines[2] = { &full, &tagged };
+    for (int i = 0; i < 2; i++)
+    {
+        size_t offset = 0;
+        while (offset < streams[i]->size())
+        {
+            TrafficMessageHeader header;
+            memcpy(&header, &(*streams[i])[offset], sizeof(header));
+            pipelines[i]->onMessage(&(*streams[i])[offset], header.size);
+            offset += header.size;
+        }
+    }
+    fullOutput.stop();
+    taggedOutput.stop();
+    fclose(sinks[0]);
+    fclose(sinks[1]);
+
+    printf("%d rounds of %zu tracked aircraft (%.0f%% parked): full %zu messages, %zu bytes; changed only %zu messages, %zu bytes (%.1fx fewer)\n",
+        ROUNDS, AIRCRAFT - 1, PARKED_SHARE * 100, fullMessages, fullStream.size(), taggedMessages, taggedStream.size(),
+        taggedStream.empty() ? 0.0 : (double)fullStream.size() / taggedStream.size());
+    if (!sameTable(full.table(), tagged.table()) || tagged.partialRecords() + AIRCRAFT - 1 != taggedMessages || tagged.partialDropped() != 0)
+    {
+        printf("FAIL: tagged updates did not merge into the same table as full ones\n");
+        failures++;
+    }
+    return failures;
+}
+
+// Tagged records whose counts or DatumIDs do not fit are rejected, and changes for unknown aircraft dropped
+static int checkMalformed()
+{
+    int failures = 0;
+    AircraftState state = {};
+    state.latitude = 33;
+    std::vector<uint8_t> message;
+    appendTaggedStateMessage(message, TRACKED_REQUEST + 5, 5, state, 1u << STATE_LATITUDE, TRAFFIC_DEFINITION_STATE);
+
+    DecodedMessage decoded;
+    bool good = decodeTrafficMessage(message.data(), (uint32_t)message.size(), decoded) && decoded.kind == DECODED_TRACKED &&
+        decoded.fields == (1u << STATE_LATITUDE) && decoded.state.latitude == 33;
+
+    std::vector<uint8_t> truncated(message.begin(), message.end() - 1);
+    bool rejectsTruncated = !decodeTrafficMessage(truncated.data(), (uint32_t)truncated.size(), decoded);
+
+    std::vector<uint8_t> overCount = message;
+    uint32_t count = 2;
+    memcpy(&overCount[offsetof(TrafficMessageHeader, defineCount)], &count, sizeof(count));
+    bool rejectsCount = !decodeTrafficMessage(overCount.data(), (uint32_t)overCount.size(), decoded);
+
+    std::vector<uint8_t> badField = message;
+    uint32_t field = STATE_FIELD_COUNT;
+    memcpy(&badField[sizeof(TrafficMessageHeader)], &field, sizeof(field));
+    bool rejectsField = !decodeTrafficMessage(badField.data(), (uint32_t)badField.size(), decoded);
+
+    FILE* sink = tmpfile();
+    AsyncOutput output(sink, 1 << 16, OVERFLOW_BLOCK);
+    TrafficPipeline pipeline(output, 32.951917, -97.264323, 3799);
+    pipeline.clock = benchClock;
+    output.start();
+    pipeline.onMessage(message.data(), (uint32_t)message.size());
+    bool dropped = pipeline.partialDropped() == 1 && pipeline.table().size() == 0;
+    output.stop();
+    fclose(sink);
+
+    printf("malformed tagged records: decode %s, truncated %s, count %s, DatumID %s, unknown aircraft %s\n", good ? "ok" : "FAIL",
+        rejectsTruncated ? "rejected" : "ACCEPTED", rejectsCount ? "rejected" : "ACCEPTED", rejectsField ? "rejected" : "ACCEPTED",
+        dropped ? "dropped" : "APPLIED");
+    if (!good || !rejectsTruncated || !rejectsCount || !rejectsField || !dropped)
+    {
+        printf("FAIL: tagged record validation\n");
+        failures++;
+    }
+    return failures;
+}
+
+// Decode and merge cost of one tagged record
+static double applyNs(const TrafficSample& sample, const std::vector<uint8_t>& stream)
+{
+    FILE* sink = tmpfile();
+    AsyncOutput output(sink, 1 << 16, OVERFLOW_BLOCK);
+    TrafficPipeline pipeline(output, 32.951917, -97.264323, 3799);
+    pipeline.clock = benchClock;
+    output.start();
+    std::vector<AircraftState> states = makeStates(sample);
+    for (size_t i = 0; i < AIRCRAFT; i++)
+        pipeline.onAircraft((uint32_t)(i + 1), (uint32_t)(i + 1), (uint32_t)AIRCRAFT, states[i]);
+
+    size_t messages = 0;
+    Stopwatch clock;
+    size_t offset = 0;
+    while (offset < stream.size())
+    {
+        TrafficMessageHeader header;
+        memcpy(&header, &stream[offset], sizeof(header));
+        pipeline.onMessage(&stream[offset], header.size);
+        offset += header.size;
+        messages++;
+    }
+    double ns = clock.elapsedNs() / (messages > 0 ? messages : 1);
+    output.stop();
+    fclose(sink);
+    keepResult((double)pipeline.partialRecords());
+    return ns;
+}
+
+int runTaggedBench()
+{
+    TrafficSample sample = makeTrafficSample(AIRCRAFT, 32.951917, -97.264323, 5, 41);
+    std::vector<uint8_t> taggedStream;
+    int failures = checkMerge(sample, taggedStream);
+    failures += checkMalformed();
+
+    double ns = applyNs(sample, taggedStream);
+    printf("tagged record decode and merge: %.1f ns/record\n", ns);
+    if (!checkSpeed("tagged.apply", ns))
+        failures++;
+    return failures;
+}
@@ -0,0 +1,145 @@
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+
+#include "AsyncOutput.h"
+#include "BenchCommon.h"
+#include "TrafficMessage.h"
+#include "TrafficPipeline.h"
+
+static const size_t AIRCRAFT = 2000;
+static const uint32_t SWEEPS = 20;
+
+static const char* const LIVERIES[] = {
+    "Boeing 737-800 Paint1", "Boeing 737-800 Paint3", "Airbus A321 Paint2", "Boeing 777-300ER Paint1",
+    "Bombardier CRJ700 Paint4", "Embraer E175 Paint2", "Beechcraft King Air 350 Paint1", "Cessna Skyhawk 172SP Paint2",
+    "Airbus A320 Paint1", "Boeing 787-9 Paint2", "De Havilland Dash 8 Q400 Paint1", "Boeing 747-400 Paint3", "Mooney Bravo",
+};
+static const size_t LIVERY_COUNT = sizeof(LIVERIES) / sizeof(LIVERIES[0]);
+
+static AircraftInfo makeAircraft(const TrafficSample& sample, size_t i, uint32_t sweep)
+{
+    AircraftInfo aircraft = {};
+    snprintf(aircraft.title, sizeof(aircraft.title), "%s", LIVERIES[i % LIVERY_COUNT]);
+    aircraft.isUser = i == 0;
+    aircraft.onGround = i % 11 == 0 && i != 0;
+    aircraft.trueHeading = 0.003 * (double)i;
+    aircraft.magHeading = aircraft.trueHeading;
+    aircraft.altitude = sample.altitude[i];
+    aircraft.latitude = sample.latitude[i] + sweep * 1e-4;
+    aircraft.longitude = sample.longitude[i];
+    return aircraft;
+}
+
+int runTitleBench()
+{
+    int failures = 0;
+    TrafficSample sample = makeTrafficSample(AIRCRAFT, 32.951917, -97.264323, 60, 11);
+
+    FILE* combinedSink = tmpfile();
+    FILE* splitSink = tmpfile();
+    AsyncOutput combinedOutput(combinedSink, 1 << 16, OVERFLOW_BLOCK);
+    AsyncOutput splitOutput(splitSink, 1 << 16, OVERFLOW_BLOCK);
+    TrafficPipeline combined(combinedOutput, 32.951917, -97.264323, 3799);
+    TrafficPipeline split(splitOutput, 32.951917, -97.264323, 3799);
+    combinedOutput.start();
+    splitOutput.start();
+
+    std::vector<uint8_t> combinedSweep, splitSweep, titleReplies;
+    std::vector<uint32_t> requests;
+    size_t combinedBytes = 0, splitBytes = 0, titleBytes = 0, titleRequests = 0, lateRequests = 0;
+    double combinedNs = 0, splitNs = 0;
+    for (uint32_t sweep = 0; sweep < SWEEPS; sweep++)
+    {
+        combinedSweep.clear();
+        splitSweep.clear();
+        for (size_t i = 0; i < AIRCRAFT; i++)
+        {
+            AircraftInfo aircraft = makeAircraft(sample, i, sweep);
+            appendTrafficMessage(combinedSweep, 0, (uint32_t)(i + 1), (uint32_t)(i + 1), (uint32_t)AIRCRAFT, aircraft);
+            appendTrafficMessage(splitSweep, 0, (uint32_t)(i + 1), (uint32_t)(i + 1), (uint32_t)AIRCRAFT, packState(stateOf(aircraft)));
+        }
+        combinedBytes += combinedSweep.size();
+        splitBytes += splitSweep.size();
+
+        // Same work per message on both sides: parse, table update, output record
+        auto feed = [](TrafficPipeline& pipeline, const std::vector<uint8_t>& bytes) {
+            Stopwatch clock;
+            for (size_t offset = 0; offset < bytes.size(); )
+            {
+                TrafficMessageHeader header;
+                memcpy(&header, &bytes[offset], sizeof(header));
+                pipeline.onMessage(&bytes[offset], header.size);
+                offset += header.size;
+            }
+            return clock.elapsedNs();
+        };
+        combinedNs += feed(combined, combinedSweep);
+        splitNs += feed(split, splitSweep);
+
+        // Answer the title requests the way the simulator would, before the next sweep
+        split.takeTitleRequests(requests);
+        titleRequests += requests.size();
+        if (sweep > 0)
+            lateRequests += requests.size();
+        titleReplies.clear();
+        for (uint32_t objectId : requests)
+        {
+            AircraftTitle title = {};
+            snprintf(title.title, sizeof(title.title), "%s", LIVERIES[(objectId - 1) % LIVERY_COUNT]);
+            appendTitleMessage(titleReplies, 1, objectId, title);
+        }
+        titleBytes += titleReplies.size();
+        feed(split, titleReplies);
+    }
+
+    // A late answer for an aircraft that has already left is ignored
+    AircraftTitle gone = {};
+    snprintf(gone.title, sizeof(gone.title), "Departed");
+    split.onTitle((uint32_t)AIRCRAFT + 100, gone);
+
+    combinedOutput.stop();
+    splitOutput.stop();
+    fclose(combinedSink);
+    fclose(splitSink);
+
+    size_t mismatches = 0;
+    const TrafficTable& table = split.table();
+    for (size_t slot = 0; slot < table.size(); slot++)
+    {
+        uint32_t objectId = table.objectIds()[slot];
+        size_t reference = combined.table().find(objectId);
+        if (reference == TrafficTable::NOT_FOUND ||
+            split.titles().title(table.titleIds()[slot]) != combined.titles().title(combined.table().titleIds()[reference]) ||
+            split.titles().title(table.titleIds()[slot]) != LIVERIES[(objectId - 1) % LIVERY_COUNT])
+            mismatches++;
+    }
+
+    printf("%zu aircraft, %u sweeps\n", AIRCRAFT, SWEEPS);
+    printf("combined definition  %8.1f KiB/sweep                          %6.1f ns/message\n",
+        combinedBytes / 1024.0 / SWEEPS, combinedNs / (SWEEPS * AIRCRAFT));
+    printf("state + title once   %8.1f KiB/sweep (+ %.1f KiB of titles once) %6.1f ns/message  %.0f%% less per sweep\n",
+        splitBytes / 1024.0 / SWEEPS, titleBytes / 1024.0, splitNs / (SWEEPS * AIRCRAFT), 100.0 * (1 - (double)splitBytes / combinedBytes));
+    printf("%zu title requests, %zu distinct titles interned, %zu wrong titles\n", titleRequests, split.titles().size() - 1, mismatches);
+
+    if (titleRequests != AIRCRAFT || lateRequests != 0)
+    {
+        printf("FAIL: expected one title request per ObjectID, got %zu (%zu after the first sweep)\n", titleRequests, lateRequests);
+        failures++;
+    }
+    if (mismatches != 0 || table.size() != AIRCRAFT || split.titles().size() != LIVERY_COUNT + 1)
+    {
+        printf("FAIL: interned titles do not match the combined definition\n");
+        failures++;
+    }
+    if (splitBytes * 3 > combinedBytes)
+    {
+        printf("FAIL: a state-only sweep should be under a third of the combined sweep\n");
+        failures++;
+    }
+
+    if (!checkSpeed("pipeline.state", splitNs / (SWEEPS * AIRCRAFT)))
+        failures++;
+
+    return failures;
+}
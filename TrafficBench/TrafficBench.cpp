@@ -0,0 +1,98 @@
+// TrafficBench.cpp : Micro-benchmarks for the P3DNearbyAircraft traffic path.
+//
+// Everything benchmarked here is plain C++20 without SimConnect, so it also builds on Linux:
+//   g++ -std=c++20 -O2 -mavx2 -I../P3DNearbyAircraft -o TrafficBench *.cpp ../P3DNearbyAircraft/{Utilities,GeoBatch,ReferenceFrame,TrafficIndex,ReceiveEngine,MockTransport,TrafficTable,AsyncOutput,TrafficPipeline,TitleTable,DeadReckoning,TrafficScheduler,TrafficStages,TrafficLog,TrafficRecorder,ReplayTransport,ConflictDetector,LatencyHistogram,TrafficMetrics,DecodedMessage,SweepAssembler,TrafficSnapshot,TrafficClient,TrafficAggregator}.cpp
+//
+// Usage: TrafficBench [options] [suite ...]    (no suites runs every suite)
+//   --baseline <file>          fail when a timing is slower than recorded in <file>
+//   --write-baseline <file>    record this run's timings to <file>
+//   --speed-tolerance <ratio>  allowed slowdown against the baseline (default 0.25)
+//
+// The exit code is non-zero when any accuracy or speed check fails, so it can gate changes to the math.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "BenchCommon.h"
+
+static const BenchSuite suites[] = {
+    { "frame", "Ownship ENU frame vs haversine range/bearing", runFrameBench },
+    { "geodesy", "Geodesy cost and accuracy against a long double reference", runGeodesyBench },
+    { "index", "Spatial grid index queries vs linear scan", runIndexBench },
+    { "receive", "Event-driven receive latency vs a sleep poll loop", runReceiveBench },
+    { "table", "Persistent ObjectID traffic table vs a per-sweep map", runTableBench },
+    { "output", "Async ring buffer output vs printf on the dispatch thread", runOutputBench },
+    { "recorder", "Traffic recording round trip and replay through the pipeline", runRecorderBench },
+    { "titles", "Per-sweep state definition with interned titles vs the combined definition", runTitleBench },
+    { "predict", "Dead reckoning between sweeps vs holding the last sample", runPredictBench },
+    { "tiers", "Range-tiered per-object scheduling: transitions, hysteresis and caps", runSchedulerBench },
+    { "stages", "Threaded receive/compute/commit stages vs the serial pipeline", runStagesBench },
+    { "conflicts", "Grid-pruned closest-point-of-approach conflict probe vs every pair", runConflictBench },
+    { "metrics", "Latency histogram accuracy and cost, and metrics from a staged session", runMetricsBench },
+    { "sweeps", "Sweep assembly from entry numbers: order, duplicates, timeouts and one ownship per sweep", runSweepBench },
+    { "snapshot", "Shared memory traffic snapshots: pipeline contents and multi-reader throughput", runSnapshotBench },
+    { "tagged", "Changed-only tagged per-object updates: merge into the table, validation and bytes saved", runTaggedBench },
+    { "ownship", "Per-frame ownship channel: latest-value cell consistency and sweeps solved from the freshest ownship", runOwnshipBench },
+    { "records", "Packed state definition generated from its description: decode, tagged widths and bytes saved", runRecordBench },
+    { "client", "Request client: concurrent sweeps and subscriptions correlated by request ID, run from the dispatch loop", runClientBench },
+    { "aggregate", "Aggregator: several simulator nodes merged into one table without duplicates or waiting on a stalled node", runAggregateBench },
+};
+
+int main(int argc, char* argv[])
+{
+    int failures = 0;
+    int ran = 0;
+    std::vector<const char*> selectedNames;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--baseline") == 0 && i + 1 < argc)
+            benchOptions.baselinePath = argv[++i];
+        else if (strcmp(argv[i], "--write-baseline") == 0 && i + 1 < argc)
+            benchOptions.writeBaselinePath = argv[++i];
+        else if (strcmp(argv[i], "--speed-tolerance") == 0 && i + 1 < argc)
+            benchOptions.speedTolerance = atof(argv[++i]);
+        else
+            selectedNames.push_back(argv[i]);
+    }
+
+    if (benchOptions.baselinePath && !loadSpeedBaseline(benchOptions.baselinePath))
+    {
+        printf("Could not read baseline %s\n", benchOptions.baselinePath);
+        return 2;
+    }
+
+    for (const BenchSuite& suite : suites)
+    {
+        bool selected = selectedNames.empty();
+        for (const char* name : selectedNames)
+        {
+            if (strcmp(name, suite.name) == 0)
+                selected = true;
+        }
+        if (!selected)
+            continue;
+
+        printf("\n=== %s: %s ===\n", suite.name, suite.description);
+        failures += suite.run();
+        ran++;
+    }
+
+    if (ran == 0)
+    {
+        printf("Unknown suite. Available suites:\n");
+        for (const BenchSuite& suite : suites)
+            printf("  %-10s %s\n", suite.name, suite.description);
+        return 2;
+    }
+
+    if (benchOptions.writeBaselinePath && !writeSpeedBaseline(benchOptions.writeBaselinePath))
+    {
+        printf("Could not write baseline %s\n", benchOptions.writeBaselinePath);
+        failures++;
+    }
+
+    printf("\n%d suite(s) run, %d failure(s)\n", ran, failures);
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,472 @@
+// TrafficLoad.cpp : Drives the traffic pipeline with synthetic traffic from the SimConnect stand-in.
+//
+// Talks to SimConnect exactly as NearbyAircraft does, but links the stand-in instead of the SDK, so it
+// builds and runs on Linux:
+//   g++ -std=c++20 -O2 -I../SimConnectStandIn -I../P3DNearbyAircraft -o TrafficLoad TrafficLoad.cpp ../SimConnectStandIn/SimConnectStandIn.cpp ../P3DNearbyAircraft/{Utilities,ReferenceFrame,TrafficIndex,TrafficTable,AsyncOutput,TrafficPipeline,TitleTable,DeadReckoning,TrafficScheduler,TrafficStages,ConflictDetector,LatencyHistogram,TrafficMetrics,DecodedMessage,SweepAssembler,TrafficSnapshot,TrafficClient,TrafficAggregator}.cpp -lpthread
+//
+// Usage: TrafficLoad [options]
+//   --density <x>      traffic as a multiple of a busy real terminal area (default 10)
+//   --aircraft <n>     AI aircraft, overriding --density
+//   --radius <nm>      request radius around the user aircraft (default 100)
+//   --parked <share>   fraction of the AI aircraft parked on the ground, as around a busy airport (default 0.1)
+//   --sweeps <n>       sim seconds to run, one wide sweep each (default 50)
+//   --tiers            wide sweeps only every farSweepMs; close traffic is tracked per object (TrafficScheduler)
+//   --workers <n>      compute threads of the staged pipeline (default: one per spare core)
+//   --serial           run the pipeline on the dispatch thread instead of in stages
+//   --updates <mode>   per-object requests send only changed fields ("changed", the default) or every field ("full")
+//   --epsilon <scale>  multiply the change thresholds of DEFAULT_STATE_EPSILONS (default 1)
+//   --probes <n>       also make n sweeps of other radii every sim second, all in flight at once, through TrafficClient
+//   --sources <n>      instead, merge n simulators of one shared world through TrafficAggregator, each on its own thread
+//   --slow <ms>        with --sources: the last simulator takes this much longer over every poll
+//   --report           print the traffic report instead of discarding it
+
+#include <algorithm>
+#include <chrono>
+#include <memory>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "SimConnect.h"
+#include "SimConnectDefinition.h"
+#include "SimConnectRequests.h"
+#include "SimConnectSource.h"
+#include "SimConnectStandIn.h"
+#include "AsyncOutput.h"
+#include "TrafficAggregator.h"
+#include "TrafficClient.h"
+#include "TrafficMessage.h"
+#include "TrafficPipeline.h"
+#include "TrafficStages.h"
+#include "TrafficMetrics.h"
+#include "Utilities.h"
+
+// A busy hub with AI traffic at 100% shows on the order of this many aircraft within 100 nm
+static const uint32_t REAL_TRAFFIC_AIRCRAFT = 150;
+
+// Aggregated simulators run on the wall clock, this many times faster, with a sweep every sim second
+static const double AGGREGATE_TIME_SCALE = 10;
+static const uint32_t NODE_OBJECT_ID_SPACING = 1000000;
+
+#ifdef _WIN32
+static const char* NULL_DEVICE = "NUL";
+#else
+static const char* NULL_DEVICE = "/dev/null";
+#endif
+
+enum DATA_DEFINE_ID {
+    DEFINITION_AIRCRAFT_STATE = TRAFFIC_DEFINITION_PACKED_STATE,
+    DEFINITION_AIRCRAFT_TITLE = TRAFFIC_DEFINITION_TITLE,
+    DEFINITION_OWNSHIP = TRAFFIC_DEFINITION_OWNSHIP,
+};
+
+enum DATA_REQUEST_ID {
+    REQUEST_LOCAL_AIRCRAFT,
+    REQUEST_AIRCRAFT_TITLE,
+    REQUEST_OWNSHIP,
+    REQUEST_TRACKED_AIRCRAFT = 0x10000,     // + ObjectID, as in NearbyAircraft
+};
+
+struct LoadState
+{
+    TrafficStages* stages;
+    TrafficClient* client;
+    bool opened;
+    bool quit;
+    uint64_t exceptions;
+};
+
+static void CALLBACK loadDispatchProc(SIMCONNECT_RECV* pData, DWORD cbData, void* pContext)
+{
+    LoadState* state = (LoadState*)pContext;
+    switch (pData->dwID)
+    {
+    case SIMCONNECT_RECV_ID_SIMOBJECT_DATA_BYTYPE:
+    case SIMCONNECT_RECV_ID_SIMOBJECT_DATA:
+        if (!state->client->onMessage(pData, cbData))
+            state->stages->submit(pData, cbData);
+        break;
+    case SIMCONNECT_RECV_ID_OPEN:
+        state->opened = true;
+        break;
+    case SIMCONNECT_RECV_ID_QUIT:
+        state->quit = true;
+        break;
+    case SIMCONNECT_RECV_ID_EXCEPTION:
+        state->exceptions++;
+        break;
+    default:
+        break;
+    }
+}
+
+struct ProbeTotals
+{
+    uint64_t sweeps;
+    uint64_t entries;
+};
+
+static void onProbeSweep(RequestHandle, const AssembledSweep& sweep, void* context)
+{
+    ProbeTotals* totals = (ProbeTotals*)context;
+    totals->sweeps++;
+    totals->entries += sweep.entries.size();
+}
+
+static double loadClock()
+{
+    return monotonicNs() / 1e9;
+}
+
+static double percentile(std::vector<double> values, double fraction)
+{
+    if (values.empty())
+        return 0;
+    std::sort(values.begin(), values.end());
+    return values[(size_t)(fraction * (values.size() - 1))];
+}
+
+/**
+* A source that is slow to answer, as a simulator on a loaded or distant machine is.
+*/
+class SlowSource : public TrafficSource
+{
+public:
+    SlowSource(TrafficSource& source, uint32_t delayMs)
+        : m_source(source)
+        , m_delayMs(delayMs)
+    {
+    }
+
+    bool poll(uint32_t timeoutMs, MessageHandler handler, void* context) override
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(m_delayMs));
+        return m_source.poll(timeoutMs, handler, context);
+    }
+
+    void requestIdentity(uint32_t objectId) override
+    {
+        m_source.requestIdentity(objectId);
+    }
+
+private:
+    TrafficSource& m_source;
+    uint32_t m_delayMs;
+};
+
+// Every node holds the same world under its own ObjectIDs, so each aircraft should come out of the merge once
+static int runAggregation(StandInSettings settings, int sources, int sweeps, double radiusNm, uint32_t slowMs)
+{
+    settings.timeScale = AGGREGATE_TIME_SCALE;
+    std::vector<HANDLE> connections;
+    std::vector<std::unique_ptr<SimConnectSource>> nodes;
+    for (int i = 0; i < sources; i++)
+    {
+        settings.firstObjectId = 2 + i * NODE_OBJECT_ID_SPACING;
+        configureStandIn(settings);
+        HANDLE hSimConnect = NULL;
+        if (FAILED(SimConnect_Open(&hSimConnect, "Traffic Load", NULL, 0, NULL, i)))
+        {
+            printf("Could not open the stand-in\n");
+            return 1;
+        }
+        connections.push_back(hSimConnect);
+        nodes.emplace_back(new SimConnectSource(hSimConnect, NULL, (uint32_t)nmToMeters(radiusNm), 1 / AGGREGATE_TIME_SCALE));
+    }
+    SlowSource slow(*nodes.back(), slowMs);
+
+    TrafficAggregator aggregator;
+    aggregator.clock = loadClock;
+    for (int i = 0; i < sources; i++)
+    {
+        if (slowMs > 0 && i == sources - 1)
+            aggregator.addSource(slow);
+        else
+            aggregator.addSource(*nodes[i]);
+    }
+
+    // Merge as often as a sweep arrives, and time it: a slow node must not show up here
+    aggregator.start();
+    std::vector<double> mergeUs;
+    uint64_t merged = 0;
+    auto start = std::chrono::steady_clock::now();
+    auto period = std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(1 / AGGREGATE_TIME_SCALE));
+    for (int sweep = 0; sweep < sweeps; sweep++)
+    {
+        std::this_thread::sleep_until(start + period * (sweep + 1));
+        uint64_t mergeStart = monotonicNs();
+        merged += aggregator.merge(loadClock());
+        mergeUs.push_back((monotonicNs() - mergeStart) / 1e3);
+    }
+    aggregator.stop();
+    aggregator.merge(loadClock());
+
+    size_t shared = 0;
+    std::vector<std::string> atcIds;
+    for (const AggregatedAircraft& aircraft : aggregator.aircraft())
+    {
+        if ((aircraft.sources & (aircraft.sources - 1)) != 0)
+            shared++;
+        atcIds.push_back(aircraft.identity.atcId);
+    }
+    std::sort(atcIds.begin(), atcIds.end());
+    size_t duplicates = atcIds.size() - (std::unique(atcIds.begin(), atcIds.end()) - atcIds.begin());
+
+    fprintf(stderr, "\n%d simulators of %u AI aircraft within %.0f nm, %d sweeps each at %.0fx%s\n", sources, settings.aircraft, radiusNm,
+        sweeps, AGGREGATE_TIME_SCALE, slowMs > 0 ? ", the last one slow" : "");
+    for (int i = 0; i < sources; i++)
+    {
+        SourceStats stats = aggregator.sourceStats(i);
+        fprintf(stderr, "source %d: %llu polls, %llu messages, %llu records, %llu identities, %llu dropped, %zu aircraft%s\n", i,
+            (unsigned long long)stats.polls, (unsigned long long)stats.messages, (unsigned long long)stats.records,
+            (unsigned long long)stats.identities, (unsigned long long)stats.dropped, stats.aircraft, stats.closed ? ", closed" : "");
+    }
+    fprintf(stderr, "merged: %zu aircraft, %zu reported by several simulators, %llu matches, %zu duplicates\n", aggregator.aircraft().size(),
+        shared, (unsigned long long)aggregator.matched(), duplicates);
+    fprintf(stderr, "merge: %llu records, us per merge p50 %.1f  p99 %.1f  max %.1f\n", (unsigned long long)merged, percentile(mergeUs, 0.5),
+        percentile(mergeUs, 0.99), percentile(mergeUs, 1.0));
+
+    nodes.clear();
+    for (HANDLE hSimConnect : connections)
+        SimConnect_Close(hSimConnect);
+    return duplicates == 0 ? 0 : 1;
+}
+
+int main(int argc, char* argv[])
+{
+    StandInSettings settings = defaultStandInSettings();
+    double density = 10;
+    long aircraft = -1;
+    double radiusNm = 100;
+    int sweeps = 50;
+    bool report = false;
+    bool tiers = false;
+    bool serial = false;
+    int probes = 0;
+    int sources = 0;
+    uint32_t slowMs = 0;
+    StageSettings stageSettings = DEFAULT_STAGE_SETTINGS;
+    StateEpsilons stateEpsilons = DEFAULT_STATE_EPSILONS;
+    SIMCONNECT_DATA_REQUEST_FLAG trackedFlags = SIMCONNECT_DATA_REQUEST_FLAG_CHANGED | SIMCONNECT_DATA_REQUEST_FLAG_TAGGED;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--density") == 0 && i + 1 < argc)
+            density = atof(argv[++i]);
+        else if (strcmp(argv[i], "--aircraft") == 0 && i + 1 < argc)
+            aircraft = atol(argv[++i]);
+        else if (strcmp(argv[i], "--radius") == 0 && i + 1 < argc)
+            radiusNm = atof(argv[++i]);
+        else if (strcmp(argv[i], "--parked") == 0 && i + 1 < argc)
+            settings.parkedShare = atof(argv[++i]);
+        else if (strcmp(argv[i], "--sweeps") == 0 && i + 1 < argc)
+            sweeps = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--report") == 0)
+            report = true;
+        else if (strcmp(argv[i], "--tiers") == 0)
+            tiers = true;
+        else if (strcmp(argv[i], "--workers") == 0 && i + 1 < argc)
+            stageSettings.workers = (uint32_t)atoi(argv[++i]);
+        else if (strcmp(argv[i], "--serial") == 0)
+            serial = true;
+        else if (strcmp(argv[i], "--probes") == 0 && i + 1 < argc)
+            probes = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--sources") == 0 && i + 1 < argc)
+            sources = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--slow") == 0 && i + 1 < argc)
+            slowMs = (uint32_t)atoi(argv[++i]);
+        else if (strcmp(argv[i], "--updates") == 0 && i + 1 < argc)
+            trackedFlags = strcmp(argv[++i], "full") == 0 ? 0 : SIMCONNECT_DATA_REQUEST_FLAG_CHANGED | SIMCONNECT_DATA_REQUEST_FLAG_TAGGED;
+        else if (strcmp(argv[i], "--epsilon") == 0 && i + 1 < argc)
+        {
+            float scale = (float)atof(argv[++i]);
+            stateEpsilons.heading *= scale;
+            stateEpsilons.altitude *= scale;
+            stateEpsilons.position *= scale;
+            stateEpsilons.groundSpeed *= scale;
+            stateEpsilons.verticalSpeed *= scale;
+        }
+        else
+        {
+            printf("Unknown option %s\n", argv[i]);
+            return 2;
+        }
+    }
+
+    settings.aircraft = aircraft >= 0 ? (uint32_t)aircraft : (uint32_t)(density * REAL_TRAFFIC_AIRCRAFT);
+    settings.spawnRadiusNm = radiusNm;
+    if (sources > 0)
+        return runAggregation(settings, std::min(sources, (int)AGGREGATOR_MAX_SOURCES), sweeps, radiusNm, slowMs);
+    settings.timeScale = 0;     // traffic moves one sim second per sweep, however long the sweep takes
+    configureStandIn(settings);
+
+    FILE* sink = report ? stdout : fopen(NULL_DEVICE, "w");
+    if (!sink)
+        sink = stdout;
+    AsyncOutput output(sink, 1 << 16, OVERFLOW_BLOCK);
+    TrafficPipeline pipeline(output, settings.centreLat, settings.centreLon, 3799);
+    TrafficStages stages(pipeline, stageSettings);
+    TrafficMetrics metrics;
+    pipeline.metrics = &metrics;
+    stages.setMetrics(&metrics);
+    output.setLatencyHistogram(&metrics.outputNs);
+    LoadState state = { &stages, NULL, false, false, 0 };
+
+    // The default tier radii suit a 10 nm search; scale them with the radius so the tiers hold a similar share
+    TierSettings tierSettings = DEFAULT_TIER_SETTINGS;
+    tierSettings.nearNm = radiusNm / 10;
+    tierSettings.midNm = radiusNm / 3;
+    pipeline.scheduler().setSettings(tierSettings);
+    pipeline.predictor().maxExtrapolationSeconds = tierSettings.farSweepMs / 1000.0 + 1;
+    int farSweepSeconds = tiers ? std::max(1, (int)(tierSettings.farSweepMs / 1000)) : 1;
+
+    HANDLE hSimConnect = NULL;
+    if (FAILED(SimConnect_Open(&hSimConnect, "Traffic Load", NULL, 0, NULL, 0)))
+    {
+        printf("Could not open the stand-in\n");
+        return 1;
+    }
+
+    // The same data definitions NearbyAircraft uses
+    addDataDefinition<PackedAircraftState>(hSimConnect, DEFINITION_AIRCRAFT_STATE, &stateEpsilons);
+    addDataDefinition<AircraftTitle>(hSimConnect, DEFINITION_AIRCRAFT_TITLE);
+    addDataDefinition<OwnshipState>(hSimConnect, DEFINITION_OWNSHIP);
+
+    // Extra sweeps of their own radii share the connection; the client claims their answers before the stages see them
+    SimConnectRequests requests(hSimConnect);
+    TrafficClient client(requests);
+    client.clock = loadClock;
+    state.client = &client;
+    ProbeTotals probeTotals = {};
+    size_t probesInFlight = 0;
+    SimConnect_RequestDataOnSimObject(hSimConnect, REQUEST_OWNSHIP, DEFINITION_OWNSHIP, SIMCONNECT_OBJECT_ID_USER, SIMCONNECT_PERIOD_SIM_FRAME);
+
+    output.start();
+    SimConnect_CallDispatch(hSimConnect, loadDispatchProc, &state);
+    if (!serial)
+        stages.start();
+    auto loadStart = std::chrono::steady_clock::now();
+
+    std::vector<double> requestMs;
+    std::vector<double> dispatchMs;
+    std::vector<uint32_t> titleRequests;
+    std::vector<TierChange> tierChanges;
+    uint64_t messages = 0;
+    uint64_t titles = 0;
+    uint64_t tierRequests = 0;
+    int seconds = 0;
+    for (; seconds < sweeps && !state.quit; seconds++)
+    {
+        // Tracked aircraft are sent by the stand-in while it steps through the second
+        advanceStandIn(hSimConnect, 1);
+
+        auto start = std::chrono::steady_clock::now();
+        bool wideSweep = seconds % farSweepSeconds == 0;
+        if (wideSweep)
+            SimConnect_RequestDataOnSimObjectType(hSimConnect, REQUEST_LOCAL_AIRCRAFT, DEFINITION_AIRCRAFT_STATE, nmToMeters(radiusNm), SIMCONNECT_SIMOBJECT_TYPE_AIRCRAFT);
+        for (int probe = 0; probe < probes; probe++)
+        {
+            client.requestByType(DEFINITION_AIRCRAFT_STATE, (uint32_t)nmToMeters(radiusNm * (probe + 1) / probes), TRAFFIC_OBJECT_TYPE_AIRCRAFT,
+                onProbeSweep, &probeTotals);
+        }
+        probesInFlight = std::max(probesInFlight, client.inFlight());
+        auto requested = std::chrono::steady_clock::now();
+        // drain() waits for commit, so the counters below are safe to read and the time covers every stage
+        uint64_t before = pipeline.records() + pipeline.trackedRecords();
+        uint64_t dispatchStart = monotonicNs();
+        SimConnect_CallDispatch(hSimConnect, loadDispatchProc, &state);
+        metrics.dispatchNs.record(monotonicNs() - dispatchStart);
+        client.runReady(loadClock());
+        stages.drain();
+        auto dispatched = std::chrono::steady_clock::now();
+
+        messages += pipeline.records() + pipeline.trackedRecords() - before;
+
+        // Titles for aircraft first seen in this sweep; the answers are dispatched with the next sweep
+        titles += stages.takeTitleRequests(titleRequests);
+        for (uint32_t objectId : titleRequests)
+            SimConnect_RequestDataOnSimObject(hSimConnect, REQUEST_AIRCRAFT_TITLE, DEFINITION_AIRCRAFT_TITLE, objectId, SIMCONNECT_PERIOD_ONCE);
+
+        // Tier changes from the sweep just dispatched, turned into per-object requests as NearbyAircraft does
+        stages.takeTierChanges(tierChanges);
+        for (size_t i = 0; tiers && i < tierChanges.size(); i++)
+        {
+            const TierChange& change = tierChanges[i];
+            DWORD requestId = REQUEST_TRACKED_AIRCRAFT + change.objectId;
+            if (change.to == TIER_NEAR)
+                SimConnect_RequestDataOnSimObject(hSimConnect, requestId, DEFINITION_AIRCRAFT_STATE, change.objectId, SIMCONNECT_PERIOD_SIM_FRAME, trackedFlags, 0, tierSettings.nearFrameInterval);
+            else if (change.to == TIER_MID)
+                SimConnect_RequestDataOnSimObject(hSimConnect, requestId, DEFINITION_AIRCRAFT_STATE, change.objectId, SIMCONNECT_PERIOD_SECOND, trackedFlags);
+            else
+                SimConnect_RequestDataOnSimObject(hSimConnect, requestId, DEFINITION_AIRCRAFT_STATE, change.objectId, SIMCONNECT_PERIOD_NEVER);
+            tierRequests++;
+        }
+
+        if (!wideSweep)
+        {
+            dispatchMs.push_back(std::chrono::duration<double, std::milli>(dispatched - requested).count());
+            continue;
+        }
+        requestMs.push_back(std::chrono::duration<double, std::milli>(requested - start).count());
+        dispatchMs.push_back(std::chrono::duration<double, std::milli>(dispatched - requested).count());
+    }
+
+    stages.stop();
+    output.stop();
+    double loadSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - loadStart).count();
+    std::vector<StageStats> stageStats;
+    stages.stats(stageStats);
+    MetricsSnapshot metricsSnapshot;
+    snapshotMetrics(metrics, output, metricsSnapshot);
+    StandInStats stats = standInStats(hSimConnect);
+    SimConnect_Close(hSimConnect);
+    if (sink != stdout)
+        fclose(sink);
+
+    double totalDispatchMs = 0;
+    for (double ms : dispatchMs)
+        totalDispatchMs += ms;
+
+    fprintf(stderr, "\n%u AI aircraft (%.1fx a busy terminal area) within %.0f nm, %d sim seconds, %d wide sweeps%s\n", settings.aircraft,
+        settings.aircraft / (double)REAL_TRAFFIC_AIRCRAFT, radiusNm, seconds, (int)requestMs.size(), state.opened ? "" : " (no OPEN received)");
+    fprintf(stderr, "messages: %llu (%.0f per sim second), %llu title requests, %llu bytes (%.0f per sim second), %llu exceptions\n",
+        (unsigned long long)messages, seconds > 0 ? messages / (double)seconds : 0.0, (unsigned long long)titles,
+        (unsigned long long)stats.bytesDelivered, seconds > 0 ? stats.bytesDelivered / (double)seconds : 0.0, (unsigned long long)state.exceptions);
+    if (tiers)
+    {
+        fprintf(stderr, "tiers: near < %.1f nm every %u frames, mid < %.1f nm at 1 Hz, far every %d s: %zu near, %zu mid now, %llu tier changes\n",
+            tierSettings.nearNm, tierSettings.nearFrameInterval + 1, tierSettings.midNm, farSweepSeconds, pipeline.scheduler().count(TIER_NEAR),
+            pipeline.scheduler().count(TIER_MID), (unsigned long long)tierRequests);
+        fprintf(stderr, "tracked updates (%s): %llu received, %llu partial, %llu dropped, %llu unchanged and not sent\n",
+            trackedFlags ? "changed only" : "full", (unsigned long long)pipeline.trackedRecords(), (unsigned long long)pipeline.partialRecords(),
+            (unsigned long long)pipeline.partialDropped(), (unsigned long long)stats.unchanged);
+    }
+    if (probes > 0)
+    {
+        const ClientStats& clientStats = client.stats();
+        fprintf(stderr, "probes: %llu sweeps (%llu incomplete) of %.0f aircraft on average, up to %zu in flight at once, %llu late messages\n",
+            (unsigned long long)clientStats.sweeps, (unsigned long long)clientStats.incomplete,
+            probeTotals.sweeps > 0 ? probeTotals.entries / (double)probeTotals.sweeps : 0.0, probesInFlight, (unsigned long long)clientStats.late);
+    }
+    const ConflictSettings& conflictSettings = pipeline.conflicts().settings();
+    fprintf(stderr, "conflicts: %zu pairs losing %.0f nm / %.0f ft within %.0f s after the last sweep (%zu candidate pairs probed)\n",
+        pipeline.conflicts().conflicts().size(), conflictSettings.separationNm, conflictSettings.separationFt, conflictSettings.lookaheadSeconds,
+        pipeline.conflicts().candidates());
+    fprintf(stderr, "ownship: %llu per-frame samples, now %.5f %.5f at %.0f ft\n", (unsigned long long)pipeline.ownshipCell().updates(),
+        pipeline.ownship().latitude(), pipeline.ownship().longitude(), pipeline.ownship().altitude());
+    fprintf(stderr, "pipeline: %.0f messages/s, %.0f ns/message\n", totalDispatchMs > 0 ? messages / (totalDispatchMs / 1000) : 0.0,
+        messages > 0 ? totalDispatchMs * 1e6 / messages : 0.0);
+    if (!serial)
+    {
+        fprintf(stderr, "stages (%u compute workers, %u cores):\n", stages.workers(), std::thread::hardware_concurrency());
+        printStageStats(stderr, stageStats, loadSeconds);
+    }
+    writeMetrics(stderr, metricsSnapshot);
+    fprintf(stderr, "dispatch ms per sim second: p50 %.3f  p99 %.3f  max %.3f   (stand-in generation p50 %.3f ms)\n",
+        percentile(dispatchMs, 0.5), percentile(dispatchMs, 0.99), percentile(dispatchMs, 1.0), percentile(requestMs, 0.5));
+
+    return state.exceptions == 0 ? 0 : 1;
+}
@@ -0,0 +1,109 @@
+// TrafficReplay.cpp : Plays a NearbyAircraft recording (--record) back through the traffic pipeline.
+//
+// Uses no SimConnect, so it also builds on Linux for profiling and regression runs:
+//   g++ -std=c++17 -O2 -I../P3DNearbyAircraft -o TrafficReplay TrafficReplay.cpp ../P3DNearbyAircraft/{Utilities,ReferenceFrame,TrafficIndex,TrafficTable,AsyncOutput,ReceiveEngine,TrafficPipeline,TitleTable,DeadReckoning,TrafficScheduler,TrafficLog,ReplayTransport,ConflictDetector,LatencyHistogram,TrafficMetrics,DecodedMessage,SweepAssembler,TrafficSnapshot}.cpp -lpthread
+//
+// Usage: TrafficReplay <recording> [options]
+//   --speed <N>    play N times faster than recorded (default 1)
+//   --max          play as fast as the pipeline takes it
+//   --quiet        discard the traffic report; only print the summary
+
+#include <chrono>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "AsyncOutput.h"
+#include "ReceiveEngine.h"
+#include "ReplayTransport.h"
+#include "TrafficLog.h"
+#include "TrafficPipeline.h"
+
+#ifdef _WIN32
+static const char* NULL_DEVICE = "NUL";
+#else
+static const char* NULL_DEVICE = "/dev/null";
+#endif
+
+// The pipeline's clock during a replay: the time each message was recorded, not when it is played
+static ReplayTransport* replaying = NULL;
+
+static double replayClock()
+{
+    return replaying->recordedSeconds();
+}
+
+static void dispatchMessage(const void* data, uint32_t size, void* context)
+{
+    // The clock only moves as messages are handed out, so sweeps time out just before the first message past
+    // their timeout, as many messages into the recording at any speed
+    TrafficPipeline* pipeline = (TrafficPipeline*)context;
+    pipeline->expireSweeps();
+    pipeline->onMessage(data, size);
+}
+
+int main(int argc, char* argv[])
+{
+    const char* path = NULL;
+    double speed = 1;
+    bool quiet = false;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--speed") == 0 && i + 1 < argc)
+            speed = atof(argv[++i]);
+        else if (strcmp(argv[i], "--max") == 0)
+            speed = 0;
+        else if (strcmp(argv[i], "--quiet") == 0)
+            quiet = true;
+        else
+            path = argv[i];
+    }
+
+    if (!path)
+    {
+        printf("Usage: TrafficReplay <recording> [--speed <N> | --max] [--quiet]\n");
+        return 2;
+    }
+
+    TrafficLogReader reader;
+    if (!reader.open(path))
+    {
+        printf("Could not open recording %s\n", path);
+        return 2;
+    }
+
+    FILE* sink = quiet ? fopen(NULL_DEVICE, "w") : stdout;
+    if (!sink)
+        sink = stdout;
+
+    // Same starting ownship as NearbyAircraft; the recording's user aircraft moves it from there
+    AsyncOutput output(sink, 1 << 16, OVERFLOW_BLOCK);
+    TrafficPipeline pipeline(output, 32.951917, -97.264323, 3799);
+    ReplayTransport transport(reader, speed);
+    ReceiveEngine receiver(transport);
+    replaying = &transport;
+    pipeline.clock = replayClock;
+
+    output.start();
+    auto start = std::chrono::steady_clock::now();
+    while (!transport.finished())
+        receiver.pump(dispatchMessage, &pipeline);
+    pipeline.closeSweeps();     // a recording stopped mid-sweep
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    output.stop();
+
+    if (sink != stdout)
+        fclose(sink);
+
+    const TrafficLogStats& log = reader.stats();
+    const ReceiveStats& received = receiver.stats();
+    OutputStats written = output.stats();
+    fprintf(stderr, "\nReplayed %llu messages (%llu sweeps) from %llu chunks in %.3f s, %.0f messages/s\n",
+        (unsigned long long)received.messages, (unsigned long long)pipeline.sweeps(), (unsigned long long)log.chunks,
+        seconds, seconds > 0 ? received.messages / seconds : 0.0);
+    fprintf(stderr, "Chunks: %llu corrupt, %llu unsealed.  Output: %llu records written\n",
+        (unsigned long long)log.corruptChunks, (unsigned long long)log.unsealedChunks, (unsigned long long)written.written);
+
+    return log.corruptChunks == 0 ? 0 : 1;
+}